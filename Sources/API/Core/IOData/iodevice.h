@@ -46,7 +46,8 @@ class IODevice_Impl;
 ///
 /// This class can store basic datatypes and retain portability (using the specified endian mode)\n
 ///    The supported datatypes are: int64_t, int32_t, int16_t and int8_t\n
-///    The std::string datatype is supported - Using Size(int32_t), Charactor Data (std::string characters) 
+///    The std::string datatype is supported - Using Size(int32_t), Charactor Data (std::string characters)\n
+///    Sizes and positions are 64 bit, while a single send or receive call transfers at most 2 GB.
 class IODevice
 {
 /// \name Enumerations
@@ -95,12 +96,12 @@ public:
 	/// \brief Returns the size of data stream.
 	/** <p>Returns -1 if the size is unknown.</p>
 	    \return The size (-1 if size is unknown)*/
-	int get_size() const;
+	int64_t get_size() const;
 
 	/// \brief Returns the position in the data stream.
 	/** <p>Returns -1 if the position is unknown.</p>
 	    \return The size (-1 if position is unknown)*/
-	int get_position() const;
+	int64_t get_position() const;
 
 	/// \brief Returns true if the input source is in little endian mode.
 	/** \return true if little endian*/
@@ -146,7 +147,7 @@ public:
 	/// \param position Position to use (usage depends on the seek mode)
 	/// \param mode Seek mode
 	/// \return false = Failed
-	bool seek(int position, SeekMode mode = seek_set);
+	bool seek(int64_t position, SeekMode mode = seek_set);
 
 	/// \brief Alias for receive(data, len, receive_all)
 	///
@@ -32,6 +32,7 @@
 #include <memory>
 #include <functional>
 #include <vector>
+#include <algorithm>
 
 namespace clan
 {
@@ -63,68 +64,156 @@ namespace clan
 		virtual ~SlotImpl() { }
 	};
 
-	template<typename SlotImplType>
-	class SignalImpl
+	template<typename FuncType>
+	class SignalCallback
 	{
 	public:
-		std::vector<std::weak_ptr<SlotImplType>> slots;
+		SignalCallback(const std::function<FuncType> &func) : func(func) { }
+
+		std::function<FuncType> func;
+		bool connected = true;
 	};
 
 	template<typename FuncType>
-	class SlotImplT : public SlotImpl
+	class SignalImpl;
+
+	/// \brief Bookkeeping for an emission in progress. Lives on the stack of Signal::operator()
+	template<typename FuncType>
+	class SignalEmitFrame
 	{
 	public:
-		SlotImplT(const std::weak_ptr<SignalImpl<SlotImplT>> &signal, const std::function<FuncType> &callback) : signal(signal), callback(callback)
+		SignalEmitFrame(SignalImpl<FuncType> *signal) : signal(signal), parent(signal->emit_frame)
 		{
+			signal->emit_frame = this;
 		}
 
-		~SlotImplT()
+		~SignalEmitFrame()
 		{
-			std::shared_ptr<SignalImpl<SlotImplT>> sig = signal.lock();
-			if (sig)
+			if (!signal_destroyed)
 			{
-				for (auto it = sig->slots.begin(); it != sig->slots.end(); ++it)
+				signal->emit_frame = parent;
+				if (!parent && signal->needs_compact)
+					signal->compact();
+			}
+		}
+
+		SignalEmitFrame(const SignalEmitFrame &) = delete;
+		SignalEmitFrame &operator=(const SignalEmitFrame &) = delete;
+
+		SignalImpl<FuncType> *signal;
+		SignalEmitFrame *parent;
+		bool signal_destroyed = false;
+
+		// Callbacks of a signal destroyed during emission are kept alive until the outermost emission returns
+		std::vector<std::unique_ptr<SignalCallback<FuncType>>> orphaned_callbacks;
+	};
+
+	template<typename FuncType>
+	class SignalImpl
+	{
+	public:
+		SignalImpl() { }
+		SignalImpl(const SignalImpl &) = delete;
+		SignalImpl &operator=(const SignalImpl &) = delete;
+
+		~SignalImpl()
+		{
+			if (emit_frame)
+			{
+				SignalEmitFrame<FuncType> *outermost = emit_frame;
+				for (SignalEmitFrame<FuncType> *frame = emit_frame; frame; frame = frame->parent)
 				{
-					// todo: investigate if "it->lock().get() == this" is required
-					if (it->expired() || it->lock().get() == this)
+					frame->signal_destroyed = true;
+					outermost = frame;
+				}
+				outermost->orphaned_callbacks.swap(callbacks);
+			}
+		}
+
+		void disconnect(SignalCallback<FuncType> *callback)
+		{
+			if (emit_frame)
+			{
+				// Removing entries would shift the indices of the emission in progress
+				callback->connected = false;
+				needs_compact = true;
+			}
+			else
+			{
+				for (auto it = callbacks.begin(); it != callbacks.end(); ++it)
+				{
+					if (it->get() == callback)
 					{
-						it = sig->slots.erase(it);
-						if (it == sig->slots.end())
-							break;
+						callbacks.erase(it);
+						break;
 					}
 				}
 			}
 		}
 
-		std::weak_ptr<SignalImpl<SlotImplT>> signal;
-		std::function<FuncType> callback;
+		void compact()
+		{
+			callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [](const std::unique_ptr<SignalCallback<FuncType>> &callback) { return !callback->connected; }), callbacks.end());
+			needs_compact = false;
+		}
+
+		std::vector<std::unique_ptr<SignalCallback<FuncType>>> callbacks;
+		SignalEmitFrame<FuncType> *emit_frame = nullptr;
+		bool needs_compact = false;
+	};
+
+	template<typename FuncType>
+	class SlotImplT : public SlotImpl
+	{
+	public:
+		SlotImplT(const std::weak_ptr<SignalImpl<FuncType>> &signal, SignalCallback<FuncType> *callback) : signal(signal), callback(callback)
+		{
+		}
+
+		~SlotImplT()
+		{
+			std::shared_ptr<SignalImpl<FuncType>> sig = signal.lock();
+			if (sig)
+				sig->disconnect(callback);
+		}
+
+		std::weak_ptr<SignalImpl<FuncType>> signal;
+		SignalCallback<FuncType> *callback;
 	};
 
 	template<typename FuncType>
 	class Signal
 	{
 	public:
-		Signal() : impl(std::make_shared<SignalImpl<SlotImplT<FuncType>>>()) { }
+		Signal() : impl(std::make_shared<SignalImpl<FuncType>>()) { }
 
+		/// \brief Invokes all connected callbacks
+		///
+		/// Callbacks connected during emission are first invoked by the next emission. Callbacks disconnected
+		/// during emission are skipped. Emitting does not allocate memory or touch reference counts.
 		template<typename... Args>
 		void operator()(Args... args)
 		{
-			std::vector<std::weak_ptr<SlotImplT<FuncType>>> slots = impl->slots;
-			for (std::weak_ptr<SlotImplT<FuncType>> &weak_slot : slots)
+			SignalImpl<FuncType> *signal = impl.get();
+			SignalEmitFrame<FuncType> frame(signal);
+
+			size_t count = signal->callbacks.size();
+			for (size_t i = 0; i < count; i++)
 			{
-				std::shared_ptr<SlotImplT<FuncType>> slot = weak_slot.lock();
-				if (slot)
+				SignalCallback<FuncType> *callback = signal->callbacks[i].get();
+				if (callback->connected)
 				{
-					slot->callback(args...);
+					callback->func(args...);
+					if (frame.signal_destroyed)
+						break;
 				}
 			}
 		}
 
 		Slot connect(const std::function<FuncType> &func)
 		{
-			auto slot_impl = std::make_shared<SlotImplT<FuncType>>(impl, func);
-			impl->slots.push_back(slot_impl);
-			return Slot(slot_impl);
+			impl->callbacks.push_back(std::unique_ptr<SignalCallback<FuncType>>(new SignalCallback<FuncType>(func)));
+			return Slot(std::make_shared<SlotImplT<FuncType>>(impl, impl->callbacks.back().get()));
 		}
 
 		template<typename InstanceType, typename MemberFuncType>
@@ -134,7 +223,7 @@ namespace clan
 		}
 
 	private:
-		std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> impl;
+		std::shared_ptr<SignalImpl<FuncType>> impl;
 	};
 
 	class SlotContainer
@@ -51,6 +51,34 @@ public:
 };
 
 class WorkQueue_Impl;
+class WorkTaskGroup_Impl;
+
+/// \brief Handle for waiting on a group of work items queued on a WorkQueue
+class WorkTaskGroup
+{
+public:
+	/// \brief Constructs a null instance
+	WorkTaskGroup();
+
+	/// \brief Returns true if this object is invalid.
+	bool is_null() const { return !impl; }
+
+	/// \brief Returns true if all work queued in the group has been processed
+	bool is_done() const;
+
+	/// \brief Blocks until all work queued in the group has been processed
+	///
+	/// When called from a worker thread of the owning queue, the thread processes other queued work while waiting.
+	/// Rethrows the first exception thrown by work in the group.
+	void wait();
+
+private:
+	WorkTaskGroup(const std::shared_ptr<WorkTaskGroup_Impl> &impl);
+
+	std::shared_ptr<WorkTaskGroup_Impl> impl;
+
+	friend class WorkQueue;
+};
 
 /// \brief Thread pool for worker threads
 class WorkQueue
@@ -69,6 +97,20 @@ public:
 	/// \brief Queue some work to be executed on a worker thread
 	void queue(const std::function<void()> &func);
 
+	/// \brief Creates a group that work can be queued into and waited on
+	WorkTaskGroup create_task_group();
+
+	/// \brief Queue some work to be executed on a worker thread as part of a task group
+	///
+	/// The work is not part of get_items_queued() and needs no process_work_completed() call to be released.
+	void queue(const WorkTaskGroup &group, const std::function<void()> &func);
+
+	/// \brief Splits [0, range) into chunks of grain size and processes them on the worker threads
+	///
+	/// Blocks until all chunks have been processed. The calling thread processes chunks too.
+	/// Rethrows the first exception thrown by func.
+	void parallel_for(int range, int grain, const std::function<void(int begin, int end)> &func);
+
 	/// \brief Queue some work to be executed on the main WorkQueue thread
 	void work_completed(const std::function<void()> &func);
 
@@ -31,6 +31,7 @@
 
 #include <memory>
 #include "xpath_object.h"
+#include "xpath_expression.h"
 
 namespace clan
 {
@@ -63,6 +64,14 @@ public:
 	/// \return XPath Object
 	XPathObject evaluate(const std::string &expression, const DomNode &context_node) const;
 
+	/// \brief Evaluate a compiled expression
+	///
+	/// \param expression = Compiled XPath expression
+	/// \param context_node = Dom Node
+	///
+	/// \return XPath Object
+	XPathObject evaluate(const XPathExpression &expression, const DomNode &context_node) const;
+
 /// \}
 /// \name Implementation
 /// \{
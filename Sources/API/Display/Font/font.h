@@ -35,6 +35,7 @@
 #include "../2D/sprite.h"
 #include "font_description.h"
 #include "glyph_metrics.h"
+#include "font_text_run.h"
 
 namespace clan
 {
@@ -144,6 +145,23 @@ public:
 	void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color = Colorf::white);
 	void draw_text(Canvas &canvas, float xpos, float ypos, const std::string &text, const Colorf &color = Colorf::white) { draw_text(canvas, Pointf(xpos, ypos), text, color); }
 
+	/// \brief Print text prepared with prepare_text
+	///
+	/// \param canvas = Canvas
+	/// \param position = Dest position
+	/// \param run = The text to draw
+	/// \param color = The text color
+	void draw_text(Canvas &canvas, const Pointf &position, const FontTextRun &run, const Colorf &color = Colorf::white);
+	void draw_text(Canvas &canvas, float xpos, float ypos, const FontTextRun &run, const Colorf &color = Colorf::white) { draw_text(canvas, Pointf(xpos, ypos), run, color); }
+
+	/// \brief Prepare text for drawing
+	///
+	/// Decodes the text and looks up the glyphs once, so the returned run can be drawn and measured many times.
+	/// \param canvas = Canvas
+	/// \param text = The text to prepare
+	/// \return The text run
+	FontTextRun prepare_text(Canvas &canvas, const std::string &text);
+
 	/// \brief Gets the glyph metrics
 	///
 	/// \param glyph = The glyph to get
@@ -156,6 +174,12 @@ public:
 	/// \return The metrics
 	GlyphMetrics measure_text(Canvas &canvas, const std::string &string);
 
+	/// \brief Measure the size of text prepared with prepare_text
+	///
+	/// \param run = The text to use
+	/// \return The metrics
+	GlyphMetrics measure_text(Canvas &canvas, const FontTextRun &run);
+
 	/// \brief Retrieves font metrics description for the selected font.
 	FontMetrics get_font_metrics(Canvas &canvas);
 
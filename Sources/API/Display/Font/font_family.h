@@ -46,6 +46,29 @@ class Canvas;
 class FontFamily_Impl;
 class GlyphMetrics;
 
+/// \brief Glyph cache counters of a font family
+class GlyphCacheStatistics
+{
+public:
+	/// \brief Number of glyph lookups served from the cache
+	uint64_t hits = 0;
+
+	/// \brief Number of glyph lookups that had to render the glyph
+	uint64_t misses = 0;
+
+	/// \brief Number of glyphs removed from the texture atlas to stay within the memory budget
+	uint64_t evictions = 0;
+
+	/// \brief Number of glyphs currently cached
+	int glyph_count = 0;
+
+	/// \brief Number of texture atlas pages currently allocated
+	int atlas_pages = 0;
+
+	/// \brief Bytes of texture memory currently used by the texture atlas pages
+	int64_t atlas_bytes = 0;
+};
+
 /// \brief FontFamily class
 ///
 /// A FontFamily is a collection of font descriptions
@@ -75,6 +98,12 @@ public:
 	/// \brief Font family name used for this font family
 	const std::string &get_family_name() const;
 
+	/// \brief Returns the glyph cache counters, summed over all fonts in this family
+	GlyphCacheStatistics get_glyph_cache_statistics() const;
+
+	/// \brief Returns the glyph texture atlas memory budget in bytes (0 = unlimited)
+	int64_t get_glyph_cache_budget() const;
+
 /// \}
 /// \name Operations
 /// \{
@@ -101,6 +130,13 @@ public:
 	/// \param metrics = Font metrics for the sprite font
 	void add(Canvas &canvas, Sprite &sprite, const std::string &glyph_list, float spacelen, bool monospace, const FontMetrics &metrics);
 
+	/// \brief Limits how much glyph texture atlas memory the fonts in this family may use
+	///
+	/// The budget is charged per atlas page. When a new glyph needs another page and that exceeds the budget,
+	/// all glyphs on the least recently used page are evicted and the page texture is released.
+	/// \param bytes = Budget in bytes, or 0 for no limit (the default)
+	void set_glyph_cache_budget(int64_t bytes);
+
 /// \}
 /// \name Implementation
 /// \{
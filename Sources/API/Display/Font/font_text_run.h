@@ -0,0 +1,93 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "glyph_metrics.h"
+
+namespace clan
+{
+/// \addtogroup clanDisplay_Font clanDisplay Font
+/// \{
+
+class Font;
+class FontTextRun_Impl;
+
+/// \brief Text prepared for drawing with a font
+///
+/// A text run holds the glyphs of a string and their positions, so that drawing or measuring the same text again
+/// does not need to decode the string or look up the glyph metrics. Use Font::prepare_text to create a run.
+///
+/// If the font is changed (for example by Font::set_height) after the run was prepared, the run is prepared again the next time it is used.
+class FontTextRun
+{
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs a null text run.
+	FontTextRun();
+
+/// \}
+/// \name Attributes
+/// \{
+public:
+	/// \brief Returns true if this object is invalid.
+	bool is_null() const { return !impl; }
+
+	/// \brief Throw an exception if this object is invalid.
+	void throw_if_null() const;
+
+	/// \brief Returns the text of the run
+	const std::string &get_text() const;
+
+	/// \brief Returns the number of glyphs in the run (excluding line breaks)
+	int get_glyph_count() const;
+
+	/// \brief Returns the size of the text, as it was when the run was prepared
+	///
+	/// Font::measure_text(canvas, run) also updates the run if the font has been changed since.
+	GlyphMetrics get_metrics() const;
+
+/// \}
+/// \name Implementation
+/// \{
+private:
+	FontTextRun(const std::shared_ptr<FontTextRun_Impl> &impl);
+
+	std::shared_ptr<FontTextRun_Impl> impl;
+
+	friend class Font;
+/// \}
+};
+
+}
+
+/// \}
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include "../../Core/Math/vec4.h"
 #include "texture_format.h"
 
@@ -40,6 +41,7 @@ namespace clan
 /// \{
 
 class PixelConverter_Impl;
+class WorkQueue;
 
 /// \brief Low level pixel format converter class.
 class PixelConverter
@@ -105,8 +107,24 @@ public:
 	/// \brief Converts to JPEG JFIF YCrCb
 	void set_output_is_ycrcb(bool enable);
 
+	/// \brief Limits the SIMD instruction sets used by the conversion kernels
+	///
+	/// By default all instruction sets supported by the CPU are used. Instruction sets the CPU lacks stay disabled even if enabled here.
+	/// Disabling all of them selects the scalar kernels, which is mostly useful for testing the other kernels against them.
+	void set_instruction_sets(bool sse2, bool ssse3, bool sse4, bool avx2);
+
 	/// \brief Convert some pixel data
 	void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height);
+
+	/// \brief Convert some pixel data on the worker threads of a work queue
+	///
+	/// The image is split into bands of rows that are converted in parallel. The output is identical to the single threaded convert.
+	void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, WorkQueue &queue);
+
+	/// \brief Convert some pixel data using a custom executor
+	///
+	/// The image is split into bands of rows. The executor must call func once for every band in [0, num_bands), in any order and on any thread, and return when all calls have completed.
+	void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, const std::function<void(int num_bands, const std::function<void(int band)> &func)> &executor);
 /// \}
 
 /// \name Implementation
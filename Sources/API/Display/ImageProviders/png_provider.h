@@ -32,6 +32,7 @@
 
 #include "../Image/pixel_buffer.h"
 #include "../../Core/IOData/file_system.h"
+#include <functional>
 
 namespace clan
 {
@@ -67,6 +68,19 @@ public:
 	/// \return Pixel Buffer
 	static PixelBuffer load(IODevice &dev, bool srgb = false);
 
+	/// \brief Load while reporting the rows as they are decoded
+	///
+	/// The image data is inflated incrementally and written straight into the returned pixel buffer.
+	/// rows_decoded is called with the image and a band of rows [y, y + height) as soon as the band holds its final pixels,
+	/// for example to upload it to a texture while the rest of the file is decoded. Interlaced images are reported as one band once the last pass is done.
+	///
+	/// \param dev = IODevice
+	/// \param srgb = Load as tf_srgb8_alpha8 instead of tf_rgba8
+	/// \param rows_decoded = Function called for every decoded band of rows
+	///
+	/// \return Pixel Buffer
+	static PixelBuffer load(IODevice &dev, bool srgb, const std::function<void(const PixelBuffer &image, int y, int height)> &rows_decoded);
+
 	/// \brief Called to save a given PixelBuffer to a file
 	static void save(
 		PixelBuffer buffer,
@@ -32,15 +32,41 @@
 #pragma once
 
 #include <map>
+#include <vector>
+#include <functional>
 #include "../../Core/IOData/file_system.h"
+#include "../Image/pixel_buffer.h"
 
 namespace clan
 {
 /// \addtogroup clanDisplay_Image_Providers clanDisplay Image Providers
 /// \{
 
-class PixelBuffer;
 class ImageProviderType;
+class WorkQueue;
+
+/// \brief Outcome of loading one image of a batch
+class ImageProviderBatchResult
+{
+public:
+	/// \brief Position of the image in the batch
+	int index = 0;
+
+	/// \brief Filename of the image, or an empty string for a batch of IODevices
+	std::string filename;
+
+	/// \brief The loaded image, or a null pixel buffer if loading failed
+	PixelBuffer image;
+
+	/// \brief Why loading failed
+	std::string failure_reason;
+
+	/// \brief Time spent reading the file, in microseconds
+	uint64_t read_microseconds = 0;
+
+	/// \brief Time spent decoding the image, in microseconds
+	uint64_t decode_microseconds = 0;
+};
 
 /// \brief Image Provider factory
 class ImageProviderFactory
@@ -89,6 +115,44 @@ public:
 		const std::string &type,
 		bool srgb = false);
 
+	/// \brief Loads a batch of image files on the worker threads of a work queue
+	///
+	/// <p>The type of each file is determined by its extension. The images are decoded in parallel, but the files are read
+	/// one at a time across all batches. Other use of the file system is not serialized with the batch, so the file system
+	/// must not be read by other threads while a batch is loading.</p>
+	/// <p>file_loaded is called for each file, in the order they finish, by the thread calling queue.process_work_completed().
+	/// A file that fails with a clan::Exception is reported with a null image and a failure reason. Any other exception
+	/// is rethrown from queue.process_work_completed(), and the next call reports the file as failed.</p>
+	static void load_batch(
+		WorkQueue &queue,
+		const std::vector<std::string> &filenames,
+		const FileSystem &fs,
+		const std::function<void(const ImageProviderBatchResult &result)> &file_loaded,
+		bool srgb = false);
+
+	/// \brief Loads a batch of images from IODevices on the worker threads of a work queue
+	///
+	/// <p>types holds the provider type of each device. Each device is read by a worker thread, so the devices
+	/// must not share state with each other or with the calling thread.</p>
+	/// <p>file_loaded is called for each device, in the order they finish, by the thread calling queue.process_work_completed().
+	/// Failures are reported the same way as for a batch of files.</p>
+	static void load_batch(
+		WorkQueue &queue,
+		const std::vector<IODevice> &files,
+		const std::vector<std::string> &types,
+		const std::function<void(const ImageProviderBatchResult &result)> &file_loaded,
+		bool srgb = false);
+
+	/// \brief Loads a batch of image files in parallel and waits for all of them
+	///
+	/// <p>Uses the worker threads of clanDisplay. The results are in the same order as the filenames.
+	/// A file that fails with a clan::Exception is reported with a null image and a failure reason. Any other exception
+	/// is rethrown once the whole batch has finished.</p>
+	static std::vector<ImageProviderBatchResult> load_batch(
+		const std::vector<std::string> &filenames,
+		const FileSystem &fs,
+		bool srgb = false);
+
 	/// \brief Saves the given PixelBuffer to the file given by 'filename'.
 	/** <p>If the type is an empty string, it uses the extension of the
 	    filename to determine what type it is </p>*/
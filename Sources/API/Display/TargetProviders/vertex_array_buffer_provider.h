@@ -73,6 +73,19 @@ public:
 
 	/// \brief Copies data to transfer buffer
 	virtual void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) = 0;
+
+	/// \brief Maps the whole buffer into client memory for the rest of its lifetime
+	///
+	/// Writes to the returned memory are visible to the GPU without an upload. The caller must use fence_range and
+	/// wait_range to avoid overwriting data the GPU is still reading.
+	/// \return Pointer to the mapped memory, or nullptr if the target does not support persistent mapping
+	virtual void *map_persistent(GraphicContext &gc) { return nullptr; }
+
+	/// \brief Inserts a fence after the commands submitted so far that read from the range
+	virtual void fence_range(GraphicContext &gc, int offset, int size) { }
+
+	/// \brief Blocks until the GPU has completed all fenced commands reading from the range
+	virtual void wait_range(GraphicContext &gc, int offset, int size) { }
 /// \}
 
 /// \name Implementation
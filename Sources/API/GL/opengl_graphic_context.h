@@ -39,6 +39,18 @@ namespace clan
 
 class GraphicContext_GL_Impl;
 
+/// \brief Bind and state calls counted by the state cache of a GL graphic context
+///
+/// Only the OpenGL 3 and later targets have a state cache. Other targets report zero for both counts.
+struct StateCacheCounters_GL
+{
+	/// \brief Calls passed on to OpenGL because they changed the state
+	int64_t calls_issued = 0;
+
+	/// \brief Calls dropped because OpenGL already had the requested state
+	int64_t calls_elided = 0;
+};
+
 /// \brief GL Graphic Context
 class GraphicContext_GL : public GraphicContext
 {
@@ -88,11 +100,28 @@ public:
 	/// \brief Get the list of opengl extensions.
 	std::vector<std::string> get_extensions();
 
+	/// \brief Get the counts of issued and elided calls since the last reset
+	StateCacheCounters_GL get_state_cache_counters() const;
+
 //!Operations
 public:
 	/// \brief Sets the thread's OpenGL context to the one used by the graphic context
 	void set_active();
 
+	/// \brief Sets the counts of issued and elided calls back to zero
+	void reset_state_cache_counters();
+
+	/// \brief Cross-check the state cache against OpenGL before every draw
+	///
+	/// Each check queries OpenGL with glGet calls and throws an exception naming the first state that differs
+	/// from the cache. Intended for debugging; it stalls the OpenGL pipeline.
+	void set_state_cache_validation(bool enable);
+
+	/// \brief Forgets the cached state
+	///
+	/// Call this after changing bindings with raw OpenGL calls, so the next ClanLib call is not dropped as redundant.
+	void invalidate_state_cache();
+
 //!Implementation
 private:
 	std::shared_ptr<GraphicContext_GL_Impl> impl;
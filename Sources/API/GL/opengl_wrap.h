@@ -1961,15 +1961,15 @@ public:
 #define glVertexArrayVertexBindingDivisorEXT clan::OpenGL::functions->vertexArrayVertexBindingDivisorEXT
 
 // OpenGL 4.4
-#define glBufferStorage clan::OpenGL::functions->BufferStorage;
-#define glClearTexImage clan::OpenGL::functions->ClearTexImage;
-#define glClearTexSubImage clan::OpenGL::functions->ClearTexSubImage;
-#define glBindBuffersBase clan::OpenGL::functions->BindBuffersBase;
-#define glBindBuffersRange clan::OpenGL::functions->BindBuffersRange;
-#define glBindTextures clan::OpenGL::functions->BindTextures;
-#define glBindSamplers clan::OpenGL::functions->BindSamplers;
-#define glBindImageTextures clan::OpenGL::functions->BindImageTextures;
-#define glBindVertexBuffers clan::OpenGL::functions->BindVertexBuffers;
+#define glBufferStorage clan::OpenGL::functions->BufferStorage
+#define glClearTexImage clan::OpenGL::functions->ClearTexImage
+#define glClearTexSubImage clan::OpenGL::functions->ClearTexSubImage
+#define glBindBuffersBase clan::OpenGL::functions->BindBuffersBase
+#define glBindBuffersRange clan::OpenGL::functions->BindBuffersRange
+#define glBindTextures clan::OpenGL::functions->BindTextures
+#define glBindSamplers clan::OpenGL::functions->BindSamplers
+#define glBindImageTextures clan::OpenGL::functions->BindImageTextures
+#define glBindVertexBuffers clan::OpenGL::functions->BindVertexBuffers
 
 // For Legacy OpenGL (For GL1 target)
 #define glClientActiveTexture clan::OpenGL::functions->clientActiveTexture
@@ -31,6 +31,7 @@
 
 
 #include "connection_site.h"	// TODO: Remove
+#include "transport.h"
 #include "../../Core/Signals/signal.h"
 
 namespace clan
@@ -58,6 +59,27 @@ public:
 	/// \brief Disconnect
 	void disconnect();
 
+	/// \brief Sets the protocol used to talk to the server
+	///
+	/// Must match the transport of the server. The transport is picked up by the next call to connect.
+	///
+	/// \param transport = NetGameTransport::tcp (default) or NetGameTransport::udp
+	void set_transport(NetGameTransport transport);
+
+	/// \brief Sets the largest UDP datagram the client sends
+	///
+	/// Only used by the UDP transport. See NetGameServer::set_mtu.
+	///
+	/// \param mtu = Datagram size in bytes, 1200 by default
+	void set_mtu(int mtu);
+
+	/// \brief Sets the event schema shared with the server
+	///
+	/// The schema is picked up by the next call to connect.
+	///
+	/// \param schema = Events registered in the same order as on the server
+	void set_event_schema(const NetGameEventSchema &schema);
+
 	/// \brief Process events
 	void process_events();
 
@@ -65,6 +87,13 @@ public:
 	///
 	/// \param game_event = Net Game Event
 	void send_event(const NetGameEvent &game_event);
+
+	/// \brief Send event on a channel
+	///
+	/// \param game_event = Net Game Event
+	/// \param channel = Delivery guarantees, only used by the UDP transport
+	void send_event(const NetGameEvent &game_event, NetGameChannel channel);
+
 	Signal<void(const NetGameEvent &)> &sig_event_received();
 
 	/// \brief Sig connected
@@ -84,6 +113,8 @@ private:
 	/// \param e = Net Game Network Event
 	void add_network_event(const NetGameNetworkEvent &e) override;
 
+	NetGameEventSchema get_event_schema() override;
+
 	std::shared_ptr<NetGameClient_Impl> impl;
 };
 
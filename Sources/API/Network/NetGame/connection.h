@@ -32,6 +32,7 @@
 #include <vector>
 #include <string>
 #include "event.h"
+#include "transport.h"
 
 namespace clan
 {
@@ -40,6 +41,8 @@ namespace clan
 
 class NetGameConnectionSite;
 class NetGameConnection_Impl;
+class NetGameReactor;
+class NetGameUDPHost;
 class SocketName;
 class TCPConnection;
 
@@ -75,6 +78,12 @@ public:
 	/// \param game_event = Net Game Event
 	void send_event(const NetGameEvent &game_event);
 
+	/// \brief Send event on a channel
+	///
+	/// \param game_event = Net Game Event
+	/// \param channel = Delivery guarantees, only used by the UDP transport
+	void send_event(const NetGameEvent &game_event, NetGameChannel channel);
+
 	/// \brief Disconnects a client
 	void disconnect();
 
@@ -84,11 +93,20 @@ public:
 	SocketName get_remote_name() const;
 
 private:
+	/// \brief Constructs a NetGameConnection driven by the I/O threads of a reactor
+	NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection, NetGameReactor *reactor);
+
+	/// \brief Constructs a NetGameConnection to a peer of a UDP host
+	NetGameConnection(NetGameConnectionSite *site, NetGameUDPHost *udp_host, const SocketName &peer_name);
+
 	/// \brief Disallow copy constructors
 	NetGameConnection(NetGameConnection &other);
 	NetGameConnection &operator =(const NetGameConnection &other);
 
 	NetGameConnection_Impl *impl;
+
+	friend class NetGameServer;
+	friend class NetGameClient;
 };
 
 }
@@ -36,6 +36,7 @@ namespace clan
 /// \{
 
 class NetGameNetworkEvent;
+class NetGameEventSchema;
 
 /// \brief NetGameConnectionSite
 class NetGameConnectionSite
@@ -46,6 +47,11 @@ public:
 	///
 	/// \param e = Net Game Network Event
 	virtual void add_network_event(const NetGameNetworkEvent &e) = 0;
+
+	/// \brief Returns the event schema used by the connections of this site
+	///
+	/// Connections ask for the schema once, when they start. The default is an empty schema.
+	virtual NetGameEventSchema get_event_schema();
 };
 
 }
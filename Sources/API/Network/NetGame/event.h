@@ -44,7 +44,7 @@ public:
 	NetGameEvent(const std::string &name, std::vector<NetGameEventValue> arg = {});
 
 	/// \return The name of this event.
-	std::string get_name() const { return name; };
+	const std::string &get_name() const { return name; };
 
 	/// \return The number of arguments stored in this event.
 	unsigned int get_argument_count() const;
@@ -64,6 +64,8 @@ public:
 private:
 	std::string name;
 	std::vector<NetGameEventValue> arguments;
+
+	friend class NetGameNetworkData;
 };
 
 }
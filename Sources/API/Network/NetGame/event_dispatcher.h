@@ -30,7 +30,7 @@
 #pragma once
 
 #include "event.h"
-#include <map>
+#include <unordered_map>
 
 namespace clan
 {
@@ -62,7 +62,7 @@ public:
 	}
 
 private:
-	std::map<std::string, CallbackClass> event_handlers;
+	std::unordered_map<std::string, CallbackClass> event_handlers;
 
 };
 
@@ -0,0 +1,90 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "event.h"
+#include <memory>
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+class DataBuffer;
+class NetGameEventSchema_Impl;
+
+/// \brief Layouts of the events known to both ends of a connection
+///
+/// A registered event goes on the wire as a small integer id followed by its arguments, packed without type tags.
+/// Events that are not registered still use the self-describing format with the event name and a type tag per argument.
+///
+/// Ids are assigned in registration order, so the client and the server must register the same events in the same
+/// order. Register all events before the schema is handed to a NetGameServer or NetGameClient.
+class NetGameEventSchema
+{
+public:
+	/// \brief Constructs an empty schema
+	NetGameEventSchema();
+
+	~NetGameEventSchema();
+
+	/// \brief Registers an event
+	///
+	/// \param name = Event name
+	/// \param argument_types = Type of each argument, in order
+	/// \return The id of the event on the wire
+	int add_event(const std::string &name, const std::vector<NetGameEventValue::Type> &argument_types);
+
+	/// \return The number of registered events
+	int get_event_count() const;
+
+	/// \return The id of the event, or -1 if it is not registered
+	int find_event(const std::string &name) const;
+
+	/// \brief Encodes an event as a network packet, including its length prefix
+	///
+	/// Throws an exception if a registered event does not match its argument types.
+	DataBuffer encode_event(const NetGameEvent &game_event) const;
+
+	/// \brief Decodes a network packet created by encode_event
+	///
+	/// The event is written into out_event, reusing the storage of its name and arguments. When out_event last held
+	/// an event with the same layout, packed events only allocate for binary arguments and for strings that do
+	/// not fit the previous string capacity.
+	void decode_event(const DataBuffer &packet, NetGameEvent &out_event) const;
+
+private:
+	std::shared_ptr<NetGameEventSchema_Impl> impl;
+
+	friend class NetGameNetworkData;
+};
+
+}
+
+/// \}
@@ -248,6 +248,8 @@ private:
 	std::string value_string;
 	DataBuffer value_binary;
 	std::vector<NetGameEventValue> value_complex;
+
+	friend class NetGameNetworkData;
 };
 
 }
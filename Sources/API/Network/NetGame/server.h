@@ -31,6 +31,7 @@
 
 
 #include "connection_site.h"	// TODO: Remove
+#include "transport.h"
 #include "../../Core/Signals/signal.h"
 
 namespace clan
@@ -41,6 +42,7 @@ namespace clan
 class NetGameEvent;
 class NetGameConnection;
 class NetGameServer_Impl;
+class SocketName;
 
 /// \brief NetGameServer
 class NetGameServer : NetGameConnectionSite
@@ -60,23 +62,66 @@ public:
 	/// \param port = String
 	void start(const std::string &address, const std::string &port);
 
+	/// \brief Sets the number of I/O threads driving the connections
+	///
+	/// By default every connection runs its own thread. With a count above zero the accepted connections share
+	/// that many epoll based I/O threads instead. The I/O threads are only available on Linux; on other platforms
+	/// each connection keeps its own thread. The new count is used the next time the server is started.
+	///
+	/// \param count = Number of I/O threads, or 0 for one thread per connection
+	void set_io_thread_count(int count);
+
+	/// \brief Sets the protocol used to talk to the clients
+	///
+	/// The clients must use the same transport. The new transport is used the next time the server is started.
+	///
+	/// \param transport = NetGameTransport::tcp (default) or NetGameTransport::udp
+	void set_transport(NetGameTransport transport);
+
+	/// \brief Sets the largest UDP datagram the server sends
+	///
+	/// Events are coalesced into datagrams of up to this size. A single encoded event must fit in one datagram
+	/// together with a few bytes of protocol header. Only used by the UDP transport.
+	///
+	/// \param mtu = Datagram size in bytes, 1200 by default
+	void set_mtu(int mtu);
+
+	/// \brief Sets the event schema shared with the clients
+	///
+	/// Connections use the schema that was set when they were accepted. Set it before starting the server.
+	///
+	/// \param schema = Events registered in the same order as on the clients
+	void set_event_schema(const NetGameEventSchema &schema);
+
 	/// \brief Process events
 	void process_events();
 
 	/// \brief Stop
 	void stop();
 
-	/// \brief Send event
+	/// \brief Send event to all connected clients
+	///
+	/// The event is encoded once and the resulting packet is shared by every connection.
+	/// Throws an exception if the encoded event is too big.
 	///
 	/// \param game_event = Net Game Event
 	void send_event(const NetGameEvent &game_event);
 
+	/// \brief Send event to all connected clients on a channel
+	///
+	/// \param game_event = Net Game Event
+	/// \param channel = Delivery guarantees, only used by the UDP transport
+	void send_event(const NetGameEvent &game_event, NetGameChannel channel);
+
 	Signal<void(NetGameConnection *)> &sig_client_connected();
 	Signal<void(NetGameConnection *, const std::string &)> &sig_client_disconnected();
 	Signal<void(NetGameConnection *, const NetGameEvent &)> &sig_event_received();
 
 private:
 
+	/// \brief Starts accepting clients on the end point with the current transport
+	void listen(const SocketName &endpoint);
+
 	/// \brief Listen thread main
 	void listen_thread_main();
 
@@ -85,6 +130,8 @@ private:
 	/// \param e = Net Game Network Event
 	void add_network_event(const NetGameNetworkEvent &e) override;
 
+	NetGameEventSchema get_event_schema() override;
+
 	std::shared_ptr<NetGameServer_Impl> impl;
 };
 
@@ -0,0 +1,63 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+/// \brief Protocol carrying the events of a NetGameServer or NetGameClient
+enum class NetGameTransport
+{
+	/// Every event is delivered reliably and in order over one TCP connection
+	tcp,
+
+	/// Events are coalesced into UDP datagrams and delivered according to the channel they were sent on
+	udp
+};
+
+/// \brief Delivery guarantees for an event
+///
+/// Channels only differ on the UDP transport. TCP connections deliver every event as reliable_ordered.
+enum class NetGameChannel
+{
+	/// Delivered at most once, in any order
+	unreliable,
+
+	/// Delivered at most once; an event arriving after a newer event on this channel is dropped
+	unreliable_sequenced,
+
+	/// Delivered exactly once and in the order sent. Lost datagrams only delay the events on this channel.
+	reliable_ordered
+};
+
+}
+
+/// \}
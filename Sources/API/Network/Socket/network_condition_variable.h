@@ -9,6 +9,7 @@ namespace clan
 {
 	class SocketHandle;
 	class NetworkConditionVariableImpl;
+	class NetGameReactor;
 
 	/// \brief Base class for all classes that generate network events
 	class NetworkEvent
@@ -17,6 +18,7 @@ namespace clan
 		virtual SocketHandle *get_socket_handle() = 0;
 
 		friend class NetworkConditionVariable;
+		friend class NetGameReactor;
 	};
 
 	/// \brief Condition variable that also awaken on network events
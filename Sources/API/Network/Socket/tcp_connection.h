@@ -43,6 +43,12 @@ namespace clan
 		/// \return Bytes written, or -1 if buffer is full
 		int write(const void *data, int size);
 
+		/// \brief Write data from several buffers to TCP socket in a single call
+		///
+		/// The socket gathers the buffers in order, as if they were one contiguous block.
+		/// \return Bytes written, or -1 if buffer is full
+		int write(const void * const *data, const int *sizes, int count);
+
 		/// \brief Read data from TCP socket
 		/// \return Bytes read, 0 if remote closed connection, or -1 if buffer is empty
 		int read(void *data, int size);
@@ -36,6 +36,8 @@ namespace clan
 /// \{
 
 /// \brief Sound related functions implemented as SIMD using SSE
+///
+/// The mixing functions use AVX instead when the CPU supports it.
 class SoundSSE
 {
 /// \name Operations
@@ -71,6 +73,9 @@ public:
 	/// \brief Packs two float channels into a single float samples stream
 	static void pack_float_stereo(float *input[2], int size, float *output);
 
+	/// \brief Multiplies two float channels with a volume each, clamps them to the -1 to 1 range and packs them into a single float samples stream
+	static void pack_float_stereo_clamped(float *input[2], int size, const float volume[2], float *output);
+
 	/// \brief Copy floats from one buffer to another
 	static void copy_float(float *input, int size, float *output);
 
@@ -42,6 +42,22 @@ class SoundBuffer;
 class SoundBuffer_Session_Impl;
 class SoundOutput;
 
+/// \brief Interpolation used when a session plays at another frequency than the mixer
+enum class SoundInterpolation
+{
+	/// \brief Nearest sample. Cheapest, but aliases audibly when pitch shifting
+	nearest,
+
+	/// \brief Linear interpolation between two samples
+	linear,
+
+	/// \brief Catmull-Rom spline through four samples
+	cubic,
+
+	/// \brief Windowed sinc filter over sixteen samples. Highest quality
+	sinc
+};
+
 /// \brief SoundBuffer_Session provides control over a playing soundeffect.
 ///
 ///    <p>Whenever a soundbuffer is played, it returns a SoundBuffer_Session
@@ -109,6 +125,9 @@ public:
 	/// \brief Returns true if the session is playing
 	bool is_playing();
 
+	/// \brief Returns the interpolation used when the session frequency differs from the mixing frequency
+	SoundInterpolation get_interpolation() const;
+
 /// \}
 /// \name Operations
 /// \{
@@ -116,8 +135,9 @@ public:
 public:
 	/// \brief Sets the session position to 'new_pos'.
 	///
+	/// The mixer applies the new position before it mixes the next fragment.
 	/// \param new_pos = The new position of the session.
-	/// \return Returns true if operation completed succesfully.
+	/// \return Returns false if the position is outside the sound buffer.
 	bool set_position(int new_pos);
 
 	/// \brief Sets the relative position of the session.
@@ -132,9 +152,10 @@ public:
 
 	/// \brief Sets the end position within the current stream.
 	///
+	/// The mixer applies the new end position before it mixes the next fragment.
 	/// \param pos = End position.
 	///
-	/// \return True for success. False otherwise.
+	/// \return False if the position is outside the sound buffer, true otherwise.
 	bool set_end_position(int pos);
 
 	/// \brief Sets the frequency of the session.
@@ -142,6 +163,11 @@ public:
 	/// \param new_freq New frequency of session.
 	void set_frequency(int new_freq);
 
+	/// \brief Sets the interpolation used when the session frequency differs from the mixing frequency
+	///
+	/// The default is SoundInterpolation::linear. Sessions playing at the mixing frequency are copied without interpolation.
+	void set_interpolation(SoundInterpolation interpolation);
+
 	/// \brief Sets the volume of the session in a relative measure (0->1)
 	///
 	/// A value of 0 will effectively mute the sound (although it will
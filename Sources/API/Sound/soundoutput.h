@@ -131,6 +131,7 @@ private:
 	friend class SoundBuffer;
 	friend class Sound;
 	friend class SoundBuffer_Session;
+	friend class SoundBuffer_Session_Impl;
 /// \}
 };
 
@@ -66,6 +66,11 @@ namespace clan
 		StyleGetValue declared_value(const char *property_name) const;
 		StyleGetValue declared_value(const std::string &property_name) const { return declared_value(property_name.c_str()); }
 
+		/// Revision number of the declared values
+		///
+		/// The revision changes whenever a property value changes. Revisions are never reused, not even by other styles.
+		unsigned int revision() const;
+
 		/// Static helper that generates a "rgba(%1,%2,%3,%4)" string for the given color.
 		static std::string to_rgba(const Colorf &c)
 		{
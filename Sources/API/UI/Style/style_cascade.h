@@ -31,6 +31,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "style_get_value.h"
 
 namespace clan
@@ -61,6 +62,33 @@ namespace clan
 	};
 #endif
 
+	/// Interned style property name
+	///
+	/// Resolving the name to an id once, for example in a static variable, avoids hashing the name on every lookup.
+	class StylePropertyId
+	{
+	public:
+		StylePropertyId() { }
+		explicit StylePropertyId(const char *property_name) : _id(find(property_name)) { }
+		explicit StylePropertyId(const std::string &property_name) : _id(find(property_name.c_str())) { }
+
+		/// Integer id of the property name, or -1 for the null id
+		int id() const { return _id; }
+
+		/// Property name for the id
+		const char *name() const;
+
+		bool is_null() const { return _id == -1; }
+
+		bool operator==(const StylePropertyId &that) const { return _id == that._id; }
+		bool operator!=(const StylePropertyId &that) const { return _id != that._id; }
+
+	private:
+		static int find(const char *property_name);
+
+		int _id = -1;
+	};
+
 	/// Style value resolver
 	class StyleCascade
 	{
@@ -85,8 +113,16 @@ namespace clan
 		/// Find the computed value for the specified value
 		///
 		/// The computed value is a simplified value for the property. Lengths are resolved to device independent pixels and so on.
-		StyleGetValue computed_value(const char *property_name) const;
-		StyleGetValue computed_value(const std::string &property_name) const { return computed_value(property_name.c_str()); }
+		///
+		/// Computed values are cached until the cascade, the parent or a property of a style in the cascade changes.
+		StyleGetValue computed_value(const StylePropertyId &property) const;
+		StyleGetValue computed_value(const char *property_name) const { return computed_value(StylePropertyId(property_name)); }
+		StyleGetValue computed_value(const std::string &property_name) const { return computed_value(StylePropertyId(property_name)); }
+
+		/// Revision number of the computed values
+		///
+		/// The revision changes whenever the computed values of this cascade may have changed, including through inheritance.
+		unsigned int computed_revision() const;
 		
 		/// Convert length into px (device independent pixel) units
 		StyleGetValue compute_length(const StyleGetValue &length) const;
@@ -115,5 +151,16 @@ namespace clan
 		
 		/// Font used by this style cascade
 		Font get_font(Canvas &canvas) const;
+
+	private:
+		StyleGetValue compute_value(const char *property_name) const;
+		void validate_computed_values() const;
+
+		mutable std::unordered_map<int, StyleGetValue> computed_values;
+		mutable std::vector<Style *> computed_cascade;
+		mutable const StyleCascade *computed_parent = nullptr;
+		mutable unsigned int computed_parent_revision = 0;
+		mutable std::vector<unsigned int> computed_style_revisions;
+		mutable unsigned int revision = 0;
 	};
 }
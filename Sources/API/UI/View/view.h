@@ -107,6 +107,9 @@ namespace clan
 		bool needs_layout() const;
 
 		/// Forces recalculation of view geometry before next rendering
+		///
+		/// This also discards the measurements cached for this view and its superviews. Call it whenever
+		/// anything the preferred size of the view depends on changes.
 		void set_needs_layout();
 
 		/// Actual view position and size after layout
@@ -114,7 +117,8 @@ namespace clan
 
 		/// Sets the view position and size
 		///
-		/// This function should only be called by layout_subviews.
+		/// This function should only be called by layout_subviews. The subviews are only laid out again if
+		/// the content box changed or needs_layout is set.
 		void set_geometry(const ViewGeometry &geometry);
 
 		/// Gets the current canvas used to render this view
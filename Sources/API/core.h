@@ -109,6 +109,7 @@
 #include "Core/XML/xml_writer.h"
 #include "Core/XML/xml_token.h"
 #include "Core/XML/xpath_evaluator.h"
+#include "Core/XML/xpath_expression.h"
 #include "Core/XML/xpath_object.h"
 #include "Core/IOData/file.h"
 #include "Core/IOData/file_help.h"
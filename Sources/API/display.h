@@ -62,6 +62,7 @@
 #include "Display/Font/font_description.h"
 #include "Display/Font/font_metrics.h"
 #include "Display/Font/glyph_metrics.h"
+#include "Display/Font/font_text_run.h"
 #include "Display/Image/pixel_buffer.h"
 #include "Display/Image/pixel_buffer_lock.h"
 #include "Display/Image/pixel_buffer_help.h"
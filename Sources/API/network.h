@@ -50,8 +50,10 @@
 #include "Network/NetGame/connection.h"
 #include "Network/NetGame/event.h"
 #include "Network/NetGame/event_dispatcher.h"
+#include "Network/NetGame/event_schema.h"
 #include "Network/NetGame/event_value.h"
 #include "Network/NetGame/server.h"
+#include "Network/NetGame/transport.h"
 
 #ifdef __cplusplus_cli
 #pragma managed(pop)
@@ -31,6 +31,8 @@
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Core/Math/cl_math.h"
 #include "iodevice_impl.h"
 #include "iodevice_provider_file.h"
 
@@ -43,7 +45,10 @@ namespace clan
 std::string File::read_text(const std::string &filename)
 {
 	File file(filename);
-	unsigned int file_size = file.get_size();
+	int64_t size = file.get_size();
+	if (size >= 0x7fffffff)
+		throw Exception(string_format("File::read_text(): File '%1' is too big to be loaded into memory", filename));
+	int file_size = (int)size;
 	std::vector<char> text;
 	text.resize(file_size+1);
 	text[file_size] = 0;
@@ -59,8 +64,20 @@ std::string File::read_text(const std::string &filename)
 DataBuffer File::read_bytes(const std::string &filename)
 {
 	File file(filename);
-	DataBuffer buffer(file.get_size());
-	file.read(buffer.get_data(), buffer.get_size());
+	int64_t size = file.get_size();
+	if (size > 0xffffffff)
+		throw Exception(string_format("File::read_bytes(): File '%1' is too big to be loaded into memory", filename));
+	DataBuffer buffer((unsigned int)size);
+	char *data = buffer.get_data();
+	int64_t pos = 0;
+	while (pos < size)
+	{
+		// A single read transfers at most 2 GB
+		int received = file.read(data + pos, (int)min(size - pos, (int64_t)0x40000000));
+		if (received <= 0)
+			throw Exception(string_format("File::read_bytes(): Unable to read file '%1'", filename));
+		pos += received;
+	}
 	file.close();
 	return buffer;
 }
@@ -80,7 +97,16 @@ void File::write_text(const std::string &filename, const std::string &text, bool
 void File::write_bytes(const std::string &filename, const DataBuffer &bytes)
 {
 	File file(filename, create_always, access_write);
-	file.write(bytes.get_data(), bytes.get_size());
+	const char *data = bytes.get_data();
+	int64_t size = bytes.get_size();
+	int64_t pos = 0;
+	while (pos < size)
+	{
+		int sent = file.write(data + pos, (int)min(size - pos, (int64_t)0x40000000));
+		if (sent <= 0)
+			throw Exception(string_format("File::write_bytes(): Unable to write file '%1'", filename));
+		pos += sent;
+	}
 	file.close();
 }
 
@@ -62,14 +62,14 @@ void IODevice::throw_if_null() const
 		throw Exception("IODevice is null");
 }
 
-int IODevice::get_size() const
+int64_t IODevice::get_size() const
 {
 	if (impl)
 		return impl->provider->get_size();
 	return -1;
 }
 
-int IODevice::get_position() const
+int64_t IODevice::get_position() const
 {
 	if (impl)
 		return impl->provider->get_position();
@@ -117,7 +117,7 @@ int IODevice::peek(void *data, int len)
 	return -1;
 }
 
-bool IODevice::seek(int position, SeekMode mode)
+bool IODevice::seek(int64_t position, SeekMode mode)
 {
 	if (impl)
 		return impl->provider->seek(position, mode);
@@ -448,7 +448,7 @@ std::string IODevice::read_string_text(const char *skip_initial_chars, const cha
 	int size = 0;
 	bool find_flag = true;
 	bool null_found = false;
-	int current_position = get_position();
+	int64_t current_position = get_position();
 
 	// Skip initial unwanted chars
 	if (skip_initial_chars)
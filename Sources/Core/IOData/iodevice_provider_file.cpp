@@ -79,17 +79,17 @@ IODeviceProvider_File::~IODeviceProvider_File()
 /////////////////////////////////////////////////////////////////////////////
 // IODeviceProvider_File Attributes:
 
-int IODeviceProvider_File::get_size() const
+int64_t IODeviceProvider_File::get_size() const
 {
 #ifdef WIN32
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
 
-	DWORD size = GetFileSize(handle, 0);
-	if (size == INVALID_FILE_SIZE)
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(handle, &size) == FALSE)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
 
-	return size;
+	return size.QuadPart;
 #else
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
@@ -103,21 +103,22 @@ int IODeviceProvider_File::get_size() const
 	if (size == (off_t) -1)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
 		
-	return (int) size;
+	return (int64_t) size;
 #endif
 }
 
-int IODeviceProvider_File::get_position() const
+int64_t IODeviceProvider_File::get_position() const
 {
 #ifdef WIN32
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer, no file open");
 
-	DWORD pos = SetFilePointer(handle, 0, 0, FILE_CURRENT);
-	if (pos == INVALID_SET_FILE_POINTER)
+	LARGE_INTEGER distance, pos;
+	distance.QuadPart = 0;
+	if (SetFilePointerEx(handle, distance, &pos, FILE_CURRENT) == FALSE)
 		throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer");
 
-	return (int) pos;
+	return pos.QuadPart;
 #else
 	if (handle == invalid_handle)
 		throw Exception("Unable to get file position pointer, no file open");
@@ -126,7 +127,7 @@ int IODeviceProvider_File::get_position() const
 	if (pos == (off_t) -1)
 		throw Exception("Unable to get file position pointer");
 
-	return pos;
+	return (int64_t) pos;
 #endif
 }
 
@@ -311,7 +312,7 @@ int IODeviceProvider_File::peek(void *data, int len)
 	}
 }
 
-bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
+bool IODeviceProvider_File::seek(int64_t position, IODevice::SeekMode seek_mode)
 {
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::seek(): Unable to get file position pointer, no file open");
@@ -325,8 +326,9 @@ bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
 	case IODevice::seek_end: moveMethod = FILE_END; break;
 	}
 
-	DWORD new_pos = SetFilePointer(handle, position, 0, moveMethod);
-	return (new_pos != INVALID_FILE_SIZE);
+	LARGE_INTEGER distance;
+	distance.QuadPart = position;
+	return SetFilePointerEx(handle, distance, 0, moveMethod) == TRUE;
 #else
 	int mode = SEEK_SET;
 	if (seek_mode == File::seek_set)
@@ -336,7 +338,10 @@ bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
 	else if (seek_mode == File::seek_end)
 		mode = SEEK_END;
 	
-	off_t new_pos = lseek(handle, position, mode);
+	if ((int64_t)(off_t) position != position)
+		return false;
+
+	off_t new_pos = lseek(handle, (off_t) position, mode);
 	if (new_pos == (off_t) -1)
 		return false;
 	else
@@ -59,9 +59,9 @@ public:
 /// \{
 
 public:
-	int get_size() const override;
+	int64_t get_size() const override;
 
-	int get_position() const override;
+	int64_t get_position() const override;
 
 /// \}
 /// \name Operations
@@ -87,7 +87,7 @@ public:
 
 	int peek(void *data, int len) override;
 
-	bool seek(int position, IODevice::SeekMode mode) override;
+	bool seek(int64_t position, IODevice::SeekMode mode) override;
 
 	IODeviceProvider *duplicate() override;
 
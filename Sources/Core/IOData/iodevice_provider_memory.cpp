@@ -30,6 +30,7 @@
 #include "API/Core/IOData/memory_device.h"
 #include "iodevice_provider_memory.h"
 #include "API/Core/Math/cl_math.h"
+#include "API/Core/System/exception.h"
 
 namespace clan
 {
@@ -50,12 +51,12 @@ IODeviceProvider_Memory::IODeviceProvider_Memory(DataBuffer &data)
 /////////////////////////////////////////////////////////////////////////////
 // IODeviceProvider_Memory Attributes:
 
-int IODeviceProvider_Memory::get_size() const
+int64_t IODeviceProvider_Memory::get_size() const
 {
 	return data.get_size();
 }
 	
-int IODeviceProvider_Memory::get_position() const
+int64_t IODeviceProvider_Memory::get_position() const
 {
 	validate_position();
 	return position;
@@ -77,16 +78,20 @@ DataBuffer &IODeviceProvider_Memory::get_data()
 int IODeviceProvider_Memory::send(const void *send_data, int len, bool send_all)
 {
 	validate_position();
-	int size_needed = position + len;
+	int64_t size_needed = position + len;
 	if (size_needed > data.get_size())
 	{
+		if (size_needed > (int64_t)0xffffffff)
+			throw Exception("IODeviceProvider_Memory::send(): Memory device cannot grow beyond 4 GB");
+
 		if (size_needed > data.get_capacity())	// Capacity exceeded
 		{
 			// Estimate the optimum databuffer capacity. TODO: Maybe adjust this class to be link list based, thus removing reallocation and block movement of the DataBuffer
-			data.set_capacity(clan::max(size_needed + clan::min(size_needed, 16 * 1024 * 1024), 16 * 1024));
+			int64_t capacity = clan::max(size_needed + clan::min(size_needed, (int64_t)16 * 1024 * 1024), (int64_t)16 * 1024);
+			data.set_capacity((unsigned int)clan::min(capacity, (int64_t)0xffffffff));
 		}
 
-		data.set_size(size_needed);
+		data.set_size((unsigned int)size_needed);
 	}
 	memcpy(data.get_data() + position, send_data, len);
 	position += len;
@@ -96,9 +101,9 @@ int IODeviceProvider_Memory::send(const void *send_data, int len, bool send_all)
 int IODeviceProvider_Memory::receive(void *recv_data, int len, bool receive_all)
 {
 	validate_position();
-	int data_available = data.get_size() - position;
+	int64_t data_available = data.get_size() - position;
 	if (len > data_available)
-		len = data_available;
+		len = (int)data_available;
 	memcpy(recv_data, data.get_data() + position, len);
 	position += len;
 	return len;
@@ -107,17 +112,17 @@ int IODeviceProvider_Memory::receive(void *recv_data, int len, bool receive_all)
 int IODeviceProvider_Memory::peek(void *recv_data, int len)
 {
 	validate_position();
-	int data_available = data.get_size() - position;
+	int64_t data_available = data.get_size() - position;
 	if (len > data_available)
-		len = data_available;
+		len = (int)data_available;
 	memcpy(recv_data, data.get_data() + position, len);
 	return len;
 }
 
-bool IODeviceProvider_Memory::seek(int requested_position, IODevice::SeekMode mode)
+bool IODeviceProvider_Memory::seek(int64_t requested_position, IODevice::SeekMode mode)
 {
 	validate_position();
-	int new_position = position;
+	int64_t new_position = position;
 	switch (mode)
 	{
 	case IODevice::seek_set:
@@ -127,7 +132,7 @@ bool IODeviceProvider_Memory::seek(int requested_position, IODevice::SeekMode mo
 		new_position += requested_position;
 		break;
 	case IODevice::seek_end:
-		new_position = data.get_size() + requested_position;
+		new_position = (int64_t)data.get_size() + requested_position;
 		break;
 	default:
 		return false;
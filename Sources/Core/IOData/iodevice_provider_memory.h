@@ -50,9 +50,9 @@ public:
 /// \{
 
 public:
-	virtual int get_size() const override;
+	virtual int64_t get_size() const override;
 
-	virtual int get_position() const override;
+	virtual int64_t get_position() const override;
 
 	const DataBuffer &get_data() const;
 
@@ -70,7 +70,7 @@ public:
 
 	virtual int peek(void *data, int len) override;
 
-	virtual bool seek(int position, IODevice::SeekMode mode) override;
+	virtual bool seek(int64_t position, IODevice::SeekMode mode) override;
 
 	IODeviceProvider *duplicate() override;
 
@@ -84,7 +84,7 @@ private:
 
 	DataBuffer data;
 
-	mutable int position;
+	mutable int64_t position;
 /// \}
 };
 
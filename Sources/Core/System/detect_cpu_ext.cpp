@@ -55,6 +55,8 @@ bool System::detect_cpu_extension(CPU_ExtensionX86 ext)
 
 #define __cpuid(out, infoType)\
 	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
+#define __cpuidex(out, infoType, subType)\
+	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subType));
 #else
 
 #define __cpuid(out, infoType) \
@@ -64,10 +66,28 @@ bool System::detect_cpu_extension(CPU_ExtensionX86 ext)
 			"popl %%ebx" \
 		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
 
+#define __cpuidex(out, infoType, subType) \
+	asm volatile(	"pushl %%ebx \n" \
+			"cpuid \n" \
+			"movl %%ebx, %1 \n" \
+			"popl %%ebx" \
+		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subType));
+
 #endif
 
 #endif
 
+static unsigned long long read_xcr0()
+{
+#ifdef __GNUC__
+	unsigned int eax, edx;
+	asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));	// xgetbv
+	return (((unsigned long long)edx) << 32) | eax;
+#else
+	return _xgetbv(0);
+#endif
+}
+
 bool System::detect_cpu_extension(CPU_ExtensionPPC ext)
 {
 	throw ("Congratulations, you've just been selected to code this feature!");
@@ -161,7 +181,25 @@ bool System::detect_cpu_extension(CPU_ExtensionX86 ext)
 	else if(ext == avx)
 	{
 		__cpuid((int*)cpuinfo, 0x1);
-		return ((cpuinfo[2] & (1 << 28)) != 0);
+		if ((cpuinfo[2] & (1 << 28)) == 0)
+			return false;
+
+		// The operating system must also save the AVX registers on context switches (OSXSAVE set and XMM/YMM state enabled in XCR0)
+		if ((cpuinfo[2] & (1 << 27)) == 0)
+			return false;
+		return (read_xcr0() & 6) == 6;
+	}
+	else if(ext == avx2)
+	{
+		if (!detect_cpu_extension(avx))
+			return false;
+
+		__cpuid((int*)cpuinfo, 0x0);
+		if (cpuinfo[0] < 7)
+			return false;
+
+		__cpuidex((int*)cpuinfo, 0x7, 0x0);
+		return ((cpuinfo[1] & (1 << 5)) != 0);
 	}
 	else if(ext == aes)
 	{
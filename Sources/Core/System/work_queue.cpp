@@ -1,216 +1,625 @@
-/*
-**  ClanLib SDK
-**  Copyright (c) 1997-2015 The ClanLib Team
-**
-**  This software is provided 'as-is', without any express or implied
-**  warranty.  In no event will the authors be held liable for any damages
-**  arising from the use of this software.
-**
-**  Permission is granted to anyone to use this software for any purpose,
-**  including commercial applications, and to alter it and redistribute it
-**  freely, subject to the following restrictions:
-**
-**  1. The origin of this software must not be misrepresented; you must not
-**     claim that you wrote the original software. If you use this software
-**     in a product, an acknowledgment in the product documentation would be
-**     appreciated but is not required.
-**  2. Altered source versions must be plainly marked as such, and must not be
-**     misrepresented as being the original software.
-**  3. This notice may not be removed or altered from any source distribution.
-**
-**  Note: Some of the libraries ClanLib may link to may have additional
-**  requirements or restrictions.
-**
-**  File Author(s):
-**
-**    Magnus Norddahl
-*/
-
-#include "Core/precomp.h"
-#include "API/Core/System/work_queue.h"
-#include "API/Core/System/system.h"
-#include <algorithm>
-#include "API/Core/Math/cl_math.h"
-#include <atomic>
-#include <thread>
-#include <condition_variable>
-
-namespace clan
-{
-
-class WorkItemProcess : public WorkItem
-{
-public:
-	WorkItemProcess(const std::function<void()> &func) : func(func) { }
-
-	void process_work() override { func(); }
-
-private:
-	std::function<void()> func;
-};
-
-class WorkItemWorkCompleted : public WorkItem
-{
-public:
-	WorkItemWorkCompleted(const std::function<void()> &func) : func(func) { }
-
-	void process_work() override { }
-	void work_completed() override { func(); }
-
-private:
-	std::function<void()> func;
-};
-
-class WorkQueue_Impl
-{
-public:
-	WorkQueue_Impl(bool serial_queue);
-	~WorkQueue_Impl();
-
-	void queue(WorkItem *item); // transfers ownership
-	void work_completed(WorkItem *item); // transfers ownership
-
-	int get_items_queued() const { return items_queued; }
-
-	void process_work_completed();
-
-private:
-	void worker_main();
-
-	bool serial_queue = false;
-	std::vector<std::thread> threads;
-	std::mutex mutex;
-	std::condition_variable worker_event;
-	bool stop_flag = false;
-	std::vector<WorkItem *> queued_items;
-	std::vector<WorkItem *> finished_items;
-	std::atomic_int items_queued;
-};
-
-WorkQueue::WorkQueue(bool serial_queue)
-	: impl(std::make_shared<WorkQueue_Impl>(serial_queue))
-{
-}
-
-WorkQueue::~WorkQueue()
-{
-}
-
-void WorkQueue::queue(WorkItem *item) // transfers ownership
-{
-	impl->queue(item);
-}
-
-void WorkQueue::queue(const std::function<void()> &func)
-{
-	impl->queue(new WorkItemProcess(func));
-}
-
-void WorkQueue::work_completed(const std::function<void()> &func)
-{
-	impl->work_completed(new WorkItemWorkCompleted(func));
-}
-
-int WorkQueue::get_items_queued() const
-{
-	return impl->get_items_queued();
-}
-
-void WorkQueue::process_work_completed()
-{
-	impl->process_work_completed();
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-WorkQueue_Impl::WorkQueue_Impl(bool serial_queue)
-	: serial_queue(serial_queue)
-{
-}
-
-WorkQueue_Impl::~WorkQueue_Impl()
-{
-	std::unique_lock<std::mutex> mutex_lock(mutex);
-	stop_flag = true;
-	mutex_lock.unlock();
-	worker_event.notify_all();
-
-	for (auto & elem : threads)
-		elem.join();
-	for (auto & elem : queued_items)
-		delete elem;
-	for (auto & elem : finished_items)
-		delete elem;
-}
-
-void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
-{
-	if (threads.empty())
-	{
-		int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
-		for (int i = 0; i < num_cores; i++)
-		{
-			threads.push_back(std::thread(&WorkQueue_Impl::worker_main, this));
-		}
-	}
-
-	std::unique_lock<std::mutex> mutex_lock(mutex);
-	queued_items.push_back(item);
-	++items_queued;
-	mutex_lock.unlock();
-	worker_event.notify_one();
-}
-
-void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
-{
-	std::unique_lock<std::mutex> mutex_lock(mutex);
-	finished_items.push_back(item);
-	++items_queued;
-}
-
-void WorkQueue_Impl::process_work_completed()
-{
-	std::unique_lock<std::mutex> mutex_lock(mutex);
-	std::vector<WorkItem *> items;
-	items.swap(finished_items);
-	mutex_lock.unlock();
-	for (size_t i = 0; i < items.size(); i++)
-	{
-		try
-		{
-			items[i]->work_completed();
-		}
-		catch (...)
-		{
-			mutex_lock.lock();
-			finished_items.insert(finished_items.begin(), items.begin() + i, items.end());
-			throw;
-		}
-		delete items[i];
-		--items_queued;
-	}
-}
-
-void WorkQueue_Impl::worker_main()
-{
-	while (true)
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued_items.empty(); });
-
-		if (stop_flag)
-			break;
-
-		WorkItem *item = queued_items.front();
-		queued_items.erase(queued_items.begin());
-		mutex_lock.unlock();
-
-		item->process_work();
-
-		mutex_lock.lock();
-		finished_items.push_back(item);
-		mutex_lock.unlock();
-	}
-}
-
-}
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/system.h"
+#include <algorithm>
+#include "API/Core/Math/cl_math.h"
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+namespace clan
+{
+
+class WorkItemProcess : public WorkItem
+{
+public:
+	WorkItemProcess(const std::function<void()> &func) : func(func) { }
+
+	void process_work() override { func(); }
+
+private:
+	std::function<void()> func;
+};
+
+class WorkItemWorkCompleted : public WorkItem
+{
+public:
+	WorkItemWorkCompleted(const std::function<void()> &func) : func(func) { }
+
+	void process_work() override { }
+	void work_completed() override { func(); }
+
+private:
+	std::function<void()> func;
+};
+
+class WorkTaskGroup_Impl
+{
+public:
+	WorkTaskGroup_Impl(const std::weak_ptr<WorkQueue_Impl> &queue) : queue(queue) { }
+
+	void task_started();
+	void task_finished(const std::exception_ptr &exception);
+
+	std::weak_ptr<WorkQueue_Impl> queue;
+	std::mutex mutex;
+	std::condition_variable finished_event;
+	int tasks_pending = 0;
+	std::exception_ptr exception;
+};
+
+class WorkItemTaskGroup : public WorkItem
+{
+public:
+	WorkItemTaskGroup(const std::shared_ptr<WorkTaskGroup_Impl> &group, const std::function<void()> &func) : group(group), func(func) { }
+
+	~WorkItemTaskGroup()
+	{
+		// Work discarded by a destroyed queue must still release waiters
+		if (!processed)
+			group->task_finished(std::exception_ptr());
+	}
+
+	void process_work() override
+	{
+		std::exception_ptr exception;
+		try
+		{
+			func();
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+		processed = true;
+		group->task_finished(exception);
+	}
+
+private:
+	std::shared_ptr<WorkTaskGroup_Impl> group;
+	std::function<void()> func;
+	bool processed = false;
+};
+
+class ParallelForJob
+{
+public:
+	ParallelForJob(int range, int grain, const std::function<void(int, int)> &func) : range(range), grain(grain), num_chunks((int)(((int64_t)range + grain - 1) / grain)), func(func) { }
+
+	/// \brief Processes chunks until none are left to claim
+	void process_chunks();
+
+	/// \brief Blocks until all chunks have been processed
+	void wait();
+
+	int range;
+	int grain;
+	int num_chunks;
+	std::function<void(int, int)> func;
+
+	std::atomic_int next_chunk{ 0 };
+	std::mutex mutex;
+	std::condition_variable finished_event;
+	int chunks_finished = 0;
+	std::exception_ptr exception;
+};
+
+class WorkItemParallelFor : public WorkItem
+{
+public:
+	WorkItemParallelFor(const std::shared_ptr<ParallelForJob> &job) : job(job) { }
+
+	void process_work() override { job->process_chunks(); }
+
+private:
+	std::shared_ptr<ParallelForJob> job;
+};
+
+/// \brief Queued work item and whether it still needs to be passed to process_work_completed
+class WorkQueueEntry
+{
+public:
+	WorkQueueEntry(WorkItem *item = nullptr, bool detached = false) : item(item), detached(detached) { }
+
+	WorkItem *item;
+	bool detached;
+};
+
+/// \brief Worker thread and its local work deque
+///
+/// Work spawned on a worker goes to its own deque. The owning worker pops the most recently queued entry from the back
+/// and other workers steal the oldest from the front. A serial queue only has one worker and pops from the front to keep the queue order.
+class WorkQueueWorker
+{
+public:
+	std::thread thread;
+	std::mutex mutex;
+	std::deque<WorkQueueEntry> entries;
+};
+
+class WorkQueue_Impl
+{
+public:
+	WorkQueue_Impl(bool serial_queue);
+	~WorkQueue_Impl();
+
+	void queue(WorkItem *item); // transfers ownership
+	void queue_detached(WorkItem *item); // transfers ownership, item is deleted after process_work
+	void work_completed(WorkItem *item); // transfers ownership
+
+	int get_items_queued() const { return items_queued; }
+
+	void process_work_completed();
+
+	void parallel_for(int range, int grain, const std::function<void(int, int)> &func);
+
+	/// \brief Index of the worker owning the calling thread, or -1 if it is not a worker thread
+	int find_current_worker() const;
+
+	/// \brief Pops or steals one entry and processes it. Returns false if no work was available
+	bool process_one(int worker_index);
+
+	bool is_serial_queue() const { return serial_queue; }
+
+private:
+	void start_threads();
+	void push_entry(const WorkQueueEntry &entry);
+	bool pop_entry(int worker_index, WorkQueueEntry &out_entry);
+	void process_entry(const WorkQueueEntry &entry);
+	void worker_main(int worker_index);
+
+	bool serial_queue = false;
+	std::once_flag threads_started;
+	std::vector<std::unique_ptr<WorkQueueWorker>> workers;
+
+	// Work queued from outside the worker threads, processed in FIFO order so it cannot be starved by newer submissions
+	std::mutex injection_mutex;
+	std::deque<WorkQueueEntry> injection_entries;
+
+	std::mutex sleep_mutex;
+	std::condition_variable worker_event;
+	std::atomic_int sleeping_workers{ 0 };
+	std::atomic_int pending_entries{ 0 };
+	std::atomic_bool stop_flag{ false };
+	std::atomic_bool threads_ready{ false };
+
+	std::mutex finished_mutex;
+	std::vector<WorkItem *> finished_items;
+	std::atomic_int items_queued{ 0 };
+};
+
+WorkQueue::WorkQueue(bool serial_queue)
+	: impl(std::make_shared<WorkQueue_Impl>(serial_queue))
+{
+}
+
+WorkQueue::~WorkQueue()
+{
+}
+
+void WorkQueue::queue(WorkItem *item) // transfers ownership
+{
+	impl->queue(item);
+}
+
+void WorkQueue::queue(const std::function<void()> &func)
+{
+	impl->queue(new WorkItemProcess(func));
+}
+
+void WorkQueue::work_completed(const std::function<void()> &func)
+{
+	impl->work_completed(new WorkItemWorkCompleted(func));
+}
+
+WorkTaskGroup WorkQueue::create_task_group()
+{
+	return WorkTaskGroup(std::make_shared<WorkTaskGroup_Impl>(impl));
+}
+
+void WorkQueue::queue(const WorkTaskGroup &group, const std::function<void()> &func)
+{
+	if (group.is_null())
+		throw Exception("WorkTaskGroup is null");
+
+	group.impl->task_started();
+	impl->queue_detached(new WorkItemTaskGroup(group.impl, func));
+}
+
+void WorkQueue::parallel_for(int range, int grain, const std::function<void(int begin, int end)> &func)
+{
+	impl->parallel_for(range, grain, func);
+}
+
+int WorkQueue::get_items_queued() const
+{
+	return impl->get_items_queued();
+}
+
+void WorkQueue::process_work_completed()
+{
+	impl->process_work_completed();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+WorkTaskGroup::WorkTaskGroup()
+{
+}
+
+WorkTaskGroup::WorkTaskGroup(const std::shared_ptr<WorkTaskGroup_Impl> &impl)
+	: impl(impl)
+{
+}
+
+bool WorkTaskGroup::is_done() const
+{
+	if (!impl)
+		return true;
+
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	return impl->tasks_pending == 0;
+}
+
+void WorkTaskGroup::wait()
+{
+	if (!impl)
+		return;
+
+	std::shared_ptr<WorkQueue_Impl> queue = impl->queue.lock();
+	int worker_index = (queue && !queue->is_serial_queue()) ? queue->find_current_worker() : -1;
+
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	if (worker_index == -1)
+	{
+		impl->finished_event.wait(mutex_lock, [&]() { return impl->tasks_pending == 0; });
+	}
+	else
+	{
+		// Waiting on a worker thread: keep the worker busy so the group cannot starve the pool
+		while (impl->tasks_pending != 0)
+		{
+			mutex_lock.unlock();
+			bool processed = queue->process_one(worker_index);
+			mutex_lock.lock();
+			if (!processed)
+				impl->finished_event.wait_for(mutex_lock, std::chrono::milliseconds(1), [&]() { return impl->tasks_pending == 0; });
+		}
+	}
+
+	std::exception_ptr exception = impl->exception;
+	impl->exception = std::exception_ptr();
+	mutex_lock.unlock();
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void WorkTaskGroup_Impl::task_started()
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	tasks_pending++;
+}
+
+void WorkTaskGroup_Impl::task_finished(const std::exception_ptr &task_exception)
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	if (task_exception && !exception)
+		exception = task_exception;
+	tasks_pending--;
+	if (tasks_pending == 0)
+		finished_event.notify_all();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ParallelForJob::process_chunks()
+{
+	while (true)
+	{
+		int chunk = next_chunk++;
+		if (chunk >= num_chunks)
+			break;
+
+		int64_t chunk_begin = (int64_t)chunk * grain;
+		int begin = (int)chunk_begin;
+		int end = (int)clan::min(chunk_begin + grain, (int64_t)range);
+
+		std::exception_ptr chunk_exception;
+		try
+		{
+			func(begin, end);
+		}
+		catch (...)
+		{
+			chunk_exception = std::current_exception();
+		}
+
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		if (chunk_exception && !exception)
+			exception = chunk_exception;
+		chunks_finished++;
+		if (chunks_finished == num_chunks)
+			finished_event.notify_all();
+	}
+}
+
+void ParallelForJob::wait()
+{
+	// Every chunk has been claimed by a running thread at this point, so this cannot deadlock
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	finished_event.wait(mutex_lock, [&]() { return chunks_finished == num_chunks; });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+WorkQueue_Impl::WorkQueue_Impl(bool serial_queue)
+	: serial_queue(serial_queue)
+{
+}
+
+WorkQueue_Impl::~WorkQueue_Impl()
+{
+	std::unique_lock<std::mutex> mutex_lock(sleep_mutex);
+	stop_flag = true;
+	mutex_lock.unlock();
+	worker_event.notify_all();
+
+	for (auto & worker : workers)
+	{
+		worker->thread.join();
+		for (auto & entry : worker->entries)
+			delete entry.item;
+	}
+	for (auto & entry : injection_entries)
+		delete entry.item;
+	for (auto & elem : finished_items)
+		delete elem;
+}
+
+void WorkQueue_Impl::start_threads()
+{
+	std::call_once(threads_started, [this]()
+	{
+		int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
+		for (int i = 0; i < num_cores; i++)
+			workers.push_back(std::unique_ptr<WorkQueueWorker>(new WorkQueueWorker()));
+		for (int i = 0; i < num_cores; i++)
+			workers[i]->thread = std::thread(&WorkQueue_Impl::worker_main, this, i);
+
+		// Workers may not look at the thread ids of other workers until all of them have been assigned
+		std::unique_lock<std::mutex> mutex_lock(sleep_mutex);
+		threads_ready = true;
+		mutex_lock.unlock();
+		worker_event.notify_all();
+	});
+}
+
+void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
+{
+	++items_queued;
+	push_entry(WorkQueueEntry(item, false));
+}
+
+void WorkQueue_Impl::queue_detached(WorkItem *item) // transfers ownership
+{
+	push_entry(WorkQueueEntry(item, true));
+}
+
+void WorkQueue_Impl::push_entry(const WorkQueueEntry &entry)
+{
+	start_threads();
+
+	// Work queued from a worker stays on that worker's deque, everything else goes to the shared injection queue
+	int worker_index = serial_queue ? 0 : find_current_worker();
+	if (worker_index != -1)
+	{
+		WorkQueueWorker *worker = workers[worker_index].get();
+		std::unique_lock<std::mutex> worker_lock(worker->mutex);
+		worker->entries.push_back(entry);
+	}
+	else
+	{
+		std::unique_lock<std::mutex> injection_lock(injection_mutex);
+		injection_entries.push_back(entry);
+	}
+
+	++pending_entries;
+	if (sleeping_workers > 0)
+	{
+		std::unique_lock<std::mutex> mutex_lock(sleep_mutex);
+		mutex_lock.unlock();
+		worker_event.notify_one();
+	}
+}
+
+bool WorkQueue_Impl::pop_entry(int worker_index, WorkQueueEntry &out_entry)
+{
+	WorkQueueWorker *worker = workers[worker_index].get();
+	std::unique_lock<std::mutex> worker_lock(worker->mutex);
+	if (!worker->entries.empty())
+	{
+		if (serial_queue)
+		{
+			out_entry = worker->entries.front();
+			worker->entries.pop_front();
+		}
+		else
+		{
+			out_entry = worker->entries.back();
+			worker->entries.pop_back();
+		}
+		--pending_entries;
+		return true;
+	}
+	worker_lock.unlock();
+
+	std::unique_lock<std::mutex> injection_lock(injection_mutex);
+	if (!injection_entries.empty())
+	{
+		out_entry = injection_entries.front();
+		injection_entries.pop_front();
+		--pending_entries;
+		return true;
+	}
+	injection_lock.unlock();
+
+	for (size_t i = 1; i < workers.size(); i++)
+	{
+		WorkQueueWorker *victim = workers[(worker_index + i) % workers.size()].get();
+		std::unique_lock<std::mutex> victim_lock(victim->mutex);
+		if (!victim->entries.empty())
+		{
+			out_entry = victim->entries.front();
+			victim->entries.pop_front();
+			--pending_entries;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkQueue_Impl::process_entry(const WorkQueueEntry &entry)
+{
+	entry.item->process_work();
+
+	if (entry.detached)
+	{
+		delete entry.item;
+	}
+	else
+	{
+		std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+		finished_items.push_back(entry.item);
+	}
+}
+
+bool WorkQueue_Impl::process_one(int worker_index)
+{
+	WorkQueueEntry entry;
+	if (!pop_entry(worker_index, entry))
+		return false;
+	process_entry(entry);
+	return true;
+}
+
+int WorkQueue_Impl::find_current_worker() const
+{
+	if (!threads_ready)
+		return -1;
+
+	std::thread::id thread_id = std::this_thread::get_id();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		if (workers[i]->thread.get_id() == thread_id)
+			return (int)i;
+	}
+	return -1;
+}
+
+void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
+{
+	std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+	finished_items.push_back(item);
+	++items_queued;
+}
+
+void WorkQueue_Impl::process_work_completed()
+{
+	std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+	std::vector<WorkItem *> items;
+	items.swap(finished_items);
+	mutex_lock.unlock();
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		try
+		{
+			items[i]->work_completed();
+		}
+		catch (...)
+		{
+			mutex_lock.lock();
+			finished_items.insert(finished_items.begin(), items.begin() + i, items.end());
+			throw;
+		}
+		delete items[i];
+		--items_queued;
+	}
+}
+
+void WorkQueue_Impl::parallel_for(int range, int grain, const std::function<void(int, int)> &func)
+{
+	if (range <= 0)
+		return;
+
+	grain = clan::max(grain, 1);
+	std::shared_ptr<ParallelForJob> job = std::make_shared<ParallelForJob>(range, grain, func);
+
+	if (!serial_queue && job->num_chunks > 1)
+	{
+		start_threads();
+		int num_helpers = clan::min(job->num_chunks - 1, (int)workers.size());
+		for (int i = 0; i < num_helpers; i++)
+			queue_detached(new WorkItemParallelFor(job));
+	}
+
+	job->process_chunks();
+	job->wait();
+
+	if (job->exception)
+		std::rethrow_exception(job->exception);
+}
+
+void WorkQueue_Impl::worker_main(int worker_index)
+{
+	std::unique_lock<std::mutex> start_lock(sleep_mutex);
+	worker_event.wait(start_lock, [&]() { return stop_flag || threads_ready; });
+	start_lock.unlock();
+
+	while (!stop_flag)
+	{
+		WorkQueueEntry entry;
+		if (pop_entry(worker_index, entry))
+		{
+			process_entry(entry);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> mutex_lock(sleep_mutex);
+		++sleeping_workers;
+		worker_event.wait(mutex_lock, [&]() { return stop_flag || pending_entries > 0; });
+		--sleeping_workers;
+	}
+}
+
+}
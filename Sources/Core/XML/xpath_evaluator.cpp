@@ -33,6 +33,7 @@
 #include "API/Core/XML/dom_node.h"
 #include "xpath_evaluator_impl.h"
 #include "xpath_token.h"
+#include "xpath_expression_impl.h"
 
 namespace clan
 {
@@ -50,11 +51,18 @@ XPathEvaluator::XPathEvaluator()
 
 XPathObject XPathEvaluator::evaluate(const std::string &expression, const DomNode &context_node) const
 {
+	return evaluate(XPathExpression(XPathEvaluator_Impl::get_compiled_expression(expression)), context_node);
+}
+
+XPathObject XPathEvaluator::evaluate(const XPathExpression &expression, const DomNode &context_node) const
+{
+	expression.throw_if_null();
+
 	XPathToken prev_token;
 	std::vector<DomNode> nodelist(1, context_node);
-	XPathEvaluateResult result = impl->evaluate(expression, nodelist, 0, prev_token);
+	XPathEvaluateResult result = impl->evaluate(*expression.impl, nodelist, 0, prev_token);
 	if (result.next_token.type != XPathToken::type_none)
-		throw XPathException("Expected end of expression", expression, result.next_token);
+		throw XPathException("Expected end of expression", expression.impl->text, result.next_token);
 	return result.result;
 }
 
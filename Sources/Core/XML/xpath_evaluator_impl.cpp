@@ -46,12 +46,33 @@
 namespace clan
 {
 
+std::mutex XPathEvaluator_Impl::cache_mutex;
+std::unordered_map<std::string, std::shared_ptr<XPathExpression_Impl> > XPathEvaluator_Impl::expression_cache;
+
 /////////////////////////////////////////////////////////////////////////////
 // XPathEvaluator_Impl Operations:
 
+std::shared_ptr<XPathExpression_Impl> XPathEvaluator_Impl::get_compiled_expression(const std::string &expression)
+{
+	std::unique_lock<std::mutex> lock(cache_mutex);
+	auto it = expression_cache.find(expression);
+	if (it != expression_cache.end())
+		return it->second;
+	lock.unlock();
+
+	std::shared_ptr<XPathExpression_Impl> compiled = std::make_shared<XPathExpression_Impl>(expression);
+
+	lock.lock();
+	// Applications only use a limited set of expressions. Start over if something keeps generating new ones:
+	if (expression_cache.size() >= max_cached_expressions)
+		expression_cache.clear();
+	expression_cache[expression] = compiled;
+	return compiled;
+}
+
 
 XPathEvaluateResult XPathEvaluator_Impl::evaluate(
-	const std::string &expression,
+	const XPathExpression_Impl &expression,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
 	XPathToken prev_token) const
@@ -64,7 +85,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 
 	while (true)
 	{
-		cur_token = read_token(expression, prev_token);
+		cur_token = expression.get_next_token(prev_token);
 
 		bool end_parenthesis = (
 			cur_token.type == XPathToken::type_operator &&
@@ -109,11 +130,11 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		else if (cur_token.type == XPathToken::type_function_name)
 		{
 			std::string function_name = cur_token.value.str;
-			cur_token = read_token(expression, cur_token);
+			cur_token = expression.get_next_token(cur_token);
 			if (cur_token.type != XPathToken::type_operator ||
 				cur_token.value.oper != XPathToken::operator_parenthesis_begin)
 			{
-				throw XPathException("Expected '(' after function name", expression, cur_token);
+				throw XPathException("Expected '(' after function name", expression.text, cur_token);
 			}
 
 			std::vector<XPathObject> parameters;
@@ -128,7 +149,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 					cur_token.value.oper == XPathToken::operator_parenthesis_end)
 					break;
 				if (cur_token.type != XPathToken::type_comma)
-					throw XPathException("Expected ',' or ')' in function call", expression, cur_token);
+					throw XPathException("Expected ',' or ')' in function call", expression.text, cur_token);
 			}
 
 			XPathObject obj = call_function(context, context_node_index, function_name, parameters);
@@ -137,23 +158,22 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		else if (cur_token.type == XPathToken::type_bracket_begin)
 		{
 			if (operand_stack.empty())
-				throw XPathException("Missing operand before predicate", expression, cur_token);
+				throw XPathException("Missing operand before predicate", expression.text, cur_token);
 
 			Operand cur_operand = operand_stack.back();
 			operand_stack.pop_back();
 			if (cur_operand.get_type() != XPathObject::type_node_set)
-				throw XPathException("Expected node-set operand before '['", expression, cur_token);
+				throw XPathException("Expected node-set operand before '['", expression.text, cur_token);
 
 			XPathToken end_token = cur_token;
 			while (end_token.type != XPathToken::type_bracket_end && end_token.type != XPathToken::type_none)
-				end_token = read_token(expression, end_token);
+				end_token = expression.get_next_token(end_token);
 
 			if (end_token.type == XPathToken::type_none)
-				throw XPathException("Missing matching ']' in expression", expression, cur_token);
+				throw XPathException("Missing matching ']' in expression", expression.text, cur_token);
 
 			XPathLocationStep::Predicate predicate;
-			predicate.pos = cur_token.pos + cur_token.length;
-			predicate.length = end_token.pos - predicate.pos;
+			predicate.bracket_begin = cur_token;
 
 			XPathNodeSet filtered_nodes;
 			XPathNodeSet nodes = cur_operand.get_node_set();
@@ -163,8 +183,8 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 					filtered_nodes.push_back(nodes[node_index]);
 			}
 
-			cur_token = read_token(expression, end_token);
-			XPathToken next_token = read_token(expression, cur_token);
+			cur_token = expression.get_next_token(end_token);
+			XPathToken next_token = expression.get_next_token(cur_token);
 			if (!filtered_nodes.empty() &&
 				(next_token.type == XPathToken::type_axis_name ||
 				next_token.type == XPathToken::type_name_test ||
@@ -203,7 +223,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		}
 		else
 		{
-			throw XPathException("Unexpected token", expression, cur_token);
+			throw XPathException("Unexpected token", expression.text, cur_token);
 		}
 
 		prev_token = cur_token;
@@ -218,7 +238,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 			cur_token.type == XPathToken::type_operator &&
 			cur_token.value.oper == XPathToken::operator_parenthesis_end))
 	{
-		throw XPathException("Expected operand", expression, cur_token);
+		throw XPathException("Expected operand", expression.text, cur_token);
 	}
 
 	XPathEvaluateResult result;
@@ -866,7 +886,7 @@ bool XPathEvaluator_Impl::compare_string(const Operand &a, const Operand &b, Ope
 }
 
 XPathToken XPathEvaluator_Impl::read_location_path(
-	const std::string &expression,
+	const XPathExpression_Impl &expression,
 	XPathToken cur_token,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
@@ -899,7 +919,7 @@ XPathToken XPathEvaluator_Impl::read_location_path(
 		}
 		else
 		{
-			XPathToken next_token = read_token(expression, cur_token);
+			XPathToken next_token = expression.get_next_token(cur_token);
 			if (next_token.type == XPathToken::type_axis_name ||
 				next_token.type == XPathToken::type_name_test ||
 				next_token.type == XPathToken::type_node_type ||
@@ -925,7 +945,7 @@ XPathToken XPathEvaluator_Impl::read_location_path(
 }
 
 XPathToken XPathEvaluator_Impl::read_location_steps(
-	const std::string &expression,
+	const XPathExpression_Impl &expression,
 	XPathToken cur_token,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
@@ -938,12 +958,12 @@ XPathToken XPathEvaluator_Impl::read_location_steps(
 		cur_token = read_location_step(expression, cur_token, step);
 		steps.push_back(step);
 
-		XPathToken next_token = read_token(expression, cur_token);
+		XPathToken next_token = expression.get_next_token(cur_token);
 		if ((next_token.type == XPathToken::type_operator && next_token.value.oper == XPathToken::operator_slash) ||
 			(cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash))
 		{
 			if (next_token.value.oper == XPathToken::operator_slash)
-				next_token = read_token(expression, next_token);
+				next_token = expression.get_next_token(next_token);
 			if (next_token.type == XPathToken::type_axis_name ||
 				next_token.type == XPathToken::type_name_test ||
 				next_token.type == XPathToken::type_node_type ||
@@ -971,7 +991,7 @@ XPathToken XPathEvaluator_Impl::read_location_steps(
 }
 
 XPathToken XPathEvaluator_Impl::read_location_step(
-	const std::string &expression,
+	const XPathExpression_Impl &expression,
 	XPathToken cur_token,
 	XPathLocationStep &step) const
 {
@@ -1021,15 +1041,15 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		if (cur_token.type == XPathToken::type_axis_name)
 		{
 			step.axis = cur_token.value.str;
-			cur_token = read_token(expression, cur_token);
+			cur_token = expression.get_next_token(cur_token);
 			if (cur_token.type != XPathToken::type_double_colon)
-				throw XPathException("Expected '::' after axis name", expression, cur_token);
-			cur_token = read_token(expression, cur_token);
+				throw XPathException("Expected '::' after axis name", expression.text, cur_token);
+			cur_token = expression.get_next_token(cur_token);
 		}
 		else if (cur_token.type == XPathToken::type_at_sign) // Abbreviated axis specifier
 		{
 			step.axis = "attribute";
-			cur_token = read_token(expression, cur_token);
+			cur_token = expression.get_next_token(cur_token);
 		}
 		else // Abbreviated syntax
 		{
@@ -1046,44 +1066,43 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		{
 			step.test_type = XPathLocationStep::type_node;
 			step.node_type = cur_token.value.node_type;
-			cur_token = read_token(expression, cur_token);
+			cur_token = expression.get_next_token(cur_token);
 			if (cur_token.type != XPathToken::type_operator || cur_token.value.oper != XPathToken::operator_parenthesis_begin)
-				throw XPathException("Expected '(' after node-type test", expression, cur_token);
-			cur_token = read_token(expression, cur_token);
+				throw XPathException("Expected '(' after node-type test", expression.text, cur_token);
+			cur_token = expression.get_next_token(cur_token);
 			if (cur_token.type == XPathToken::type_literal && step.node_type == XPathToken::node_type_processing_instruction)
 			{
 				step.test_str = cur_token.value.str;
-				cur_token = read_token(expression, cur_token);
+				cur_token = expression.get_next_token(cur_token);
 			}
 			if (cur_token.type != XPathToken::type_operator || cur_token.value.oper != XPathToken::operator_parenthesis_end)
-				throw XPathException("Expected ')' after node-type test", expression, cur_token);
+				throw XPathException("Expected ')' after node-type test", expression.text, cur_token);
 		}
 		else
 		{
-			throw XPathException("Unknown node test type", expression, cur_token);
+			throw XPathException("Unknown node test type", expression.text, cur_token);
 		}
 
-		XPathToken next_token = read_token(expression, cur_token);
+		XPathToken next_token = expression.get_next_token(cur_token);
 		while (next_token.type == XPathToken::type_bracket_begin)
 		{
 			XPathLocationStep::Predicate predicate;
-			predicate.pos = next_token.pos + next_token.length;
+			predicate.bracket_begin = next_token;
 			cur_token = skip_predicate_expression(expression, next_token);
-			predicate.length = cur_token.pos - predicate.pos;
 			step.predicates.push_back(predicate);
-			next_token = read_token(expression, cur_token);
+			next_token = expression.get_next_token(cur_token);
 		}
 	}
 	return cur_token;
 }
 
-XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &expression, const XPathToken &previous_token) const
+XPathToken XPathEvaluator_Impl::skip_predicate_expression(const XPathExpression_Impl &expression, const XPathToken &previous_token) const
 {
 	int bracket_count = 1;
 	XPathToken cur_token = previous_token;
 	while (true)
 	{
-		cur_token = read_token(expression, cur_token);
+		cur_token = expression.get_next_token(cur_token);
 		if (cur_token.type == XPathToken::type_bracket_begin)
 		{
 			bracket_count++;
@@ -1102,7 +1121,7 @@ XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &exp
 	return cur_token;
 }
 
-void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	if (step_index < steps.size())
 	{
@@ -1133,7 +1152,7 @@ void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XP
 		else if (steps[step_index].axis == "self")
 			select_nodes_self(context, context_node_index, steps, step_index, expression, nodes);
 		else
-			throw XPathException(string_format("Unknown location step axis", steps[step_index].axis), expression);
+			throw XPathException(string_format("Unknown location step axis", steps[step_index].axis), expression.text);
 	}
 	else
 	{
@@ -1141,7 +1160,7 @@ void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XP
 	}
 }
 
-void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index].get_parent_node();
@@ -1156,7 +1175,7 @@ void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPa
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index];
@@ -1171,7 +1190,7 @@ void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &cont
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNamedNodeMap attributes = context[context_node_index].get_attributes();
@@ -1186,7 +1205,7 @@ void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_first_child();
@@ -1200,7 +1219,7 @@ void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathN
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet parentNodes;
 	XPathNodeSet nodeset;
@@ -1226,7 +1245,7 @@ void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, X
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet parentNodes;
 	XPathNodeSet nodeset;
@@ -1252,7 +1271,7 @@ void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &co
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 
@@ -1288,7 +1307,7 @@ void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_next_sibling();
@@ -1302,11 +1321,11 @@ void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &con
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 }
 
-void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index].get_parent_node();
@@ -1319,7 +1338,7 @@ void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPath
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 
@@ -1355,7 +1374,7 @@ void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_previous_sibling();
@@ -1369,7 +1388,7 @@ void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &con
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	DomNode cur_node = context[context_node_index];
 	if (!cur_node.is_null())
@@ -1379,7 +1398,7 @@ void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNo
 	}
 }
 
-bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const
+bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const XPathExpression_Impl &expression) const
 {
 	bool test_passed = false;
 	switch (step.test_type)
@@ -1418,9 +1437,10 @@ bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const X
 	return test_passed;
 }
 
-bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const
+bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const XPathExpression_Impl &expression) const
 {
-	XPathEvaluateResult result = evaluate(expression.substr(predicate.pos, predicate.length), context, context_node_index, XPathToken());
+	// Evaluation stops at the ']' ending the predicate:
+	XPathEvaluateResult result = evaluate(expression, context, context_node_index, predicate.bracket_begin);
 	bool include_in_nodeset = false;
 	switch (result.result.get_type())
 	{
@@ -1442,7 +1462,7 @@ bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNod
 	return include_in_nodeset;
 }
 
-void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathExpression_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset = context;
 	for (const auto & elem : steps[step_index].predicates)
@@ -1462,7 +1482,7 @@ void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &
 
 XPathToken XPathEvaluator_Impl::read_token(
 	const std::string &expression,
-	const XPathToken &previous_token) const
+	const XPathToken &previous_token)
 {
 	std::string::size_type pos = previous_token.pos + previous_token.length;
 	pos = expression.find_first_not_of(" \t\r\n", pos);
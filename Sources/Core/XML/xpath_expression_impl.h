@@ -0,0 +1,59 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "xpath_token.h"
+#include <vector>
+
+namespace clan
+{
+
+class XPathExpression_Impl
+{
+public:
+	XPathExpression_Impl(const std::string &text);
+
+	/// \brief Returns the token following 'token' in the expression
+	///
+	/// A default constructed token is treated as the position before the first token.
+	/// Reading past the end of the expression returns a type_none token.
+	const XPathToken &get_next_token(const XPathToken &token) const
+	{
+		std::vector<XPathToken>::size_type next_index = token.index + 1;
+		return tokens[next_index < tokens.size() ? next_index : tokens.size() - 1];
+	}
+
+	/// \brief Expression string
+	std::string text;
+
+	/// \brief Tokens of the expression, terminated by a type_none token
+	std::vector<XPathToken> tokens;
+};
+
+}
@@ -54,7 +54,8 @@ public:
 
 	struct Predicate
 	{
-		std::string::size_type pos, length;
+		/// \brief The '[' token starting the predicate expression
+		XPathToken bracket_begin;
 	};
 
 	XPathToken::NodeType node_type;
@@ -96,8 +96,11 @@ public:
 	Value value;
 	std::string::size_type pos, length;
 
+	/// \brief Index of the token in XPathExpression_Impl::tokens, or -1 for the position before the first token
+	int index;
+
 	XPathToken()
-	: type(type_none), pos(0), length(0)
+	: type(type_none), pos(0), length(0), index(-1)
 	{
 	}
 };
@@ -45,6 +45,7 @@
 #include "zip_digital_signature.h"
 #include <ctime>
 #include <mutex>
+#include <unordered_set>
 
 namespace clan
 {
@@ -63,6 +64,7 @@ ZipArchive::ZipArchive(const std::string &filename)
 	IODevice input = File(filename);
 	impl->input = input;
 	load(input);
+	impl->mapped_file = ZipMappedFile::try_map(filename);
 }
 
 ZipArchive::ZipArchive(IODevice &input)
@@ -97,54 +99,14 @@ std::vector<ZipFileEntry> ZipArchive::get_file_list(const std::string &dirpath)
 	path = PathHelp::make_absolute("/",	path, PathHelp::path_type_virtual);
 	path = PathHelp::add_trailing_slash(path, PathHelp::path_type_virtual);
 
-	std::vector<ZipFileEntry> files;
-	std::vector<std::string> added_directories;
+	if (!impl->directory_listings_built)
+		impl->build_directory_listings();
 
-	for (auto & elem : impl->files)
-	{
-		std::string filename = elem.get_archive_filename();
-		if (filename[0] != '/')
-		{
-			filename.insert(filename.begin(), '/');
-			elem.set_archive_filename(filename);
-		}
-		
-		if (filename.substr(0, path.size()) == path)
-		{
-			std::string::size_type subdir_slash_pos = filename.find('/', path.size());
-
-			if (subdir_slash_pos != std::string::npos) // subdirectory or files in a subdirectory
-			{
-				bool dir_added = false;
-				std::string directory_name = filename.substr(path.size(), subdir_slash_pos-path.size());
-
-				for (auto & added_directory : added_directories)
-				{
-					if (added_directory == directory_name)
-						dir_added = true;
-				}
-
-				if (!dir_added)
-				{
-					ZipFileEntry dir_entry;
-					dir_entry.set_archive_filename(directory_name);
-					dir_entry.set_directory(true);
-					files.push_back(dir_entry);
-
-					added_directories.push_back(directory_name);
-				}
-			}
-			else if (elem.get_archive_filename() != path)
-			{
-				std::string file_name = filename.substr(path.size(), std::string::npos);
-				ZipFileEntry file_entry;
-				file_entry.set_archive_filename(file_name);
-				files.push_back(file_entry);
-			}
-		}
-	}
-
-	return files;
+	auto it = impl->directory_listings.find(path);
+	if (it != impl->directory_listings.end())
+		return it->second;
+	else
+		return std::vector<ZipFileEntry>();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -152,39 +114,33 @@ std::vector<ZipFileEntry> ZipArchive::get_file_list(const std::string &dirpath)
 
 IODevice ZipArchive::open_file(const std::string &filename)
 {
-	int size = impl->files.size();
-	for (int i=0; i<size; i++)
-	{
-		ZipFileEntry &entry = impl->files[i];
+	auto it = impl->file_index.find(filename);
+	if (it == impl->file_index.end())
+		throw Exception(string_format("Unable to find zip index %1", filename));
 
-		std::string entry_filename = entry.impl->record.filename;
-		if (entry_filename[0] == '/')
-			entry_filename = entry_filename.substr(1,std::string::npos);
+	ZipFileEntry &entry = impl->files[it->second];
+	switch (entry.impl->type)
+	{
+	case ZipFileEntry_Impl::type_file:
+	{
+		if (impl->mapped_file)
+			return IODevice(new ZipIODevice_FileEntry(impl->mapped_file, entry));
 
-		if (entry_filename == filename)
-		{
-			switch (entry.impl->type)
-			{
-			case ZipFileEntry_Impl::type_file:
-			{
-				IODevice dupe = impl->input.duplicate();
-				return IODevice(new ZipIODevice_FileEntry(dupe, entry));
-			}
+		IODevice dupe = impl->input.duplicate();
+		return IODevice(new ZipIODevice_FileEntry(dupe, entry));
+	}
 
-			case ZipFileEntry_Impl::type_removed:
-				throw Exception(string_format("Unable to zip open file entry %1. The entry has been removed!", filename));
-				break;
+	case ZipFileEntry_Impl::type_removed:
+		throw Exception(string_format("Unable to zip open file entry %1. The entry has been removed!", filename));
+		break;
 
-			case ZipFileEntry_Impl::type_added_memory:
-				return MemoryDevice(entry.impl->data);
+	case ZipFileEntry_Impl::type_added_memory:
+		return MemoryDevice(entry.impl->data);
 
-			case ZipFileEntry_Impl::type_added_file:
-				return File(entry.impl->filename);
-			}
-			throw Exception(string_format("Unknown zip file entry type %1", filename));
-		}
+	case ZipFileEntry_Impl::type_added_file:
+		return File(entry.impl->filename);
 	}
-	throw Exception(string_format("Unable to find zip index %1", filename));
+	throw Exception(string_format("Unknown zip file entry type %1", filename));
 } 
 
 std::string ZipArchive::get_pathname(const std::string &filename)
@@ -203,6 +159,8 @@ void ZipArchive::add_file(const std::string &input_filename, const std::string &
 	file_entry.set_input_filename(input_filename);
 	file_entry.set_archive_filename(archive_filename);
 	impl->files.push_back(file_entry);
+	impl->add_to_index(impl->files.size() - 1);
+	impl->directory_listings_built = false;
 }
 
 void ZipArchive::save()
@@ -214,7 +172,7 @@ void ZipArchive::save(const std::string &filename)
 {
 	File output(filename, File::create_always, File::access_read_write);
 
-	std::vector<int> local_header_offsets;
+	std::vector<int64_t> local_header_offsets;
 	std::vector<uint32_t> crc32_codes;
 
 	int16_t dos_date = 0, dos_time = 0;
@@ -256,7 +214,7 @@ void ZipArchive::save(const std::string &filename)
 	}
 
 	int index = 0;
-	int offset_start_central_dir = output.get_position();
+	int64_t offset_start_central_dir = output.get_position();
 
 	// write central directory entries.
 	for (it=impl->files.begin(); it!=impl->files.end(); ++it)
@@ -291,7 +249,7 @@ void ZipArchive::save(const std::string &filename)
 	digi_sign.size_of_data = 0;
 	digi_sign.save(output);*/
 
-	int central_dir_size = output.get_position() - offset_start_central_dir;
+	int64_t central_dir_size = output.get_position() - offset_start_central_dir;
 
 	ZipEndOfCentralDirectoryRecord central_dir_end;
 
@@ -309,6 +267,7 @@ void ZipArchive::save(const std::string &filename)
 void ZipArchive::load(IODevice &input)
 {
 	impl->input = input;
+	impl->mapped_file.reset();
 	// Load zip file structures:
 
 	// indicate the file is little-endian
@@ -316,13 +275,13 @@ void ZipArchive::load(IODevice &input)
 
 	// Find end of central directory record:
 
-	int size_file = input.get_size();
+	int64_t size_file = input.get_size();
 
 	char buffer[32*1024];
 	if (size_file > 32*1024) input.seek(-32*1024, IODevice::seek_end);
 	int size_buffer = input.read(buffer, 32*1024);
 
-	int end_record_pos = -1;
+	int64_t end_record_pos = -1;
 	for (int pos = size_buffer-4; pos >= 0; pos--)
 	{
 	#ifdef USE_BIG_ENDIAN
@@ -352,16 +311,15 @@ void ZipArchive::load(IODevice &input)
 	Zip64EndOfCentralDirectoryLocator zip64_locator;
 	Zip64EndOfCentralDirectoryRecord zip64_end_of_directory;
 
-	int end64_locator = end_record_pos-20;
-	input.seek(end64_locator, IODevice::seek_set);
-	if (input.read_uint32() == 0x07064b50)
+	int64_t end64_locator = end_record_pos-20;
+	if (end64_locator >= 0 && input.seek(end64_locator, IODevice::seek_set) && input.read_uint32() == 0x07064b50)
 	{
 		// Load zip64 structures:
 
 		input.seek(end64_locator, IODevice::seek_set);
 		zip64_locator.load(input);
 
-		input.seek(int(end64_locator+zip64_locator.relative_offset_of_zip64_end_of_central_directory), IODevice::seek_set);
+		input.seek(zip64_locator.relative_offset_of_zip64_end_of_central_directory, IODevice::seek_set);
 		zip64_end_of_directory.load(input);
 
 		zip64 = true;
@@ -369,23 +327,101 @@ void ZipArchive::load(IODevice &input)
 
 	// Load central directory records:
 
-	if (zip64) input.seek(int(zip64_end_of_directory.offset_to_start_of_central_directory), IODevice::seek_set);
-	else input.seek(int(end_of_directory.offset_to_start_of_central_directory), IODevice::seek_set);
+	int64_t directory_offset = (uint32_t)end_of_directory.offset_to_start_of_central_directory;
+	int64_t directory_size = (uint32_t)end_of_directory.size_of_central_directory;
+	int64_t num_entries = (uint16_t)end_of_directory.number_of_entries_in_central_directory;
+	if (zip64)
+	{
+		directory_offset = zip64_end_of_directory.offset_to_start_of_central_directory;
+		directory_size = zip64_end_of_directory.size_of_central_directory;
+		num_entries = zip64_end_of_directory.number_of_entries_in_central_directory;
+	}
+
+	if (directory_offset < 0 || directory_size < 0 || directory_offset + directory_size > size_file)
+		throw Exception("Zip central directory is outside the file");
+	if (directory_size > 0xffffffff)
+		throw Exception("Zip central directory is too large");
+
+	// Read the whole directory at once, rather than field by field from the device
+	DataBuffer directory_data((unsigned int)directory_size);
+	input.seek(directory_offset, IODevice::seek_set);
+	if (input.read(directory_data.get_data(), directory_data.get_size()) != directory_data.get_size())
+		throw Exception("Unable to read zip central directory");
 
-	int64_t num_entries = end_of_directory.number_of_entries_in_central_directory;
-	if (zip64) num_entries = zip64_end_of_directory.number_of_entries_in_central_directory;
+	MemoryDevice directory(directory_data);
+	directory.set_little_endian_mode();
 
+	impl->directory_listings_built = false;
+	impl->files.reserve(impl->files.size() + size_t(num_entries));
+	impl->file_index.reserve(impl->files.size() + size_t(num_entries));
 	for (int i=0; i<num_entries; i++)
 	{
 		ZipFileEntry entry;
-		entry.impl->record.load(input);
+		entry.impl->record.load(directory);
 		impl->files.push_back(entry);
+		impl->add_to_index(impl->files.size() - 1);
 	}
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // ZipArchive implementation:
 
+void ZipArchive_Impl::add_to_index(int index)
+{
+	std::string filename = files[index].get_archive_filename();
+	if (!filename.empty() && filename[0] == '/')
+		file_index.emplace(filename.substr(1), index);
+	else
+		file_index.emplace(filename, index);
+}
+
+void ZipArchive_Impl::build_directory_listings()
+{
+	directory_listings.clear();
+	std::unordered_map<std::string, std::unordered_set<std::string> > added_directories;
+
+	for (auto & elem : files)
+	{
+		std::string filename = elem.get_archive_filename();
+		if (filename.empty() || filename[0] != '/')
+			filename.insert(filename.begin(), '/');
+
+		// Every parent directory lists either the next directory of the path, or the file itself
+		std::string::size_type dir_end = 0;
+		while (true)
+		{
+			std::string path = filename.substr(0, dir_end + 1);
+			std::vector<ZipFileEntry> &listing = directory_listings[path];
+
+			std::string::size_type subdir_slash_pos = filename.find('/', dir_end + 1);
+			if (subdir_slash_pos != std::string::npos)
+			{
+				std::string directory_name = filename.substr(dir_end + 1, subdir_slash_pos - dir_end - 1);
+				if (added_directories[path].insert(directory_name).second)
+				{
+					ZipFileEntry dir_entry;
+					dir_entry.set_archive_filename(directory_name);
+					dir_entry.set_directory(true);
+					listing.push_back(dir_entry);
+				}
+				dir_end = subdir_slash_pos;
+			}
+			else
+			{
+				if (filename.size() > path.size())
+				{
+					ZipFileEntry file_entry;
+					file_entry.set_archive_filename(filename.substr(path.size()));
+					listing.push_back(file_entry);
+				}
+				break;
+			}
+		}
+	}
+
+	directory_listings_built = true;
+}
+
 void ZipArchive_Impl::calc_time_and_date(int16_t &out_date, int16_t &out_time)
 {
 	uint32_t day_of_month = 0;
@@ -31,6 +31,8 @@
 #include "API/Core/Zip/zip_file_entry.h"
 #include "API/Core/IOData/iodevice.h"
 #include "zip_flags.h"
+#include "zip_mapped_file.h"
+#include <unordered_map>
 
 namespace clan
 {
@@ -52,6 +54,17 @@ public:
 
 	IODevice input;
 
+	/// \brief Memory mapping of the archive, if it was loaded from a file that could be mapped
+	std::shared_ptr<ZipMappedFile> mapped_file;
+
+	/// \brief Index into files for each archive filename, without leading slash
+	std::unordered_map<std::string, int> file_index;
+
+	/// \brief Listing of each directory in the form "/Folder/", built on first use
+	std::unordered_map<std::string, std::vector<ZipFileEntry> > directory_listings;
+
+	bool directory_listings_built = false;
+
 
 /// \}
 /// \name Operations
@@ -62,6 +75,11 @@ public:
 
 	static void calc_time_and_date(int16_t &out_date, int16_t &out_time);
 
+	/// \brief Adds files[index] to the filename index, unless an earlier entry has the same name
+	void add_to_index(int index);
+
+	void build_directory_listings();
+
 
 /// \}
 /// \name Implementation
@@ -68,15 +68,17 @@ void ZipFileHeader::load(IODevice &input)
 	last_mod_file_time = input.read_int16();
 	last_mod_file_date = input.read_int16();
 	crc32 = input.read_uint32();
-	compressed_size = input.read_int32();
-	uncompressed_size = input.read_int32();
+	compressed_size = input.read_uint32();
+	uncompressed_size = input.read_uint32();
 	file_name_length = input.read_int16();
 	extra_field_length = input.read_int16();
 	file_comment_length = input.read_int16();
 	disk_number_start = input.read_int16();
 	internal_file_attributes = input.read_int16();
 	external_file_attributes = input.read_int32();
-	relative_offset_of_local_header = input.read_int32();
+	relative_offset_of_local_header = input.read_uint32();
+	if (file_name_length < 0 || extra_field_length < 0 || file_comment_length < 0)
+		throw Exception("Invalid File Header field length");
 	filename.resize(file_name_length);
 
 	auto str1 = new char[file_name_length];
@@ -99,6 +101,7 @@ void ZipFileHeader::load(IODevice &input)
 		}
 
 		extra_field = DataBuffer(str2, extra_field_length);
+		read_zip64_extra_field(extra_field, &uncompressed_size, &compressed_size, &relative_offset_of_local_header);
 
 		delete[] str1;
 		delete[] str2;
@@ -131,6 +134,9 @@ void ZipFileHeader::save(IODevice &output)
 	file_name_length = str_filename.length();
 	file_comment_length = str_comment.length();
 
+	if (compressed_size > 0xffffffff || uncompressed_size > 0xffffffff || relative_offset_of_local_header > 0xffffffff)
+		throw Exception("Writing Zip64 File Headers is not supported");
+
 	output.write_int32(signature);
 	output.write_int16(version_made_by);
 	output.write_int16(version_needed_to_extract);
@@ -139,20 +145,58 @@ void ZipFileHeader::save(IODevice &output)
 	output.write_int16(last_mod_file_time);
 	output.write_int16(last_mod_file_date);
 	output.write_uint32(crc32);
-	output.write_int32(compressed_size);
-	output.write_int32(uncompressed_size);
+	output.write_uint32((uint32_t)compressed_size);
+	output.write_uint32((uint32_t)uncompressed_size);
 	output.write_int16(file_name_length);
 	output.write_int16(extra_field_length);
 	output.write_int16(file_comment_length);
 	output.write_int16(disk_number_start);
 	output.write_int16(internal_file_attributes);
 	output.write_int32(external_file_attributes);
-	output.write_int32(relative_offset_of_local_header);
+	output.write_uint32((uint32_t)relative_offset_of_local_header);
 	output.write(str_filename.data(), file_name_length);
 	output.write(extra_field.get_data(), extra_field_length);
 	output.write(file_comment.data(), file_comment_length);
 }
 
+void ZipFileHeader::read_zip64_extra_field(const DataBuffer &extra_field, int64_t *uncompressed_size, int64_t *compressed_size, int64_t *relative_offset_of_local_header)
+{
+	const unsigned char *data = extra_field.get_data<unsigned char>();
+	int size = extra_field.get_size();
+	int pos = 0;
+	while (pos + 4 <= size)
+	{
+		int tag = data[pos] + (data[pos + 1] << 8);
+		int length = data[pos + 2] + (data[pos + 3] << 8);
+		pos += 4;
+		if (pos + length > size)
+			break;
+
+		if (tag == 0x0001)
+		{
+			// Only the fields saturated at 0xffffffff in the header are present, in this order:
+			int64_t *fields[3] = { uncompressed_size, compressed_size, relative_offset_of_local_header };
+			int field_pos = pos;
+			for (int64_t *field : fields)
+			{
+				if (field && *field == 0xffffffff)
+				{
+					if (field_pos + 8 > pos + length)
+						throw Exception("Invalid Zip64 extended information extra field");
+
+					uint64_t value = 0;
+					for (int i = 7; i >= 0; i--)
+						value = (value << 8) | data[field_pos + i];
+					*field = (int64_t)value;
+					field_pos += 8;
+				}
+			}
+			break;
+		}
+		pos += length;
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ZipFileHeader implementation:
 
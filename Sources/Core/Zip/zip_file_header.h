@@ -68,9 +68,9 @@ public:
 
 	uint32_t crc32;
 
-	int32_t compressed_size;
+	int64_t compressed_size;
 
-	int32_t uncompressed_size;
+	int64_t uncompressed_size;
 
 	int16_t file_name_length;
 
@@ -84,7 +84,7 @@ public:
 
 	int32_t external_file_attributes;
 
-	int32_t relative_offset_of_local_header;
+	int64_t relative_offset_of_local_header;
 
 	std::string filename;
 
@@ -102,6 +102,9 @@ public:
 
 	void save(IODevice &output);
 
+	/// \brief Replaces the 32 bit fields saturated at 0xffffffff with the values in a Zip64 extended information extra field
+	static void read_zip64_extra_field(const DataBuffer &extra_field, int64_t *uncompressed_size, int64_t *compressed_size, int64_t *relative_offset_of_local_header);
+
 
 /// \}
 /// \name Implementation
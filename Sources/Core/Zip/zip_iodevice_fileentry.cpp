@@ -32,8 +32,10 @@
 #include "zip_compression_method.h"
 #include "zip_flags.h"
 #include "API/Core/IOData/file.h"
+#include "API/Core/IOData/memory_device.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Text/string_format.h"
+#include <climits>
 
 namespace clan
 {
@@ -42,7 +44,13 @@ namespace clan
 // ZipIODevice_FileEntry construction:
 
 ZipIODevice_FileEntry::ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry)
-: iodevice(iodevice), file_entry(entry), zstream_open(false), peeked_data(0)
+: iodevice(iodevice), mapped_data(nullptr), file_entry(entry), zstream_open(false), peeked_data(0)
+{
+	init();
+}
+
+ZipIODevice_FileEntry::ZipIODevice_FileEntry(const std::shared_ptr<ZipMappedFile> &mapped_file, const ZipFileEntry &entry)
+: mapped_file(mapped_file), mapped_data(nullptr), file_entry(entry), zstream_open(false), peeked_data(0)
 {
 	init();
 }
@@ -55,14 +63,14 @@ ZipIODevice_FileEntry::~ZipIODevice_FileEntry()
 /////////////////////////////////////////////////////////////////////////////
 // ZipIODevice_FileEntry attributes:
 
-int ZipIODevice_FileEntry::get_size() const
+int64_t ZipIODevice_FileEntry::get_size() const
 {
 	return file_header.uncompressed_size;
 }
 
-int ZipIODevice_FileEntry::get_position() const
+int64_t ZipIODevice_FileEntry::get_position() const
 {
-	return (int) pos;
+	return pos;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -116,7 +124,7 @@ int ZipIODevice_FileEntry::peek(void *data, int len)
 	}
 }
 
-bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
+bool ZipIODevice_FileEntry::seek(int64_t seek_pos, IODevice::SeekMode mode)
 {
 	int64_t absolute_pos = 0;
 	switch (mode)
@@ -137,7 +145,10 @@ bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
 	switch (file_header.compression_method)
 	{
 	case zip_compress_store: // no compression
-		iodevice.seek(int(absolute_pos-pos), IODevice::seek_cur);
+		absolute_pos = clamp(absolute_pos, (int64_t)0, (int64_t)file_header.uncompressed_size);
+		if (!mapped_file)
+			iodevice.seek(absolute_pos-pos, IODevice::seek_cur);
+		pos = absolute_pos;
 		break;
 
 	case zip_compress_deflate:
@@ -172,8 +183,10 @@ bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
 
 IODeviceProvider *ZipIODevice_FileEntry::duplicate()
 {
-	ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(this, file_entry);
-	return new_provider;
+	if (mapped_file)
+		return new ZipIODevice_FileEntry(mapped_file, file_entry);
+	else
+		return new ZipIODevice_FileEntry(iodevice.duplicate(), file_entry);
 }
 
 
@@ -182,8 +195,15 @@ IODeviceProvider *ZipIODevice_FileEntry::duplicate()
 
 void ZipIODevice_FileEntry::init()
 {
-	iodevice.seek(file_entry.impl->record.relative_offset_of_local_header, IODevice::seek_set);
-	file_header.load(iodevice);
+	if (mapped_file)
+	{
+		load_mapped_header();
+	}
+	else
+	{
+		iodevice.seek(file_entry.impl->record.relative_offset_of_local_header, IODevice::seek_set);
+		file_header.load(iodevice);
+	}
 
 	//This fix allows OS X created .zips to be opened - SAR
 	if (file_header.general_purpose_bit_flag  & ZIP_CRC32_IN_FILE_DESCRIPTOR) //if this bit is set, it means the local header data for sizes was not
@@ -196,6 +216,14 @@ void ZipIODevice_FileEntry::init()
 	pos = 0;
 	compressed_pos = 0;
 
+	if (mapped_file)
+	{
+		int64_t data_offset = mapped_data - mapped_file->get_data();
+		int64_t data_size = (file_header.compression_method == zip_compress_store) ? file_header.uncompressed_size : file_header.compressed_size;
+		if (data_size < 0 || data_offset + data_size > mapped_file->get_size())
+			throw Exception("Zip file entry data is outside the archive");
+	}
+
 	// Initialize decompression:
 	int result = 0;
 	switch (file_header.compression_method)
@@ -262,6 +290,14 @@ int ZipIODevice_FileEntry::lowlevel_read(void *data, int size, bool read_all)
 	switch (file_header.compression_method)
 	{
 	case zip_compress_store: // no compression
+		if (mapped_file)
+		{
+			int received = int(min((int64_t)size, file_header.uncompressed_size - pos));
+			memcpy(data, mapped_data + pos, received);
+			pos += received;
+			return received;
+		}
+		else
 		{
 			int received = iodevice.receive(data, int(min((int64_t)size, file_header.uncompressed_size - pos)), read_all);
 			pos += received;
@@ -270,19 +306,31 @@ int ZipIODevice_FileEntry::lowlevel_read(void *data, int size, bool read_all)
 		break;
 
 	case zip_compress_deflate:
+		// Never inflate past the size recorded in the central directory:
+		size = int(max((int64_t)0, min((int64_t)size, file_header.uncompressed_size - pos)));
 		zs.next_out = (unsigned char *) data;
 		zs.avail_out = size;
 		// Continue feeding zlib data until we get our data:
 		while (zs.avail_out > 0)
 		{
 			// zlib needs more data:
-			if (zs.avail_in == 0 && compressed_pos < file_header.compressed_size)
+			if (zs.avail_in == 0 && compressed_pos < file_header.compressed_size && mapped_file)
+			{
+				// Feed the mapping directly, in chunks that fit the 32-bit avail_in of the stream:
+				int64_t chunk_size = min(file_header.compressed_size - compressed_pos, (int64_t)UINT_MAX);
+				zs.next_in = mapped_data + compressed_pos;
+				zs.avail_in = (unsigned int)chunk_size;
+				compressed_pos += chunk_size;
+			}
+			else if (zs.avail_in == 0 && compressed_pos < file_header.compressed_size)
 			{
 				// Read some compressed data:
 				int received_input = 0;
 				while (received_input < 16*1024)
 				{
-					received_input += iodevice.receive(zbuffer, int(min((int64_t)16*1024, file_header.compressed_size - compressed_pos)), true);
+					int received = iodevice.receive(zbuffer + received_input, int(min((int64_t)16*1024 - received_input, file_header.compressed_size - compressed_pos - received_input)), true);
+					if (received <= 0) throw Exception("Premature end of zip file data");
+					received_input += received;
 					if (compressed_pos + received_input == file_header.compressed_size) break;
 				}
 				compressed_pos += received_input;
@@ -292,6 +340,8 @@ int ZipIODevice_FileEntry::lowlevel_read(void *data, int size, bool read_all)
 			}
 
 			// Decompress data:
+			unsigned int avail_in_before = zs.avail_in;
+			unsigned int avail_out_before = zs.avail_out;
 			int result = mz_inflate(&zs, 0);
 			if (result == MZ_STREAM_END) break;
 			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
@@ -300,6 +350,9 @@ int ZipIODevice_FileEntry::lowlevel_read(void *data, int size, bool read_all)
 			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
 			if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
 			if (result != MZ_OK) throw Exception("Zlib inflate failed while decompressing zip file!");
+
+			// All input consumed without reaching the end of the stream:
+			if (zs.avail_in == avail_in_before && zs.avail_out == avail_out_before) throw Exception("Zip data stream is corrupted");
 		}
 		pos += size - zs.avail_out;
 		return size - zs.avail_out;
@@ -319,4 +372,25 @@ int ZipIODevice_FileEntry::lowlevel_read(void *data, int size, bool read_all)
 	return 0;
 }
 
+void ZipIODevice_FileEntry::load_mapped_header()
+{
+	// The name and extra field lengths are needed to know the size of the local header
+	const int fixed_header_size = 30;
+	int64_t header_offset = file_entry.impl->record.relative_offset_of_local_header;
+	if (header_offset + fixed_header_size > mapped_file->get_size())
+		throw Exception("Zip local file header is outside the archive");
+
+	const unsigned char *header = mapped_file->get_data() + header_offset;
+	int header_size = fixed_header_size + (header[26] | (header[27] << 8)) + (header[28] | (header[29] << 8));
+	if (header_offset + header_size > mapped_file->get_size())
+		throw Exception("Zip local file header is outside the archive");
+
+	DataBuffer header_data(header, header_size);
+	MemoryDevice header_device(header_data);
+	header_device.set_little_endian_mode();
+	file_header.load(header_device);
+
+	mapped_data = header + header_size;
+}
+
 }
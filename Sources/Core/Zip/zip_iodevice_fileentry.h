@@ -32,6 +32,7 @@
 #include "API/Core/Zip/zip_file_entry.h"
 #include "API/Core/System/databuffer.h"
 #include "zip_local_file_header.h"
+#include "zip_mapped_file.h"
 #include <stack>
 #include "Core/Zip/miniz.h"
 
@@ -46,6 +47,9 @@ class ZipIODevice_FileEntry : public IODeviceProvider
 public:
 	ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry);
 
+	/// \brief Reads the entry directly from a memory mapped archive
+	ZipIODevice_FileEntry(const std::shared_ptr<ZipMappedFile> &mapped_file, const ZipFileEntry &entry);
+
 	~ZipIODevice_FileEntry();
 
 
@@ -54,9 +58,9 @@ public:
 /// \{
 
 public:
-	virtual int get_size() const override;
+	virtual int64_t get_size() const override;
 
-	virtual int get_position() const override;
+	virtual int64_t get_position() const override;
 
 
 /// \}
@@ -70,7 +74,7 @@ public:
 
 	virtual int peek(void *data, int len) override;
 
-	virtual bool seek(int position, IODevice::SeekMode mode) override;
+	virtual bool seek(int64_t position, IODevice::SeekMode mode) override;
 
 	IODeviceProvider *duplicate() override;
 
@@ -84,10 +88,17 @@ private:
 
 	void deinit();
 
+	void load_mapped_header();
+
 	int lowlevel_read(void *buffer, int size, bool read_all);
 
 	IODevice iodevice;
 
+	std::shared_ptr<ZipMappedFile> mapped_file;
+
+	/// \brief Compressed data of the entry in the mapped archive
+	const unsigned char *mapped_data;
+
 	ZipFileEntry file_entry;
 
 	ZipLocalFileHeader file_header;
@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "zip_local_file_header.h"
+#include "zip_file_header.h"
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/Text/string_help.h"
 #include "zip_flags.h"
@@ -67,10 +68,12 @@ void ZipLocalFileHeader::load(IODevice &input)
 	last_mod_file_time = input.read_int16();
 	last_mod_file_date = input.read_int16();
 	crc32 = input.read_uint32();
-	compressed_size = input.read_int32();
-	uncompressed_size = input.read_int32();
+	compressed_size = input.read_uint32();
+	uncompressed_size = input.read_uint32();
 	file_name_length = input.read_int16();
 	extra_field_length = input.read_int16();
+	if (file_name_length < 0 || extra_field_length < 0)
+		throw Exception("Invalid Local File Header field length");
 	auto str1 = new char[file_name_length];
 	auto str2 = new char[extra_field_length];
 	try
@@ -83,6 +86,7 @@ void ZipLocalFileHeader::load(IODevice &input)
 			filename = StringHelp::cp437_to_text(std::string(str1, file_name_length));
 
 		extra_field = DataBuffer(str2, extra_field_length);
+		ZipFileHeader::read_zip64_extra_field(extra_field, &uncompressed_size, &compressed_size, nullptr);
 
 		delete[] str1;
 		delete[] str2;
@@ -105,6 +109,9 @@ void ZipLocalFileHeader::save(IODevice &output)
 
 	file_name_length = str_filename.length();
 
+	if (compressed_size > 0xffffffff || uncompressed_size > 0xffffffff)
+		throw Exception("Writing Zip64 Local File Headers is not supported");
+
 	output.write_int32(signature); // 0x04034b50
 	output.write_int16(version_needed_to_extract);
 	output.write_int16(general_purpose_bit_flag);
@@ -112,8 +119,8 @@ void ZipLocalFileHeader::save(IODevice &output)
 	output.write_int16(last_mod_file_time);
 	output.write_int16(last_mod_file_date);
 	output.write_uint32(crc32);
-	output.write_int32(compressed_size);
-	output.write_int32(uncompressed_size);
+	output.write_uint32((uint32_t)compressed_size);
+	output.write_uint32((uint32_t)uncompressed_size);
 	output.write_int16(file_name_length);
 	output.write_int16(extra_field_length);
 
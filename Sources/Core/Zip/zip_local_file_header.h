@@ -66,9 +66,9 @@ public:
 
 	uint32_t crc32;
 
-	int32_t compressed_size;
+	int64_t compressed_size;
 
-	int32_t uncompressed_size;
+	int64_t uncompressed_size;
 
 	int16_t file_name_length;
 
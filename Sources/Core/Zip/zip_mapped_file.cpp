@@ -0,0 +1,100 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "zip_mapped_file.h"
+#include "API/Core/Text/string_help.h"
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// ZipMappedFile construction:
+
+std::shared_ptr<ZipMappedFile> ZipMappedFile::try_map(const std::string &filename)
+{
+	std::shared_ptr<ZipMappedFile> mapped_file(new ZipMappedFile());
+
+#ifdef WIN32
+	HANDLE handle = CreateFile(StringHelp::utf8_to_ucs2(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (handle == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(handle, &file_size) && file_size.QuadPart > 0)
+	{
+		mapped_file->size = file_size.QuadPart;
+		mapped_file->file_mapping = CreateFileMapping(handle, 0, PAGE_READONLY, 0, 0, 0);
+		if (mapped_file->file_mapping)
+			mapped_file->data = static_cast<const unsigned char *>(MapViewOfFile(mapped_file->file_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	CloseHandle(handle);
+#else
+	int handle = open(filename.c_str(), O_RDONLY);
+	if (handle == -1)
+		return nullptr;
+
+	struct stat file_stat;
+	if (fstat(handle, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0 && (uint64_t)file_stat.st_size <= SIZE_MAX)
+	{
+		void *data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+		if (data != MAP_FAILED)
+		{
+			mapped_file->data = static_cast<const unsigned char *>(data);
+			mapped_file->size = file_stat.st_size;
+		}
+	}
+	close(handle);
+#endif
+
+	if (!mapped_file->data)
+		return nullptr;
+	return mapped_file;
+}
+
+ZipMappedFile::~ZipMappedFile()
+{
+#ifdef WIN32
+	if (data)
+		UnmapViewOfFile(data);
+	if (file_mapping)
+		CloseHandle(file_mapping);
+#else
+	if (data)
+		munmap(const_cast<unsigned char *>(data), size);
+#endif
+}
+
+}
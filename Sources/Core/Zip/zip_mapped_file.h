@@ -0,0 +1,78 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+
+/// \brief Read-only memory mapping of a zip archive file
+class ZipMappedFile
+{
+/// \name Construction
+/// \{
+
+public:
+	/// \brief Maps a file into memory
+	///
+	/// \return The mapping, or nullptr if the file could not be mapped
+	static std::shared_ptr<ZipMappedFile> try_map(const std::string &filename);
+
+	~ZipMappedFile();
+
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	const unsigned char *get_data() const { return data; }
+
+	int64_t get_size() const { return size; }
+
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	ZipMappedFile() { }
+
+	const unsigned char *data = nullptr;
+
+	int64_t size = 0;
+
+#ifdef WIN32
+	HANDLE file_mapping = 0;
+#endif
+/// \}
+};
+
+}
@@ -121,6 +121,7 @@ ProgramObject StandardPrograms::get_program_object(StandardProgram standard_prog
 	case program_single_texture: return impl->single_texture_program;
 	case program_sprite: return impl->sprite_program;
 	case program_path: return impl->path_program;
+	case program_sprite_packed: break;
 	}
 	throw Exception("Unsupported standard program");
 }
@@ -32,16 +32,27 @@
 #include "sprite_impl.h"
 #include "API/Display/Render/blend_state_description.h"
 #include "API/Display/2D/canvas.h"
+#include "API/Display/TargetProviders/vertex_array_buffer_provider.h"
 
 namespace clan
 {
 
+bool RenderBatchBuffer::use_persistent_mapping = true;
+
 RenderBatchBuffer::RenderBatchBuffer(GraphicContext &gc)
 {
 	for (auto & elem : vertex_buffers)
 	{
 		elem = VertexArrayBuffer(gc, vertex_buffer_size, usage_stream_draw);
 	}
+
+	if (use_persistent_mapping)
+	{
+		vertex_ring = VertexArrayBuffer(gc, vertex_buffer_size * num_vertex_buffers, usage_stream_draw);
+		vertex_ring_data = (char *) vertex_ring.get_provider()->map_persistent(gc);
+		if (!vertex_ring_data)
+			vertex_ring = VertexArrayBuffer();
+	}
 }
 
 VertexArrayBuffer RenderBatchBuffer::get_vertex_buffer(GraphicContext &gc, int &out_index)
@@ -55,6 +66,23 @@ VertexArrayBuffer RenderBatchBuffer::get_vertex_buffer(GraphicContext &gc, int &
 	return vertex_buffers[out_index];
 }
 
+char *RenderBatchBuffer::acquire_vertex_ring_segment(GraphicContext &gc, int &out_index)
+{
+	out_index = current_vertex_ring_segment;
+
+	current_vertex_ring_segment++;
+	if (current_vertex_ring_segment == num_vertex_buffers)
+		current_vertex_ring_segment = 0;
+
+	vertex_ring.get_provider()->wait_range(gc, out_index * vertex_buffer_size, vertex_buffer_size);
+	return vertex_ring_data + out_index * vertex_buffer_size;
+}
+
+void RenderBatchBuffer::release_vertex_ring_segment(GraphicContext &gc, int index)
+{
+	vertex_ring.get_provider()->fence_range(gc, index * vertex_buffer_size, vertex_buffer_size);
+}
+
 Texture2D RenderBatchBuffer::get_texture_rgba32f(GraphicContext &gc)
 {
 	current_rgba32f_texture++;
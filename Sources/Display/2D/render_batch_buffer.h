@@ -54,6 +54,18 @@ public:
 	enum { vertex_buffer_size = 1024*1024 };
 	char buffer[vertex_buffer_size];
 
+	// Persistently mapped ring of num_vertex_buffers segments, each vertex_buffer_size bytes. Null if the target cannot map persistently.
+	bool has_vertex_ring() const { return vertex_ring_data != nullptr; }
+	VertexArrayBuffer get_vertex_ring() const { return vertex_ring; }
+
+	/// \brief Returns the next ring segment to write vertices into, waiting for the GPU to finish with it first
+	char *acquire_vertex_ring_segment(GraphicContext &gc, int &out_index);
+
+	/// \brief Fences the segment after the draw commands reading from it have been submitted
+	void release_vertex_ring_segment(GraphicContext &gc, int index);
+
+	static bool use_persistent_mapping;	// Set to false to always upload through the rotating vertex buffers
+
 	
 	static const int rgba32f_width = 512;	// *** If changing this, remember to modify the path shaders ***
 	static const int rgba32f_height = 4;
@@ -67,6 +79,10 @@ private:
 	VertexArrayBuffer vertex_buffers[num_vertex_buffers];
 	int current_vertex_buffer = 0;
 
+	VertexArrayBuffer vertex_ring;
+	char *vertex_ring_data = nullptr;
+	int current_vertex_ring_segment = 0;
+
 	Texture2D textures_rgba32f[num_rgba32f_buffers];
 	int current_rgba32f_texture = 0;
 
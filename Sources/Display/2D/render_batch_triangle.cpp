@@ -31,6 +31,7 @@
 #include "render_batch_triangle.h"
 #include "sprite_impl.h"
 #include "API/Display/Render/blend_state_description.h"
+#include "API/Display/Render/program_object.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Core/Math/quad.h"
 
@@ -41,15 +42,39 @@ namespace clan
 // Warning: Ensure this number does not exceed RenderBatchTriangle::max_number_of_texture_coords
 int RenderBatchTriangle::max_textures = 4;
 
+bool RenderBatchTriangle::use_packed_vertices = true;
+
 RenderBatchTriangle::RenderBatchTriangle(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
 : batch_buffer(batch_buffer)
 {
-	vertices = (SpriteVertex *) batch_buffer->buffer;
+	// With a persistently mapped ring the vertices are written straight into GPU visible memory
+	if (batch_buffer->has_vertex_ring())
+		vertices = (SpriteVertex *) batch_buffer->acquire_vertex_ring_segment(gc, vertex_ring_segment);
+	else
+		vertices = (SpriteVertex *) batch_buffer->buffer;
+
+	// The packed layout needs the target to apply the projection and expand the normalized attributes.
+	// GLSL targets do this in the vertex shader and the GL1 target with the fixed function pipeline.
+	ShaderLanguage shader_language = gc.get_shader_language();
+	packed_supported = use_packed_vertices && (shader_language == shader_glsl || shader_language == shader_fixed_function);
 }
 
 void RenderBatchTriangle::draw_sprite(Canvas &canvas, const Pointf texture_position[4], const Pointf dest_position[4], const Texture2D &texture, const Colorf &color)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	bool packable = packed_supported && is_packable(color) &&
+		is_packable(texture_position[0]) && is_packable(texture_position[1]) && is_packable(texture_position[2]) && is_packable(texture_position[3]);
+
+	int texindex = set_batcher_active(canvas, packable, texture);
+
+	if (packed_batch)
+	{
+		Vec4ub packed_color = to_packed_color(color);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		for (int i = 0; i < 4; i++)
+			to_packed_vertex(dest_position[i].x, dest_position[i].y, texture_position[i].x, texture_position[i].y, packed_color, texindex, v[i]);
+		position += 4;
+		return;
+	}
 
 	to_sprite_vertex(texture_position[0], dest_position[0], vertices[position++], texindex, color);
 	to_sprite_vertex(texture_position[1], dest_position[1], vertices[position++], texindex, color);
@@ -61,8 +86,28 @@ void RenderBatchTriangle::draw_sprite(Canvas &canvas, const Pointf texture_posit
 
 void RenderBatchTriangle::fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Vec4f *triangle_colors, int num_vertices)
 {
-	int texindex = set_batcher_active(canvas, num_vertices);
+	bool packable = packed_supported && (num_vertices % 3) == 0;
+	for (int i = 0; packable && i < num_vertices; i++)
+		packable = is_packable(triangle_colors[i]);
 
+	int texindex = set_batcher_active(canvas, packable, num_vertices);
+
+	if (packed_batch)
+	{
+		// Each triangle is stored as a degenerate quad so that it can share the quad index buffer
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		for (int i = 0; i < num_vertices; i += 3, v += 4)
+		{
+			PackedSpriteVertex last;
+			to_packed_vertex(triangle_positions[i].x, triangle_positions[i].y, 0.0f, 0.0f, to_packed_color(triangle_colors[i]), texindex, v[0]);
+			to_packed_vertex(triangle_positions[i + 1].x, triangle_positions[i + 1].y, 0.0f, 0.0f, to_packed_color(triangle_colors[i + 1]), texindex, v[1]);
+			to_packed_vertex(triangle_positions[i + 2].x, triangle_positions[i + 2].y, 0.0f, 0.0f, to_packed_color(triangle_colors[i + 2]), texindex, last);
+			v[2] = last;
+			v[3] = last;
+		}
+		position += num_vertices / 3 * 4;
+		return;
+	}
 
 	for (; num_vertices > 0; num_vertices--)
 	{
@@ -77,8 +122,26 @@ void RenderBatchTriangle::fill_triangle(Canvas &canvas, const Vec2f *triangle_po
 
 void RenderBatchTriangle::fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Colorf &color, int num_vertices)
 {
-	int texindex = set_batcher_active(canvas, num_vertices);
+	bool packable = packed_supported && (num_vertices % 3) == 0 && is_packable(color);
 
+	int texindex = set_batcher_active(canvas, packable, num_vertices);
+
+	if (packed_batch)
+	{
+		Vec4ub packed_color = to_packed_color(color);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		for (int i = 0; i < num_vertices; i += 3, v += 4)
+		{
+			PackedSpriteVertex last;
+			to_packed_vertex(triangle_positions[i].x, triangle_positions[i].y, 0.0f, 0.0f, packed_color, texindex, v[0]);
+			to_packed_vertex(triangle_positions[i + 1].x, triangle_positions[i + 1].y, 0.0f, 0.0f, packed_color, texindex, v[1]);
+			to_packed_vertex(triangle_positions[i + 2].x, triangle_positions[i + 2].y, 0.0f, 0.0f, packed_color, texindex, last);
+			v[2] = last;
+			v[3] = last;
+		}
+		position += num_vertices / 3 * 4;
+		return;
+	}
 
 	for (; num_vertices > 0; num_vertices--)
 	{
@@ -93,7 +156,28 @@ void RenderBatchTriangle::fill_triangle(Canvas &canvas, const Vec2f *triangle_po
 
 void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf &color)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	bool packable = packed_supported && (num_vertices % 3) == 0 && is_packable(color);
+	for (int i = 0; packable && i < num_vertices; i++)
+		packable = is_packable(texture_positions[i]);
+
+	int texindex = set_batcher_active(canvas, packable, texture);
+
+	if (packed_batch)
+	{
+		Vec4ub packed_color = to_packed_color(color);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		for (int i = 0; i < num_vertices; i += 3, v += 4)
+		{
+			PackedSpriteVertex last;
+			to_packed_vertex(positions[i].x, positions[i].y, texture_positions[i].x, texture_positions[i].y, packed_color, texindex, v[0]);
+			to_packed_vertex(positions[i + 1].x, positions[i + 1].y, texture_positions[i + 1].x, texture_positions[i + 1].y, packed_color, texindex, v[1]);
+			to_packed_vertex(positions[i + 2].x, positions[i + 2].y, texture_positions[i + 2].x, texture_positions[i + 2].y, packed_color, texindex, last);
+			v[2] = last;
+			v[3] = last;
+		}
+		position += num_vertices / 3 * 4;
+		return;
+	}
 
 	for (; num_vertices > 0; num_vertices--)
 	{
@@ -109,7 +193,27 @@ void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions,
 
 void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf *colors)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	bool packable = packed_supported && (num_vertices % 3) == 0;
+	for (int i = 0; packable && i < num_vertices; i++)
+		packable = is_packable(texture_positions[i]) && is_packable(colors[i]);
+
+	int texindex = set_batcher_active(canvas, packable, texture);
+
+	if (packed_batch)
+	{
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		for (int i = 0; i < num_vertices; i += 3, v += 4)
+		{
+			PackedSpriteVertex last;
+			to_packed_vertex(positions[i].x, positions[i].y, texture_positions[i].x, texture_positions[i].y, to_packed_color(colors[i]), texindex, v[0]);
+			to_packed_vertex(positions[i + 1].x, positions[i + 1].y, texture_positions[i + 1].x, texture_positions[i + 1].y, to_packed_color(colors[i + 1]), texindex, v[1]);
+			to_packed_vertex(positions[i + 2].x, positions[i + 2].y, texture_positions[i + 2].x, texture_positions[i + 2].y, to_packed_color(colors[i + 2]), texindex, last);
+			v[2] = last;
+			v[3] = last;
+		}
+		position += num_vertices / 3 * 4;
+		return;
+	}
 
 	for (; num_vertices > 0; num_vertices--)
 	{
@@ -130,9 +234,65 @@ inline void RenderBatchTriangle::to_sprite_vertex(const Pointf &texture_position
 	v.texindex = texindex;
 }
 
+inline void RenderBatchTriangle::to_packed_vertex(float x, float y, float tex_x, float tex_y, const Vec4ub &color, int texindex, PackedSpriteVertex &v) const
+{
+	v.position = Vec2f(
+		modelview_matrix.matrix[0*4+0]*x + modelview_matrix.matrix[1*4+0]*y + modelview_matrix.matrix[3*4+0],
+		modelview_matrix.matrix[0*4+1]*x + modelview_matrix.matrix[1*4+1]*y + modelview_matrix.matrix[3*4+1]);
+	v.color = color;
+	v.texcoord = Vec2us((unsigned short)(tex_x * 65535.0f + 0.5f), (unsigned short)(tex_y * 65535.0f + 0.5f));
+	v.texindex = (unsigned char)texindex;
+}
+
+inline bool RenderBatchTriangle::is_packable(const Vec4f &color)
+{
+	return color.x >= 0.0f && color.x <= 1.0f && color.y >= 0.0f && color.y <= 1.0f && color.z >= 0.0f && color.z <= 1.0f && color.w >= 0.0f && color.w <= 1.0f;
+}
+
+inline bool RenderBatchTriangle::is_packable(const Vec2f &texcoord)
+{
+	return texcoord.x >= 0.0f && texcoord.x <= 1.0f && texcoord.y >= 0.0f && texcoord.y <= 1.0f;
+}
+
+inline bool RenderBatchTriangle::is_packable(const Rectf &src, const Texture2D &texture)
+{
+	float width = (float)texture.get_width();
+	float height = (float)texture.get_height();
+	return src.left >= 0.0f && src.left <= width && src.right >= 0.0f && src.right <= width &&
+		src.top >= 0.0f && src.top <= height && src.bottom >= 0.0f && src.bottom <= height;
+}
+
+inline Vec4ub RenderBatchTriangle::to_packed_color(const Vec4f &color)
+{
+	return Vec4ub(
+		(unsigned char)(color.x * 255.0f + 0.5f),
+		(unsigned char)(color.y * 255.0f + 0.5f),
+		(unsigned char)(color.z * 255.0f + 0.5f),
+		(unsigned char)(color.w * 255.0f + 0.5f));
+}
+
 void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	bool packable = packed_supported && is_packable(color) && is_packable(src, texture);
+
+	int texindex = set_batcher_active(canvas, packable, texture);
+
+	float src_left = (src.left)/tex_sizes[texindex].width;
+	float src_top = (src.top) / tex_sizes[texindex].height;
+	float src_right = (src.right)/tex_sizes[texindex].width;
+	float src_bottom = (src.bottom) / tex_sizes[texindex].height;
+
+	if (packed_batch)
+	{
+		Vec4ub packed_color = to_packed_color(color);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		to_packed_vertex(dest.left, dest.top, src_left, src_top, packed_color, texindex, v[0]);
+		to_packed_vertex(dest.right, dest.top, src_right, src_top, packed_color, texindex, v[1]);
+		to_packed_vertex(dest.left, dest.bottom, src_left, src_bottom, packed_color, texindex, v[2]);
+		to_packed_vertex(dest.right, dest.bottom, src_right, src_bottom, packed_color, texindex, v[3]);
+		position += 4;
+		return;
+	}
 
 	vertices[position+0].position = to_position(dest.left, dest.top);
 	vertices[position+1].position = to_position(dest.right, dest.top);
@@ -140,10 +300,6 @@ void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Rec
 	vertices[position+3].position = to_position(dest.right, dest.top);
 	vertices[position+4].position = to_position(dest.right, dest.bottom);
 	vertices[position+5].position = to_position(dest.left, dest.bottom);
-	float src_left = (src.left)/tex_sizes[texindex].width;
-	float src_top = (src.top) / tex_sizes[texindex].height;
-	float src_right = (src.right)/tex_sizes[texindex].width;
-	float src_bottom = (src.bottom) / tex_sizes[texindex].height;
 	vertices[position+0].texcoord = Vec2f(src_left, src_top);
 	vertices[position+1].texcoord = Vec2f(src_right, src_top);
 	vertices[position+2].texcoord = Vec2f(src_left, src_bottom);
@@ -160,7 +316,26 @@ void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Rec
 
 void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2D &texture)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	bool packable = packed_supported && is_packable(color) && is_packable(src, texture);
+
+	int texindex = set_batcher_active(canvas, packable, texture);
+
+	float src_left = (src.left)/tex_sizes[texindex].width;
+	float src_top = (src.top) / tex_sizes[texindex].height;
+	float src_right = (src.right)/tex_sizes[texindex].width;
+	float src_bottom = (src.bottom) / tex_sizes[texindex].height;
+
+	if (packed_batch)
+	{
+		Vec4ub packed_color = to_packed_color(color);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		to_packed_vertex(dest.p.x, dest.p.y, src_left, src_top, packed_color, texindex, v[0]);
+		to_packed_vertex(dest.q.x, dest.q.y, src_right, src_top, packed_color, texindex, v[1]);
+		to_packed_vertex(dest.s.x, dest.s.y, src_left, src_bottom, packed_color, texindex, v[2]);
+		to_packed_vertex(dest.r.x, dest.r.y, src_right, src_bottom, packed_color, texindex, v[3]);
+		position += 4;
+		return;
+	}
 
 	vertices[position+0].position = to_position(dest.p.x, dest.p.y);
 	vertices[position+1].position = to_position(dest.q.x, dest.q.y);
@@ -168,10 +343,6 @@ void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Qua
 	vertices[position+3].position = to_position(dest.q.x, dest.q.y);
 	vertices[position+4].position = to_position(dest.r.x, dest.r.y);
 	vertices[position+5].position = to_position(dest.s.x, dest.s.y);
-	float src_left = (src.left)/tex_sizes[texindex].width;
-	float src_top = (src.top) / tex_sizes[texindex].height;
-	float src_right = (src.right)/tex_sizes[texindex].width;
-	float src_bottom = (src.bottom) / tex_sizes[texindex].height;
 	vertices[position+0].texcoord = Vec2f(src_left, src_top);
 	vertices[position+1].texcoord = Vec2f(src_right, src_top);
 	vertices[position+2].texcoord = Vec2f(src_left, src_bottom);
@@ -188,7 +359,26 @@ void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Qua
 
 void RenderBatchTriangle::draw_glyph_subpixel(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture)
 {
-	int texindex = set_batcher_active(canvas, texture, true, color);
+	bool packable = packed_supported && is_packable(src, texture);
+
+	int texindex = set_batcher_active(canvas, packable, texture, true, color);
+
+	float src_left = (src.left)/tex_sizes[texindex].width;
+	float src_top = (src.top) / tex_sizes[texindex].height;
+	float src_right = (src.right)/tex_sizes[texindex].width;
+	float src_bottom = (src.bottom) / tex_sizes[texindex].height;
+
+	if (packed_batch)
+	{
+		Vec4ub white(255, 255, 255, 255);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		to_packed_vertex(dest.left, dest.top, src_left, src_top, white, texindex, v[0]);
+		to_packed_vertex(dest.right, dest.top, src_right, src_top, white, texindex, v[1]);
+		to_packed_vertex(dest.left, dest.bottom, src_left, src_bottom, white, texindex, v[2]);
+		to_packed_vertex(dest.right, dest.bottom, src_right, src_bottom, white, texindex, v[3]);
+		position += 4;
+		return;
+	}
 
 	vertices[position+0].position = to_position(dest.left, dest.top);
 	vertices[position+1].position = to_position(dest.right, dest.top);
@@ -196,10 +386,6 @@ void RenderBatchTriangle::draw_glyph_subpixel(Canvas &canvas, const Rectf &src,
 	vertices[position+3].position = to_position(dest.right, dest.top);
 	vertices[position+4].position = to_position(dest.right, dest.bottom);
 	vertices[position+5].position = to_position(dest.left, dest.bottom);
-	float src_left = (src.left)/tex_sizes[texindex].width;
-	float src_top = (src.top) / tex_sizes[texindex].height;
-	float src_right = (src.right)/tex_sizes[texindex].width;
-	float src_bottom = (src.bottom) / tex_sizes[texindex].height;
 	vertices[position+0].texcoord = Vec2f(src_left, src_top);
 	vertices[position+1].texcoord = Vec2f(src_right, src_top);
 	vertices[position+2].texcoord = Vec2f(src_left, src_bottom);
@@ -216,7 +402,21 @@ void RenderBatchTriangle::draw_glyph_subpixel(Canvas &canvas, const Rectf &src,
 
 void RenderBatchTriangle::fill(Canvas &canvas, float x1, float y1, float x2, float y2, const Colorf &color)
 {
-	int texindex = set_batcher_active(canvas);
+	bool packable = packed_supported && is_packable(color);
+
+	int texindex = set_batcher_active(canvas, packable);
+
+	if (packed_batch)
+	{
+		Vec4ub packed_color = to_packed_color(color);
+		PackedSpriteVertex *v = get_packed_vertices() + position;
+		to_packed_vertex(x1, y1, 0.0f, 0.0f, packed_color, texindex, v[0]);
+		to_packed_vertex(x2, y1, 0.0f, 0.0f, packed_color, texindex, v[1]);
+		to_packed_vertex(x1, y2, 0.0f, 0.0f, packed_color, texindex, v[2]);
+		to_packed_vertex(x2, y2, 0.0f, 0.0f, packed_color, texindex, v[3]);
+		position += 4;
+		return;
+	}
 
 	vertices[position+0].position = to_position(x1, y1);
 	vertices[position+1].position = to_position(x2, y1);
@@ -242,9 +442,26 @@ inline Vec4f RenderBatchTriangle::to_position(float x, float y) const
 		modelview_projection_matrix.matrix[0*4+3]*x + modelview_projection_matrix.matrix[1*4+3]*y + modelview_projection_matrix.matrix[3*4+3]);
 }
 
+void RenderBatchTriangle::set_vertex_format(Canvas &canvas, bool packable)
+{
+	// Activating the batcher first makes sure matrix_changed has seen the current transform
+	canvas.set_batcher(this);
 
-int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color)
+	bool packed = packable && packed_transform;
+	if (position > 0 && (packed != packed_batch || (packed && packed_batch_projection != projection_matrix)))
+		canvas.flush();
+
+	if (position == 0)
+	{
+		packed_batch = packed;
+		packed_batch_projection = projection_matrix;
+	}
+}
+
+int RenderBatchTriangle::set_batcher_active(Canvas &canvas, bool packable, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color)
 {
+	set_vertex_format(canvas, packable);
+
 	if (use_glyph_program != glyph_program || constant_color != new_constant_color)
 	{
 		canvas.flush();
@@ -268,7 +485,7 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &tex
 		tex_sizes[texindex] = Sizef((float)current_textures[texindex].get_width(), (float)current_textures[texindex].get_height());
 	}
 
-	if (position == 0 || position+6 > max_vertices || texindex == -1)
+	if (position == 0 || position+6 > get_max_vertices() || texindex == -1)
 	{
 		canvas.flush();
 		texindex = 0;
@@ -280,32 +497,40 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &tex
 	return texindex;
 }
 
-int RenderBatchTriangle::set_batcher_active(Canvas &canvas)
+int RenderBatchTriangle::set_batcher_active(Canvas &canvas, bool packable)
 {
+	set_vertex_format(canvas, packable);
+
 	if (use_glyph_program != false)
 	{
 		canvas.flush();
 		use_glyph_program = false;
 	}
 
-	if (position == 0 || position+6 > max_vertices)
+	if (position == 0 || position+6 > get_max_vertices())
 		canvas.flush();
 	canvas.set_batcher(this);
 	return RenderBatchTriangle::max_textures;
 }
 
-int RenderBatchTriangle::set_batcher_active(Canvas &canvas, int num_vertices)
+int RenderBatchTriangle::set_batcher_active(Canvas &canvas, bool packable, int num_vertices)
 {
+	set_vertex_format(canvas, packable);
+
 	if (use_glyph_program != false)
 	{
 		canvas.flush();
 		use_glyph_program = false;
 	}
 
-	if (position+num_vertices > max_vertices)
+	// Packed batches store each triangle as a degenerate quad
+	if (packed_batch)
+		num_vertices = num_vertices / 3 * 4;
+
+	if (position+num_vertices > get_max_vertices())
 		canvas.flush();
 
-	if (num_vertices > max_vertices)
+	if (num_vertices > get_max_vertices())
 		throw Exception("Too many vertices for RenderBatchTriangle");
 
 	canvas.set_batcher(this);
@@ -314,20 +539,46 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas, int num_vertices)
 
 void RenderBatchTriangle::flush(GraphicContext &gc)
 {
-	if (position > 0)
+	if (position > 0 && packed_batch)
+	{
+		flush_packed(gc);
+	}
+	else if (position > 0)
 	{
 		gc.set_program_object(program_sprite);
 
+		bool use_vertex_ring = batch_buffer->has_vertex_ring();
+
 		int gpu_index;
-		VertexArrayVector<SpriteVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
+		VertexArrayVector<SpriteVertex> gpu_vertices;
+		if (use_vertex_ring)
+		{
+			gpu_index = vertex_ring_segment;
+			gpu_vertices = VertexArrayVector<SpriteVertex>(batch_buffer->get_vertex_ring());
+		}
+		else
+		{
+			gpu_vertices = VertexArrayVector<SpriteVertex>(batch_buffer->get_vertex_buffer(gc, gpu_index));
+		}
 
 		if (prim_array[gpu_index].is_null())
 		{
 			prim_array[gpu_index] = PrimitivesArray(gc);
-			prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
-			prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color));
-			prim_array[gpu_index].set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
-			prim_array[gpu_index].set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
+			if (use_vertex_ring)
+			{
+				size_t segment_offset = gpu_index * RenderBatchBuffer::vertex_buffer_size;
+				prim_array[gpu_index].set_attributes(0, gpu_vertices, 4, type_float, segment_offset + (size_t)cl_offsetof(SpriteVertex, position), sizeof(SpriteVertex));
+				prim_array[gpu_index].set_attributes(1, gpu_vertices, 4, type_float, segment_offset + (size_t)cl_offsetof(SpriteVertex, color), sizeof(SpriteVertex));
+				prim_array[gpu_index].set_attributes(2, gpu_vertices, 2, type_float, segment_offset + (size_t)cl_offsetof(SpriteVertex, texcoord), sizeof(SpriteVertex));
+				prim_array[gpu_index].set_attributes(3, gpu_vertices, 1, type_int, segment_offset + (size_t)cl_offsetof(SpriteVertex, texindex), sizeof(SpriteVertex));
+			}
+			else
+			{
+				prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
+				prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color));
+				prim_array[gpu_index].set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
+				prim_array[gpu_index].set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
+			}
 
 			if (glyph_blend.is_null())
 			{
@@ -337,7 +588,8 @@ void RenderBatchTriangle::flush(GraphicContext &gc)
 			}
 		}
 
-		gpu_vertices.upload_data(gc, 0, vertices, position);
+		if (!use_vertex_ring)
+			gpu_vertices.upload_data(gc, 0, vertices, position);
 
 		for (int i = 0; i < num_current_textures; i++)
 			gc.set_texture(i, current_textures[i]);
@@ -353,22 +605,114 @@ void RenderBatchTriangle::flush(GraphicContext &gc)
 			gc.draw_primitives(type_triangles, position, prim_array[gpu_index]);
 		}
 
-		for (int i = 0; i < num_current_textures; i++)
-			gc.reset_texture(i);
+		finish_batch(gc);
+	}
+}
 
-		gc.reset_program_object();
+void RenderBatchTriangle::flush_packed(GraphicContext &gc)
+{
+	gc.set_program_object(program_sprite_packed);
+	gc.get_program_object().set_uniform_matrix("Projection", packed_batch_projection);
 
-		position = 0;
-		for (int i = 0; i < num_current_textures; i++)
-			current_textures[i] = Texture2D();
-		num_current_textures = 0;
+	bool use_vertex_ring = batch_buffer->has_vertex_ring();
 
+	int gpu_index;
+	VertexArrayBuffer gpu_vertices;
+	size_t segment_offset = 0;
+	if (use_vertex_ring)
+	{
+		gpu_index = vertex_ring_segment;
+		gpu_vertices = batch_buffer->get_vertex_ring();
+		segment_offset = gpu_index * RenderBatchBuffer::vertex_buffer_size;
 	}
+	else
+	{
+		gpu_vertices = batch_buffer->get_vertex_buffer(gc, gpu_index);
+	}
+
+	if (packed_prim_array[gpu_index].is_null())
+	{
+		int stride = sizeof(PackedSpriteVertex);
+		packed_prim_array[gpu_index] = PrimitivesArray(gc);
+		packed_prim_array[gpu_index].set_attributes(0, gpu_vertices, 2, type_float, segment_offset + (size_t)cl_offsetof(PackedSpriteVertex, position), stride);
+		packed_prim_array[gpu_index].set_attributes(1, gpu_vertices, 4, type_unsigned_byte, segment_offset + (size_t)cl_offsetof(PackedSpriteVertex, color), stride, true);
+		packed_prim_array[gpu_index].set_attributes(2, gpu_vertices, 2, type_unsigned_short, segment_offset + (size_t)cl_offsetof(PackedSpriteVertex, texcoord), stride, true);
+		packed_prim_array[gpu_index].set_attributes(3, gpu_vertices, 1, type_unsigned_byte, segment_offset + (size_t)cl_offsetof(PackedSpriteVertex, texindex), stride);
+
+		if (glyph_blend.is_null())
+		{
+			BlendStateDescription blend_desc;
+			blend_desc.set_blend_function(blend_constant_color, blend_one_minus_src_color, blend_zero, blend_one);
+			glyph_blend = BlendState(gc, blend_desc);
+		}
+	}
+
+	if (quad_indices.is_null())
+	{
+		std::vector<unsigned short> indices(max_packed_vertices / 4 * 6);
+		for (int quad = 0; quad < max_packed_vertices / 4; quad++)
+		{
+			indices[quad * 6 + 0] = quad * 4 + 0;
+			indices[quad * 6 + 1] = quad * 4 + 1;
+			indices[quad * 6 + 2] = quad * 4 + 2;
+			indices[quad * 6 + 3] = quad * 4 + 1;
+			indices[quad * 6 + 4] = quad * 4 + 3;
+			indices[quad * 6 + 5] = quad * 4 + 2;
+		}
+		quad_indices = ElementArrayVector<unsigned short>(gc, indices);
+	}
+
+	if (!use_vertex_ring)
+		gpu_vertices.upload_data(gc, 0, vertices, position * sizeof(PackedSpriteVertex));
+
+	for (int i = 0; i < num_current_textures; i++)
+		gc.set_texture(i, current_textures[i]);
+
+	gc.set_primitives_array(packed_prim_array[gpu_index]);
+	if (use_glyph_program)
+	{
+		gc.set_blend_state(glyph_blend, constant_color);
+		gc.draw_primitives_elements(type_triangles, position / 4 * 6, quad_indices);
+		gc.reset_blend_state();
+	}
+	else
+	{
+		gc.draw_primitives_elements(type_triangles, position / 4 * 6, quad_indices);
+	}
+	gc.reset_primitives_array();
+
+	finish_batch(gc);
+}
+
+void RenderBatchTriangle::finish_batch(GraphicContext &gc)
+{
+	for (int i = 0; i < num_current_textures; i++)
+		gc.reset_texture(i);
+
+	gc.reset_program_object();
+
+	if (batch_buffer->has_vertex_ring())
+	{
+		batch_buffer->release_vertex_ring_segment(gc, vertex_ring_segment);
+		vertices = (SpriteVertex *) batch_buffer->acquire_vertex_ring_segment(gc, vertex_ring_segment);
+	}
+
+	position = 0;
+	for (int i = 0; i < num_current_textures; i++)
+		current_textures[i] = Texture2D();
+	num_current_textures = 0;
 }
 
 void RenderBatchTriangle::matrix_changed(const Mat4f &new_modelview, const Mat4f &new_projection, TextureImageYAxis image_yaxis, float pixel_ratio)
 {
 	modelview_projection_matrix = new_projection * new_modelview;
+	modelview_matrix = new_modelview;
+	projection_matrix = new_projection;
+
+	// Packed positions are 2D, so the modelview may not move vertices along z or apply any perspective
+	const float *m = new_modelview.matrix;
+	packed_transform = m[0*4+2] == 0.0f && m[1*4+2] == 0.0f && m[3*4+2] == 0.0f &&
+		m[0*4+3] == 0.0f && m[1*4+3] == 0.0f && m[3*4+3] == 1.0f;
 }
 
 }
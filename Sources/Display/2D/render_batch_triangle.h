@@ -34,6 +34,7 @@
 #include "API/Display/Render/blend_state.h"
 #include "API/Display/Render/render_batcher.h"
 #include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/element_array_vector.h"
 #include "render_batch_buffer.h"
 
 namespace clan
@@ -59,6 +60,7 @@ public:
 
 public:
 	static int max_textures;	// For use by the GL1 target, so it can reduce the number of textures
+	static bool use_packed_vertices;	// Set to false to always use the full float vertex layout
 
 private:
 	struct SpriteVertex
@@ -69,23 +71,56 @@ private:
 		int texindex;
 	};
 
-	int set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = Colorf::black);
-	int set_batcher_active(Canvas &canvas);
-	int set_batcher_active(Canvas &canvas, int num_vertices);
+	// Compact layout used on the GL3 and GL1 targets. Positions only have the modelview applied. The projection is set as the Projection
+	// uniform, which the GL3 vertex shader applies and the GL1 target loads into the fixed-function GL_PROJECTION matrix for the draw.
+	// Colors are RGBA8, texcoords are normalized 16 bit and quads are drawn indexed using 4 vertices each.
+	struct PackedSpriteVertex
+	{
+		Vec2f position;
+		Vec4ub color;
+		Vec2us texcoord;
+		unsigned char texindex;
+		unsigned char padding[3];
+	};
+
+	int set_batcher_active(Canvas &canvas, bool packable, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = Colorf::black);
+	int set_batcher_active(Canvas &canvas, bool packable);
+	int set_batcher_active(Canvas &canvas, bool packable, int num_vertices);
+	void set_vertex_format(Canvas &canvas, bool packable);
+	int get_max_vertices() const { return packed_batch ? (int)max_packed_vertices : (int)max_vertices; }
 	void flush(GraphicContext &gc) override;
+	void flush_packed(GraphicContext &gc);
+	void finish_batch(GraphicContext &gc);
 	void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
 
 	inline void to_sprite_vertex(const Pointf &texture_position, const Pointf &dest_position, RenderBatchTriangle::SpriteVertex &v, int texindex, const Colorf &color) const;
 	inline Vec4f to_position(float x, float y) const;
+	inline void to_packed_vertex(float x, float y, float tex_x, float tex_y, const Vec4ub &color, int texindex, PackedSpriteVertex &v) const;
+	inline PackedSpriteVertex *get_packed_vertices() const { return reinterpret_cast<PackedSpriteVertex *>(vertices); }
+	static inline bool is_packable(const Vec4f &color);
+	static inline bool is_packable(const Vec2f &texcoord);
+	static inline bool is_packable(const Rectf &src, const Texture2D &texture);
+	static inline Vec4ub to_packed_color(const Vec4f &color);
 
 	Mat4f modelview_projection_matrix;
+	Mat4f modelview_matrix;
+	Mat4f projection_matrix;
+	bool packed_transform = false;	// True if the modelview matrix is a plain 2D transform that can be applied to packed positions
 	int position = 0;
 	enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(SpriteVertex) };
+	enum { max_packed_vertices = (RenderBatchBuffer::vertex_buffer_size / sizeof(PackedSpriteVertex)) & ~3 };
 	SpriteVertex *vertices;
+	int vertex_ring_segment = 0;
+
+	bool packed_supported = false;
+	bool packed_batch = false;
+	Mat4f packed_batch_projection;
 
 	RenderBatchBuffer *batch_buffer;
 
 	PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
+	PrimitivesArray packed_prim_array[RenderBatchBuffer::num_vertex_buffers];
+	ElementArrayVector<unsigned short> quad_indices;
 
 	static const int max_number_of_texture_coords = 32;
 
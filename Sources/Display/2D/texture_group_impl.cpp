@@ -123,7 +123,10 @@ Subtexture TextureGroup_Impl::add_new_node(GraphicContext &context, const Size &
 			{
 				node = root_nodes[index]->node.insert(texture_size, next_id);
 				if(node)	// We found space in a previous texture
+				{
+					active_root = root_nodes[index];
 					break;
+				}
 			}
 		}
 
@@ -31,11 +31,13 @@
 namespace clan
 {
 
+class FontTextRun_Impl;
+
 class Font_Draw
 {
 public:
 	virtual GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) = 0;
-	virtual void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) = 0;
+	virtual void draw_text(Canvas &canvas, const Pointf &position, const FontTextRun_Impl &run, const Colorf &color) = 0;
 
 };
 
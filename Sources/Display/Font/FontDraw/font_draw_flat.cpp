@@ -45,6 +45,7 @@
 #include "font_draw_flat.h"
 #include "../glyph_cache.h"
 #include "../path_cache.h"
+#include "../font_text_run_impl.h"
 
 namespace clan
 {
@@ -61,39 +62,21 @@ namespace clan
 		return glyph_cache->get_metrics(font_engine, canvas, glyph);
 	}
 
-	void Font_DrawFlat::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
+	void Font_DrawFlat::draw_text(Canvas &canvas, const Pointf &position, const FontTextRun_Impl &run, const Colorf &color)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
 		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
 
-		while (!reader.is_end())
+		for (const auto &run_glyph : run.glyphs)
 		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				offset_x = 0;
-				offset_y += line_spacing;
-				continue;
-			}
-
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
-			if (gptr)
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, run_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
 			{
-				if (!gptr->texture.is_null())
-				{
-					float xp = offset_x + position.x + gptr->offset.x;
-					float yp = offset_y + position.y + gptr->offset.y;
-					Pointf pos = canvas.grid_fit(Pointf(xp, yp));
+				float xp = run_glyph.offset.x + position.x + gptr->offset.x;
+				float yp = run_glyph.offset.y + position.y + gptr->offset.y;
+				Pointf pos = canvas.grid_fit(Pointf(xp, yp));
 
-					Rectf dest_size(pos, gptr->size);
-					batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
-				}
-				offset_x += gptr->metrics.advance.width;
-				offset_y += gptr->metrics.advance.height;
+				Rectf dest_size(pos, gptr->size);
+				batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
 			}
 		}
 	}
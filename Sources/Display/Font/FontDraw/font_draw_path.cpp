@@ -45,6 +45,7 @@
 #include "font_draw_path.h"
 #include "../glyph_cache.h"
 #include "../path_cache.h"
+#include "../font_text_run_impl.h"
 
 namespace clan
 {
@@ -62,37 +63,18 @@ namespace clan
 		return path_cache->get_metrics(font_engine, canvas, glyph);
 	}
 
-	void Font_DrawPath::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
+	void Font_DrawPath::draw_text(Canvas &canvas, const Pointf &position, const FontTextRun_Impl &run, const Colorf &color)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
-
 		const Mat4f original_transform = canvas.get_transform();
 		clan::Mat4f scale_matrix = clan::Mat4f::scale(scaled_height, scaled_height, scaled_height);
 		Brush brush(color);
-		Sizef advance;
 
-		while (!reader.is_end())
+		for (const auto &run_glyph : run.glyphs)
 		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				offset_x = 0;
-				offset_y += line_spacing * scaled_height;
-				continue;
-			}
-
-			canvas.set_transform(original_transform * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
-			Font_PathGlyph *gptr = path_cache->get_glyph(canvas, font_engine, glyph);
+			canvas.set_transform(original_transform * Mat4f::translate(position.x + run_glyph.offset.x * scaled_height, position.y + run_glyph.offset.y * scaled_height, 0) * scale_matrix);
+			Font_PathGlyph *gptr = path_cache->get_glyph(canvas, font_engine, run_glyph.glyph);
 			if (gptr)
-			{
 				gptr->path.fill(canvas, brush);
-				offset_x += gptr->metrics.advance.width * scaled_height;
-				offset_y += gptr->metrics.advance.height * scaled_height;
-			}
 		}
 		canvas.set_transform(original_transform);
 	}
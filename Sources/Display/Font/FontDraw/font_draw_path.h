@@ -41,7 +41,7 @@ namespace clan
 		void init(PathCache *cache, FontEngine *engine, float new_scaled_height);
 
 		GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) override;
-		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) override;
+		void draw_text(Canvas &canvas, const Pointf &position, const FontTextRun_Impl &run, const Colorf &color) override;
 
 	private:
 		PathCache *path_cache = nullptr;
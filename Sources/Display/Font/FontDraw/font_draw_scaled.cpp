@@ -45,6 +45,7 @@
 #include "font_draw_scaled.h"
 #include "../glyph_cache.h"
 #include "../path_cache.h"
+#include "../font_text_run_impl.h"
 
 namespace clan
 {
@@ -61,43 +62,24 @@ namespace clan
 		return glyph_cache->get_metrics(font_engine, canvas, glyph);
 	}
 
-	void Font_DrawScaled::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
+	void Font_DrawScaled::draw_text(Canvas &canvas, const Pointf &position, const FontTextRun_Impl &run, const Colorf &color)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
 		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
 
 		const Mat4f original_transform = canvas.get_transform();
 		clan::Mat4f scale_matrix = clan::Mat4f::scale(scaled_height, scaled_height, scaled_height);
-		Sizef advance;
 
-		while (!reader.is_end())
+		for (const auto &run_glyph : run.glyphs)
 		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				offset_x = 0;
-				offset_y += line_spacing * scaled_height;
-				continue;
-			}
-
-			canvas.set_transform(original_transform * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
-			if (gptr)
+			canvas.set_transform(original_transform * Mat4f::translate(position.x + run_glyph.offset.x * scaled_height, position.y + run_glyph.offset.y * scaled_height, 0) * scale_matrix);
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, run_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
 			{
-				if (!gptr->texture.is_null())
-				{
-					float xp = gptr->offset.x;
-					float yp = gptr->offset.y;
+				float xp = gptr->offset.x;
+				float yp = gptr->offset.y;
 
-					Rectf dest_size(xp, yp, gptr->size);
-					batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
-				}
-				offset_x += gptr->metrics.advance.width * scaled_height;
-				offset_y += gptr->metrics.advance.height * scaled_height;
+				Rectf dest_size(xp, yp, gptr->size);
+				batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
 			}
 		}
 		canvas.set_transform(original_transform);
@@ -39,7 +39,7 @@ namespace clan
 		void init(GlyphCache *cache, FontEngine *engine);
 
 		GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) override;
-		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) override;
+		void draw_text(Canvas &canvas, const Pointf &position, const FontTextRun_Impl &run, const Colorf &color) override;
 
 	private:
 		GlyphCache *glyph_cache = nullptr;
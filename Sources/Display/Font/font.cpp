@@ -168,6 +168,19 @@ GlyphMetrics Font::measure_text(Canvas &canvas, const std::string &string)
 	return GlyphMetrics();
 }
 
+GlyphMetrics Font::measure_text(Canvas &canvas, const FontTextRun &run)
+{
+	if (impl && run.impl)
+		return impl->measure_text(canvas, *run.impl);
+	return GlyphMetrics();
+}
+
+FontTextRun Font::prepare_text(Canvas &canvas, const std::string &text)
+{
+	throw_if_null();
+	return FontTextRun(impl->get_text_run(canvas, text));
+}
+
 size_t Font::clip_from_left(Canvas &canvas, const std::string &text, float width)
 {
 	float x = 0.0f;
@@ -219,6 +232,14 @@ void Font::draw_text(Canvas &canvas, const Pointf &position, const std::string &
 	}
 }
 
+void Font::draw_text(Canvas &canvas, const Pointf &position, const FontTextRun &run, const Colorf &color)
+{
+	if (impl && run.impl)
+	{
+		impl->draw_text(canvas, position, *run.impl, color);
+	}
+}
+
 std::string Font::get_clipped_text(Canvas &canvas, const Sizef &box_size, const std::string &text, const std::string &ellipsis_text)
 {
 	std::string out_string;
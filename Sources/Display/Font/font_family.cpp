@@ -56,6 +56,24 @@ namespace clan
 		return impl->get_family_name();
 	}
 
+	GlyphCacheStatistics FontFamily::get_glyph_cache_statistics() const
+	{
+		throw_if_null();
+		return impl->get_glyph_cache_statistics();
+	}
+
+	int64_t FontFamily::get_glyph_cache_budget() const
+	{
+		throw_if_null();
+		return impl->get_glyph_cache_budget();
+	}
+
+	void FontFamily::set_glyph_cache_budget(int64_t bytes)
+	{
+		throw_if_null();
+		impl->set_glyph_cache_budget(bytes);
+	}
+
 	void FontFamily::add(const std::string &typeface_name, float height)
 	{
 		throw_if_null();
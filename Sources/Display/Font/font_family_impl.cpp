@@ -80,7 +80,7 @@ namespace clan
 		FontMetrics font_metrics;
 	};
 
-	FontFamily_Impl::FontFamily_Impl(const std::string &family_name) : family_name(family_name), texture_group(Size(256, 256))
+	FontFamily_Impl::FontFamily_Impl(const std::string &family_name) : family_name(family_name), glyph_atlas(std::make_shared<GlyphAtlas>(Size(256, 256)))
 	{
 	}
 
@@ -116,7 +116,7 @@ namespace clan
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Freetype>(desc, font_databuffer, pixel_ratio);
 		font_cache.push_back(Font_Cache(engine));
 #endif
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
+		font_cache.back().glyph_cache->set_atlas(glyph_atlas);
 		font_cache.back().pixel_ratio = pixel_ratio;
 	}
 
@@ -125,12 +125,12 @@ namespace clan
 #if defined(WIN32)
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Win32>(desc, typeface_name, pixel_ratio);
 		font_cache.push_back(Font_Cache(engine));
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
+		font_cache.back().glyph_cache->set_atlas(glyph_atlas);
 		font_cache.back().pixel_ratio = pixel_ratio;
 #elif defined(__APPLE__)
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Cocoa>(desc, typeface_name, pixel_ratio);
 		font_cache.push_back(Font_Cache(engine));
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
+		font_cache.back().glyph_cache->set_atlas(glyph_atlas);
 		font_cache.back().pixel_ratio = pixel_ratio;
 #elif defined(__ANDROID__)
 		throw Exception("automatic typeface to ttf file selection is not supported on android");
@@ -231,6 +231,7 @@ namespace clan
 		Font_Cache sprite_engine(engine);
 		font_cache.push_back(sprite_engine);
 		GlyphCache *glyph_cache = sprite_engine.glyph_cache.get();
+		glyph_cache->set_atlas(glyph_atlas);
 
 		// Setup char to glyph map:
 
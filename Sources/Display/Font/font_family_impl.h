@@ -71,6 +71,10 @@ public:
 
 	const std::string &get_family_name() const { return family_name; }
 
+	GlyphCacheStatistics get_glyph_cache_statistics() const { return glyph_atlas->statistics; }
+	int64_t get_glyph_cache_budget() const { return glyph_atlas->memory_budget; }
+	void set_glyph_cache_budget(int64_t bytes) { glyph_atlas->memory_budget = bytes; }
+
 	void add(const FontDescription &desc, const std::string &typeface_name);
 	void add(const FontDescription &desc, DataBuffer &font_databuffer);
 
@@ -87,7 +91,7 @@ private:
 	void font_face_load(const FontDescription &desc, DataBuffer &font_databuffer, float pixel_ratio);
 
 	std::string family_name;
-	TextureGroup texture_group;		// Shared texture group between glyph cache's
+	std::shared_ptr<GlyphAtlas> glyph_atlas;		// Shared texture atlas between glyph cache's
 	std::vector<Font_Cache> font_cache;
 	std::vector<FontFamily_Definition> font_definitions;
 };
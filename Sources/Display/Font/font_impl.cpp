@@ -46,10 +46,13 @@
 #include "FontEngine/font_engine.h"
 #include "../2D/sprite_impl.h"
 #include "API/Core/Resources/xml_resource_node.h"
+#include <atomic>
 
 namespace clan
 {
 
+static std::atomic<unsigned int> next_font_selection_id(0);
+
 Font_Impl::Font_Impl(FontFamily &new_font_family, const FontDescription &description)
 {
 	new_font_family.throw_if_null();
@@ -74,6 +77,7 @@ void Font_Impl::select_font_family(Canvas &canvas)
 			new_selected.set_height(256.0f);	// A reasonable scalable size
 
 		selected_pixel_ratio = pixel_ratio;
+		invalidate_text_runs();
 
 		Font_Cache font_cache = font_family.impl->get_font(new_selected, pixel_ratio);
 		if (!font_cache.engine)	// Font not found
@@ -250,12 +254,20 @@ void Font_Impl::get_glyph_path(Canvas &canvas, unsigned int glyph_index, Path &o
 }
 
 void Font_Impl::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color)
+{
+	std::shared_ptr<FontTextRun_Impl> run = get_text_run(canvas, text);
+	Pointf pos = canvas.grid_fit(position);
+	font_draw->draw_text(canvas, pos, *run, color);
+}
+
+void Font_Impl::draw_text(Canvas &canvas, const Pointf &position, FontTextRun_Impl &run, const Colorf &color)
 {
 	select_font_family(canvas);
+	if (run.selection_id != selection_id)
+		prepare_text_run(canvas, run);
 
-	float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 	Pointf pos = canvas.grid_fit(position);
-	font_draw->draw_text(canvas, pos, text, color, line_spacing);
+	font_draw->draw_text(canvas, pos, run, color);
 }
 
 GlyphMetrics Font_Impl::get_metrics(Canvas &canvas, unsigned int glyph)
@@ -270,15 +282,57 @@ GlyphMetrics Font_Impl::get_metrics(Canvas &canvas, unsigned int glyph)
 
 
 GlyphMetrics Font_Impl::measure_text(Canvas &canvas, const std::string &string)
+{
+	return get_text_run(canvas, string)->metrics;
+}
+
+GlyphMetrics Font_Impl::measure_text(Canvas &canvas, FontTextRun_Impl &run)
 {
 	select_font_family(canvas);
-	GlyphMetrics total_metrics;
+	if (run.selection_id != selection_id)
+		prepare_text_run(canvas, run);
+	return run.metrics;
+}
+
+std::shared_ptr<FontTextRun_Impl> Font_Impl::get_text_run(Canvas &canvas, const std::string &text)
+{
+	select_font_family(canvas);
+
+	if (text.length() > max_cached_text_length)
+	{
+		auto run = std::make_shared<FontTextRun_Impl>();
+		run->text = text;
+		prepare_text_run(canvas, *run);
+		return run;
+	}
+
+	auto it = text_runs.find(text);
+	if (it != text_runs.end())
+		return it->second;
+
+	// Text that changes every frame would otherwise grow the cache without bounds
+	if (text_runs.size() >= max_cached_text_runs)
+		text_runs.clear();
+
+	auto run = std::make_shared<FontTextRun_Impl>();
+	run->text = text;
+	prepare_text_run(canvas, *run);
+	text_runs[text] = run;
+	return run;
+}
+
+void Font_Impl::prepare_text_run(Canvas &canvas, FontTextRun_Impl &run)
+{
+	run.glyphs.clear();
+	run.glyphs.reserve(run.text.length());
+	run.selection_id = selection_id;
 
 	float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
+	Pointf offset;
 	bool first_char = true;
 	Rectf text_bbox;
 
-	UTF8_Reader reader(string.data(), string.length());
+	UTF8_Reader reader(run.text.data(), run.text.length());
 	while (!reader.is_end())
 	{
 		unsigned int glyph = reader.get_char();
@@ -286,38 +340,40 @@ GlyphMetrics Font_Impl::measure_text(Canvas &canvas, const std::string &string)
 
 		if (glyph == '\n')
 		{
-			total_metrics.advance.width = 0;
-			total_metrics.advance.height += line_spacing;
+			offset.x = 0;
+			offset.y += line_spacing;
 			continue;
 		}
 
 		GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
 
-		metrics.bbox_offset.x += total_metrics.advance.width;
-		metrics.bbox_offset.y += total_metrics.advance.height;
+		FontTextRun_Impl::Glyph run_glyph = { glyph, offset };
+		run.glyphs.push_back(run_glyph);
 
+		Rectf glyph_bbox(metrics.bbox_offset + offset, metrics.bbox_size);
 		if (first_char)
 		{
-			text_bbox = Rectf(metrics.bbox_offset, metrics.bbox_size);
+			text_bbox = glyph_bbox;
 			first_char = false;
 		}
 		else
 		{
-			Rectf glyph_bbox(metrics.bbox_offset, metrics.bbox_size);
 			text_bbox.bounding_rect(glyph_bbox);
 		}
 
-		total_metrics.advance += metrics.advance;
+		offset.x += metrics.advance.width;
+		offset.y += metrics.advance.height;
 	}
 
-	total_metrics.bbox_offset = text_bbox.get_top_left();
-	total_metrics.bbox_size = text_bbox.get_size();
-
-	total_metrics.advance *= scaled_height;
-	total_metrics.bbox_offset *= scaled_height;
-	total_metrics.bbox_size *= scaled_height;
+	run.metrics.advance = Sizef(offset.x, offset.y) * scaled_height;
+	run.metrics.bbox_offset = text_bbox.get_top_left() * scaled_height;
+	run.metrics.bbox_size = text_bbox.get_size() * scaled_height;
+}
 
-	return total_metrics;
+void Font_Impl::invalidate_text_runs()
+{
+	selection_id = ++next_font_selection_id;
+	text_runs.clear();
 }
 
 void Font_Impl::set_height(float value)
@@ -340,7 +396,11 @@ void Font_Impl::set_weight(FontWeight value)
 
 void Font_Impl::set_line_height(float height)
 {
-	selected_line_height = height;
+	if (selected_line_height != height)
+	{
+		selected_line_height = height;
+		invalidate_text_runs();
+	}
 	// (Don't need to reset the font engine)
 }
 
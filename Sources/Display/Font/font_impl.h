@@ -37,9 +37,11 @@
 #include "API/Display/Render/texture_2d.h"
 #include <list>
 #include <map>
+#include <unordered_map>
 #include "glyph_cache.h"
 #include "path_cache.h"
 #include "font_family_impl.h"
+#include "font_text_run_impl.h"
 
 #include "FontDraw/font_draw_subpixel.h"
 #include "FontDraw/font_draw_flat.h"
@@ -67,8 +69,13 @@ public:
 	GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph);
 
 	GlyphMetrics measure_text(Canvas &canvas, const std::string &string);
+	GlyphMetrics measure_text(Canvas &canvas, FontTextRun_Impl &run);
 
 	void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color);
+	void draw_text(Canvas &canvas, const Pointf &position, FontTextRun_Impl &run, const Colorf &color);
+
+	/// \brief Returns the text run for a string, reusing a previously prepared run if the font has not changed since
+	std::shared_ptr<FontTextRun_Impl> get_text_run(Canvas &canvas, const std::string &text);
 
 	void get_glyph_path(Canvas &canvas, unsigned int glyph_index, Path &out_path, GlyphMetrics &out_metrics);
 
@@ -80,6 +87,8 @@ public:
 
 private:
 	void select_font_family(Canvas &canvas);
+	void prepare_text_run(Canvas &canvas, FontTextRun_Impl &run);
+	void invalidate_text_runs();
 
 	FontDescription selected_description;
 	float selected_line_height = 0.0f;
@@ -100,6 +109,14 @@ private:
 	Font_DrawScaled font_draw_scaled;
 	Font_DrawPath font_draw_path;
 
+	/// \brief Identifies the current font selection and line height. Text runs prepared with another id must be prepared again
+	unsigned int selection_id = 0;
+
+	/// \brief Recently used text runs, keyed by their text
+	std::unordered_map<std::string, std::shared_ptr<FontTextRun_Impl>> text_runs;
+
+	static const size_t max_cached_text_runs = 256;
+	static const size_t max_cached_text_length = 256;
 };
 
 }
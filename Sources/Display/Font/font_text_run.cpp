@@ -0,0 +1,77 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Font/font_text_run.h"
+#include "font_text_run_impl.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// FontTextRun Construction:
+
+FontTextRun::FontTextRun()
+{
+}
+
+FontTextRun::FontTextRun(const std::shared_ptr<FontTextRun_Impl> &impl) : impl(impl)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// FontTextRun Attributes:
+
+void FontTextRun::throw_if_null() const
+{
+	if (!impl)
+		throw Exception("FontTextRun is null");
+}
+
+const std::string &FontTextRun::get_text() const
+{
+	throw_if_null();
+	return impl->text;
+}
+
+int FontTextRun::get_glyph_count() const
+{
+	if (impl)
+		return impl->glyphs.size();
+	return 0;
+}
+
+GlyphMetrics FontTextRun::get_metrics() const
+{
+	if (impl)
+		return impl->metrics;
+	return GlyphMetrics();
+}
+
+}
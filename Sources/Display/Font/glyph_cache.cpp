@@ -47,20 +47,104 @@
 #include "../Render/graphic_context_impl.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Display/Font/glyph_metrics.h"
+#include <algorithm>
 
 namespace clan
 {
 
+/////////////////////////////////////////////////////////////////////////////
+// GlyphAtlas Construction:
+
+GlyphAtlas::GlyphAtlas(const Size &texture_sizes) : texture_group(texture_sizes)
+{
+	// Fill the space freed by evicted glyphs before allocating another page
+	texture_group.set_texture_allocation_policy(TextureGroup::search_previous_textures);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlyphAtlas Operations:
+
+GlyphAtlas::PageIterator GlyphAtlas::use_page(const Texture2D &texture)
+{
+	for (auto it = pages.begin(); it != pages.end(); ++it)
+	{
+		if (it->texture == texture)
+		{
+			touch_page(it);
+			return pages.begin();
+		}
+	}
+
+	pages.push_front(Page());
+	Page &page = pages.front();
+	page.texture = texture;
+	page.bytes = (int64_t)texture.get_width() * texture.get_height() * 4;
+	statistics.atlas_bytes += page.bytes;
+	statistics.atlas_pages++;
+	return pages.begin();
+}
+
+void GlyphAtlas::make_room(Canvas &canvas, PageIterator keep_page)
+{
+	if (memory_budget <= 0)
+		return;
+
+	bool flushed = false;
+	while (statistics.atlas_bytes > memory_budget && pages.size() > 1)
+	{
+		PageIterator victim = std::prev(pages.end());
+		if (victim == keep_page)
+			victim = std::prev(victim);
+
+		// Draws still queued in the canvas batcher may reference the glyphs about to be evicted
+		if (!flushed)
+		{
+			canvas.flush();
+			flushed = true;
+		}
+
+		// Removing the last subtexture of a page releases its texture
+		for (auto &page_glyph : victim->glyphs)
+			page_glyph.cache->evict(page_glyph.glyph);
+		statistics.evictions += victim->glyphs.size();
+		remove_page(victim);
+	}
+}
+
+void GlyphAtlas::remove_page(PageIterator page)
+{
+	statistics.atlas_bytes -= page->bytes;
+	statistics.atlas_pages--;
+	pages.erase(page);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GlyphCache Construction:
 
 GlyphCache::GlyphCache()
 {
-	glyph_list.reserve(256);
+	glyphs.reserve(256);
 }
 
 GlyphCache::~GlyphCache()
 {
+	if (!atlas)
+		return;
+
+	for (auto &it : glyphs)
+	{
+		GlyphEntry &entry = it.second;
+		if (entry.in_atlas)
+		{
+			atlas->texture_group.remove(entry.sub_texture);
+
+			std::vector<GlyphAtlas::PageGlyph> &page_glyphs = entry.page->glyphs;
+			page_glyphs.erase(std::remove_if(page_glyphs.begin(), page_glyphs.end(), [&](const GlyphAtlas::PageGlyph &page_glyph) { return page_glyph.cache == this && page_glyph.glyph == it.first; }), page_glyphs.end());
+			if (page_glyphs.empty())
+				atlas->remove_page(entry.page);
+		}
+	}
+	atlas->statistics.glyph_count -= (int)glyphs.size();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -68,25 +152,28 @@ GlyphCache::~GlyphCache()
 
 Font_TextureGlyph *GlyphCache::get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph)
 {
-	auto size = glyph_list.size();
-	for (int cnt=0; cnt<size; cnt++)
+	GlyphAtlas *glyph_atlas = get_atlas();
+
+	auto it = glyphs.find(glyph);
+	if (it != glyphs.end())
 	{
-		if (glyph_list[cnt]->glyph == glyph)
-			return &(*glyph_list[cnt]);
+		glyph_atlas->statistics.hits++;
+		if (it->second.in_atlas)
+			glyph_atlas->touch_page(it->second.page);
+		return it->second.glyph.get();
 	}
 
+	glyph_atlas->statistics.misses++;
+
 	// If glyph does not exist, create one automatically
 	FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
 	if (pb.glyph)	// Ignore invalid glyphs
 		insert_glyph(canvas, pb);
 
 	// Search for the glyph again
-	size = glyph_list.size();
-	for (int cnt=0; cnt<size; cnt++)
-	{
-		if (glyph_list[cnt]->glyph == glyph)
-			return &(*glyph_list[cnt]);
-	}
+	it = glyphs.find(glyph);
+	if (it != glyphs.end())
+		return it->second.glyph.get();
 
 	return nullptr;
 }
@@ -94,9 +181,11 @@ Font_TextureGlyph *GlyphCache::get_glyph(Canvas &canvas, FontEngine *font_engine
 /////////////////////////////////////////////////////////////////////////////
 // GlyphCache Operations:
 
-void GlyphCache::set_texture_group(TextureGroup &new_texture_group)
+void GlyphCache::set_atlas(const std::shared_ptr<GlyphAtlas> &new_atlas)
 {
-	texture_group = new_texture_group;
+	if (!glyphs.empty())
+		throw Exception("Cannot change the glyph atlas after glyphs have been cached");
+	atlas = new_atlas;
 }
 
 GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, Canvas &canvas, unsigned int glyph)
@@ -111,8 +200,15 @@ GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, Canvas &canvas, un
 
 void GlyphCache::insert_glyph(Canvas &canvas, FontPixelBuffer &pb)
 {
-	auto font_glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
-	
+	if (glyphs.find(pb.glyph) != glyphs.end())
+		return;
+
+	GlyphAtlas *glyph_atlas = get_atlas();
+
+	GlyphEntry entry;
+	entry.glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
+
+	Font_TextureGlyph *font_glyph = entry.glyph.get();
 	font_glyph->glyph = pb.glyph;
 	font_glyph->offset = pb.offset;
 	font_glyph->metrics = pb.metrics;
@@ -120,21 +216,37 @@ void GlyphCache::insert_glyph(Canvas &canvas, FontPixelBuffer &pb)
 	if (!pb.empty_buffer)
 	{
 		PixelBuffer buffer_with_border = PixelBufferHelp::add_border(pb.buffer, glyph_border_size, pb.buffer_rect);
+
 		GraphicContext gc = canvas.get_gc();
-		Subtexture sub_texture = texture_group.add(gc, buffer_with_border.get_size());
+		Subtexture sub_texture = glyph_atlas->texture_group.add(gc, buffer_with_border.get_size());
 		font_glyph->texture = sub_texture.get_texture();
 		font_glyph->geometry = Rect(sub_texture.get_geometry().left + glyph_border_size, sub_texture.get_geometry().top + glyph_border_size, pb.buffer_rect.get_size() );
 		font_glyph->size = pb.size;
 		sub_texture.get_texture().set_subimage(gc, sub_texture.get_geometry().left, sub_texture.get_geometry().top, buffer_with_border, buffer_with_border.get_size());
+
+		entry.sub_texture = sub_texture;
+		entry.in_atlas = true;
+		entry.page = glyph_atlas->use_page(sub_texture.get_texture());
+		entry.page->glyphs.push_back({ this, pb.glyph });
 	}
 
-	glyph_list.push_back(std::move(font_glyph));
+	GlyphAtlas::PageIterator page = entry.page;
+	bool in_atlas = entry.in_atlas;
+	insert_entry(pb.glyph, entry);
+
+	if (in_atlas)
+		glyph_atlas->make_room(canvas, page);
 }
 
 void GlyphCache::insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics)
 {
-	auto font_glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
+	if (glyphs.find(glyph) != glyphs.end())
+		return;
+
+	GlyphEntry entry;
+	entry.glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
 
+	Font_TextureGlyph *font_glyph = entry.glyph.get();
 	font_glyph->glyph = glyph;
 	font_glyph->offset = offset;
 	font_glyph->metrics = glyph_metrics;
@@ -146,10 +258,34 @@ void GlyphCache::insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &su
 		font_glyph->geometry = sub_texture.get_geometry();
 	}
 
-	glyph_list.push_back(std::move(font_glyph));
+	insert_entry(glyph, entry);
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // GlyphCache Implementation:
 
+GlyphAtlas *GlyphCache::get_atlas()
+{
+	if (!atlas)
+		atlas = std::make_shared<GlyphAtlas>(Size(256, 256));
+	return atlas.get();
+}
+
+void GlyphCache::insert_entry(unsigned int glyph, GlyphEntry &entry)
+{
+	get_atlas()->statistics.glyph_count++;
+	glyphs[glyph] = std::move(entry);
+}
+
+void GlyphCache::evict(unsigned int glyph)
+{
+	auto it = glyphs.find(glyph);
+	if (it == glyphs.end())
+		return;
+
+	atlas->texture_group.remove(it->second.sub_texture);
+	atlas->statistics.glyph_count--;
+	glyphs.erase(it);
+}
+
 }
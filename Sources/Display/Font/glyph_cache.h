@@ -35,8 +35,10 @@
 #include "API/Display/2D/texture_group.h"
 #include "API/Display/2D/subtexture.h"
 #include "API/Display/Render/texture_2d.h"
+#include "API/Display/Font/font_family.h"
 #include <list>
-#include <map>
+#include <vector>
+#include <unordered_map>
 
 namespace clan
 {
@@ -49,6 +51,7 @@ class Subtexture;
 class FontPixelBuffer;
 class Path;
 class RenderBatchTriangle;
+class GlyphCache;
 
 /// \brief Font texture format (holds a pixel buffer containing a glyph)
 class Font_TextureGlyph
@@ -80,6 +83,55 @@ public:
 
 };
 
+/// \brief Texture atlas shared by the glyph caches of a font family
+///
+/// A texture only gives its memory back once every glyph on it has been removed, so glyphs are evicted a whole
+/// atlas page at a time. The atlas keeps its pages in least recently used order to pick which page to evict.
+class GlyphAtlas
+{
+public:
+	GlyphAtlas(const Size &texture_sizes);
+
+	struct PageGlyph
+	{
+		GlyphCache *cache;
+		unsigned int glyph;
+	};
+
+	struct Page
+	{
+		Texture2D texture;
+		int64_t bytes = 0;
+		std::vector<PageGlyph> glyphs;
+	};
+
+	typedef std::list<Page>::iterator PageIterator;
+
+	/// \brief Returns the page for a texture of the texture group, adding the page if the texture is new
+	PageIterator use_page(const Texture2D &texture);
+
+	/// \brief Marks a page as the most recently used one
+	void touch_page(PageIterator page) { pages.splice(pages.begin(), pages, page); }
+
+	/// \brief Evicts the least recently used pages until the atlas is within its memory budget
+	///
+	/// \param keep_page = Page that must not be evicted, as the glyph being inserted lives there
+	void make_room(Canvas &canvas, PageIterator keep_page);
+
+	/// \brief Removes a page that no longer holds any glyphs
+	void remove_page(PageIterator page);
+
+	TextureGroup texture_group;
+
+	/// \brief Atlas pages, most recently used first
+	std::list<Page> pages;
+
+	/// \brief Maximum number of bytes of texture memory used by atlas pages (0 = unlimited)
+	int64_t memory_budget = 0;
+
+	GlyphCacheStatistics statistics;
+};
+
 class GlyphCache
 {
 /// \name Construction
@@ -94,6 +146,8 @@ public:
 
 public:
 	/// \brief Get a glyph. Returns NULL if the glyph was not found
+	///
+	/// The returned pointer is only valid until the next glyph is inserted, as that may evict other glyphs
 	Font_TextureGlyph *get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph);
 
 /// \}
@@ -105,16 +159,32 @@ public:
 	void insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics);
 	void insert_glyph(Canvas &canvas, FontPixelBuffer &pb);
 
-	void set_texture_group(TextureGroup &new_texture_group);
+	void set_atlas(const std::shared_ptr<GlyphAtlas> &new_atlas);
 
 /// \}
 /// \name Implementation
 /// \{
 private:
+	struct GlyphEntry
+	{
+		std::unique_ptr<Font_TextureGlyph> glyph;
 
-	std::vector<std::unique_ptr<Font_TextureGlyph>> glyph_list;
+		/// \brief Atlas allocation. Only set for glyphs rendered into the atlas, which are the only ones that can be evicted
+		Subtexture sub_texture;
+		bool in_atlas = false;
+		GlyphAtlas::PageIterator page;
+	};
 
-	TextureGroup texture_group;
+	GlyphAtlas *get_atlas();
+	void insert_entry(unsigned int glyph, GlyphEntry &entry);
+	void evict(unsigned int glyph);
+
+	friend class GlyphAtlas;
+
+	std::unordered_map<unsigned int, GlyphEntry> glyphs;
+
+	/// \brief Created on first use unless set_atlas is called first
+	std::shared_ptr<GlyphAtlas> atlas;
 
 	static const int glyph_border_size = 1;
 
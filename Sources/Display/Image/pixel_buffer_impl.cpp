@@ -36,6 +36,7 @@
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 #include "API/Display/TargetProviders/pixel_buffer_provider.h"
 #include "API/Display/Image/pixel_converter.h"
+#include "Display/setup_display.h"
 
 namespace clan
 {
@@ -248,8 +249,10 @@ void PixelBuffer_Impl::convert(PixelBuffer &target, const Rect &dest_rect, const
 	src_data += src_rect.top*src_pitch + src_rect.left*get_bytes_per_pixel();
 	dest_data += dest_rect.top*dest_pitch + dest_rect.left*target.get_bytes_per_pixel();
 
-	converter.convert(dest_data, dest_pitch, target.get_format(), src_data, src_pitch, get_format(), dest_rect.get_width(), dest_rect.get_height());
-
+	if (dest_rect.get_width() * dest_rect.get_height() >= threaded_convert_threshold)
+		converter.convert(dest_data, dest_pitch, target.get_format(), src_data, src_pitch, get_format(), dest_rect.get_width(), dest_rect.get_height(), SetupDisplay::get_work_queue());
+	else
+		converter.convert(dest_data, dest_pitch, target.get_format(), src_data, src_pitch, get_format(), dest_rect.get_width(), dest_rect.get_height());
 }
 
 }
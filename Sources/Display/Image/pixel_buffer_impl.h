@@ -99,6 +99,9 @@ public:
 
 	void convert(PixelBuffer &target, const Rect &dest_rect, const Rect &src_rect, PixelConverter &converter) const;
 
+	/// \brief Images with at least this many pixels are converted on the display work queue
+	static const int threaded_convert_threshold = 512 * 512;
+
 /// \}
 /// \name Implementation
 /// \{
@@ -31,7 +31,9 @@
 #include "API/Display/Image/pixel_converter.h"
 #include "API/Core/System/databuffer.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
 #include "pixel_converter_impl.h"
+#include "pixel_converter_direct.h"
 #include "pixel_reader_cast.h"
 #include "pixel_reader_half_float.h"
 #include "pixel_reader_norm.h"
@@ -132,20 +134,79 @@ void PixelConverter::set_output_is_ycrcb(bool enable)
 	impl->output_is_ycrcb = enable;
 }
 
+void PixelConverter::set_instruction_sets(bool sse2, bool ssse3, bool sse4, bool avx2)
+{
+	impl->sse2 = sse2 && System::detect_cpu_extension(System::sse2);
+	impl->ssse3 = ssse3 && System::detect_cpu_extension(System::ssse3);
+	impl->sse4 = sse4 && System::detect_cpu_extension(System::sse4_1);
+	impl->avx2 = avx2 && System::detect_cpu_extension(System::avx2);
+}
+
 void PixelConverter::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height)
 {
-	bool sse2 = System::detect_cpu_extension(System::sse2);
-	bool sse4 = System::detect_cpu_extension(System::sse4_1);
+	impl->convert_rows(output, output_pitch, output_format, input, input_pitch, input_format, width, height, 0, height);
+}
+
+void PixelConverter::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, WorkQueue &queue)
+{
+	convert(output, output_pitch, output_format, input, input_pitch, input_format, width, height, [&](int num_bands, const std::function<void(int band)> &func)
+	{
+		queue.parallel_for(num_bands, 1, [&](int begin, int end)
+		{
+			for (int band = begin; band < end; band++)
+				func(band);
+		});
+	});
+}
+
+void PixelConverter::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, const std::function<void(int num_bands, const std::function<void(int band)> &func)> &executor)
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	// Bands always cover the same rows for a given image size, and every row is converted independently, so the output does not depend on the thread schedule
+	int rows_per_band = clan::max(PixelConverter_Impl::pixels_per_band / width, 1);
+	int num_bands = (height + rows_per_band - 1) / rows_per_band;
+	if (num_bands == 1)
+	{
+		impl->convert_rows(output, output_pitch, output_format, input, input_pitch, input_format, width, height, 0, height);
+		return;
+	}
+
+	executor(num_bands, [&](int band)
+	{
+		int row_begin = band * rows_per_band;
+		int row_end = clan::min(row_begin + rows_per_band, height);
+		impl->convert_rows(output, output_pitch, output_format, input, input_pitch, input_format, width, height, row_begin, row_end);
+	});
+}
+
+void PixelConverter_Impl::convert_rows(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, int row_begin, int row_end)
+{
+	std::unique_ptr<PixelConverterDirect> direct = create_direct(output_format, input_format);
+	if (direct)
+	{
+		direct->set_instruction_sets(sse2, ssse3, avx2);
+		for (int input_y = row_begin; input_y < row_end; input_y++)
+		{
+			int output_y = flip_vertical ? (height - 1 - input_y) : input_y;
+
+			const char *input_line = static_cast<const char*>(input) + input_pitch * input_y;
+			char *output_line = static_cast<char*>(output) + output_pitch * output_y;
+			direct->convert(output_line, input_line, width);
+		}
+		return;
+	}
 
-	std::unique_ptr<PixelReader> reader = impl->create_reader(input_format, sse2);
-	std::unique_ptr<PixelWriter> writer = impl->create_writer(output_format, sse2, sse4);
-	std::vector<std::shared_ptr<PixelFilter> > filters = impl->create_filters(sse2);
+	std::unique_ptr<PixelReader> reader = create_reader(input_format, sse2);
+	std::unique_ptr<PixelWriter> writer = create_writer(output_format, sse2, sse4);
+	std::vector<std::shared_ptr<PixelFilter> > filters = create_filters(sse2);
 
 	DataBuffer work_buffer(width * sizeof(Vec4f));
 	Vec4f *temp = work_buffer.get_data<Vec4f>();
-	for (int input_y = 0; input_y < height; input_y++)
+	for (int input_y = row_begin; input_y < row_end; input_y++)
 	{
-		int output_y = impl->flip_vertical ? (height - 1 - input_y) : input_y;
+		int output_y = flip_vertical ? (height - 1 - input_y) : input_y;
 
 		const char *input_line = static_cast<const char*>(input) + input_pitch * input_y;
 		char *output_line = static_cast<char*>(output) + output_pitch * output_y;
@@ -156,6 +217,15 @@ void PixelConverter::convert(void *output, int output_pitch, TextureFormat outpu
 	}
 }
 
+std::unique_ptr<PixelConverterDirect> PixelConverter_Impl::create_direct(TextureFormat output_format, TextureFormat input_format)
+{
+	// Integer kernels only handle the byte formats with swizzle and premultiplied alpha
+	if (input_is_ycrcb || output_is_ycrcb || gamma != 1.0f)
+		return std::unique_ptr<PixelConverterDirect>();
+
+	return PixelConverterDirect::create(output_format, input_format, swizzle, premultiply_alpha);
+}
+
 std::unique_ptr<PixelReader> PixelConverter_Impl::create_reader(TextureFormat format, bool sse2)
 {
 	switch (format)
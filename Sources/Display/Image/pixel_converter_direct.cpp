@@ -0,0 +1,397 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "pixel_converter_direct.h"
+#include <cstring>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+
+// SSSE3 and AVX2 kernels are compiled for x86 and selected at runtime
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CL_PIXEL_DIRECT_SIMD
+#include <immintrin.h>
+#ifdef __GNUC__
+#define CL_SSSE3_FUNCTION __attribute__((target("ssse3")))
+#define CL_AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define CL_SSSE3_FUNCTION
+#define CL_AVX2_FUNCTION
+#endif
+#endif
+#endif
+
+namespace clan
+{
+
+namespace
+{
+	/// \brief Byte layout of the 8 bit formats handled by PixelConverterDirect
+	struct DirectFormatLayout
+	{
+		int bytes;
+		int channel_offset[4]; // Offset of red, green, blue and alpha. -1 if not present
+	};
+
+	bool get_direct_format_layout(TextureFormat format, DirectFormatLayout &out_layout)
+	{
+		// sRGB formats are converted as plain bytes, just like the generic path does
+		switch (format)
+		{
+		case tf_rgba8:
+		case tf_srgb8_alpha8:
+			out_layout = { 4, { 0, 1, 2, 3 } };
+			return true;
+		case tf_bgra8:
+			out_layout = { 4, { 2, 1, 0, 3 } };
+			return true;
+		case tf_rgb8:
+		case tf_srgb8:
+			out_layout = { 3, { 0, 1, 2, -1 } };
+			return true;
+		case tf_bgr8:
+			out_layout = { 3, { 2, 1, 0, -1 } };
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	template<int input_bytes, int output_bytes>
+	void shuffle_scalar(const unsigned char *input, unsigned char *output, int num_pixels, const unsigned char *shuffle)
+	{
+		for (int i = 0; i < num_pixels; i++)
+		{
+			for (int j = 0; j < output_bytes; j++)
+				output[j] = (shuffle[j] & 0x80) ? 255 : input[shuffle[j]];
+			input += input_bytes;
+			output += output_bytes;
+		}
+	}
+
+	inline unsigned char premultiply_channel(unsigned int value, unsigned int alpha)
+	{
+		// Every premultiply kernel computes t = v * a + 128; (t + (t >> 8)) >> 8.
+		// For 8-bit v and a this is exactly round(v * a / 255), the same as (v * a + 127) / 255, and t fits in 16 bits
+		unsigned int t = value * alpha + 128;
+		return (t + (t >> 8)) >> 8;
+	}
+
+	void premultiply_scalar(const unsigned char *input, unsigned char *output, int num_pixels)
+	{
+		for (int i = 0; i < num_pixels; i++)
+		{
+			unsigned int alpha = input[3];
+			output[0] = premultiply_channel(input[0], alpha);
+			output[1] = premultiply_channel(input[1], alpha);
+			output[2] = premultiply_channel(input[2], alpha);
+			output[3] = alpha;
+			input += 4;
+			output += 4;
+		}
+	}
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+
+	void swap_red_blue_sse2(const unsigned char *input, unsigned char *output, int num_pixels, const unsigned char *shuffle)
+	{
+		__m128i green_alpha_mask = _mm_set1_epi32(0xff00ff00);
+		__m128i red_blue_mask = _mm_set1_epi32(0x000000ff);
+		int sse_length = (num_pixels / 4) * 4;
+		for (int i = 0; i < sse_length; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 4));
+			__m128i green_alpha = _mm_and_si128(pixels, green_alpha_mask);
+			__m128i first = _mm_and_si128(pixels, red_blue_mask);
+			__m128i third = _mm_and_si128(_mm_srli_epi32(pixels, 16), red_blue_mask);
+			pixels = _mm_or_si128(_mm_or_si128(green_alpha, _mm_slli_epi32(first, 16)), third);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4), pixels);
+		}
+		shuffle_scalar<4, 4>(input + sse_length * 4, output + sse_length * 4, num_pixels - sse_length, shuffle);
+	}
+
+	inline __m128i premultiply_sse2(__m128i pixels)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+		__m128i half = _mm_set1_epi16(128);
+
+		__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+		__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+		__m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		// t = v * a + 128; (t + (t >> 8)) >> 8, see premultiply_channel
+		__m128i t_lo = _mm_add_epi16(_mm_mullo_epi16(lo, alpha_lo), half);
+		__m128i t_hi = _mm_add_epi16(_mm_mullo_epi16(hi, alpha_hi), half);
+		t_lo = _mm_srli_epi16(_mm_add_epi16(t_lo, _mm_srli_epi16(t_lo, 8)), 8);
+		t_hi = _mm_srli_epi16(_mm_add_epi16(t_hi, _mm_srli_epi16(t_hi, 8)), 8);
+
+		lo = _mm_or_si128(_mm_andnot_si128(alpha_mask, t_lo), _mm_and_si128(alpha_mask, lo));
+		hi = _mm_or_si128(_mm_andnot_si128(alpha_mask, t_hi), _mm_and_si128(alpha_mask, hi));
+		return _mm_packus_epi16(lo, hi);
+	}
+
+	void premultiply_sse2(const unsigned char *input, unsigned char *output, int num_pixels)
+	{
+		int sse_length = (num_pixels / 4) * 4;
+		for (int i = 0; i < sse_length; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4), premultiply_sse2(pixels));
+		}
+		premultiply_scalar(input + sse_length * 4, output + sse_length * 4, num_pixels - sse_length);
+	}
+
+#endif
+
+#ifdef CL_PIXEL_DIRECT_SIMD
+
+	CL_SSSE3_FUNCTION inline __m128i shuffle_ssse3(__m128i pixels, __m128i shuffle, __m128i constant)
+	{
+		return _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), constant);
+	}
+
+	// Reads and writes whole 16 byte blocks as long as they stay inside the scanlines. The scalar kernel does the rest.
+	template<int input_bytes, int output_bytes>
+	CL_SSSE3_FUNCTION void shuffle_ssse3(const unsigned char *input, unsigned char *output, int num_pixels, const unsigned char *shuffle)
+	{
+		__m128i shuffle_mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffle));
+		__m128i constant = _mm_cmplt_epi8(shuffle_mask, _mm_setzero_si128());
+
+		int i = 0;
+		for (; i * input_bytes + 16 <= num_pixels * input_bytes && i * output_bytes + 16 <= num_pixels * output_bytes; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * input_bytes));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * output_bytes), shuffle_ssse3(pixels, shuffle_mask, constant));
+		}
+		shuffle_scalar<input_bytes, output_bytes>(input + i * input_bytes, output + i * output_bytes, num_pixels - i, shuffle);
+	}
+
+	template<int input_bytes, int output_bytes>
+	CL_AVX2_FUNCTION void shuffle_avx2(const unsigned char *input, unsigned char *output, int num_pixels, const unsigned char *shuffle)
+	{
+		__m256i shuffle_mask = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffle)));
+		__m256i constant = _mm256_cmpgt_epi8(_mm256_setzero_si256(), shuffle_mask);
+
+		// Each 128 bit lane holds four pixels, so the lanes are loaded and stored separately unless the pixels are 4 bytes on both sides
+		int i = 0;
+		for (; (i + 4) * input_bytes + 16 <= num_pixels * input_bytes && (i + 4) * output_bytes + 16 <= num_pixels * output_bytes; i += 8)
+		{
+			__m256i pixels;
+			if (input_bytes == 4)
+			{
+				pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i * 4));
+			}
+			else
+			{
+				__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * input_bytes));
+				__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + (i + 4) * input_bytes));
+				pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+			}
+
+			pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle_mask), constant);
+
+			if (output_bytes == 4)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i * 4), pixels);
+			}
+			else
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * output_bytes), _mm256_castsi256_si128(pixels));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + (i + 4) * output_bytes), _mm256_extracti128_si256(pixels, 1));
+			}
+		}
+		shuffle_scalar<input_bytes, output_bytes>(input + i * input_bytes, output + i * output_bytes, num_pixels - i, shuffle);
+	}
+
+	CL_AVX2_FUNCTION void premultiply_avx2(const unsigned char *input, unsigned char *output, int num_pixels)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		__m256i alpha_mask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+		__m256i half = _mm256_set1_epi16(128);
+
+		int avx_length = (num_pixels / 8) * 8;
+		for (int i = 0; i < avx_length; i += 8)
+		{
+			__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i * 4));
+
+			__m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+			__m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+			__m256i alpha_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m256i alpha_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+			// t = v * a + 128; (t + (t >> 8)) >> 8, see premultiply_channel
+			__m256i t_lo = _mm256_add_epi16(_mm256_mullo_epi16(lo, alpha_lo), half);
+			__m256i t_hi = _mm256_add_epi16(_mm256_mullo_epi16(hi, alpha_hi), half);
+			t_lo = _mm256_srli_epi16(_mm256_add_epi16(t_lo, _mm256_srli_epi16(t_lo, 8)), 8);
+			t_hi = _mm256_srli_epi16(_mm256_add_epi16(t_hi, _mm256_srli_epi16(t_hi, 8)), 8);
+
+			lo = _mm256_or_si256(_mm256_andnot_si256(alpha_mask, t_lo), _mm256_and_si256(alpha_mask, lo));
+			hi = _mm256_or_si256(_mm256_andnot_si256(alpha_mask, t_hi), _mm256_and_si256(alpha_mask, hi));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i * 4), _mm256_packus_epi16(lo, hi));
+		}
+		premultiply_sse2(input + avx_length * 4, output + avx_length * 4, num_pixels - avx_length);
+	}
+
+#endif
+
+	/// \brief Shuffle kernels for each combination of input and output pixel size (3 or 4 bytes)
+	struct ShuffleKernels
+	{
+		void (*scalar)(const unsigned char *, unsigned char *, int, const unsigned char *);
+		void (*ssse3)(const unsigned char *, unsigned char *, int, const unsigned char *);
+		void (*avx2)(const unsigned char *, unsigned char *, int, const unsigned char *);
+	};
+
+#ifdef CL_PIXEL_DIRECT_SIMD
+#define CL_SHUFFLE_KERNELS(in, out) { &shuffle_scalar<in, out>, &shuffle_ssse3<in, out>, &shuffle_avx2<in, out> }
+#else
+#define CL_SHUFFLE_KERNELS(in, out) { &shuffle_scalar<in, out>, nullptr, nullptr }
+#endif
+
+	const ShuffleKernels shuffle_kernels[2][2] =
+	{
+		{ CL_SHUFFLE_KERNELS(3, 3), CL_SHUFFLE_KERNELS(3, 4) },
+		{ CL_SHUFFLE_KERNELS(4, 3), CL_SHUFFLE_KERNELS(4, 4) }
+	};
+
+#undef CL_SHUFFLE_KERNELS
+}
+
+std::unique_ptr<PixelConverterDirect> PixelConverterDirect::create(TextureFormat output_format, TextureFormat input_format, const Vec4i &swizzle, bool premultiply_alpha)
+{
+	DirectFormatLayout input_layout, output_layout;
+	if (!get_direct_format_layout(input_format, input_layout) || !get_direct_format_layout(output_format, output_layout))
+		return std::unique_ptr<PixelConverterDirect>();
+
+	int swizzle_source[4] = { swizzle.x, swizzle.y, swizzle.z, swizzle.w };
+	for (int i = 0; i < 4; i++)
+	{
+		if (swizzle_source[i] < 0 || swizzle_source[i] > 3)
+			return std::unique_ptr<PixelConverterDirect>();
+	}
+
+	std::unique_ptr<PixelConverterDirect> converter(new PixelConverterDirect());
+	converter->input_bytes = input_layout.bytes;
+	converter->output_bytes = output_layout.bytes;
+
+	// Without an alpha channel the input is already premultiplied
+	converter->premultiply = premultiply_alpha && input_layout.channel_offset[3] != -1;
+
+	// Find the input byte for each output byte. The alpha of formats without alpha reads as opaque.
+	unsigned char pixel_shuffle[4] = { 0x80, 0x80, 0x80, 0x80 };
+	for (int channel = 0; channel < 4; channel++)
+	{
+		int output_offset = output_layout.channel_offset[channel];
+		if (output_offset != -1)
+		{
+			int input_offset = input_layout.channel_offset[swizzle_source[channel]];
+			pixel_shuffle[output_offset] = (input_offset != -1) ? input_offset : 0x80;
+		}
+	}
+
+	memset(converter->shuffle, 0x80, 16);
+	for (int pixel = 0; pixel < 4; pixel++)
+	{
+		for (int i = 0; i < converter->output_bytes; i++)
+		{
+			unsigned char index = pixel_shuffle[i];
+			converter->shuffle[pixel * converter->output_bytes + i] = (index & 0x80) ? 0x80 : pixel * converter->input_bytes + index;
+		}
+	}
+
+	converter->identity = (converter->input_bytes == converter->output_bytes);
+	for (int i = 0; i < converter->output_bytes; i++)
+	{
+		if (pixel_shuffle[i] != i)
+			converter->identity = false;
+	}
+
+	converter->set_instruction_sets(false, false, false);
+	return converter;
+}
+
+void PixelConverterDirect::set_instruction_sets(bool sse2, bool ssse3, bool avx2)
+{
+	const ShuffleKernels &kernels = shuffle_kernels[input_bytes - 3][output_bytes - 3];
+	if (avx2 && kernels.avx2)
+		shuffle_func = kernels.avx2;
+	else if (ssse3 && kernels.ssse3)
+		shuffle_func = kernels.ssse3;
+	else
+		shuffle_func = kernels.scalar;
+
+	premultiply_func = &premultiply_scalar;
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+	// Swapping red and blue is common enough to have a SSE2 kernel of its own
+	bool swap_red_blue = (input_bytes == 4 && output_bytes == 4 && shuffle[0] == 2 && shuffle[1] == 1 && shuffle[2] == 0 && shuffle[3] == 3);
+	if (sse2 && swap_red_blue && shuffle_func == kernels.scalar)
+		shuffle_func = &swap_red_blue_sse2;
+
+	if (sse2)
+		premultiply_func = &premultiply_sse2;
+#endif
+
+#ifdef CL_PIXEL_DIRECT_SIMD
+	if (avx2)
+		premultiply_func = &premultiply_avx2;
+#endif
+}
+
+void PixelConverterDirect::convert(void *output, const void *input, int num_pixels)
+{
+	const unsigned char *src = static_cast<const unsigned char *>(input);
+	unsigned char *dest = static_cast<unsigned char *>(output);
+
+	if (premultiply)
+	{
+		if (identity)
+		{
+			premultiply_func(src, dest, num_pixels);
+			return;
+		}
+
+		if (premultiply_buffer_size < num_pixels)
+		{
+			premultiply_buffer.reset(new unsigned char[num_pixels * 4]);
+			premultiply_buffer_size = num_pixels;
+		}
+		premultiply_func(src, premultiply_buffer.get(), num_pixels);
+		src = premultiply_buffer.get();
+	}
+
+	if (identity)
+		memcpy(dest, src, num_pixels * output_bytes);
+	else
+		shuffle_func(src, dest, num_pixels, shuffle);
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/Math/vec4.h"
+#include "API/Display/Image/texture_format.h"
+#include <memory>
+
+namespace clan
+{
+
+/// \brief Converts scanlines between 8 bit RGB(A) formats using integer kernels
+///
+/// Covers swizzling, channel expansion and removal and premultiplied alpha without the float round-trip
+/// of the generic PixelReader/PixelFilter/PixelWriter path.
+class PixelConverterDirect
+{
+public:
+	/// \brief Returns a direct converter, or nullptr if the conversion needs the generic float path
+	static std::unique_ptr<PixelConverterDirect> create(TextureFormat output_format, TextureFormat input_format, const Vec4i &swizzle, bool premultiply_alpha);
+
+	/// \brief Restrict the kernels to the ones available for the given instruction sets
+	void set_instruction_sets(bool sse2, bool ssse3, bool avx2);
+
+	/// \brief Converts a scanline
+	void convert(void *output, const void *input, int num_pixels);
+
+	/// \brief Returns the number of bytes per input pixel
+	int get_input_bytes() const { return input_bytes; }
+
+	/// \brief Returns the number of bytes per output pixel
+	int get_output_bytes() const { return output_bytes; }
+
+private:
+	PixelConverterDirect() { }
+
+	typedef void (*ShuffleFunc)(const unsigned char *input, unsigned char *output, int num_pixels, const unsigned char *shuffle);
+	typedef void (*PremultiplyFunc)(const unsigned char *input, unsigned char *output, int num_pixels);
+
+	int input_bytes = 4;
+	int output_bytes = 4;
+
+	/// \brief Input byte read for each output byte of four pixels, or 0x80 for a constant 255 (opaque alpha)
+	unsigned char shuffle[16];
+
+	/// \brief True if the shuffle is a plain copy
+	bool identity = false;
+
+	/// \brief True if the input pixels are multiplied by their alpha before shuffling
+	bool premultiply = false;
+
+	ShuffleFunc shuffle_func = nullptr;
+	PremultiplyFunc premultiply_func = nullptr;
+
+	/// \brief Line buffer holding the premultiplied input pixels
+	std::unique_ptr<unsigned char[]> premultiply_buffer;
+	int premultiply_buffer_size = 0;
+};
+
+}
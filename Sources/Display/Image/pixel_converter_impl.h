@@ -31,6 +31,7 @@
 
 #include "API/Core/Math/vec4.h"
 #include "API/Core/Math/half_float_vector.h"
+#include "API/Core/System/system.h"
 #include <memory>
 #include <vector>
 
@@ -58,11 +59,22 @@ public:
 	virtual void filter(Vec4f *pixels, int num_pixels) = 0;
 };
 
+class PixelConverterDirect;
+
 class PixelConverter_Impl
 {
 public:
-	PixelConverter_Impl() : premultiply_alpha(false), flip_vertical(false), gamma(1.0f), swizzle(0,1,2,3), input_is_ycrcb(false), output_is_ycrcb(false) { }
+	PixelConverter_Impl() : premultiply_alpha(false), flip_vertical(false), gamma(1.0f), swizzle(0,1,2,3), input_is_ycrcb(false), output_is_ycrcb(false)
+	{
+		sse2 = System::detect_cpu_extension(System::sse2);
+		ssse3 = System::detect_cpu_extension(System::ssse3);
+		sse4 = System::detect_cpu_extension(System::sse4_1);
+		avx2 = System::detect_cpu_extension(System::avx2);
+	}
+
+	void convert_rows(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, int row_begin, int row_end);
 
+	std::unique_ptr<PixelConverterDirect> create_direct(TextureFormat output_format, TextureFormat input_format);
 	std::unique_ptr<PixelReader> create_reader(TextureFormat format, bool sse2);
 	std::unique_ptr<PixelWriter> create_writer(TextureFormat format, bool sse2, bool sse4);
 	std::vector<std::shared_ptr<PixelFilter> > create_filters(bool sse2);
@@ -73,6 +85,14 @@ public:
 	Vec4i swizzle;
 	bool input_is_ycrcb;
 	bool output_is_ycrcb;
+
+	bool sse2;
+	bool ssse3;
+	bool sse4;
+	bool avx2;
+
+	/// \brief Number of pixels converted by each band of a multi-threaded conversion
+	static const int pixels_per_band = 128 * 1024;
 };
 
 }
@@ -84,28 +84,28 @@ public:
 	PixelFilterSwizzleSSE2(const Vec4i &swizzle)
 	{
 		red_mask = _mm_castsi128_ps(_mm_set_epi32(
-			swizzle.x == 0 ? 0xffffffff : 0,
-			swizzle.y == 0 ? 0xffffffff : 0,
+			swizzle.w == 0 ? 0xffffffff : 0,
 			swizzle.z == 0 ? 0xffffffff : 0,
-			swizzle.w == 0 ? 0xffffffff : 0));
+			swizzle.y == 0 ? 0xffffffff : 0,
+			swizzle.x == 0 ? 0xffffffff : 0));
 
 		green_mask = _mm_castsi128_ps(_mm_set_epi32(
-			swizzle.x == 1 ? 0xffffffff : 0,
-			swizzle.y == 1 ? 0xffffffff : 0,
+			swizzle.w == 1 ? 0xffffffff : 0,
 			swizzle.z == 1 ? 0xffffffff : 0,
-			swizzle.w == 1 ? 0xffffffff : 0));
+			swizzle.y == 1 ? 0xffffffff : 0,
+			swizzle.x == 1 ? 0xffffffff : 0));
 
 		blue_mask = _mm_castsi128_ps(_mm_set_epi32(
-			swizzle.x == 2 ? 0xffffffff : 0,
-			swizzle.y == 2 ? 0xffffffff : 0,
+			swizzle.w == 2 ? 0xffffffff : 0,
 			swizzle.z == 2 ? 0xffffffff : 0,
-			swizzle.w == 2 ? 0xffffffff : 0));
+			swizzle.y == 2 ? 0xffffffff : 0,
+			swizzle.x == 2 ? 0xffffffff : 0));
 
 		alpha_mask = _mm_castsi128_ps(_mm_set_epi32(
-			swizzle.x == 3 ? 0xffffffff : 0,
-			swizzle.y == 3 ? 0xffffffff : 0,
+			swizzle.w == 3 ? 0xffffffff : 0,
 			swizzle.z == 3 ? 0xffffffff : 0,
-			swizzle.w == 3 ? 0xffffffff : 0));
+			swizzle.y == 3 ? 0xffffffff : 0,
+			swizzle.x == 3 ? 0xffffffff : 0));
 	}
 
 	void filter(Vec4f *pixels, int num_pixels) override
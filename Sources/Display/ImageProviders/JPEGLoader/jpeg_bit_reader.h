@@ -38,6 +38,9 @@ class JPEGBitReader
 public:
 	JPEGBitReader(JPEGFileReader *reader);
 
+	/// \brief Reads bits from entropy data already in memory (with the 0xff00 stuffing removed)
+	JPEGBitReader(const unsigned char *data, int length);
+
 	void reset();
 	unsigned int get_bit();
 	unsigned int get_bits(int count);
@@ -45,6 +48,7 @@ public:
 private:
 	JPEGFileReader *reader;
 	std::vector<unsigned char> buffer;
+	const unsigned char *data;
 	int length;
 	int pos;
 	int bitpos;
@@ -368,4 +368,49 @@ int JPEGFileReader::read_entropy_data(void *d, int size)
 	return j;
 }
 
+void JPEGFileReader::read_entropy_segments(std::vector<unsigned char> &data, std::vector<int> &segment_starts)
+{
+	segment_starts.push_back(data.size());
+
+	uint8_t buffer[16*1024];
+	while (true)
+	{
+		int start = iodevice.get_position();
+		int len = iodevice.read(buffer, 16*1024, false);
+		if (len == 0)
+			return;
+
+		for (int i = 0; i < len; i++)
+		{
+			if (buffer[i] != 0xff)
+			{
+				data.push_back(buffer[i]);
+			}
+			else if (i + 1 == len)
+			{
+				// Marker split by the end of the buffer. Read it again at the start of the next one
+				if (i == 0)
+					return;
+				iodevice.seek(start + i);
+				break;
+			}
+			else if (buffer[i + 1] == 0x00)
+			{
+				data.push_back(0xff);
+				i++;
+			}
+			else if (buffer[i + 1] >= marker_rst0 && buffer[i + 1] <= marker_rst7)
+			{
+				segment_starts.push_back(data.size());
+				i++;
+			}
+			else
+			{
+				iodevice.seek(start + i);
+				return;
+			}
+		}
+	}
+}
+
 }
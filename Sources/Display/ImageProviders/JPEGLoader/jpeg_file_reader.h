@@ -60,6 +60,11 @@ public:
 	std::string read_comment();
 	int read_entropy_data(void *d, int size);
 
+	/// \brief Reads all entropy data up to the next marker that is not a restart marker
+	///
+	/// The byte stuffing is removed. segment_starts receives the offset in data of each restart interval.
+	void read_entropy_segments(std::vector<unsigned char> &data, std::vector<int> &segment_starts);
+
 private:
 	IODevice iodevice;
 };
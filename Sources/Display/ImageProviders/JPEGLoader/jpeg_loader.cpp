@@ -32,6 +32,8 @@
 #include "jpeg_huffman_decoder.h"
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_rgb_decoder.h"
+#include "API/Core/System/work_queue.h"
+#include "Display/setup_display.h"
 
 namespace clan
 {
@@ -39,41 +41,47 @@ namespace clan
 PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb)
 {
 	JPEGLoader loader(iodevice);
-	JPEGMCUDecoder mcu_decoder(&loader);
-	JPEGRGBDecoder rgb_decoder(&loader);
 
 	int image_width = loader.start_of_frame.width;
 	int image_height = loader.start_of_frame.height;
 	PixelBuffer image(image_width, image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
 	unsigned int *image_pixels = reinterpret_cast<unsigned int *>(image.get_data());
 
-	const unsigned int *block_pixels = rgb_decoder.get_pixels();
-	int block_width = rgb_decoder.get_width();
-	int block_height = rgb_decoder.get_height();
-
-	for (int curMcuY = 0, y = 0; curMcuY < loader.mcu_height; curMcuY++, y += block_height)
+	// IDCT and color conversion of each MCU row only depends on the decoded DCT coefficients
+	int mcu_rows_per_task = max(mcus_per_task / loader.mcu_width, 1);
+	SetupDisplay::get_work_queue().parallel_for(loader.mcu_height, mcu_rows_per_task, [&](int mcu_row_begin, int mcu_row_end)
 	{
-		for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
-		{
-			mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
-			rgb_decoder.decode(&mcu_decoder);
+		JPEGMCUDecoder mcu_decoder(&loader);
+		JPEGRGBDecoder rgb_decoder(&loader);
+
+		const unsigned int *block_pixels = rgb_decoder.get_pixels();
+		int block_width = rgb_decoder.get_width();
+		int block_height = rgb_decoder.get_height();
 
-			int w = min(block_width, image_width-x);
-			int h = min(block_height, image_height-y);
-			for (int yy = 0; yy < h; yy++)
+		for (int curMcuY = mcu_row_begin, y = mcu_row_begin * block_height; curMcuY < mcu_row_end; curMcuY++, y += block_height)
+		{
+			for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
 			{
-				for (int xx = 0; xx < w; xx++)
+				mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
+				rgb_decoder.decode(&mcu_decoder);
+
+				int w = min(block_width, image_width-x);
+				int h = min(block_height, image_height-y);
+				for (int yy = 0; yy < h; yy++)
 				{
-					unsigned int p = block_pixels[xx+yy*block_width];
-					unsigned int red = (p >> 16) & 0xff;
-					unsigned int green = (p >> 8) & 0xff;
-					unsigned int blue = p & 0xff;
-					unsigned int alpha = (p >> 24) & 0xff;
-					image_pixels[x+xx+(y+yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
+					for (int xx = 0; xx < w; xx++)
+					{
+						unsigned int p = block_pixels[xx+yy*block_width];
+						unsigned int red = (p >> 16) & 0xff;
+						unsigned int green = (p >> 8) & 0xff;
+						unsigned int blue = p & 0xff;
+						unsigned int alpha = (p >> 24) & 0xff;
+						image_pixels[x+xx+(y+yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
+					}
 				}
 			}
 		}
-	}
+	});
 
 	return image;
 }
@@ -306,25 +314,42 @@ void JPEGLoader::process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vec
 	verify_dc_table_selector(start_of_scan);
 	verify_ac_table_selector(start_of_scan);
 
-	JPEGBitReader bit_reader(&reader);
-	int restart_counter = 0;
-	for (int mcu_block = 0; mcu_block < mcu_width*mcu_height; mcu_block++)
+	int mcu_count = mcu_width*mcu_height;
+	if (restart_interval != 0 && restart_interval < mcu_count)
 	{
-		if (restart_interval != 0 && restart_counter == restart_interval)
+		// Restart intervals start with fresh DC predictions at a byte boundary and can be decoded independently
+		std::vector<unsigned char> entropy_data;
+		std::vector<int> segment_starts;
+		reader.read_entropy_segments(entropy_data, segment_starts);
+
+		int num_segments = (mcu_count + restart_interval - 1) / restart_interval;
+		if ((int)segment_starts.size() < num_segments)
+			throw Exception("Restart marker missing between JPEG entropy data");
+		segment_starts.push_back(entropy_data.size());
+
+		int segments_per_task = max(mcus_per_task / restart_interval, 1);
+		SetupDisplay::get_work_queue().parallel_for(num_segments, segments_per_task, [&](int segment_begin, int segment_end)
 		{
-			JPEGMarker marker = reader.read_marker();
-			if (marker < marker_rst0 || marker > marker_rst7)
+			for (int segment = segment_begin; segment < segment_end; segment++)
 			{
-				throw Exception("Restart marker missing between JPEG entropy data");
+				JPEGBitReader bit_reader(entropy_data.data() + segment_starts[segment], segment_starts[segment + 1] - segment_starts[segment]);
+				int mcu_begin = segment * restart_interval;
+				decode_sequential_mcus(start_of_scan, component_to_sof, bit_reader, mcu_begin, min(mcu_begin + restart_interval, mcu_count));
 			}
-			restart_counter = 0;
-			for (auto & elem : last_dc_values)
-				elem = 0;
-			bit_reader.reset();
-			eobrun = 0;
-		}
-		restart_counter++;
+		});
+	}
+	else
+	{
+		JPEGBitReader bit_reader(&reader);
+		decode_sequential_mcus(start_of_scan, component_to_sof, bit_reader, 0, mcu_count);
+	}
+}
 
+void JPEGLoader::decode_sequential_mcus(const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGBitReader &bit_reader, int mcu_begin, int mcu_end)
+{
+	std::vector<short> last_dc(start_of_frame.components.size(), 0);
+	for (int mcu_block = mcu_begin; mcu_block < mcu_end; mcu_block++)
+	{
 		for (size_t c = 0; c < start_of_scan.components.size(); c++)
 		{
 			int c_sof = component_to_sof[c];
@@ -344,8 +369,8 @@ void JPEGLoader::process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vec
 							dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
 						dct[0] <<= start_of_scan.point_transform;
 
-						dct[0] += last_dc_values[c_sof];
-						last_dc_values[c_sof] = dct[0];
+						dct[0] += last_dc[c_sof];
+						last_dc[c_sof] = dct[0];
 					}
 					else // DCT AC coefficient
 					{
@@ -65,6 +65,7 @@ private:
 	void process_dnl(JPEGFileReader &reader);
 	void process_sos(JPEGFileReader &reader);
 	void process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+	void decode_sequential_mcus(const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGBitReader &bit_reader, int mcu_begin, int mcu_end);
 	void process_sos_progressive(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
 	void process_dqt(JPEGFileReader &reader);
 	void process_dht(JPEGFileReader &reader);
@@ -94,6 +95,9 @@ private:
 
 	static int zigzag_map[64];
 
+	/// \brief Minimum number of MCUs decoded by each task when a JPEG is decoded on multiple threads
+	static const int mcus_per_task = 256;
+
 	friend class JPEGMCUDecoder;
 	friend class JPEGRGBDecoder;
 };
@@ -43,8 +43,10 @@ namespace clan
 {
 
 JPEGRGBDecoder::JPEGRGBDecoder(JPEGLoader *loader)
-: loader(loader), mcu_x(0), mcu_y(0), pixels(nullptr)
+: loader(loader), colorspace(0), sse2(false), mcu_x(0), mcu_y(0), pixels(nullptr)
 {
+	colorspace = loader->get_colorspace();
+	sse2 = System::detect_cpu_extension(System::sse2);
 	mcu_x = loader->mcu_x;
 	mcu_y = loader->mcu_y;
 	try
@@ -73,14 +75,14 @@ void JPEGRGBDecoder::decode(JPEGMCUDecoder *mcu_decoder)
 {
 	upsample(mcu_decoder);
 
-	switch (loader->get_colorspace())
+	switch (colorspace)
 	{
 	case JPEGLoader::colorspace_grayscale:
 		convert_monochrome();
 		break;
 	case JPEGLoader::colorspace_ycrcb:
 #ifndef CL_DISABLE_SSE2
-		if (System::detect_cpu_extension(System::sse2))
+		if (sse2)
 			convert_ycrcb_sse();
 		else
 			convert_ycrcb_float();
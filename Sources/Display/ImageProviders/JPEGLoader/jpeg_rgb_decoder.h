@@ -54,6 +54,8 @@ private:
 	void convert_rgb();
 
 	JPEGLoader *loader;
+	int colorspace;
+	bool sse2;
 	int mcu_x, mcu_y;
 	unsigned int *pixels;
 	std::vector<unsigned char *> channels;
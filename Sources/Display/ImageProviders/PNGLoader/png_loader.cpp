@@ -32,28 +32,46 @@
 #include "API/Core/Zip/zlib_compression.h"
 #include "API/Core/System/system.h"
 #include "Display/ImageProviders/PNGWriter/png_writer.h"
+#include "Display/Image/pixel_converter_direct.h"
+#include "png_loader_sse.h"
 
 namespace clan
 {
 
-PixelBuffer PNGLoader::load(IODevice iodevice, bool srgb)
+PixelBuffer PNGLoader::load(IODevice iodevice, bool srgb, const std::function<void(const PixelBuffer &image, int y, int height)> &rows_decoded)
 {
-	PNGLoader loader(iodevice, srgb);
+	PNGLoader loader(iodevice, srgb, rows_decoded);
 	return loader.image;
 }
 
-PNGLoader::PNGLoader(IODevice iodevice, bool force_srgb)
-: file(iodevice), force_srgb(force_srgb), scanline(nullptr), prev_scanline(nullptr), scanline_4ub(nullptr), scanline_4us(nullptr), palette(nullptr)
+PNGLoader::PNGLoader(IODevice iodevice, bool force_srgb, const std::function<void(const PixelBuffer &image, int y, int height)> &rows_decoded)
+: file(iodevice), force_srgb(force_srgb), rows_decoded(rows_decoded), scanline(nullptr), prev_scanline(nullptr), scanline_4ub(nullptr), scanline_4us(nullptr), palette(nullptr)
 {
-	read_magic();
-	read_chunks();
-	decode_header();
-	decode_palette();
-	decode_colorkey();
-	decode_image();
+	sse2 = System::detect_cpu_extension(System::sse2);
+
+	try
+	{
+		read_magic();
+		read_chunks();
+		decode_header();
+		decode_palette();
+		decode_colorkey();
+		decode_image();
+		read_trailing_chunks();
+	}
+	catch (...)
+	{
+		free_buffers();
+		throw;
+	}
 }
 
 PNGLoader::~PNGLoader()
+{
+	free_buffers();
+}
+
+void PNGLoader::free_buffers()
 {
 	System::aligned_free(scanline);
 	System::aligned_free(prev_scanline);
@@ -77,47 +95,23 @@ void PNGLoader::read_chunks()
 
 	std::map<std::string, DataBuffer> chunks;
 
-	std::vector<DataBuffer> idat_chunks;
-	uint64_t total_idat_size = 0;
-
+	// Everything the decoder needs precedes the image data. Reading stops at the first IDAT chunk, the rest is inflated while decoding.
 	while (true)
 	{
-		unsigned int length = file.read_uint32();
-		char name[5];
-		name[4] = 0;
-		file.read(name, 4);
-
-		DataBuffer data(length);
-		file.read(data.get_data(), data.get_size());
+		DataBuffer data;
+		std::string name = read_chunk(data);
 
-		unsigned int crc32 = file.read_uint32();
-
-		unsigned int compare_crc32 = PNGCRC32::crc(name, data.get_data(), data.get_size());
-		if (crc32 != compare_crc32)
-			throw Exception("CRC32 error");
-
-		if (name == std::string("IDAT")) // Concatenate all IDAT chunks to one big
+		if (name == "IDAT")
 		{
-			total_idat_size += length;
-			idat_chunks.push_back(data);
+			idat_chunk = data;
+			break;
 		}
-		else
+		else if (name == "IEND") // image trailer, which is the last chunk in a PNG datastream.
 		{
-			chunks[name] = data;
-			if (name == std::string("IEND")) // image trailer, which is the last chunk in a PNG datastream.
-				break;
+			throw Exception("Invalid PNG image file");
 		}
-	}
 
-	if (total_idat_size >= (1 << 31))
-		throw Exception("PNG image file too big!");
-
-	idat = DataBuffer((int)total_idat_size);
-	int idat_pos = 0;
-	for (auto & idat_chunk : idat_chunks)
-	{
-		memcpy(idat.get_data() + idat_pos, idat_chunk.get_data(), idat_chunk.get_size());
-		idat_pos += idat_chunk.get_size();
+		chunks[name] = data;
 	}
 
 	ihdr = chunks["IHDR"];
@@ -130,10 +124,84 @@ void PNGLoader::read_chunks()
 	sbit = chunks["sBIT"];
 	srgb = chunks["sRGB"];
 
-	if (ihdr.is_null() || idat_chunks.empty() || ihdr.get_size() != 13) // Always required chunks
+	if (ihdr.is_null() || ihdr.get_size() != 13) // Always required chunks
 		throw Exception("Invalid PNG image file");
 }
 
+std::string PNGLoader::read_chunk(DataBuffer &data)
+{
+	unsigned int length = file.read_uint32();
+	char name[5];
+	name[4] = 0;
+	file.read(name, 4);
+
+	if (length >= (1u << 31))
+		throw Exception("Invalid PNG image file");
+
+	data.set_size(0);
+	data.set_size(length);
+	file.read(data.get_data(), data.get_size());
+
+	unsigned int crc32 = file.read_uint32();
+
+	unsigned int compare_crc32 = PNGCRC32::crc(name, data.get_data(), data.get_size());
+	if (crc32 != compare_crc32)
+		throw Exception("CRC32 error");
+
+	return name;
+}
+
+void PNGLoader::read_idat_chunk()
+{
+	// Chunks may be empty, so keep going until there is data to inflate
+	while (true)
+	{
+		if (read_chunk(idat_chunk) != "IDAT")
+			throw Exception("Invalid PNG image file");
+
+		if (idat_chunk.get_size() > 0)
+			break;
+	}
+
+	zs.next_in = reinterpret_cast<const unsigned char*>(idat_chunk.get_data());
+	zs.avail_in = idat_chunk.get_size();
+}
+
+void PNGLoader::read_image_data(unsigned char *data, int size)
+{
+	zs.next_out = data;
+	zs.avail_out = size;
+	while (zs.avail_out > 0)
+	{
+		int result = mz_inflate(&zs, MZ_NO_FLUSH);
+		if (result == MZ_STREAM_END)
+		{
+			if (zs.avail_out > 0)
+				throw Exception("Invalid PNG image file");
+		}
+		else if (result != MZ_OK && result != MZ_BUF_ERROR)
+		{
+			throw Exception("Invalid PNG image file");
+		}
+		else if (zs.avail_out > 0)
+		{
+			// Only fetch the next chunk once the inflater has flushed everything it could produce from the current one
+			if (zs.avail_in == 0)
+				read_idat_chunk();
+			else if (result == MZ_BUF_ERROR)
+				throw Exception("Invalid PNG image file");
+		}
+	}
+}
+
+void PNGLoader::read_trailing_chunks()
+{
+	DataBuffer data;
+	while (read_chunk(data) != "IEND")
+	{
+	}
+}
+
 void PNGLoader::decode_header()
 {
 	image_width = from_network_order(*reinterpret_cast<unsigned int*>(ihdr.get_data()));
@@ -220,22 +288,37 @@ void PNGLoader::decode_colorkey()
 
 void PNGLoader::decode_image()
 {
-	DataBuffer image_data = ZLibCompression::decompress(idat, false);
-
-	create_image();
-	create_scanline_buffers();
+	zs = mz_stream();
+	if (mz_inflateInit2(&zs, 15) != MZ_OK)
+		throw Exception("Zlib inflateInit failed");
 
-	if (interlace_method == 0)
+	try
 	{
-		decode_interlace_none(reinterpret_cast<const unsigned char*>(image_data.get_data()), image_data.get_size());
-	}
-	else if (interlace_method == 1)
-	{
-		decode_interlace_adam7(reinterpret_cast<const unsigned char*>(image_data.get_data()), image_data.get_size());
+		zs.next_in = reinterpret_cast<const unsigned char*>(idat_chunk.get_data());
+		zs.avail_in = idat_chunk.get_size();
+
+		create_image();
+		create_scanline_buffers();
+
+		if (interlace_method == 0)
+		{
+			decode_interlace_none();
+		}
+		else if (interlace_method == 1)
+		{
+			decode_interlace_adam7();
+		}
+		else
+		{
+			throw Exception("Invalid PNG image file");
+		}
+
+		mz_inflateEnd(&zs);
 	}
-	else
+	catch (...)
 	{
-		throw Exception("Invalid PNG image file");
+		mz_inflateEnd(&zs);
+		throw;
 	}
 }
 
@@ -250,10 +333,22 @@ void PNGLoader::create_image()
 void PNGLoader::create_scanline_buffers()
 {
 	int size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-	scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
-	prev_scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
-	scanline_4ub = static_cast<Vec4ub *>(System::aligned_alloc(image_width * sizeof(Vec4ub)));
-	scanline_4us = static_cast<Vec4us *>(System::aligned_alloc(image_width * sizeof(Vec4us)));
+	scanline = static_cast<unsigned char *>(System::aligned_alloc(size + PNGLoaderSSE::scanline_padding));
+	prev_scanline = static_cast<unsigned char *>(System::aligned_alloc(size + PNGLoaderSSE::scanline_padding));
+
+	// Opaque 8 bit truecolor expands to RGBA with the byte shuffle kernels of the pixel converter
+	if (color_type == 2 && bit_depth == 8 && !has_colorkey)
+	{
+		truecolor_converter = PixelConverterDirect::create(tf_rgba8, tf_rgb8, Vec4i(0, 1, 2, 3), false);
+		truecolor_converter->set_instruction_sets(sse2, System::detect_cpu_extension(System::ssse3), System::detect_cpu_extension(System::avx2));
+	}
+
+	// Non-interlaced scanlines are converted straight into the image
+	if (interlace_method == 1)
+	{
+		scanline_4ub = static_cast<Vec4ub *>(System::aligned_alloc(image_width * sizeof(Vec4ub)));
+		scanline_4us = static_cast<Vec4us *>(System::aligned_alloc(image_width * sizeof(Vec4us)));
+	}
 }
 
 int PNGLoader::get_image_data_channels()
@@ -269,16 +364,14 @@ int PNGLoader::get_image_data_channels()
 	}
 }
 
-void PNGLoader::decode_interlace_none(const unsigned char *data, int data_length)
+void PNGLoader::decode_interlace_none()
 {
 	int scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-	if ((1 + scanline_size) * image_height > data_length)
-		throw Exception("Invalid PNG image file");
 
 	for (size_t i = 0; i < scanline_size; i++)
 		scanline[i] = 0;
 
-	int data_pos = 0;
+	int band_start = 0;
 	PixelBufferLockAny pixels(image);
 	for (int y = 0; y < image_height; y++)
 	{
@@ -286,30 +379,30 @@ void PNGLoader::decode_interlace_none(const unsigned char *data, int data_length
 		scanline = prev_scanline;
 		prev_scanline = tmp;
 
-		int predictor_type = data[data_pos++];
-		memcpy(scanline, data + data_pos, scanline_size);
-		data_pos += scanline_size;
+		unsigned char predictor_type = 0;
+		read_image_data(&predictor_type, 1);
+		read_image_data(scanline, scanline_size);
 
 		filter_scanline(predictor_type, scanline_size);
 
-		if (bit_depth <= 8)
-			convert_scanline_4ub(image_width);
-		else
-			convert_scanline_4us(image_width);
-
 		unsigned char *output_line = pixels.get_row(y);
 		if (bit_depth <= 8)
-			memcpy(output_line, scanline_4ub, image_width * 4);
+			convert_scanline_4ub(reinterpret_cast<Vec4ub*>(output_line), image_width);
 		else
-			memcpy(output_line, scanline_4us, image_width * 8);
+			convert_scanline_4us(reinterpret_cast<Vec4us*>(output_line), image_width);
+
+		if (rows_decoded && (y + 1 - band_start == rows_per_band || y + 1 == image_height))
+		{
+			rows_decoded(image, band_start, y + 1 - band_start);
+			band_start = y + 1;
+		}
 	}
 }
 
-void PNGLoader::decode_interlace_adam7(const unsigned char *data, int data_length)
+void PNGLoader::decode_interlace_adam7()
 {
 	int scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
 
-	int data_pos = 0;
 	int channels = get_image_data_channels();
 
 	int starting_row[7]  = { 0, 0, 4, 0, 2, 0, 1 };
@@ -338,19 +431,16 @@ void PNGLoader::decode_interlace_adam7(const unsigned char *data, int data_lengt
 				int scanline_pixel_length = (image_width - starting_col[pass] + col_increment[pass] - 1) / col_increment[pass];
 				int scanline_byte_length = (scanline_pixel_length * bit_depth * channels + 7) / 8;
 
-				if (data_pos + scanline_byte_length > data_length)
-					throw Exception("Invalid PNG image file");
-
-				int predictor_type = data[data_pos++];
-				memcpy(scanline, data + data_pos, scanline_byte_length);
-				data_pos += scanline_byte_length;
+				unsigned char predictor_type = 0;
+				read_image_data(&predictor_type, 1);
+				read_image_data(scanline, scanline_byte_length);
 
 				filter_scanline(predictor_type, scanline_byte_length);
 
 				if (bit_depth <= 8)
-					convert_scanline_4ub(scanline_pixel_length);
+					convert_scanline_4ub(scanline_4ub, scanline_pixel_length);
 				else
-					convert_scanline_4us(scanline_pixel_length);
+					convert_scanline_4us(scanline_4us, scanline_pixel_length);
 
 				int scanline_pos = 0;
 				for (int x = starting_col[pass]; x < image_width; x += col_increment[pass])
@@ -363,11 +453,31 @@ void PNGLoader::decode_interlace_adam7(const unsigned char *data, int data_lengt
 			}
 		}
 	}
+
+	// Rows are not final until the last pass has been decoded
+	if (rows_decoded)
+		rows_decoded(image, 0, image_height);
 }
 
 void PNGLoader::filter_scanline(int predictor_type, int scanline_byte_length)
 {
 	int channels = get_image_data_channels();
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+	int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
+	if (sse2 && PNGLoaderSSE::is_supported(predictor_type, bytes_per_pixel))
+	{
+		switch (predictor_type)
+		{
+		case 1: PNGLoaderSSE::predictor_sub(scanline, scanline_byte_length, bytes_per_pixel); break;
+		case 2: PNGLoaderSSE::predictor_up(scanline, prev_scanline, scanline_byte_length); break;
+		case 3: PNGLoaderSSE::predictor_average(scanline, prev_scanline, scanline_byte_length, bytes_per_pixel); break;
+		case 4: PNGLoaderSSE::predictor_paeth(scanline, prev_scanline, scanline_byte_length, bytes_per_pixel); break;
+		}
+		return;
+	}
+#endif
+
 	switch (predictor_type)
 	{
 	case 0: break; // none
@@ -437,32 +547,32 @@ void PNGLoader::predictor_paeth(unsigned char *scanline, const unsigned char *pr
 	}
 }
 
-void PNGLoader::convert_scanline_4ub(int scanline_pixel_length)
+void PNGLoader::convert_scanline_4ub(Vec4ub *output, int scanline_pixel_length)
 {
 	switch (color_type)
 	{
-	case 0: grayscale_to_4ub(scanline_pixel_length); break;
-	case 2: truecolor_to_4ub(scanline_pixel_length); break;
-	case 3: indexed_to_4ub(scanline_pixel_length); break;
-	case 4: grayscale_alpha_to_4ub(scanline_pixel_length); break;
-	case 6: truecolor_alpha_to_4ub(scanline_pixel_length); break;
+	case 0: grayscale_to_4ub(output, scanline_pixel_length); break;
+	case 2: truecolor_to_4ub(output, scanline_pixel_length); break;
+	case 3: indexed_to_4ub(output, scanline_pixel_length); break;
+	case 4: grayscale_alpha_to_4ub(output, scanline_pixel_length); break;
+	case 6: truecolor_alpha_to_4ub(output, scanline_pixel_length); break;
 	default: throw Exception("Invalid PNG image file");
 	}
 }
 
-void PNGLoader::convert_scanline_4us(int scanline_pixel_length)
+void PNGLoader::convert_scanline_4us(Vec4us *output, int scanline_pixel_length)
 {
 	switch (color_type)
 	{
-	case 0: grayscale_to_4us(scanline_pixel_length); break;
-	case 2: truecolor_to_4us(scanline_pixel_length); break;
-	case 4: grayscale_alpha_to_4us(scanline_pixel_length); break;
-	case 6: truecolor_alpha_to_4us(scanline_pixel_length); break;
+	case 0: grayscale_to_4us(output, scanline_pixel_length); break;
+	case 2: truecolor_to_4us(output, scanline_pixel_length); break;
+	case 4: grayscale_alpha_to_4us(output, scanline_pixel_length); break;
+	case 6: truecolor_alpha_to_4us(output, scanline_pixel_length); break;
 	default: throw Exception("Invalid PNG image file");
 	}
 }
 
-void PNGLoader::grayscale_to_4ub(int count)
+void PNGLoader::grayscale_to_4ub(Vec4ub *output, int count)
 {
 	unsigned char *input = scanline;
 	if (bit_depth == 1)
@@ -474,7 +584,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 				int shift = i % 8;
 				unsigned char value = (input[i/8] >> shift) & 1;
 				value = static_cast<int>(value) * 255;
-				scanline_4ub[i] = Vec4ub(value, value, value, 255);
+				output[i] = Vec4ub(value, value, value, 255);
 			}
 		}
 		else
@@ -485,7 +595,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 				unsigned char value = (input[i/8] >> shift) & 1;
 				unsigned char alpha = (value != colorkey.r) ? 255 : 0;
 				value = static_cast<int>(value) * 255;
-				scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+				output[i] = Vec4ub(value, value, value, alpha);
 			}
 		}
 	}
@@ -498,7 +608,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 				int shift = (i % 4) * 2;
 				unsigned char value = (input[i/4] >> shift) & 3;
 				value = (static_cast<int>(value) * 255 + 1) / 2;
-				scanline_4ub[i] = Vec4ub(value, value, value, 255);
+				output[i] = Vec4ub(value, value, value, 255);
 			}
 		}
 		else
@@ -509,7 +619,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 				unsigned char value = (input[i/4] >> shift) & 3;
 				unsigned char alpha = (value != colorkey.r) ? 255 : 0;
 				value = (static_cast<int>(value) * 255 + 1) / 2;
-				scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+				output[i] = Vec4ub(value, value, value, alpha);
 			}
 		}
 	}
@@ -522,7 +632,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 				int shift = (i % 2) * 4;
 				unsigned char value = (input[i/4] >> shift) & 15;
 				value = (static_cast<int>(value) * 255 + 8) / 16;
-				scanline_4ub[i] = Vec4ub(value, value, value, 255);
+				output[i] = Vec4ub(value, value, value, 255);
 			}
 		}
 		else
@@ -533,7 +643,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 				unsigned char value = (input[i/4] >> shift) & 15;
 				unsigned char alpha = (value != colorkey.r) ? 255 : 0;
 				value = (static_cast<int>(value) * 255 + 8) / 16;
-				scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+				output[i] = Vec4ub(value, value, value, alpha);
 			}
 		}
 	}
@@ -544,7 +654,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 			for (int i = 0; i < count; i++)
 			{
 				unsigned char value = input[i];
-				scanline_4ub[i] = Vec4ub(value, value, value, 255);
+				output[i] = Vec4ub(value, value, value, 255);
 			}
 		}
 		else
@@ -553,7 +663,7 @@ void PNGLoader::grayscale_to_4ub(int count)
 			{
 				unsigned char value = input[i];
 				unsigned char alpha = (value != colorkey.r) ? 255 : 0;
-				scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+				output[i] = Vec4ub(value, value, value, alpha);
 			}
 		}
 	}
@@ -563,21 +673,25 @@ void PNGLoader::grayscale_to_4ub(int count)
 	}
 }
 
-void PNGLoader::truecolor_to_4ub(int count)
+void PNGLoader::truecolor_to_4ub(Vec4ub *output, int count)
 {
 	if (bit_depth != 8)
 		throw Exception("Invalid PNG image file");
 
 	unsigned char *input = scanline;
 
-	if (!has_colorkey)
+	if (truecolor_converter)
+	{
+		truecolor_converter->convert(output, input, count);
+	}
+	else if (!has_colorkey)
 	{
 		for (int i = 0; i < count; i++)
 		{
 			unsigned char red = input[i * 3 + 0];
 			unsigned char green = input[i * 3 + 1];
 			unsigned char blue = input[i * 3 + 2];
-			scanline_4ub[i] = Vec4ub(red, green, blue, 255);
+			output[i] = Vec4ub(red, green, blue, 255);
 		}
 	}
 	else
@@ -590,12 +704,12 @@ void PNGLoader::truecolor_to_4ub(int count)
 			unsigned char alpha = 255;
 			if (red == colorkey.r && green == colorkey.g && blue == colorkey.b)
 				alpha = 0;
-			scanline_4ub[i] = Vec4ub(red, green, blue, alpha);
+			output[i] = Vec4ub(red, green, blue, alpha);
 		}
 	}
 }
 
-void PNGLoader::indexed_to_4ub(int count)
+void PNGLoader::indexed_to_4ub(Vec4ub *output, int count)
 {
 	unsigned char *input = scanline;
 	if (bit_depth == 1)
@@ -604,7 +718,7 @@ void PNGLoader::indexed_to_4ub(int count)
 		{
 			int shift = i % 8;
 			unsigned char value = (input[i/8] >> shift) & 1;
-			scanline_4ub[i] = palette[value];
+			output[i] = palette[value];
 		}
 	}
 	else if (bit_depth == 2)
@@ -613,7 +727,7 @@ void PNGLoader::indexed_to_4ub(int count)
 		{
 			int shift = (i % 4) * 2;
 			unsigned char value = (input[i/4] >> shift) & 3;
-			scanline_4ub[i] = palette[value];
+			output[i] = palette[value];
 		}
 	}
 	else if (bit_depth == 4)
@@ -622,7 +736,7 @@ void PNGLoader::indexed_to_4ub(int count)
 		{
 			int shift = (i % 2) * 4;
 			unsigned char value = (input[i/4] >> shift) & 15;
-			scanline_4ub[i] = palette[value];
+			output[i] = palette[value];
 		}
 	}
 	else if (bit_depth == 8)
@@ -630,7 +744,7 @@ void PNGLoader::indexed_to_4ub(int count)
 		for (int i = 0; i < count; i++)
 		{
 			unsigned char value = input[i];
-			scanline_4ub[i] = palette[value];
+			output[i] = palette[value];
 		}
 	}
 	else
@@ -639,7 +753,7 @@ void PNGLoader::indexed_to_4ub(int count)
 	}
 }
 
-void PNGLoader::grayscale_alpha_to_4ub(int count)
+void PNGLoader::grayscale_alpha_to_4ub(Vec4ub *output, int count)
 {
 	if (bit_depth != 8)
 		throw Exception("Invalid PNG image file");
@@ -649,27 +763,21 @@ void PNGLoader::grayscale_alpha_to_4ub(int count)
 	{
 		unsigned char value = input[i * 2];
 		unsigned char alpha = input[i * 2 + 1];
-		scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+		output[i] = Vec4ub(value, value, value, alpha);
 	}
 }
 
-void PNGLoader::truecolor_alpha_to_4ub(int count)
+void PNGLoader::truecolor_alpha_to_4ub(Vec4ub *output, int count)
 {
 	if (bit_depth != 8)
 		throw Exception("Invalid PNG image file");
 
-	unsigned char *input = scanline;
-	for (int i = 0; i < count; i++)
-	{
-		unsigned char red = input[i * 4 + 0];
-		unsigned char green = input[i * 4 + 1];
-		unsigned char blue = input[i * 4 + 2];
-		unsigned char alpha = input[i * 4 + 3];
-		scanline_4ub[i] = Vec4ub(red, green, blue, alpha);
-	}
+	// Same byte layout as the output
+	static_assert(sizeof(Vec4ub) == 4, "Vec4ub must be tightly packed");
+	memcpy(reinterpret_cast<unsigned char *>(output), scanline, count * 4);
 }
 
-void PNGLoader::grayscale_to_4us(int count)
+void PNGLoader::grayscale_to_4us(Vec4us *output, int count)
 {
 	if (bit_depth != 16)
 		throw Exception("Invalid PNG image file");
@@ -680,7 +788,7 @@ void PNGLoader::grayscale_to_4us(int count)
 		for (int i = 0; i < count; i++)
 		{
 			unsigned short value = from_network_order(input[i]);
-			scanline_4us[i] = Vec4us(value, value, value, 65535);
+			output[i] = Vec4us(value, value, value, 65535);
 		}
 	}
 	else
@@ -689,12 +797,12 @@ void PNGLoader::grayscale_to_4us(int count)
 		{
 			unsigned short value = from_network_order(input[i]);
 			unsigned short alpha = (value != colorkey.r) ? 65535 : 0;
-			scanline_4us[i] = Vec4us(value, value, value, alpha);
+			output[i] = Vec4us(value, value, value, alpha);
 		}
 	}
 }
 
-void PNGLoader::truecolor_to_4us(int count)
+void PNGLoader::truecolor_to_4us(Vec4us *output, int count)
 {
 	if (bit_depth != 16)
 		throw Exception("Invalid PNG image file");
@@ -707,7 +815,7 @@ void PNGLoader::truecolor_to_4us(int count)
 			unsigned short red = from_network_order(input[i * 3 + 0]);
 			unsigned short green = from_network_order(input[i * 3 + 1]);
 			unsigned short blue = from_network_order(input[i * 3 + 2]);
-			scanline_4us[i] = Vec4us(red, green, blue, 65535);
+			output[i] = Vec4us(red, green, blue, 65535);
 		}
 	}
 	else
@@ -720,12 +828,12 @@ void PNGLoader::truecolor_to_4us(int count)
 			unsigned short alpha = 65535;
 			if (red == colorkey.r && green == colorkey.g && blue == colorkey.b)
 				alpha = 0;
-			scanline_4us[i] = Vec4us(red, green, blue, alpha);
+			output[i] = Vec4us(red, green, blue, alpha);
 		}
 	}
 }
 
-void PNGLoader::grayscale_alpha_to_4us(int count)
+void PNGLoader::grayscale_alpha_to_4us(Vec4us *output, int count)
 {
 	if (bit_depth != 16)
 		throw Exception("Invalid PNG image file");
@@ -735,15 +843,23 @@ void PNGLoader::grayscale_alpha_to_4us(int count)
 	{
 		unsigned short value = from_network_order(input[i * 2]);
 		unsigned short alpha = from_network_order(input[i * 2 + 1]);
-		scanline_4us[i] = Vec4us(value, value, value, alpha);
+		output[i] = Vec4us(value, value, value, alpha);
 	}
 }
 
-void PNGLoader::truecolor_alpha_to_4us(int count)
+void PNGLoader::truecolor_alpha_to_4us(Vec4us *output, int count)
 {
 	if (bit_depth != 16)
 		throw Exception("Invalid PNG image file");
 
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+	if (sse2)
+	{
+		PNGLoaderSSE::swap_bytes_16(scanline, reinterpret_cast<unsigned short*>(output), count * 4);
+		return;
+	}
+#endif
+
 	unsigned short *input = reinterpret_cast<unsigned short*>(scanline);
 	for (int i = 0; i < count; i++)
 	{
@@ -751,7 +867,7 @@ void PNGLoader::truecolor_alpha_to_4us(int count)
 		unsigned short green = from_network_order(input[i * 4 + 1]);
 		unsigned short blue = from_network_order(input[i * 4 + 2]);
 		unsigned short alpha = from_network_order(input[i * 4 + 3]);
-		scanline_4us[i] = Vec4us(red, green, blue, alpha);
+		output[i] = Vec4us(red, green, blue, alpha);
 	}
 }
 
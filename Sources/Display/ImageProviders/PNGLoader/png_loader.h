@@ -31,27 +31,40 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Core/System/databuffer.h"
+#include "Core/Zip/miniz.h"
 #include <map>
+#include <functional>
+#include <memory>
 
 namespace clan
 {
 
+class PixelConverterDirect;
+
 class PNGLoader
 {
 public:
-	static PixelBuffer load(IODevice iodevice, bool srgb);
+	static PixelBuffer load(IODevice iodevice, bool srgb, const std::function<void(const PixelBuffer &image, int y, int height)> &rows_decoded = std::function<void(const PixelBuffer &, int, int)>());
+
+	/// \brief Number of rows passed to each rows decoded callback for non-interlaced images
+	static const int rows_per_band = 64;
 
 private:
-	PNGLoader(IODevice iodevice, bool force_srgb);
+	PNGLoader(IODevice iodevice, bool force_srgb, const std::function<void(const PixelBuffer &image, int y, int height)> &rows_decoded);
 	~PNGLoader();
+	void free_buffers();
 	void read_magic();
 	void read_chunks();
+	std::string read_chunk(DataBuffer &data);
+	void read_idat_chunk();
+	void read_image_data(unsigned char *data, int size);
+	void read_trailing_chunks();
 	void decode_header();
 	void decode_palette();
 	void decode_colorkey();
 	void decode_image();
-	void decode_interlace_none(const unsigned char *data, int data_length);
-	void decode_interlace_adam7(const unsigned char *data, int data_length);
+	void decode_interlace_none();
+	void decode_interlace_adam7();
 
 	void create_image();
 	void create_scanline_buffers();
@@ -63,19 +76,19 @@ private:
 	static void predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
 	static void predictor_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
 
-	void convert_scanline_4ub(int scanline_pixel_length);
-	void convert_scanline_4us(int scanline_pixel_length);
+	void convert_scanline_4ub(Vec4ub *output, int scanline_pixel_length);
+	void convert_scanline_4us(Vec4us *output, int scanline_pixel_length);
 
-	void grayscale_to_4ub(int count);
-	void truecolor_to_4ub(int count);
-	void indexed_to_4ub(int count);
-	void grayscale_alpha_to_4ub(int count);
-	void truecolor_alpha_to_4ub(int count);
+	void grayscale_to_4ub(Vec4ub *output, int count);
+	void truecolor_to_4ub(Vec4ub *output, int count);
+	void indexed_to_4ub(Vec4ub *output, int count);
+	void grayscale_alpha_to_4ub(Vec4ub *output, int count);
+	void truecolor_alpha_to_4ub(Vec4ub *output, int count);
 
-	void grayscale_to_4us(int count);
-	void truecolor_to_4us(int count);
-	void grayscale_alpha_to_4us(int count);
-	void truecolor_alpha_to_4us(int count);
+	void grayscale_to_4us(Vec4us *output, int count);
+	void truecolor_to_4us(Vec4us *output, int count);
+	void grayscale_alpha_to_4us(Vec4us *output, int count);
+	void truecolor_alpha_to_4us(Vec4us *output, int count);
 	
 	static int abs(int a) { return a >= 0 ? a : -a; }
 
@@ -93,12 +106,15 @@ private:
 
 	IODevice file;
 	bool force_srgb;
+	bool sse2;
+	std::function<void(const PixelBuffer &image, int y, int height)> rows_decoded;
 
 	PixelBuffer image;
 
 	DataBuffer ihdr; // image header, which is the first chunk in a PNG datastream.
 	DataBuffer plte; // palette table associated with indexed PNG images.
-	DataBuffer idat; // image data chunks.
+	DataBuffer idat_chunk; // image data chunk currently being inflated.
+	mz_stream zs;
 
 	DataBuffer trns; // Transparency information
 	DataBuffer chrm; // Colour space information (5 chunks)
@@ -119,6 +135,7 @@ private:
 	unsigned char *prev_scanline;
 	Vec4ub *scanline_4ub;
 	Vec4us *scanline_4us;
+	std::unique_ptr<PixelConverterDirect> truecolor_converter;
 
 	Vec4ub *palette;
 	Vec3us colorkey;
@@ -0,0 +1,193 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "png_loader_sse.h"
+#include <cstring>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+
+namespace clan
+{
+
+namespace
+{
+	// Pixels are 3 or 4 bytes, so they are moved through the low 32 bits of a register.
+	// Loads always read 4 bytes (the scanlines are padded), the extra byte of a 3 byte pixel is carried along in its own lane and never stored.
+	// A 3 byte store must not touch the byte after the pixel, as that is the next filtered value.
+
+	inline __m128i load_pixel(const unsigned char *p)
+	{
+		int value;
+		memcpy(&value, p, 4);
+		return _mm_cvtsi32_si128(value);
+	}
+
+	template<int bytes_per_pixel>
+	inline void store_pixel(unsigned char *p, __m128i pixel)
+	{
+		int value = _mm_cvtsi128_si32(pixel);
+		memcpy(p, &value, bytes_per_pixel);
+	}
+
+	template<int bytes_per_pixel>
+	void unfilter_sub(unsigned char *scanline, int byte_length)
+	{
+		__m128i a = _mm_setzero_si128();
+		int i = 0;
+		for (; i + bytes_per_pixel <= byte_length; i += bytes_per_pixel)
+		{
+			a = _mm_add_epi8(a, load_pixel(scanline + i));
+			store_pixel<bytes_per_pixel>(scanline + i, a);
+		}
+	}
+
+	template<int bytes_per_pixel>
+	void unfilter_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+	{
+		// _mm_avg_epu8 rounds up, so the low bit of a ^ b is subtracted to get (a + b) / 2
+		__m128i one = _mm_set1_epi8(1);
+		__m128i a = _mm_setzero_si128();
+		int i = 0;
+		for (; i + bytes_per_pixel <= byte_length; i += bytes_per_pixel)
+		{
+			__m128i b = load_pixel(prev_scanline + i);
+			__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+			a = _mm_add_epi8(load_pixel(scanline + i), average);
+			store_pixel<bytes_per_pixel>(scanline + i, a);
+		}
+	}
+
+	inline __m128i abs_epi16(__m128i value)
+	{
+		return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+	}
+
+	inline __m128i select(__m128i mask, __m128i if_true, __m128i if_false)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, if_true), _mm_andnot_si128(mask, if_false));
+	}
+
+	template<int bytes_per_pixel>
+	void unfilter_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+	{
+		// Computed in 16 bit lanes: with p = a + b - c, the distances are |p - a| = |b - c|, |p - b| = |a - c| and |p - c| = |(b - c) + (a - c)|
+		__m128i zero = _mm_setzero_si128();
+		__m128i a = zero;
+		__m128i c = zero;
+		int i = 0;
+		for (; i + bytes_per_pixel <= byte_length; i += bytes_per_pixel)
+		{
+			__m128i b = _mm_unpacklo_epi8(load_pixel(prev_scanline + i), zero);
+			__m128i x = _mm_unpacklo_epi8(load_pixel(scanline + i), zero);
+
+			__m128i pa = _mm_sub_epi16(b, c);
+			__m128i pb = _mm_sub_epi16(a, c);
+			__m128i pc = abs_epi16(_mm_add_epi16(pa, pb));
+			pa = abs_epi16(pa);
+			pb = abs_epi16(pb);
+
+			__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+			__m128i predictor = select(_mm_cmpeq_epi16(pa, smallest), a, select(_mm_cmpeq_epi16(pb, smallest), b, c));
+
+			a = _mm_and_si128(_mm_add_epi16(x, predictor), _mm_set1_epi16(0xff));
+			c = b;
+			store_pixel<bytes_per_pixel>(scanline + i, _mm_packus_epi16(a, a));
+		}
+	}
+}
+
+bool PNGLoaderSSE::is_supported(int predictor_type, int bytes_per_pixel)
+{
+	switch (predictor_type)
+	{
+	case 1: // sub
+	case 3: // average
+	case 4: // paeth
+		return bytes_per_pixel == 3 || bytes_per_pixel == 4;
+	case 2: // up
+		return true;
+	default:
+		return false;
+	}
+}
+
+void PNGLoaderSSE::predictor_sub(unsigned char *scanline, int byte_length, int bytes_per_pixel)
+{
+	if (bytes_per_pixel == 4)
+		unfilter_sub<4>(scanline, byte_length);
+	else
+		unfilter_sub<3>(scanline, byte_length);
+}
+
+void PNGLoaderSSE::predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+{
+	int i = 0;
+	for (; i + 16 <= byte_length; i += 16)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(scanline + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_scanline + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(scanline + i), _mm_add_epi8(x, b));
+	}
+	for (; i < byte_length; i++)
+		scanline[i] += prev_scanline[i];
+}
+
+void PNGLoaderSSE::predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
+{
+	if (bytes_per_pixel == 4)
+		unfilter_average<4>(scanline, prev_scanline, byte_length);
+	else
+		unfilter_average<3>(scanline, prev_scanline, byte_length);
+}
+
+void PNGLoaderSSE::predictor_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
+{
+	if (bytes_per_pixel == 4)
+		unfilter_paeth<4>(scanline, prev_scanline, byte_length);
+	else
+		unfilter_paeth<3>(scanline, prev_scanline, byte_length);
+}
+
+void PNGLoaderSSE::swap_bytes_16(const unsigned char *input, unsigned short *output, int count)
+{
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 2));
+		values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), values);
+	}
+	for (; i < count; i++)
+		output[i] = (input[i * 2] << 8) | input[i * 2 + 1];
+}
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+namespace clan
+{
+
+/// \brief PNG scanline unfilter kernels implemented with SSE2
+///
+/// The Sub, Average and Paeth predictors are handled for 3 and 4 bytes per pixel, which covers 8 bit truecolor
+/// with and without alpha. Up works for any pixel size.
+///
+/// The scanlines must be readable for scanline_padding bytes past their end.
+class PNGLoaderSSE
+{
+public:
+	static const int scanline_padding = 4;
+
+	/// \brief Returns true if the predictor has a kernel for the pixel size
+	static bool is_supported(int predictor_type, int bytes_per_pixel);
+
+	static void predictor_sub(unsigned char *scanline, int byte_length, int bytes_per_pixel);
+	static void predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length);
+	static void predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+	static void predictor_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+
+	/// \brief Converts 16 bit values from network byte order
+	static void swap_bytes_16(const unsigned char *input, unsigned short *output, int count);
+};
+
+}
@@ -66,6 +66,11 @@ PixelBuffer PNGProvider::load(IODevice &file, bool srgb)
 	return PNGLoader::load(file, srgb);
 }
 
+PixelBuffer PNGProvider::load(IODevice &file, bool srgb, const std::function<void(const PixelBuffer &image, int y, int height)> &rows_decoded)
+{
+	return PNGLoader::load(file, srgb, rows_decoded);
+}
+
 void PNGProvider::save(
 	PixelBuffer buffer,
 	const std::string &filename,
@@ -36,11 +36,192 @@
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/memory_device.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
 #include "../setup_display.h"
+#include <exception>
+#include <mutex>
 
 namespace clan
 {
 
+namespace
+{
+	ImageProviderType *find_provider_type(const std::string &type)
+	{
+		auto &types = *SetupDisplay::get_image_provider_factory_types();
+		auto it = types.find(StringHelp::text_to_lower(type));
+		if (it == types.end()) throw Exception("Unknown image provider type " + type);
+		return it->second;
+	}
+
+	void decode_batch_image(ImageProviderBatchResult &result, IODevice &file, ImageProviderType *provider, bool srgb)
+	{
+		uint64_t start_time = System::get_microseconds();
+		result.image = provider->load(file, srgb);
+		result.decode_microseconds = System::get_microseconds() - start_time;
+	}
+
+	/// \brief Serializes the file reads of all batches, as a file system may not support concurrent access
+	///
+	/// A single mutex is used because several batches may read from the same file system, or from copies of it.
+	std::mutex &get_batch_fs_mutex()
+	{
+		static std::mutex fs_mutex;
+		return fs_mutex;
+	}
+
+	/// \brief Marks the image as failed
+	///
+	/// A clan::Exception only fails the image. Other exceptions are returned too, so that they can be rethrown on the calling thread.
+	std::exception_ptr fail_batch_image(ImageProviderBatchResult &result, const std::string &failure_reason, const std::exception_ptr &exception)
+	{
+		result.image = PixelBuffer();
+		result.failure_reason = failure_reason;
+		return exception;
+	}
+
+	/// \brief Reads the whole file while holding the batch file system mutex, then decodes it
+	std::exception_ptr load_batch_file(ImageProviderBatchResult &result, const FileSystem &fs, bool srgb)
+	{
+		try
+		{
+			ImageProviderType *provider = find_provider_type(PathHelp::get_extension(result.filename, PathHelp::path_type_virtual));
+
+			uint64_t start_time = System::get_microseconds();
+			DataBuffer data;
+			{
+				std::unique_lock<std::mutex> lock(get_batch_fs_mutex());
+				IODevice file = fs.open_file(result.filename);
+				int64_t size = file.get_size();
+				if (size > 0xffffffff)
+					throw Exception("File " + result.filename + " is too big to be loaded into memory");
+				data.set_size((unsigned int)size);
+				int64_t pos = 0;
+				while (pos < size)
+				{
+					// A single read transfers at most 2 GB
+					int received = file.read(data.get_data() + pos, (int)min(size - pos, (int64_t)0x40000000));
+					if (received <= 0)
+						throw Exception("Unable to read " + result.filename);
+					pos += received;
+				}
+			}
+			result.read_microseconds = System::get_microseconds() - start_time;
+
+			MemoryDevice device(data);
+			decode_batch_image(result, device, provider, srgb);
+		}
+		catch (const Exception &e)
+		{
+			return fail_batch_image(result, e.message, std::exception_ptr());
+		}
+		catch (const std::exception &e)
+		{
+			return fail_batch_image(result, e.what(), std::current_exception());
+		}
+		catch (...)
+		{
+			return fail_batch_image(result, "Unknown exception", std::current_exception());
+		}
+		return std::exception_ptr();
+	}
+
+	std::exception_ptr load_batch_device(ImageProviderBatchResult &result, IODevice &file, ImageProviderType *provider, bool srgb)
+	{
+		try
+		{
+			decode_batch_image(result, file, provider, srgb);
+		}
+		catch (const Exception &e)
+		{
+			return fail_batch_image(result, e.message, std::exception_ptr());
+		}
+		catch (const std::exception &e)
+		{
+			return fail_batch_image(result, e.what(), std::current_exception());
+		}
+		catch (...)
+		{
+			return fail_batch_image(result, "Unknown exception", std::current_exception());
+		}
+		return std::exception_ptr();
+	}
+
+	/// \brief Rethrows an exception captured on a worker thread
+	///
+	/// The exception is cleared first. process_work_completed keeps the item queued when work_completed throws,
+	/// so the next call reports the image as failed instead of throwing again.
+	void rethrow_batch_exception(std::exception_ptr &exception)
+	{
+		std::exception_ptr e = exception;
+		exception = std::exception_ptr();
+		std::rethrow_exception(e);
+	}
+
+	class ImageProviderBatchFileItem : public WorkItem
+	{
+	public:
+		ImageProviderBatchFileItem(const FileSystem &fs, const std::function<void(const ImageProviderBatchResult &)> &file_loaded, bool srgb)
+			: fs(fs), file_loaded(file_loaded), srgb(srgb)
+		{
+		}
+
+		void process_work() override
+		{
+			exception = load_batch_file(result, fs, srgb);
+		}
+
+		void work_completed() override
+		{
+			if (exception)
+				rethrow_batch_exception(exception);
+			file_loaded(result);
+		}
+
+		ImageProviderBatchResult result;
+
+	private:
+		FileSystem fs;
+		std::exception_ptr exception;
+		std::function<void(const ImageProviderBatchResult &)> file_loaded;
+		bool srgb;
+	};
+
+	class ImageProviderBatchDeviceItem : public WorkItem
+	{
+	public:
+		ImageProviderBatchDeviceItem(const IODevice &file, ImageProviderType *provider, const std::function<void(const ImageProviderBatchResult &)> &file_loaded, bool srgb)
+			: file(file), provider(provider), file_loaded(file_loaded), srgb(srgb)
+		{
+		}
+
+		void process_work() override
+		{
+			exception = load_batch_device(result, file, provider, srgb);
+			file = IODevice();
+		}
+
+		void work_completed() override
+		{
+			if (exception)
+				rethrow_batch_exception(exception);
+			file_loaded(result);
+		}
+
+		ImageProviderBatchResult result;
+
+	private:
+		IODevice file;
+		std::exception_ptr exception;
+		ImageProviderType *provider;
+		std::function<void(const ImageProviderBatchResult &)> file_loaded;
+		bool srgb;
+	};
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ImageProviderFactory operations:
 
@@ -114,6 +295,74 @@ PixelBuffer ImageProviderFactory::load(
 	return ImageProviderFactory::load(filename, vfs, type, srgb);
 }
 
+void ImageProviderFactory::load_batch(
+	WorkQueue &queue,
+	const std::vector<std::string> &filenames,
+	const FileSystem &fs,
+	const std::function<void(const ImageProviderBatchResult &result)> &file_loaded,
+	bool srgb)
+{
+	SetupDisplay::start();
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		ImageProviderBatchFileItem *item = new ImageProviderBatchFileItem(fs, file_loaded, srgb);
+		item->result.index = (int)i;
+		item->result.filename = filenames[i];
+		queue.queue(item);
+	}
+}
+
+void ImageProviderFactory::load_batch(
+	WorkQueue &queue,
+	const std::vector<IODevice> &files,
+	const std::vector<std::string> &types,
+	const std::function<void(const ImageProviderBatchResult &result)> &file_loaded,
+	bool srgb)
+{
+	SetupDisplay::start();
+	if (files.size() != types.size())
+		throw Exception("Each file in an image batch needs a provider type");
+
+	std::vector<ImageProviderType *> providers;
+	for (auto & type : types)
+		providers.push_back(find_provider_type(type));
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		ImageProviderBatchDeviceItem *item = new ImageProviderBatchDeviceItem(files[i], providers[i], file_loaded, srgb);
+		item->result.index = (int)i;
+		queue.queue(item);
+	}
+}
+
+std::vector<ImageProviderBatchResult> ImageProviderFactory::load_batch(
+	const std::vector<std::string> &filenames,
+	const FileSystem &fs,
+	bool srgb)
+{
+	SetupDisplay::start();
+	std::vector<ImageProviderBatchResult> results(filenames.size());
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		results[i].index = (int)i;
+		results[i].filename = filenames[i];
+	}
+
+	std::vector<std::exception_ptr> exceptions(filenames.size());
+	SetupDisplay::get_work_queue().parallel_for((int)results.size(), 1, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+			exceptions[i] = load_batch_file(results[i], fs, srgb);
+	});
+
+	for (auto & exception : exceptions)
+	{
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+	return results;
+}
+
 void ImageProviderFactory::save(
 	PixelBuffer buffer,
 	const std::string &filename,
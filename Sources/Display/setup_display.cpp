@@ -35,6 +35,7 @@
 #include "API/Display/ImageProviders/png_provider.h"
 #include "API/Display/Resources/display_cache.h"
 #include "API/Core/Resources/resource_manager.h"
+#include "API/Core/System/work_queue.h"
 #include "API/Core/Resources/xml_resource_manager.h"
 #include "API/Core/Resources/xml_resource_document.h"
 #include "API/Core/Resources/file_resource_manager.h"
@@ -81,6 +82,8 @@ namespace clan
 		ProviderType_Register<TargaProvider> *targa_provider = nullptr;
 		ProviderType_Register<TargaProvider> *tga_provider = nullptr;
 
+		WorkQueue work_queue;
+
 #if defined(WIN32)
 		DisplayMessageQueue_Win32 message_queue;
 #elif defined(__APPLE__)
@@ -171,5 +174,12 @@ namespace clan
 		return &SetupDisplay_Impl::instance->image_provider_factory_types;
 	}
 
+	WorkQueue &SetupDisplay::get_work_queue()
+	{
+		if (!SetupDisplay_Impl::instance)
+			start();
+		return SetupDisplay_Impl::instance->work_queue;
+	}
+
 }
 
@@ -37,6 +37,7 @@ namespace clan
 	class DisplayMessageQueue_Win32;
 	class DisplayMessageQueue_X11;
 	class ImageProviderType;
+	class WorkQueue;
 
 	class SetupDisplay
 	{
@@ -50,6 +51,9 @@ namespace clan
 #endif
 		static std::map<std::string, ImageProviderType *> *get_image_provider_factory_types();
 
+		/// \brief Worker threads shared by the image conversion routines
+		static WorkQueue &get_work_queue();
+
 	};
 
 }
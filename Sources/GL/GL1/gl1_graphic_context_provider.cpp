@@ -36,11 +36,13 @@
 #include "gl1_render_buffer_provider.h"
 #include "gl1_primitives_array_provider.h"
 #include "gl1_vertex_array_buffer_provider.h"
+#include "gl1_element_array_buffer_provider.h"
 #include "gl1_uniform_buffer_provider.h"
 #include "gl1_transfer_buffer_provider.h"
 #include "API/Core/IOData/cl_endian.h"
 #include "API/Core/System/databuffer.h"
 #include "API/Core/Math/vec3.h"
+#include "API/Core/Math/cl_math.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Display/Render/texture.h"
@@ -84,7 +86,8 @@ public:
 GL1GraphicContextProvider::GL1GraphicContextProvider(OpenGLWindowProvider * render_window)
 : render_window(render_window),
   prim_arrays_set(false), num_set_tex_arrays(0),
-  primitives_array_texture_set(false), primitives_array_texindex_set(false), scissor_enabled(false),
+  primitives_array_texture_set(false), primitives_array_texture_normalize(false), primitives_array_texindex_set(false),
+  program_projection_set(false), primitives_elements(nullptr), scissor_enabled(false),
   framebuffer_bound(false)
 {
 	check_opengl_version();
@@ -302,7 +305,7 @@ StorageBufferProvider *GL1GraphicContextProvider::alloc_storage_buffer()
 
 ElementArrayBufferProvider *GL1GraphicContextProvider::alloc_element_array_buffer()
 {
-	throw Exception("Element Array Buffers are not supported for OpenGL 1.3");
+	return new GL1ElementArrayBufferProvider;
 }
 
 TransferBufferProvider *GL1GraphicContextProvider::alloc_transfer_buffer()
@@ -561,6 +564,7 @@ void GL1GraphicContextProvider::reset_frame_buffer()
 
 void GL1GraphicContextProvider::set_program_object(StandardProgram standard_program)
 {
+	program_projection_set = (standard_program == program_sprite_packed);
 }
 
 ProgramObject GL1GraphicContextProvider::get_program_object(StandardProgram standard_program) const
@@ -575,6 +579,7 @@ void GL1GraphicContextProvider::set_program_object(const ProgramObject &program)
 
 void GL1GraphicContextProvider::reset_program_object()
 {
+	program_projection_set = false;
 }
 
 bool GL1GraphicContextProvider::is_primitives_array_owner(const PrimitivesArray &primitives_array)
@@ -625,6 +630,7 @@ void GL1GraphicContextProvider::set_primitives_array(const PrimitivesArray &prim
 				break;
 			case 2: // TEXTURE
 				primitives_array_texture = attribute;
+				primitives_array_texture_normalize = prim_array->normalize_attributes[attribute_index];
 				primitives_array_texture_set = true;
 				break;
 			case 3: // TEXINDEX
@@ -642,11 +648,13 @@ void GL1GraphicContextProvider::set_primitives_array(const PrimitivesArray &prim
 void GL1GraphicContextProvider::draw_primitives_array(PrimitivesType type, int offset, int num_vertices)
 {
 	set_active();
+	set_program_projection();
 
 	// Simple condition - No textures set
 	if (!primitives_array_texture_set)
 	{
 		glDrawArrays(OpenGL::to_enum(type), offset, num_vertices);
+		reset_program_projection();
 		return;
 	}
 
@@ -657,21 +665,16 @@ void GL1GraphicContextProvider::draw_primitives_array(PrimitivesType type, int o
 	// Normal condition - No texture index set
 	if (!primitives_array_texindex_set)
 	{
-		set_primitive_texture( 0, primitives_array_texture, offset, num_vertices, total_vertices );
+		set_primitive_texture( 0, primitives_array_texture, primitives_array_texture_normalize, offset, num_vertices, total_vertices );
 		glDrawArrays(primitive_type, offset, num_vertices);
 		reset_primitive_texture( 0 );
+		reset_program_projection();
 		return;
 	}
 
 	// For code simplicity, disable all textures
 	reset_primitive_texture_all();
 
-	GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(primitives_array_texindex.array_provider);
-	if (!vertex_array_ptr)
-		throw Exception("Invalid BindBuffer Provider");
-
-	const char *data_ptr = ((const char *) vertex_array_ptr->get_data()) + primitives_array_texindex.offset;
-
 	// Difficult condition - Draw all texture indexes
 	while(num_vertices > 0)
 	{
@@ -685,48 +688,24 @@ void GL1GraphicContextProvider::draw_primitives_array(PrimitivesType type, int o
 			texture_index = 0;
 			num_vertices_in_group = num_vertices;
 		}
-		// Multiple textures possible
-		switch(primitives_array_texindex.type)
+		else
 		{
-			case type_int:
-			{
-				int stride_float;
-				if (primitives_array_texindex.stride)
-				{
-					stride_float = (primitives_array_texindex.stride / sizeof(int));
-				}
-				else
-				{
-					stride_float = primitives_array_texindex.size;
-				}
-
-				int *dptr = (int *) data_ptr;
-				dptr += offset * stride_float;
-				num_vertices_in_group = 1;
-				texture_index = *dptr;
-				dptr += stride_float;
-				for (int texcnt = 1; texcnt < num_vertices; ++texcnt)
-				{
-					// Note, we assume all textures in "primitives_array_texindex.size" are identical
-					if ( (*dptr) != texture_index )
-						break;
-					dptr += stride_float;
-					num_vertices_in_group++;
-				}
-
-				break;
-			}
-			default:
-				throw Exception("Implement me!");
+			// Note, we assume all textures in "primitives_array_texindex.size" are identical
+			texture_index = get_primitive_texindex(offset);
+			num_vertices_in_group = 1;
+			while ( (num_vertices_in_group < num_vertices) && (get_primitive_texindex(offset + num_vertices_in_group) == texture_index) )
+				num_vertices_in_group++;
 		}
 
-		set_primitive_texture( texture_index, primitives_array_texture, offset, num_vertices_in_group, total_vertices );
+		set_primitive_texture( texture_index, primitives_array_texture, primitives_array_texture_normalize, offset, num_vertices_in_group, total_vertices );
 		glDrawArrays(primitive_type, offset, num_vertices_in_group);
 		reset_primitive_texture( texture_index );
 
 		offset += num_vertices_in_group;
 		num_vertices -=	num_vertices_in_group;
 	}
+
+	reset_program_projection();
 }
 
 void GL1GraphicContextProvider::draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count)
@@ -736,12 +715,15 @@ void GL1GraphicContextProvider::draw_primitives_array_instanced(PrimitivesType t
 
 void GL1GraphicContextProvider::set_primitives_elements(ElementArrayBufferProvider *array_provider)
 {
-	throw Exception("Cannot draw Element Array Buffers for the OpenGL 1.3 target");
+	primitives_elements = static_cast<GL1ElementArrayBufferProvider *>(array_provider);
 }
 
 void GL1GraphicContextProvider::draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset)
 {
-	throw Exception("Cannot draw Element Array Buffers for the OpenGL 1.3 target");
+	if (!primitives_elements)
+		throw Exception("No element array buffer set for the OpenGL 1.3 target");
+
+	draw_elements(type, count, ((const char *) primitives_elements->get_data()) + offset, indices_type);
 }
 
 void GL1GraphicContextProvider::draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count)
@@ -751,7 +733,7 @@ void GL1GraphicContextProvider::draw_primitives_elements_instanced(PrimitivesTyp
 
 void GL1GraphicContextProvider::reset_primitives_elements()
 {
-	throw Exception("Cannot draw Element Array Buffers for the OpenGL 1.3 target");
+	primitives_elements = nullptr;
 }
 
 void GL1GraphicContextProvider::draw_primitives_elements(
@@ -761,7 +743,8 @@ void GL1GraphicContextProvider::draw_primitives_elements(
 	VertexAttributeDataType indices_type,
 	void *offset)
 {
-	throw Exception("Cannot draw Element Array Buffers for the OpenGL 1.3 target");
+	GL1ElementArrayBufferProvider *element_array = static_cast<GL1ElementArrayBufferProvider *>(array_provider);
+	draw_elements(type, count, ((const char *) element_array->get_data()) + (size_t) offset, indices_type);
 }
 
 void GL1GraphicContextProvider::draw_primitives_elements_instanced(
@@ -932,7 +915,7 @@ OpenGLWindowProvider & GL1GraphicContextProvider::get_opengl_window()
 /////////////////////////////////////////////////////////////////////////////
 // GL1GraphicContextProvider Implementation:
 
-void GL1GraphicContextProvider::set_primitive_texture( int texture_index, PrimitivesArrayProvider::VertexData &array_texture, int offset, int num_vertices, int total_vertices)
+void GL1GraphicContextProvider::set_primitive_texture( int texture_index, PrimitivesArrayProvider::VertexData &array_texture, bool normalize, int offset, int num_vertices, int total_vertices)
 {
 	GL1TextureProvider *texture;
 	if ( (texture_index <0) || (texture_index >= max_texture_coords) )
@@ -957,7 +940,7 @@ void GL1GraphicContextProvider::set_primitive_texture( int texture_index, Primit
 
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
-		if (texture->is_power_of_two_texture() || (num_vertices==0))
+		if ((texture->is_power_of_two_texture() && array_texture.type == type_float) || (num_vertices==0))
 		{
 			GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(array_texture.array_provider);
 			if (!vertex_array_ptr)
@@ -969,8 +952,8 @@ void GL1GraphicContextProvider::set_primitive_texture( int texture_index, Primit
 		}
 		else
 		{
-			// A hack to handle non-power-of-two textures
-			texture->transform_coordinate(array_texture, transformed_coords, offset, num_vertices, total_vertices);
+			// A hack to handle non-power-of-two textures, also used to expand integer coordinates that glTexCoordPointer cannot normalize
+			texture->transform_coordinate(array_texture, normalize, transformed_coords, offset, num_vertices, total_vertices);
 			glTexCoordPointer(array_texture.size, GL_FLOAT, 0,  &transformed_coords[0]);
 		}
 	}
@@ -1017,4 +1000,133 @@ void GL1GraphicContextProvider::reset_primitive_texture_all()
 	}
 }
 
+int GL1GraphicContextProvider::get_primitive_texindex(int vertex) const
+{
+	GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(primitives_array_texindex.array_provider);
+	if (!vertex_array_ptr)
+		throw Exception("Invalid BindBuffer Provider");
+
+	const char *data_ptr = ((const char *) vertex_array_ptr->get_data()) + primitives_array_texindex.offset;
+	int stride = primitives_array_texindex.stride;
+
+	switch(primitives_array_texindex.type)
+	{
+		case type_int:
+			if (!stride)
+				stride = primitives_array_texindex.size * sizeof(int);
+			return *((const int *) (data_ptr + vertex * stride));
+		case type_unsigned_byte:
+			if (!stride)
+				stride = primitives_array_texindex.size;
+			return *((const unsigned char *) (data_ptr + vertex * stride));
+		default:
+			throw Exception("Implement me!");
+	}
+}
+
+static int get_element_index(const char *indices, VertexAttributeDataType indices_type, int position)
+{
+	switch(indices_type)
+	{
+		case type_unsigned_int:
+			return ((const unsigned int *) indices)[position];
+		case type_unsigned_short:
+			return ((const unsigned short *) indices)[position];
+		case type_unsigned_byte:
+			return ((const unsigned char *) indices)[position];
+		default:
+			throw Exception("Invalid element array index type for the OpenGL 1.3 target");
+	}
+}
+
+void GL1GraphicContextProvider::draw_elements(PrimitivesType type, int count, const char *indices, VertexAttributeDataType indices_type)
+{
+	set_active();
+	set_program_projection();
+
+	GLenum primitive_type = OpenGL::to_enum(type);
+	GLenum gl_indices_type = OpenGL::to_enum(indices_type);
+	int index_size = (indices_type == type_unsigned_int) ? 4 : ((indices_type == type_unsigned_short) ? 2 : 1);
+
+	// Simple condition - No textures set
+	if (!primitives_array_texture_set)
+	{
+		glDrawElements(primitive_type, count, gl_indices_type, indices);
+		reset_program_projection();
+		return;
+	}
+
+	// Texture coordinates are only transformed for the range of vertices referenced by each draw
+	if (!primitives_array_texindex_set || primitives_array_texindex.size <= 0)
+	{
+		int min_index = 0;
+		int max_index = -1;
+		for (int i = 0; i < count; i++)
+		{
+			int index = get_element_index(indices, indices_type, i);
+			min_index = (i == 0) ? index : min(min_index, index);
+			max_index = max(max_index, index);
+		}
+
+		set_primitive_texture( 0, primitives_array_texture, primitives_array_texture_normalize, min_index, max_index - min_index + 1, max_index + 1 );
+		glDrawElements(primitive_type, count, gl_indices_type, indices);
+		reset_primitive_texture( 0 );
+		reset_program_projection();
+		return;
+	}
+
+	// For code simplicity, disable all textures
+	reset_primitive_texture_all();
+
+	// Draw runs of elements that use the same texture index
+	int start = 0;
+	while (start < count)
+	{
+		int index = get_element_index(indices, indices_type, start);
+		int texture_index = get_primitive_texindex(index);
+		int min_index = index;
+		int max_index = index;
+
+		int end = start + 1;
+		while (end < count)
+		{
+			index = get_element_index(indices, indices_type, end);
+			if (get_primitive_texindex(index) != texture_index)
+				break;
+			min_index = min(min_index, index);
+			max_index = max(max_index, index);
+			end++;
+		}
+
+		set_primitive_texture( texture_index, primitives_array_texture, primitives_array_texture_normalize, min_index, max_index - min_index + 1, max_index + 1 );
+		glDrawElements(primitive_type, end - start, gl_indices_type, indices + start * index_size);
+		reset_primitive_texture( texture_index );
+
+		start = end;
+	}
+
+	reset_program_projection();
+}
+
+void GL1GraphicContextProvider::set_program_projection()
+{
+	// Vertices of the other standard programs are already projected by the caller
+	if (program_projection_set)
+	{
+		glMatrixMode(GL_PROJECTION);
+		glLoadMatrixf(internal_program_provider->projection_matrix);
+		glMatrixMode(GL_MODELVIEW);
+	}
+}
+
+void GL1GraphicContextProvider::reset_program_projection()
+{
+	if (program_projection_set)
+	{
+		glMatrixMode(GL_PROJECTION);
+		glLoadIdentity();
+		glMatrixMode(GL_MODELVIEW);
+	}
+}
+
 }
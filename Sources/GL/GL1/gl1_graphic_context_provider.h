@@ -62,6 +62,7 @@ class GL1FrameBufferProvider;
 class GL1SelectedTexture;
 class DisposableObject;
 class GL1ProgramObjectProvider;
+class GL1ElementArrayBufferProvider;
 class OpenGLWindowProvider;
 
 class GL1State
@@ -199,9 +200,13 @@ public:
 private:
 	void on_dispose() override;
 	void check_opengl_version();
-	void set_primitive_texture( int texture_index, PrimitivesArrayProvider::VertexData &array_texture, int offset, int num_vertices, int total_vertices);
+	void set_primitive_texture( int texture_index, PrimitivesArrayProvider::VertexData &array_texture, bool normalize, int offset, int num_vertices, int total_vertices);
 	void reset_primitive_texture( int texture_index);
 	void reset_primitive_texture_all();
+	int get_primitive_texindex(int vertex) const;
+	void draw_elements(PrimitivesType type, int count, const char *indices, VertexAttributeDataType indices_type);
+	void set_program_projection();
+	void reset_program_projection();
 
 	/// \brief OpenGL render window.
 	OpenGLWindowProvider * render_window;
@@ -216,6 +221,7 @@ private:
 
 	bool primitives_array_texture_set;
 	PrimitivesArrayProvider::VertexData primitives_array_texture;
+	bool primitives_array_texture_normalize;
 
 	bool primitives_array_texindex_set;
 	PrimitivesArrayProvider::VertexData primitives_array_texindex;
@@ -228,6 +234,11 @@ private:
 	ProgramObject internal_program;
 	GL1ProgramObjectProvider *internal_program_provider;		// Pointer is owned by "internal_program"
 
+	/// \brief True if the selected standard program takes its projection from the Projection uniform (program_sprite_packed)
+	bool program_projection_set;
+
+	GL1ElementArrayBufferProvider *primitives_elements;
+
 	bool scissor_enabled;
 
 	std::map<RasterizerStateDescription, std::shared_ptr<RasterizerStateProvider> > rasterizer_states;
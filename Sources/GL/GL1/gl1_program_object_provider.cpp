@@ -88,6 +88,9 @@ std::string GL1ProgramObjectProvider::get_info_log() const
 
 int GL1ProgramObjectProvider::get_uniform_location(const std::string &name) const
 {
+	// The fixed function pipeline applies the projection of program_sprite_packed
+	if (name == "Projection")
+		return projection_location;
 	return -1;
 }
 	
@@ -192,6 +195,8 @@ void GL1ProgramObjectProvider::set_uniformfv(int location, int size, int count,
 
 void GL1ProgramObjectProvider::set_uniform_matrix(int location, int size, int count, bool transpose, const float *data)
 {
+	if (location == projection_location && size == 4 && count >= 1)
+		projection_matrix = transpose ? Mat4f::transpose(Mat4f(data)) : Mat4f(data);
 }
 
 void GL1ProgramObjectProvider::set_uniform_buffer_index(int block_index, int bind_index)
@@ -134,6 +134,8 @@ private:
 
 	std::vector<ShaderObject> shaders;
 
+	enum { projection_location = 0 };
+
 	Mat4f modelview_matrix;
 	Mat4f projection_matrix;
 
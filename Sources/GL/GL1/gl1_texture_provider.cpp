@@ -50,7 +50,7 @@ namespace clan
 // GL1TextureProvider Construction:
 
 GL1TextureProvider::GL1TextureProvider(TextureDimensions texture_dimensions)
-: width(0), height(0), depth(0), handle(0), texture_type(0)
+: width(0), height(0), depth(0), pot_ratio_width(1.0f), pot_ratio_height(1.0f), pot_ratio_depth(1.0f), handle(0), texture_type(0)
 {
 	SharedGCData::add_disposable(this);
 	switch (texture_dimensions)
@@ -575,64 +575,79 @@ void GL1TextureProvider::set_texture_compare(TextureCompareMode mode, CompareFun
 	glTexParameteri(texture_type, GL_TEXTURE_COMPARE_FUNC, OpenGL::to_enum(func));	
 }
 
-void GL1TextureProvider::transform_coordinate(const PrimitivesArrayProvider::VertexData &attribute, std::vector<float> &transformed_data, int vertex_offset, int num_vertices, int total_vertices)
+void GL1TextureProvider::transform_coordinate(const PrimitivesArrayProvider::VertexData &attribute, bool normalize, std::vector<float> &transformed_data, int vertex_offset, int num_vertices, int total_vertices)
 {
-	if (attribute.type != type_float)
-	{
-		throw Exception("Implement me: Texture coord npot transformation (not float) (GL1 target)");
-	}
+	int size = attribute.size;
+	if ((size < 1) || (size > 3))
+		throw Exception("Implement me: Texture coord transformation (size) (GL1 target)");
 
 	int desired_size = attribute.size * (total_vertices);
 	if (transformed_data.size() < desired_size)
 		transformed_data.resize(desired_size);
 
-	int size = attribute.size;
-
-	int stride_float;
-	if (attribute.stride)
-	{
-		stride_float = (attribute.stride / sizeof(float));
-	}
-	else
-	{
-		stride_float = size;
-	}
-
-	int source_position = vertex_offset * stride_float;
-
 	GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(attribute.array_provider);
 	if (!vertex_array_ptr)
 		throw Exception("Invalid BindBuffer Provider");
 
 	const char *data_ptr = ((const char *) vertex_array_ptr->get_data()) + attribute.offset;
-
-	float *src = (float *) data_ptr;
 	float *dest = &transformed_data[vertex_offset * size];
+	float ratio[3] = { pot_ratio_width, pot_ratio_height, pot_ratio_depth };
+
+	switch (attribute.type)
+	{
+		case type_float:
+			transform_elements<float>(data_ptr, attribute.stride, size, 1.0f, ratio, dest, vertex_offset, num_vertices);
+			break;
+		case type_unsigned_byte:
+			transform_elements<unsigned char>(data_ptr, attribute.stride, size, normalize ? 1.0f / 255.0f : 1.0f, ratio, dest, vertex_offset, num_vertices);
+			break;
+		case type_unsigned_short:
+			transform_elements<unsigned short>(data_ptr, attribute.stride, size, normalize ? 1.0f / 65535.0f : 1.0f, ratio, dest, vertex_offset, num_vertices);
+			break;
+		case type_short:
+			transform_elements<short>(data_ptr, attribute.stride, size, normalize ? 1.0f / 32767.0f : 1.0f, ratio, dest, vertex_offset, num_vertices);
+			break;
+		case type_int:
+			transform_elements<int>(data_ptr, attribute.stride, size, normalize ? 1.0f / 2147483647.0f : 1.0f, ratio, dest, vertex_offset, num_vertices);
+			break;
+		default:
+			throw Exception("Implement me: Texture coord transformation (type) (GL1 target)");
+	}
+}
+
+template<typename Type>
+void GL1TextureProvider::transform_elements(const char *data_ptr, int stride, int size, float scale, const float *ratio, float *dest, int vertex_offset, int num_vertices)
+{
+	if (!stride)
+		stride = size * sizeof(Type);
 
-	stride_float -= size;
+	float scale_width = scale * ratio[0];
+	float scale_height = scale * ratio[1];
+	float scale_depth = scale * ratio[2];
 
+	const char *src = data_ptr + vertex_offset * stride;
 	if (size==1)
 	{
-		for (int vertex_count=0; vertex_count < num_vertices; vertex_count++, source_position += stride_float)
+		for (int vertex_count=0; vertex_count < num_vertices; vertex_count++, src += stride)
 		{
-			*(dest++) = src[source_position++] * pot_ratio_width;
+			*(dest++) = ((const Type *) src)[0] * scale_width;
 		}
 	}
 	else if (size==2)
 	{
-		for (int vertex_count=0; vertex_count < num_vertices; vertex_count++, source_position += stride_float)
+		for (int vertex_count=0; vertex_count < num_vertices; vertex_count++, src += stride)
 		{
-			*(dest++) = src[source_position++] * pot_ratio_width;
-			*(dest++) = src[source_position++] * pot_ratio_height;
+			*(dest++) = ((const Type *) src)[0] * scale_width;
+			*(dest++) = ((const Type *) src)[1] * scale_height;
 		}
 	}
 	else if (size==3)
 	{
-		for (int vertex_count=0; vertex_count < num_vertices; vertex_count++, source_position += stride_float)
+		for (int vertex_count=0; vertex_count < num_vertices; vertex_count++, src += stride)
 		{
-			*(dest++) = src[source_position++] * pot_ratio_width;
-			*(dest++) = src[source_position++] * pot_ratio_height;
-			*(dest++) = src[source_position++] * pot_ratio_depth;
+			*(dest++) = ((const Type *) src)[0] * scale_width;
+			*(dest++) = ((const Type *) src)[1] * scale_height;
+			*(dest++) = ((const Type *) src)[2] * scale_depth;
 		}
 	}
 }
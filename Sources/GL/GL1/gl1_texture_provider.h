@@ -133,14 +133,15 @@ public:
 
 	TextureProvider *create_view(TextureDimensions texture_dimensions, TextureFormat texture_format, int min_level, int num_levels, int min_layer, int num_layers) override;
 
-	/// \brief Transform a non-power-of-two coordinate
+	/// \brief Transform a non-power-of-two or integer coordinate to float
 	///
 	/// \param attribute = Source attribute
+	/// \param normalize = Integer coordinates are normalized to 0-1
 	/// \param transformed_data = Destination (this will be set at a minimum of total_vertices*attribute.size
 	/// \param vertex_offset = vertex offset
 	/// \param num_vertices = Number of vertices
 	/// \param total_vertices = Size to set the destination to
-	void transform_coordinate(const PrimitivesArrayProvider::VertexData &attribute, std::vector<float> &transformed_data, int vertex_offset, int num_vertices, int total_vertices);
+	void transform_coordinate(const PrimitivesArrayProvider::VertexData &attribute, bool normalize, std::vector<float> &transformed_data, int vertex_offset, int num_vertices, int total_vertices);
 
 /// \}
 
@@ -152,6 +153,9 @@ private:
 	void set_texture_image3d(GLuint target, PixelBuffer &image, int image_depth, int level);
 	int get_next_power_of_two(int value);
 
+	template<typename Type>
+	static void transform_elements(const char *data_ptr, int stride, int size, float scale, const float *ratio, float *dest, int vertex_offset, int num_vertices);
+
 	int width, height, depth;
 	int pot_width, pot_height, pot_depth;
 	float pot_ratio_width, pot_ratio_height, pot_ratio_depth;
@@ -61,6 +61,11 @@ void GL3BufferObjectProvider::on_dispose()
 	{
 		if (OpenGL::set_active())
 		{
+			for (auto &fence : fences)
+				glDeleteSync(fence.sync);
+			fences.clear();
+
+			GL3GraphicContextProvider::forget_deleted_buffer(handle);
 			glDeleteBuffers(1, &handle);
 		}
 	}
@@ -72,6 +77,7 @@ void GL3BufferObjectProvider::create(const void *data, int size, BufferUsage usa
 
 	binding = new_binding;
 	target = new_target;
+	buffer_size = size;
 
 	OpenGL::set_active();
 
@@ -168,6 +174,68 @@ void GL3BufferObjectProvider::copy_to(GraphicContext &gc, TransferBuffer &buffer
 	glBindBuffer(GL_COPY_READ_BUFFER, 0);
 }
 
+void *GL3BufferObjectProvider::map_persistent(GraphicContext &gc)
+{
+	throw_if_disposed();
+	if (persistent_data_ptr)
+		return persistent_data_ptr;
+
+	// Immutable buffer storage (and thereby persistent mapping) requires OpenGL 4.4
+	int version_major = 0, version_minor = 0;
+	static_cast<GL3GraphicContextProvider*>(gc.get_provider())->get_opengl_version(version_major, version_minor);
+	if (version_major < 4 || (version_major == 4 && version_minor < 4) || !glBufferStorage)
+		return nullptr;
+
+	OpenGL::set_active(gc);
+	GLint last_buffer = 0;
+	if (binding)
+		glGetIntegerv(binding, &last_buffer);
+	glBindBuffer(target, handle);
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glBufferStorage(target, buffer_size, nullptr, flags);
+	persistent_data_ptr = glMapBufferRange(target, 0, buffer_size, flags);
+	glBindBuffer(target, last_buffer);
+	return persistent_data_ptr;
+}
+
+void GL3BufferObjectProvider::fence_range(GraphicContext &gc, int offset, int size)
+{
+	throw_if_disposed();
+	OpenGL::set_active(gc);
+
+	RangeFence fence;
+	fence.offset = offset;
+	fence.size = size;
+	fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	fences.push_back(fence);
+}
+
+void GL3BufferObjectProvider::wait_range(GraphicContext &gc, int offset, int size)
+{
+	throw_if_disposed();
+	OpenGL::set_active(gc);
+
+	for (size_t i = 0; i < fences.size();)
+	{
+		RangeFence &fence = fences[i];
+		if (fence.offset < offset + size && offset < fence.offset + fence.size)
+		{
+			while (true)
+			{
+				GLenum result = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+				if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+					break;
+			}
+			glDeleteSync(fence.sync);
+			fences.erase(fences.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GL3BufferObjectProvider Implementation:
 
@@ -33,6 +33,7 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/GL/opengl.h"
 #include "API/Core/System/disposable_object.h"
+#include <vector>
 
 namespace clan
 {
@@ -71,6 +72,10 @@ public:
 	void upload_data(GraphicContext &gc, const void *data, int size);
 	void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 	void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
+
+	void *map_persistent(GraphicContext &gc);
+	void fence_range(GraphicContext &gc, int offset, int size);
+	void wait_range(GraphicContext &gc, int offset, int size);
 /// \}
 
 /// \name Implementation
@@ -84,6 +89,17 @@ private:
 
 	void *data_ptr;
 	GraphicContext lock_gc;
+
+	int buffer_size = 0;
+	void *persistent_data_ptr = nullptr;
+
+	struct RangeFence
+	{
+		int offset;
+		int size;
+		CLsync sync;
+	};
+	std::vector<RangeFence> fences;
 /// \}
 };
 
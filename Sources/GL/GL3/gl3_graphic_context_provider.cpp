@@ -413,6 +413,9 @@ void GL3GraphicContextProvider::set_rasterizer_state(RasterizerStateProvider *st
 		{
 			selected_rasterizer_state.set(gl3_state->desc);
 			OpenGL::set_active(this);
+			state_cache.count_state_object(selected_rasterizer_state.is_changed());
+			if (selected_rasterizer_state.is_changed())
+				state_cache.forget_scissor_test();
 			selected_rasterizer_state.apply();
 			scissor_enabled = gl3_state->desc.get_enable_scissor();
 		}
@@ -428,6 +431,7 @@ void GL3GraphicContextProvider::set_blend_state(BlendStateProvider *state, const
 		{
 			selected_blend_state.set(gl3_state->desc, blend_color);
 			OpenGL::set_active(this);
+			state_cache.count_state_object(selected_blend_state.is_changed());
 			selected_blend_state.apply();
 		}
 	}
@@ -442,6 +446,7 @@ void GL3GraphicContextProvider::set_depth_stencil_state(DepthStencilStateProvide
 		{
 			selected_depth_stencil_state.set(gl3_state->desc);
 			OpenGL::set_active(this);
+			state_cache.count_state_object(selected_depth_stencil_state.is_changed());
 			selected_depth_stencil_state.apply();
 		}
 	}
@@ -476,61 +481,50 @@ PixelBuffer GL3GraphicContextProvider::get_pixeldata(const Rect& rect, TextureFo
 void GL3GraphicContextProvider::set_uniform_buffer(int index, const UniformBuffer &buffer)
 {
 	OpenGL::set_active(this);
-	glBindBufferBase(GL_UNIFORM_BUFFER, index, static_cast<GL3UniformBufferProvider*>(buffer.get_provider())->get_handle());
+	state_cache.bind_uniform_buffer(index, static_cast<GL3UniformBufferProvider*>(buffer.get_provider())->get_handle());
 }
 
 void GL3GraphicContextProvider::reset_uniform_buffer(int index)
 {
 	OpenGL::set_active(this);
-	glBindBufferBase(GL_UNIFORM_BUFFER, index, 0);
+	state_cache.bind_uniform_buffer(index, 0);
 }
 
 void GL3GraphicContextProvider::set_storage_buffer(int index, const StorageBuffer &buffer)
 {
 	OpenGL::set_active(this);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, static_cast<GL3StorageBufferProvider*>(buffer.get_provider())->get_handle());
+	state_cache.bind_storage_buffer(index, static_cast<GL3StorageBufferProvider*>(buffer.get_provider())->get_handle());
 }
 
 void GL3GraphicContextProvider::reset_storage_buffer(int index)
 {
 	OpenGL::set_active(this);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, 0);
+	state_cache.bind_storage_buffer(index, 0);
 }
 
 void GL3GraphicContextProvider::set_texture(int unit_index, const Texture &texture)
 {
 	OpenGL::set_active(this);
 
-	if (glActiveTexture != nullptr)
-	{
-		glActiveTexture( GL_TEXTURE0 + unit_index );
-	}
-	else if (unit_index > 0)
-	{
+	if (glActiveTexture == nullptr && unit_index > 0)
 		return;
-	}
 
 	if (!texture.is_null())
 	{
 		GL3TextureProvider *provider = static_cast<GL3TextureProvider *>(texture.get_provider());
-		glBindTexture(provider->get_texture_type(), provider->get_handle());
+		state_cache.bind_texture(unit_index, provider->get_texture_type(), provider->get_handle());
+	}
+	else
+	{
+		state_cache.active_texture(unit_index);
 	}
 }
 
 void GL3GraphicContextProvider::reset_texture(int unit_index)
 {
-	OpenGL::set_active(this);
-
-	if (glActiveTexture != nullptr)
-	{
-		glActiveTexture( GL_TEXTURE0 + unit_index );
-	}
-	else if (unit_index > 0)
-	{
-		return;
-	}
-	// Set the texture to the default state
-	glBindTexture(GL_TEXTURE_2D, 0);
+	// The texture stays bound until another texture is set on the unit. The batchers reset and set the same
+	// textures on every flush, so unbinding here would turn each of those sets into a real bind.
+	state_cache.count_elided();
 }
 
 void GL3GraphicContextProvider::set_image_texture(int unit_index, const Texture &texture)
@@ -616,18 +610,13 @@ void GL3GraphicContextProvider::set_program_object(const ProgramObject &program)
 	if (glUseProgram == nullptr)
 		return;
 
-	if (program.is_null())
-		glUseProgram(0);
-	else
-	{
-		glUseProgram(program.get_handle());
-	}
+	state_cache.use_program(program.is_null() ? 0 : program.get_handle());
 }
 
 void GL3GraphicContextProvider::reset_program_object()
 {
-	OpenGL::set_active(this);
-	glUseProgram(0);
+	// The program stays in use until another program is set, for the same reason as in reset_texture
+	state_cache.count_elided();
 }
 
 bool GL3GraphicContextProvider::is_primitives_array_owner(const PrimitivesArray &prim_array)
@@ -651,43 +640,47 @@ void GL3GraphicContextProvider::set_primitives_array(const PrimitivesArray &prim
 	GL3PrimitivesArrayProvider *prim_array = static_cast<GL3PrimitivesArrayProvider *>(primitives_array.get_provider());
 
 	OpenGL::set_active(this);
-	glBindVertexArray(prim_array->handle);
+	state_cache.bind_vertex_array(prim_array->handle);
 }
 
 void GL3GraphicContextProvider::draw_primitives_array(PrimitivesType type, int offset, int num_vertices)
 {
 	OpenGL::set_active(this);
+	check_state_cache();
 	glDrawArrays(OpenGL::to_enum(type), offset, num_vertices);
 }
 
 void GL3GraphicContextProvider::draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count)
 {
 	OpenGL::set_active(this);
+	check_state_cache();
 	glDrawArraysInstanced(OpenGL::to_enum(type), offset, num_vertices, instance_count);
 }
 
 void GL3GraphicContextProvider::set_primitives_elements(ElementArrayBufferProvider *array_provider)
 {
 	OpenGL::set_active(this);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, static_cast<GL3ElementArrayBufferProvider *>(array_provider)->get_handle());
+	state_cache.bind_element_array_buffer(static_cast<GL3ElementArrayBufferProvider *>(array_provider)->get_handle());
 }
 
 void GL3GraphicContextProvider::draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset)
 {
 	OpenGL::set_active(this);
+	check_state_cache();
 	glDrawElements(OpenGL::to_enum(type), count, OpenGL::to_enum(indices_type), (const GLvoid*)offset);
 }
 
 void GL3GraphicContextProvider::draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count)
 {
 	OpenGL::set_active(this);
+	check_state_cache();
 	glDrawElementsInstanced(OpenGL::to_enum(type), count, OpenGL::to_enum(indices_type), (const GLvoid*)offset, instance_count);
 }
 
 void GL3GraphicContextProvider::reset_primitives_elements()
 {
 	OpenGL::set_active(this);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	state_cache.bind_element_array_buffer(0);
 }
 
 void GL3GraphicContextProvider::draw_primitives_elements(
@@ -698,9 +691,10 @@ void GL3GraphicContextProvider::draw_primitives_elements(
 	void *offset)
 {
 	OpenGL::set_active(this);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, static_cast<GL3ElementArrayBufferProvider *>(array_provider)->get_handle());
+	state_cache.bind_element_array_buffer(static_cast<GL3ElementArrayBufferProvider *>(array_provider)->get_handle());
+	check_state_cache();
 	glDrawElements(OpenGL::to_enum(type), count, OpenGL::to_enum(indices_type), offset);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	state_cache.bind_element_array_buffer(0);
 }
 
 void GL3GraphicContextProvider::draw_primitives_elements_instanced(
@@ -712,15 +706,16 @@ void GL3GraphicContextProvider::draw_primitives_elements_instanced(
 	int instance_count)
 {
 	OpenGL::set_active(this);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, static_cast<GL3ElementArrayBufferProvider *>(array_provider)->get_handle());
+	state_cache.bind_element_array_buffer(static_cast<GL3ElementArrayBufferProvider *>(array_provider)->get_handle());
+	check_state_cache();
 	glDrawElementsInstanced(OpenGL::to_enum(type), count, OpenGL::to_enum(indices_type), offset, instance_count);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	state_cache.bind_element_array_buffer(0);
 }
 
 void GL3GraphicContextProvider::reset_primitives_array()
 {
-	OpenGL::set_active(this);
-	glBindVertexArray(0);
+	// The vertex array stays bound until another one is set, for the same reason as in reset_texture
+	state_cache.count_elided();
 }
 
 void GL3GraphicContextProvider::set_scissor(const Rect &rect)
@@ -730,23 +725,20 @@ void GL3GraphicContextProvider::set_scissor(const Rect &rect)
 	if (!scissor_enabled)
 		throw Exception("RasterizerState must be set with enable_scissor() for clipping to work");
 
-	glEnable(GL_SCISSOR_TEST);
-	glScissor(
-		rect.left,
-		rect.top,
-		rect.get_width(),
-		rect.get_height());
+	state_cache.enable_scissor_test(true);
+	state_cache.set_scissor(rect);
 }
 
 void GL3GraphicContextProvider::reset_scissor()
 {
 	OpenGL::set_active(this);
-	glDisable(GL_SCISSOR_TEST);
+	state_cache.enable_scissor_test(false);
 }
 
 void GL3GraphicContextProvider::dispatch(int x, int y, int z)
 {
 	OpenGL::set_active(this);
+	check_state_cache();
 	glDispatchCompute(x, y, z);
 }
 
@@ -786,11 +778,9 @@ void GL3GraphicContextProvider::on_window_resized()
 void GL3GraphicContextProvider::set_viewport(const Rectf &viewport)
 {
 	OpenGL::set_active(this);
-	glViewport(
-		GLsizei(viewport.left),
-		GLsizei(viewport.top),
-		GLsizei(viewport.right - viewport.left),
-		GLsizei(viewport.bottom - viewport.top));
+	GLsizei x = GLsizei(viewport.left);
+	GLsizei y = GLsizei(viewport.top);
+	state_cache.set_viewport(Rect(x, y, x + GLsizei(viewport.right - viewport.left), y + GLsizei(viewport.bottom - viewport.top)));
 }
 
 void GL3GraphicContextProvider::set_viewport(int index, const Rectf &viewport)
@@ -803,6 +793,10 @@ void GL3GraphicContextProvider::set_viewport(int index, const Rectf &viewport)
 			GLfloat(viewport.top),
 			GLfloat(viewport.right - viewport.left),
 			GLfloat(viewport.bottom - viewport.top));
+
+		// The float viewport cannot be kept in the integer shadow copy
+		if (index == 0)
+			state_cache.forget_viewport();
 	}
 	else
 	{
@@ -854,7 +848,34 @@ const DisplayWindowProvider & GL3GraphicContextProvider::get_render_window() con
 	return *render_window;
 }
 
+void GL3GraphicContextProvider::forget_deleted_texture(GLuint handle)
+{
+	for_each_state_cache([=](GL3StateCache &cache) { cache.forget_texture(handle); });
+}
+
+void GL3GraphicContextProvider::forget_deleted_program(GLuint handle)
+{
+	for_each_state_cache([=](GL3StateCache &cache) { cache.forget_program(handle); });
+}
+
+void GL3GraphicContextProvider::forget_deleted_buffer(GLuint handle)
+{
+	for_each_state_cache([=](GL3StateCache &cache) { cache.forget_buffer(handle); });
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GL3GraphicContextProvider Implementation:
 
+void GL3GraphicContextProvider::for_each_state_cache(const std::function<void(GL3StateCache &)> &func)
+{
+	std::unique_ptr<std::unique_lock<std::recursive_mutex>> mutex_section;
+	std::vector<GraphicContextProvider*> &gc_providers = SharedGCData::get_gc_providers(mutex_section);
+	for (auto &gc_provider : gc_providers)
+	{
+		GL3GraphicContextProvider *gl3_provider = dynamic_cast<GL3GraphicContextProvider *>(gc_provider);
+		if (gl3_provider)
+			func(gl3_provider->state_cache);
+	}
+}
+
 }
@@ -41,11 +41,13 @@
 #include "API/Display/Render/depth_stencil_state_description.h"
 #include "API/Core/System/disposable_object.h"
 #include "gl3_standard_programs.h"
+#include "gl3_state_cache.h"
 #include "GL/opengl_graphic_context_provider.h"
 #include "../State/opengl_blend_state.h"
 #include "../State/opengl_rasterizer_state.h"
 #include "../State/opengl_depth_stencil_state.h"
 
+#include <functional>
 #include <map>
 
 namespace clan
@@ -101,6 +103,8 @@ public:
 
 	ProgramObject get_program_object(StandardProgram standard_program) const override;
 
+	StateCacheCounters_GL get_state_cache_counters() const override { return state_cache.counters; }
+
 /// \}
 /// \name Operations
 /// \{
@@ -182,6 +186,20 @@ public:
 
 	void flush() override;
 
+	void reset_state_cache_counters() override { state_cache.counters = StateCacheCounters_GL(); }
+	void set_state_cache_validation(bool enable) override { state_cache.validation_enabled = enable; }
+	void invalidate_state_cache() override { state_cache.invalidate(); }
+
+	/// \brief Removes a deleted vertex array object from the state cache
+	void forget_deleted_vertex_array(GLuint handle) { state_cache.forget_vertex_array(handle); }
+
+	/// \brief Removes a deleted object from the state cache of every GL3 graphic context
+	///
+	/// Object names are reused after deletion, so a stale cache entry could drop a bind of a new object.
+	static void forget_deleted_texture(GLuint handle);
+	static void forget_deleted_program(GLuint handle);
+	static void forget_deleted_buffer(GLuint handle);
+
 /// \}
 /// \name Implementation
 /// \{
@@ -190,6 +208,11 @@ private:
 	void create_standard_programs();
 
 	void check_opengl_version();
+
+	/// \brief Cross-checks the state cache with OpenGL if validation is enabled
+	void check_state_cache() { if (state_cache.validation_enabled) state_cache.validate(); }
+
+	static void for_each_state_cache(const std::function<void(GL3StateCache &)> &func);
 	void calculate_shading_language_version();
 	/// \brief OpenGL render window.
 	const OpenGLWindowProvider * const render_window;
@@ -218,6 +241,8 @@ private:
 
 	GL3StandardPrograms standard_programs;
 
+	GL3StateCache state_cache;
+
 /// \}
 };
 
@@ -64,7 +64,7 @@ void GL3PrimitivesArrayProvider::set_attribute(int attrib_index, const VertexDat
 	glBindBuffer(GL_ARRAY_BUFFER, static_cast<GL3VertexArrayBufferProvider *>(attribute.array_provider)->get_handle());
 	glEnableVertexAttribArray(attrib_index);
 
-	if (attribute.type == type_float)
+	if (attribute.type == type_float || normalize)
 	{
 		glVertexAttribPointer( attrib_index, attribute.size, OpenGL::to_enum(attribute.type),
 			normalize ? GL_TRUE : GL_FALSE, attribute.stride, (GLvoid *) attribute.offset);
@@ -84,6 +84,7 @@ void GL3PrimitivesArrayProvider::on_dispose()
 	if (handle)
 	{
 		OpenGL::set_active(gc_provider);
+		gc_provider->forget_deleted_vertex_array(handle);
 		glDeleteVertexArrays(1, &handle);
 	}
 	gc_provider->remove_disposable(this);
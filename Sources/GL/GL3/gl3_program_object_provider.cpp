@@ -64,6 +64,7 @@ void GL3ProgramObjectProvider::on_dispose()
 	{
 		if (OpenGL::set_active())
 		{
+			GL3GraphicContextProvider::forget_deleted_program(handle);
 			glDeleteProgram(handle);
 		}
 	}
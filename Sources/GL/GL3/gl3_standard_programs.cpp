@@ -112,6 +112,30 @@ const std::string::value_type *cl_glsl_vertex_sprite =
 	"flat out int TexIndex; "
 	"void main() { gl_Position = Position; Color = Color0; TexCoord = TexCoord0; TexIndex = TexIndex0; }";
 
+const std::string::value_type *cl_glsl15_vertex_sprite_packed =
+	"#version 150\n"
+	"uniform mat4 Projection; "
+	"in vec2 Position; "
+	"in vec4 Color0; "
+	"in vec2 TexCoord0; "
+	"in uint TexIndex0; "
+	"out vec4 Color; "
+	"out vec2 TexCoord; "
+	"flat out int TexIndex; "
+	"void main() { gl_Position = Projection * vec4(Position, 0.0, 1.0); Color = Color0; TexCoord = TexCoord0; TexIndex = int(TexIndex0); }";
+
+const std::string::value_type *cl_glsl_vertex_sprite_packed =
+	"#version 130\n"
+	"uniform mat4 Projection; "
+	"in vec2 Position; "
+	"in vec4 Color0; "
+	"in vec2 TexCoord0; "
+	"in uint TexIndex0; "
+	"out vec4 Color; "
+	"out vec2 TexCoord; "
+	"flat out int TexIndex; "
+	"void main() { gl_Position = Projection * vec4(Position, 0.0, 1.0); Color = Color0; TexCoord = TexCoord0; TexIndex = int(TexIndex0); }";
+
 const std::string::value_type *cl_glsl15_fragment_sprite =
 	"#version 150\n"
 	"uniform sampler2D Texture0; "
@@ -488,6 +512,7 @@ public:
 	ProgramObject color_only_program;
 	ProgramObject single_texture_program;
 	ProgramObject sprite_program;
+	ProgramObject sprite_packed_program;
 	ProgramObject path_program;
 
 };
@@ -534,6 +559,10 @@ GL3StandardPrograms::GL3StandardPrograms(GL3GraphicContextProvider *provider) :
 	if(!fragment_sprite_shader.compile())
 		throw Exception("Unable to compile the standard shader program: 'fragment sprite' Error:" + fragment_sprite_shader.get_info_log());
 
+	ShaderObject vertex_sprite_packed_shader(provider, shadertype_vertex, use_glsl_150 ? cl_glsl15_vertex_sprite_packed : cl_glsl_vertex_sprite_packed);
+	if (!vertex_sprite_packed_shader.compile())
+		throw Exception("Unable to compile the standard shader program: 'vertex sprite packed' Error:" + vertex_sprite_packed_shader.get_info_log());
+
 	ShaderObject vertex_path_shader(provider, shadertype_vertex, use_glsl_150 ? cl_glsl15_vertex_path : cl_glsl_vertex_path);
 	if (!vertex_path_shader.compile())
 		throw Exception("Unable to compile the standard shader program: 'vertex path' Error:" + vertex_path_shader.get_info_log());
@@ -599,6 +628,37 @@ GL3StandardPrograms::GL3StandardPrograms(GL3GraphicContextProvider *provider) :
 	sprite_program.set_uniform1i("Texture14", 14);
 	sprite_program.set_uniform1i("Texture15", 15);
 
+	ProgramObject sprite_packed_program(provider);
+	sprite_packed_program.attach(vertex_sprite_packed_shader);
+	sprite_packed_program.attach(fragment_sprite_shader);
+	sprite_packed_program.bind_attribute_location(0, "Position");
+	sprite_packed_program.bind_attribute_location(1, "Color0");
+	sprite_packed_program.bind_attribute_location(2, "TexCoord0");
+	sprite_packed_program.bind_attribute_location(3, "TexIndex0");
+
+	if (use_glsl_150)
+		sprite_packed_program.bind_frag_data_location(0, "cl_FragColor");
+
+	if (!sprite_packed_program.link())
+		throw Exception("Unable to link the standard shader program: 'sprite packed' Error:" + sprite_packed_program.get_info_log());
+
+	sprite_packed_program.set_uniform1i("Texture0", 0);
+	sprite_packed_program.set_uniform1i("Texture1", 1);
+	sprite_packed_program.set_uniform1i("Texture2", 2);
+	sprite_packed_program.set_uniform1i("Texture3", 3);
+	sprite_packed_program.set_uniform1i("Texture4", 4);
+	sprite_packed_program.set_uniform1i("Texture5", 5);
+	sprite_packed_program.set_uniform1i("Texture6", 6);
+	sprite_packed_program.set_uniform1i("Texture7", 7);
+	sprite_packed_program.set_uniform1i("Texture8", 8);
+	sprite_packed_program.set_uniform1i("Texture9", 9);
+	sprite_packed_program.set_uniform1i("Texture10", 10);
+	sprite_packed_program.set_uniform1i("Texture11", 11);
+	sprite_packed_program.set_uniform1i("Texture12", 12);
+	sprite_packed_program.set_uniform1i("Texture13", 13);
+	sprite_packed_program.set_uniform1i("Texture14", 14);
+	sprite_packed_program.set_uniform1i("Texture15", 15);
+
 	ProgramObject path_program(provider);
 	path_program.attach(vertex_path_shader);
 	path_program.attach(fragment_path_shader);
@@ -616,6 +676,7 @@ GL3StandardPrograms::GL3StandardPrograms(GL3GraphicContextProvider *provider) :
 	impl->color_only_program = color_only_program;
 	impl->single_texture_program = single_texture_program;
 	impl->sprite_program = sprite_program;
+	impl->sprite_packed_program = sprite_packed_program;
 	impl->path_program = path_program;
 
 	RenderBatchTriangle::max_textures = 16; // Too many hacks..
@@ -633,6 +694,7 @@ ProgramObject GL3StandardPrograms::get_program_object(StandardProgram standard_p
 	case program_single_texture: return impl->single_texture_program;
 	case program_sprite: return impl->sprite_program;
 	case program_path: return impl->path_program;
+	case program_sprite_packed: return impl->sprite_packed_program;
 	}
 	throw Exception("Unsupported standard program");
 }
@@ -0,0 +1,289 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GL/precomp.h"
+#include "gl3_state_cache.h"
+#include "API/GL/opengl_wrap.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_format.h"
+
+namespace clan
+{
+
+const GLuint GL3StateCache::unknown;
+
+GL3StateCache::GL3StateCache()
+{
+	invalidate();
+}
+
+void GL3StateCache::invalidate()
+{
+	program = unknown;
+	vertex_array = unknown;
+	element_array_buffer = unknown;
+	active_texture_unit = -1;
+	textures.clear();
+	uniform_buffers.clear();
+	storage_buffers.clear();
+	scissor_test = unknown;
+	scissor_box_known = false;
+	viewport_known = false;
+}
+
+void GL3StateCache::use_program(GLuint handle)
+{
+	if (update(program, handle))
+		glUseProgram(handle);
+}
+
+void GL3StateCache::bind_vertex_array(GLuint handle)
+{
+	if (update(vertex_array, handle))
+	{
+		glBindVertexArray(handle);
+
+		// The element array buffer binding is part of the vertex array object
+		element_array_buffer = unknown;
+	}
+}
+
+void GL3StateCache::bind_element_array_buffer(GLuint handle)
+{
+	if (update(element_array_buffer, handle))
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
+}
+
+void GL3StateCache::active_texture(int unit_index)
+{
+	if (glActiveTexture == nullptr)
+		return;
+
+	if (update(active_texture_unit, unit_index))
+		glActiveTexture(GL_TEXTURE0 + unit_index);
+}
+
+void GL3StateCache::bind_texture(int unit_index, GLenum target, GLuint handle)
+{
+	if (unit_index >= (int)textures.size())
+		textures.resize(unit_index + 1);
+
+	TextureBinding binding;
+	binding.target = target;
+	binding.handle = handle;
+	if (update(textures[unit_index], binding))
+	{
+		active_texture(unit_index);
+		glBindTexture(target, handle);
+	}
+}
+
+void GL3StateCache::bind_uniform_buffer(int index, GLuint handle)
+{
+	if (index >= (int)uniform_buffers.size())
+		uniform_buffers.resize(index + 1, unknown);
+
+	if (update(uniform_buffers[index], handle))
+		glBindBufferBase(GL_UNIFORM_BUFFER, index, handle);
+}
+
+void GL3StateCache::bind_storage_buffer(int index, GLuint handle)
+{
+	if (index >= (int)storage_buffers.size())
+		storage_buffers.resize(index + 1, unknown);
+
+	if (update(storage_buffers[index], handle))
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, handle);
+}
+
+void GL3StateCache::enable_scissor_test(bool enable)
+{
+	if (update(scissor_test, (GLuint)(enable ? 1 : 0)))
+	{
+		if (enable)
+			glEnable(GL_SCISSOR_TEST);
+		else
+			glDisable(GL_SCISSOR_TEST);
+	}
+}
+
+void GL3StateCache::set_scissor(const Rect &box)
+{
+	if (scissor_box_known && scissor_box == box)
+	{
+		counters.calls_elided++;
+		return;
+	}
+	scissor_box = box;
+	scissor_box_known = true;
+	counters.calls_issued++;
+	glScissor(box.left, box.top, box.get_width(), box.get_height());
+}
+
+void GL3StateCache::set_viewport(const Rect &box)
+{
+	if (viewport_known && viewport == box)
+	{
+		counters.calls_elided++;
+		return;
+	}
+	viewport = box;
+	viewport_known = true;
+	counters.calls_issued++;
+	glViewport(box.left, box.top, box.get_width(), box.get_height());
+}
+
+void GL3StateCache::forget_program(GLuint handle)
+{
+	if (program == handle)
+		program = unknown;
+}
+
+void GL3StateCache::forget_vertex_array(GLuint handle)
+{
+	if (vertex_array == handle)
+	{
+		vertex_array = unknown;
+		element_array_buffer = unknown;
+	}
+}
+
+void GL3StateCache::forget_texture(GLuint handle)
+{
+	for (auto &binding : textures)
+	{
+		if (binding.handle == handle)
+			binding.handle = unknown;
+	}
+}
+
+void GL3StateCache::forget_buffer(GLuint handle)
+{
+	if (element_array_buffer == handle)
+		element_array_buffer = unknown;
+	for (auto &buffer : uniform_buffers)
+	{
+		if (buffer == handle)
+			buffer = unknown;
+	}
+	for (auto &buffer : storage_buffers)
+	{
+		if (buffer == handle)
+			buffer = unknown;
+	}
+}
+
+void GL3StateCache::validate()
+{
+	std::string mismatch;
+	auto check = [&](const std::string &name, GLuint cached, GLint actual)
+	{
+		if (mismatch.empty() && cached != unknown && cached != (GLuint)actual)
+			mismatch = string_format("%1 is %2, but the state cache has %3", name, actual, (int)cached);
+	};
+
+	GLint value = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+	check("GL_CURRENT_PROGRAM", program, value);
+
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+	check("GL_VERTEX_ARRAY_BINDING", vertex_array, value);
+
+	glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &value);
+	check("GL_ELEMENT_ARRAY_BUFFER_BINDING", element_array_buffer, value);
+
+	if (glActiveTexture)
+	{
+		GLint active_texture = GL_TEXTURE0;
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture);
+		if (active_texture_unit >= 0)
+			check("GL_ACTIVE_TEXTURE", GL_TEXTURE0 + active_texture_unit, active_texture);
+
+		for (size_t i = 0; i < textures.size(); i++)
+		{
+			if (textures[i].handle == unknown)
+				continue;
+			glActiveTexture(GL_TEXTURE0 + i);
+			glGetIntegerv(get_texture_binding(textures[i].target), &value);
+			check(string_format("Texture binding of unit %1", (int)i), textures[i].handle, value);
+		}
+		glActiveTexture(active_texture);
+	}
+
+	if (glGetIntegeri_v)
+	{
+		for (size_t i = 0; i < uniform_buffers.size(); i++)
+		{
+			glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, i, &value);
+			check(string_format("GL_UNIFORM_BUFFER_BINDING %1", (int)i), uniform_buffers[i], value);
+		}
+		for (size_t i = 0; i < storage_buffers.size(); i++)
+		{
+			glGetIntegeri_v(GL_SHADER_STORAGE_BUFFER_BINDING, i, &value);
+			check(string_format("GL_SHADER_STORAGE_BUFFER_BINDING %1", (int)i), storage_buffers[i], value);
+		}
+	}
+
+	check("GL_SCISSOR_TEST", scissor_test, glIsEnabled(GL_SCISSOR_TEST) ? 1 : 0);
+
+	GLint box[4];
+	if (scissor_box_known)
+	{
+		glGetIntegerv(GL_SCISSOR_BOX, box);
+		if (mismatch.empty() && scissor_box != Rect(box[0], box[1], box[0] + box[2], box[1] + box[3]))
+			mismatch = "GL_SCISSOR_BOX differs from the state cache";
+	}
+	if (viewport_known)
+	{
+		glGetIntegerv(GL_VIEWPORT, box);
+		if (mismatch.empty() && viewport != Rect(box[0], box[1], box[0] + box[2], box[1] + box[3]))
+			mismatch = "GL_VIEWPORT differs from the state cache";
+	}
+
+	if (!mismatch.empty())
+		throw Exception("OpenGL state cache mismatch: " + mismatch);
+}
+
+GLenum GL3StateCache::get_texture_binding(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_1D: return GL_TEXTURE_BINDING_1D;
+	case GL_TEXTURE_1D_ARRAY: return GL_TEXTURE_BINDING_1D_ARRAY;
+	case GL_TEXTURE_2D: return GL_TEXTURE_BINDING_2D;
+	case GL_TEXTURE_2D_ARRAY: return GL_TEXTURE_BINDING_2D_ARRAY;
+	case GL_TEXTURE_2D_MULTISAMPLE: return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
+	case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
+	case GL_TEXTURE_3D: return GL_TEXTURE_BINDING_3D;
+	case GL_TEXTURE_CUBE_MAP: return GL_TEXTURE_BINDING_CUBE_MAP;
+	case GL_TEXTURE_CUBE_MAP_ARRAY: return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
+	default: throw Exception("Unsupported texture target");
+	}
+}
+
+}
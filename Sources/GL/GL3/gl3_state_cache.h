@@ -0,0 +1,131 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/GL/opengl.h"
+#include "API/GL/opengl_graphic_context.h"
+#include "API/Core/Math/rect.h"
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Shadow copy of the bindings and fixed function state set by a GL3GraphicContextProvider
+///
+/// Calls that would not change the shadow copy are dropped. Resource providers bind objects temporarily through
+/// state trackers that restore the previous binding, so they leave the shadow copy valid. Deleting an object
+/// unbinds it, so the forget functions must be called for every deleted object.
+class GL3StateCache
+{
+public:
+	GL3StateCache();
+
+	/// \brief Marks all state unknown, so the next call of each kind is passed on to OpenGL
+	void invalidate();
+
+	void use_program(GLuint handle);
+	void bind_vertex_array(GLuint handle);
+	void bind_element_array_buffer(GLuint handle);
+	void active_texture(int unit_index);
+	void bind_texture(int unit_index, GLenum target, GLuint handle);
+	void bind_uniform_buffer(int index, GLuint handle);
+	void bind_storage_buffer(int index, GLuint handle);
+	void enable_scissor_test(bool enable);
+	void set_scissor(const Rect &box);
+	void set_viewport(const Rect &box);
+
+	/// \brief Counts a call that is dropped without comparing state
+	///
+	/// Used for unbinds that are skipped because the next bind replaces the binding anyway.
+	void count_elided() { counters.calls_elided++; }
+
+	/// \brief Counts applying a blend, rasterizer or depth stencil state object
+	void count_state_object(bool changed) { changed ? counters.calls_issued++ : counters.calls_elided++; }
+
+	/// \brief Marks the scissor test unknown after a state object may have changed it
+	void forget_scissor_test() { scissor_test = unknown; }
+
+	/// \brief Marks the viewport unknown after it was changed without going through the cache
+	void forget_viewport() { viewport_known = false; }
+
+	void forget_program(GLuint handle);
+	void forget_vertex_array(GLuint handle);
+	void forget_texture(GLuint handle);
+	void forget_buffer(GLuint handle);
+
+	/// \brief Compares the shadow copy with the state queried from OpenGL
+	///
+	/// Throws an exception naming the first state that differs.
+	void validate();
+
+	bool validation_enabled = false;
+	StateCacheCounters_GL counters;
+
+private:
+	/// \brief Returns true, and counts an issued call, when the cached value differs from the new value
+	template<typename T>
+	bool update(T &cached, const T &value)
+	{
+		if (cached == value)
+		{
+			counters.calls_elided++;
+			return false;
+		}
+		cached = value;
+		counters.calls_issued++;
+		return true;
+	}
+
+	static GLenum get_texture_binding(GLenum target);
+
+	static const GLuint unknown = 0xffffffff;
+
+	struct TextureBinding
+	{
+		TextureBinding() : target(0), handle(unknown) { }
+		bool operator==(const TextureBinding &other) const { return target == other.target && handle == other.handle; }
+		GLenum target;
+		GLuint handle;
+	};
+
+	GLuint program;
+	GLuint vertex_array;
+	GLuint element_array_buffer;
+	int active_texture_unit;
+	std::vector<TextureBinding> textures;
+	std::vector<GLuint> uniform_buffers;
+	std::vector<GLuint> storage_buffers;
+	GLuint scissor_test;
+	Rect scissor_box;
+	bool scissor_box_known;
+	Rect viewport;
+	bool viewport_known;
+};
+
+}
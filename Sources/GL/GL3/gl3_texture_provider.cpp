@@ -128,6 +128,7 @@ void GL3TextureProvider::on_dispose()
 	{
 		if (OpenGL::set_active())
 		{
+			GL3GraphicContextProvider::forget_deleted_texture(handle);
 			glDeleteTextures(1, &handle);
 		}
 	}
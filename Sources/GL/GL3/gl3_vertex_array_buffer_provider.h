@@ -62,6 +62,9 @@ public:
 	void upload_data(GraphicContext &gc, int offset, const void *data, int size) override { buffer.upload_data(gc, offset, data, size); }
 	void copy_from(GraphicContext &gc, TransferBuffer &transfer_buffer, int dest_pos, int src_pos, int size) override { buffer.copy_from(gc, transfer_buffer, dest_pos, src_pos, size); }
 	void copy_to(GraphicContext &gc, TransferBuffer &transfer_buffer, int dest_pos, int src_pos, int size) override { buffer.copy_to(gc, transfer_buffer, dest_pos, src_pos, size); }
+	void *map_persistent(GraphicContext &gc) override { return buffer.map_persistent(gc); }
+	void fence_range(GraphicContext &gc, int offset, int size) override { buffer.fence_range(gc, offset, size); }
+	void wait_range(GraphicContext &gc, int offset, int size) override { buffer.wait_range(gc, offset, size); }
 /// \}
 
 /// \name Implementation
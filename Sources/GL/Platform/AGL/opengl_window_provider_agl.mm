@@ -234,6 +234,11 @@ void OpenGLWindowProvider::setup_default_framebuffer()
     }
 
     glViewport(0, 0, width, height);
+
+    // The viewport was set without going through the GL state cache
+    OpenGLGraphicContextProvider *gl_provider = dynamic_cast<OpenGLGraphicContextProvider*>(gc.get_provider());
+    if (gl_provider)
+        gl_provider->invalidate_state_cache();
 }
 
 void OpenGLWindowProvider::set_default_frame_buffer()
@@ -57,6 +57,9 @@ public:
 	void set(const OpenGLBlendState &new_state);
 	void apply();
 
+	/// \brief Returns true if the next apply sends state to OpenGL
+	bool is_changed() const { return changed_desc || changed_blend_color; }
+
 private:
 	BlendStateDescription desc;
 	Vec4f blend_color;
@@ -56,6 +56,9 @@ public:
 	void set(const OpenGLRasterizerState &new_state);
 	void apply();
 
+	/// \brief Returns true if the next apply sends state to OpenGL
+	bool is_changed() const { return changed_desc; }
+
 private:
 	RasterizerStateDescription desc;
 	bool changed_desc;
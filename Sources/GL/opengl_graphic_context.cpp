@@ -120,6 +120,11 @@ std::vector<std::string> GraphicContext_GL::get_extensions()
 	return extensions;
 }
 
+StateCacheCounters_GL GraphicContext_GL::get_state_cache_counters() const
+{
+	return impl->provider->get_state_cache_counters();
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 // GraphicContext_GL Operations:
@@ -129,6 +134,21 @@ void GraphicContext_GL::set_active()
 	OpenGL::set_active(impl->provider);
 }
 
+void GraphicContext_GL::reset_state_cache_counters()
+{
+	impl->provider->reset_state_cache_counters();
+}
+
+void GraphicContext_GL::set_state_cache_validation(bool enable)
+{
+	impl->provider->set_state_cache_validation(enable);
+}
+
+void GraphicContext_GL::invalidate_state_cache()
+{
+	impl->provider->invalidate_state_cache();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GraphicContext_GL Implementation:
 
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/graphic_context_provider.h"
+#include "API/GL/opengl_graphic_context.h"
 
 namespace clan
 {
@@ -42,6 +43,11 @@ public:
 	virtual void make_current() const = 0;
 	virtual ProcAddress *get_proc_address(const std::string& function_name) const = 0;
 
+	virtual StateCacheCounters_GL get_state_cache_counters() const { return StateCacheCounters_GL(); }
+	virtual void reset_state_cache_counters() { }
+	virtual void set_state_cache_validation(bool enable) { }
+	virtual void invalidate_state_cache() { }
+
 };
 
 }
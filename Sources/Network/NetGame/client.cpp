@@ -30,6 +30,7 @@
 #include "API/Network/NetGame/client.h"
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/event.h"
+#include "API/Network/NetGame/event_schema.h"
 #include "API/Network/Socket/socket_name.h"
 #include "network_event.h"
 #include "client_impl.h"
@@ -50,7 +51,16 @@ NetGameClient::~NetGameClient()
 void NetGameClient::connect(const std::string &server, const std::string &port)
 {
 	disconnect();
-	impl->connection.reset(new NetGameConnection(this, SocketName(server, port)));
+	if (impl->transport == NetGameTransport::udp)
+	{
+		// Datagrams are matched to the peer by the address they arrive from, so resolve the name up front
+		impl->udp_host.reset(new NetGameUDPHost(impl->mtu));
+		impl->connection.reset(new NetGameConnection(this, impl->udp_host.get(), SocketName(server, port).to_ipv4()));
+	}
+	else
+	{
+		impl->connection.reset(new NetGameConnection(this, SocketName(server, port)));
+	}
 }
 
 void NetGameClient::disconnect()
@@ -58,9 +68,25 @@ void NetGameClient::disconnect()
 	if (impl->connection.get() != nullptr)
 		impl->connection->disconnect();
 	impl->connection.reset();
+	impl->udp_host.reset();
 	impl->events.clear();
 }
 
+void NetGameClient::set_transport(NetGameTransport transport)
+{
+	impl->transport = transport;
+}
+
+void NetGameClient::set_mtu(int mtu)
+{
+	impl->mtu = mtu;
+}
+
+void NetGameClient::set_event_schema(const NetGameEventSchema &schema)
+{
+	impl->schema = schema;
+}
+
 void NetGameClient::process_events()
 {
 	impl->process();
@@ -72,6 +98,12 @@ void NetGameClient::send_event(const NetGameEvent &game_event)
 		impl->connection->send_event(game_event);
 }
 
+void NetGameClient::send_event(const NetGameEvent &game_event, NetGameChannel channel)
+{
+	if (impl->connection.get() != nullptr)
+		impl->connection->send_event(game_event, channel);
+}
+
 Signal<void(const NetGameEvent &)> &NetGameClient::sig_event_received()
 {
 	return impl->sig_game_event_received;
@@ -93,6 +125,11 @@ void NetGameClient::add_network_event(const NetGameNetworkEvent &e)
 	impl->events.push_back(e);
 }
 
+NetGameEventSchema NetGameClient::get_event_schema()
+{
+	return impl->schema;
+}
+
 void NetGameClient_Impl::process()
 {
 	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Network/NetGame/transport.h"
+#include "udp_host.h"
 #include <memory>
 #include <mutex>
 
@@ -42,7 +45,13 @@ public:
 	std::recursive_mutex mutex;
 	std::vector<NetGameNetworkEvent> events;
 
+	NetGameTransport transport = NetGameTransport::tcp;
+	int mtu = 1200;
+
+	// Declared before the connection so the connection is destroyed first
+	std::unique_ptr<NetGameUDPHost> udp_host;
 	std::unique_ptr<NetGameConnection> connection;
+	NetGameEventSchema schema;
 	Signal<void(const NetGameEvent &)> sig_game_event_received;
 	Signal<void()> sig_game_connected;
 	Signal<void()> sig_game_disconnected;
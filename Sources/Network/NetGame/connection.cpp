@@ -29,6 +29,7 @@
 #include "Network/precomp.h"
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/connection_site.h"
+#include "API/Network/NetGame/event_schema.h"
 #include "network_event.h"
 #include "network_data.h"
 #include "connection_impl.h"
@@ -42,12 +43,24 @@ NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const TCPConne
 	impl->start(this, site, connection);
 }
 
+NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection, NetGameReactor *reactor)
+: impl(new NetGameConnection_Impl)
+{
+	impl->start(this, site, connection, reactor);
+}
+
 NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const SocketName &socket_name)
 : impl(new NetGameConnection_Impl)
 {
 	impl->start(this, site, socket_name);
 }
 
+NetGameConnection::NetGameConnection(NetGameConnectionSite *site, NetGameUDPHost *udp_host, const SocketName &peer_name)
+: impl(new NetGameConnection_Impl)
+{
+	impl->start(this, site, udp_host, peer_name);
+}
+
 NetGameConnection::~NetGameConnection()
 {
 	delete impl;
@@ -68,6 +81,11 @@ void NetGameConnection::send_event(const NetGameEvent &game_event)
 	impl->send_event(game_event);
 }
 
+void NetGameConnection::send_event(const NetGameEvent &game_event, NetGameChannel channel)
+{
+	impl->send_event(game_event, channel);
+}
+
 void NetGameConnection::disconnect()
 {
 	impl->disconnect();
@@ -78,4 +96,9 @@ SocketName NetGameConnection::get_remote_name() const
 	return impl->get_remote_name();
 }
 
+NetGameEventSchema NetGameConnectionSite::get_event_schema()
+{
+	return NetGameEventSchema();
+}
+
 }
@@ -34,40 +34,77 @@
 #include "network_event.h"
 #include "network_data.h"
 #include "connection_impl.h"
+#include "reactor.h"
+#include "udp_host.h"
+#include <algorithm>
 
 namespace clan
 {
 
 NetGameConnection_Impl::NetGameConnection_Impl()
+: incoming_event(std::string())
 {
 }
 
-void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const TCPConnection &xconnection)
+void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const TCPConnection &xconnection, NetGameReactor *xreactor)
 {
 	base = xbase;
 	site = xsite;
+	schema = site->get_event_schema();
 	connection = xconnection;
 	socket_name = connection.get_remote_name();
 	is_connected = true;
-	thread = std::thread(&NetGameConnection_Impl::connection_main, this);
+	if (xreactor)
+	{
+		reactor = xreactor;
+		receive_buffer = DataBuffer(max_event_packet_size);
+		reactor->add(this, connection);
+	}
+	else
+	{
+		thread = std::thread(&NetGameConnection_Impl::connection_main, this);
+	}
 }
 
 void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const SocketName &xsocket_name)
 {
 	base = xbase;
 	site = xsite;
+	schema = site->get_event_schema();
 	socket_name = xsocket_name;
 	is_connected = false;
 	thread = std::thread(&NetGameConnection_Impl::connection_main, this);
 }
 
+void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, NetGameUDPHost *xudp_host, const SocketName &peer_name)
+{
+	base = xbase;
+	site = xsite;
+	schema = site->get_event_schema();
+	socket_name = peer_name;
+	is_connected = true;
+	udp_host = xudp_host;
+	udp_host->add(this, peer_name);
+}
+
 NetGameConnection_Impl::~NetGameConnection_Impl()
 {
-	std::unique_lock<std::mutex> mutex_lock(mutex);
-	stop_flag = true;
-	mutex_lock.unlock();
-	worker_event.notify();
-	thread.join();
+	if (udp_host)
+	{
+		udp_host->remove(this);
+	}
+	else if (reactor)
+	{
+		reactor->remove(this);
+	}
+	else
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		stop_flag = true;
+		mutex_lock.unlock();
+		worker_event.notify();
+		thread.join();
+	}
 }
 
 void NetGameConnection_Impl::set_data(const std::string &name, void *new_data)
@@ -96,25 +133,42 @@ void *NetGameConnection_Impl::get_data(const std::string &name) const
 	return nullptr;
 }
 
-void NetGameConnection_Impl::send_event(const NetGameEvent &game_event)
+void NetGameConnection_Impl::send_event(const NetGameEvent &game_event, NetGameChannel channel)
 {
+	send_packet(NetGameNetworkData::send_data(game_event, schema), channel);
+}
+
+void NetGameConnection_Impl::send_packet(const DataBuffer &packet, NetGameChannel channel)
+{
+	if (udp_host)
+	{
+		udp_host->send(this, packet, channel);
+		return;
+	}
+
 	std::unique_lock<std::mutex> mutex_lock(mutex);
 	Message message;
 	message.type = Message::type_message;
-	message.event = game_event;
+	message.packet = packet;
 	send_queue.push_back(message);
 	mutex_lock.unlock();
-	worker_event.notify();
+	notify_worker();
 }
 
 void NetGameConnection_Impl::disconnect()
 {
+	if (udp_host)
+	{
+		udp_host->disconnect(this);
+		return;
+	}
+
 	std::unique_lock<std::mutex> mutex_lock(mutex);
 	Message message;
 	message.type = Message::type_disconnect;
 	send_queue.push_back(message);
 	mutex_lock.unlock();
-	worker_event.notify();
+	notify_worker();
 }
 
 SocketName NetGameConnection_Impl::get_remote_name() const
@@ -122,7 +176,15 @@ SocketName NetGameConnection_Impl::get_remote_name() const
 	return socket_name;
 }
 
-bool NetGameConnection_Impl::read_connection_data(DataBuffer &receive_buffer, int &bytes_received)
+void NetGameConnection_Impl::notify_worker()
+{
+	if (reactor)
+		reactor->wake(this);
+	else
+		worker_event.notify();
+}
+
+bool NetGameConnection_Impl::read_connection_data()
 {
 	while (true)
 	{
@@ -153,29 +215,45 @@ bool NetGameConnection_Impl::read_connection_data(DataBuffer &receive_buffer, in
 
 }
 
-bool NetGameConnection_Impl::write_connection_data(DataBuffer &send_buffer, int &bytes_sent, bool &send_graceful_close)
+bool NetGameConnection_Impl::write_connection_data()
 {
 	while (true)
 	{
-		int bytes = connection.write(send_buffer.get_data() + bytes_sent, send_buffer.get_size() - bytes_sent);
-		if (bytes < 0)
-			return false;
-
-		bytes_sent += bytes;
-
-		if (bytes_sent == send_buffer.get_size())
+		if (send_packets.empty())
 		{
 			if (send_graceful_close)
 			{
 				connection.close();
 				return true;
 			}
-			else
-			{
-				bytes_sent = 0;
-				send_buffer.set_size(0);
-				send_graceful_close = write_data(send_buffer);
-			}
+
+			send_graceful_close = write_data(send_packets);
+			if (send_packets.empty() && !send_graceful_close)
+				return false;
+			continue;
+		}
+
+		// Hand the queued packets to the socket in one gather write, straight from the shared packet buffers
+		const void *data[max_write_packets];
+		int sizes[max_write_packets];
+		int count = std::min((int)send_packets.size(), (int)max_write_packets);
+		for (int i = 0; i < count; i++)
+		{
+			data[i] = send_packets[i].get_data();
+			sizes[i] = send_packets[i].get_size();
+		}
+		data[0] = send_packets[0].get_data() + bytes_sent;
+		sizes[0] -= bytes_sent;
+
+		int bytes = connection.write(data, sizes, count);
+		if (bytes < 0)
+			return false;
+
+		bytes_sent += bytes;
+		while (!send_packets.empty() && bytes_sent >= (int)send_packets.front().get_size())
+		{
+			bytes_sent -= send_packets.front().get_size();
+			send_packets.pop_front();
 		}
 	}
 }
@@ -189,19 +267,13 @@ void NetGameConnection_Impl::connection_main()
 		is_connected = true;
 		site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_connected));
 
-		int bytes_received = 0;
-		int bytes_sent = 0;
-		const int max_event_packet_size = 32000 + 2;
-		DataBuffer receive_buffer(max_event_packet_size);
-		DataBuffer send_buffer;
-
-		bool send_graceful_close = false;
+		receive_buffer = DataBuffer(max_event_packet_size);
 
 		while (true)
 		{
-			if (read_connection_data(receive_buffer, bytes_received))
+			if (read_connection_data())
 				break;
-			if (write_connection_data(send_buffer, bytes_sent, send_graceful_close))
+			if (write_connection_data())
 				break;
 
 			std::unique_lock<std::mutex> lock(mutex);
@@ -219,20 +291,41 @@ void NetGameConnection_Impl::connection_main()
 	}
 }
 
+bool NetGameConnection_Impl::process_io()
+{
+	try
+	{
+		if (!connected_event_sent)
+		{
+			site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_connected));
+			connected_event_sent = true;
+		}
+
+		if (read_connection_data() || write_connection_data())
+		{
+			site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected));
+			return true;
+		}
+		return false;
+	}
+	catch (const Exception& e)
+	{
+		site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected, NetGameEvent(e.message)));
+		return true;
+	}
+}
+
 bool NetGameConnection_Impl::read_data(const void *data, int size, int &bytes_consumed)
 {
 	bytes_consumed = 0;
 	while (bytes_consumed != size)
 	{
 		int bytes = 0;
-		NetGameEvent incoming_event = NetGameNetworkData::receive_data(static_cast<const char*>(data) + bytes_consumed, size - bytes_consumed, bytes);
+		if (!NetGameNetworkData::receive_data(static_cast<const char*>(data) + bytes_consumed, size - bytes_consumed, bytes, schema, incoming_event))
+			return false;
 		bytes_consumed += bytes;
 
-		if (bytes == 0)
-		{
-			return false;
-		}
-		else if (incoming_event.get_name() == "_close")
+		if (incoming_event.get_name() == "_close")
 		{
 			return true;
 		}
@@ -242,7 +335,7 @@ bool NetGameConnection_Impl::read_data(const void *data, int size, int &bytes_co
 	return false;
 }
 
-bool NetGameConnection_Impl::write_data(DataBuffer &buffer)
+bool NetGameConnection_Impl::write_data(std::deque<DataBuffer> &packets)
 {
 	std::unique_lock<std::mutex> mutex_lock(mutex);
 	std::vector<Message> new_send_queue;
@@ -252,11 +345,7 @@ bool NetGameConnection_Impl::write_data(DataBuffer &buffer)
 	{
 		if (elem.type == Message::type_message)
 		{
-			DataBuffer packet = NetGameNetworkData::send_data(elem.event);
-
-			int pos = buffer.get_size();
-			buffer.set_size(pos + packet.get_size());
-			memcpy(buffer.get_data() + pos, packet.get_data(), packet.get_size());
+			packets.push_back(elem.packet);
 		}
 		else if (elem.type == Message::type_disconnect)
 		{
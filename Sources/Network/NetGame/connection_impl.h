@@ -29,57 +29,101 @@
 
 #pragma once
 
+#include <deque>
 #include <mutex>
 #include <thread>
 #include "API/Network/Socket/tcp_connection.h"
 #include "API/Network/Socket/socket_name.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Network/NetGame/transport.h"
 
 namespace clan
 {
 
+class NetGameReactor;
+class NetGameReactorThread;
+class NetGameUDPHost;
+class NetGameUDPPeer;
+
 class NetGameConnection_Impl
 {
 public:
 	NetGameConnection_Impl();
 	~NetGameConnection_Impl();
-	void start(NetGameConnection *base, NetGameConnectionSite *site, const TCPConnection &connection);
+	void start(NetGameConnection *base, NetGameConnectionSite *site, const TCPConnection &connection, NetGameReactor *reactor = nullptr);
 	void start(NetGameConnection *base, NetGameConnectionSite *site, const SocketName &socket_name);
+	void start(NetGameConnection *base, NetGameConnectionSite *site, NetGameUDPHost *udp_host, const SocketName &peer_name);
 	void set_data(const std::string &name, void *data);
 	void *get_data(const std::string &name) const;
-	void send_event(const NetGameEvent &game_event);
+	void send_event(const NetGameEvent &game_event, NetGameChannel channel = NetGameChannel::reliable_ordered);
+
+	/// \brief Queues an already encoded event packet
+	///
+	/// The packet data is shared, not copied, so a broadcast can encode once and queue the same packet on every connection.
+	/// TCP connections send every packet on the reliable_ordered channel.
+	void send_packet(const DataBuffer &packet, NetGameChannel channel = NetGameChannel::reliable_ordered);
 	void disconnect();
 	SocketName get_remote_name() const;
 
+	/// \brief Reads and writes until the socket would block
+	///
+	/// Returns true when the connection has closed. The client_disconnected event has been sent at that point.
+	bool process_io();
+
 private:
 	void connection_main();
 
-	bool read_connection_data(DataBuffer &receive_buffer, int &bytes_received);
-	bool write_connection_data(DataBuffer &send_buffer, int &bytes_sent, bool &send_graceful_close);
+	void notify_worker();
+
+	bool read_connection_data();
+	bool write_connection_data();
 
 	bool read_data(const void *data, int size, int &out_bytes_consumed);
-	bool write_data(DataBuffer &buffer);
+	bool write_data(std::deque<DataBuffer> &packets);
+
+	static const int max_event_packet_size = 32000 + 2;
+	static const int max_write_packets = 64;
 
 	NetGameConnection *base;
 
 	NetGameConnectionSite *site;
 
+	NetGameEventSchema schema;
+	NetGameEvent incoming_event;
+
 	NetworkConditionVariable worker_event;
 	TCPConnection connection;
 	SocketName socket_name;
 	bool is_connected;
 	std::thread thread;
+
+	NetGameReactor *reactor = nullptr;
+	NetGameReactorThread *reactor_thread = nullptr;
+	uint64_t reactor_id = 0;
+
+	NetGameUDPHost *udp_host = nullptr;
+	NetGameUDPPeer *udp_peer = nullptr;
+
+	DataBuffer receive_buffer;
+	int bytes_received = 0;
+	std::deque<DataBuffer> send_packets;
+	int bytes_sent = 0;
+	bool send_graceful_close = false;
+	bool connected_event_sent = false;
+
 	bool stop_flag = false;
 	std::mutex mutex;
 	struct Message
 	{
-		Message() : type(type_message), event(std::string()) { }
+		Message() : type(type_message) { }
 		enum Type
 		{
 			type_message,
 			type_disconnect
 		};
 		Type type;
-		NetGameEvent event;
+		DataBuffer packet;
 	};
 	std::vector<Message> send_queue;
 	struct AttachedData
@@ -88,6 +132,10 @@ private:
 		void *data;
 	};
 	std::vector<AttachedData> data;
+
+	friend class NetGameReactor;
+	friend class NetGameReactorThread;
+	friend class NetGameUDPHost;
 };
 
 }
@@ -0,0 +1,87 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/Text/string_format.h"
+#include "event_schema_impl.h"
+#include "network_data.h"
+
+namespace clan
+{
+
+NetGameEventSchema::NetGameEventSchema()
+: impl(std::make_shared<NetGameEventSchema_Impl>())
+{
+}
+
+NetGameEventSchema::~NetGameEventSchema()
+{
+}
+
+int NetGameEventSchema::add_event(const std::string &name, const std::vector<NetGameEventValue::Type> &argument_types)
+{
+	if (impl->event_ids.find(name) != impl->event_ids.end())
+		throw Exception(string_format("Game event %1 is already registered", name));
+	if (impl->events.size() >= NetGameNetworkData::max_schema_events)
+		throw Exception("Too many game events registered");
+
+	int id = impl->events.size();
+	NetGameEventSchema_Impl::EventLayout layout;
+	layout.name = name;
+	layout.argument_types = argument_types;
+	impl->events.push_back(layout);
+	impl->event_ids[name] = id;
+	return id;
+}
+
+int NetGameEventSchema::get_event_count() const
+{
+	return impl->events.size();
+}
+
+int NetGameEventSchema::find_event(const std::string &name) const
+{
+	auto it = impl->event_ids.find(name);
+	return it != impl->event_ids.end() ? it->second : -1;
+}
+
+DataBuffer NetGameEventSchema::encode_event(const NetGameEvent &game_event) const
+{
+	return NetGameNetworkData::send_data(game_event, *this);
+}
+
+void NetGameEventSchema::decode_event(const DataBuffer &packet, NetGameEvent &out_event) const
+{
+	int bytes_consumed = 0;
+	if (!NetGameNetworkData::receive_data(packet.get_data(), packet.get_size(), bytes_consumed, *this, out_event) || bytes_consumed != packet.get_size())
+		throw Exception("Invalid network data");
+}
+
+}
@@ -31,34 +31,46 @@
 #include "API/Core/IOData/memory_device.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Zip/zlib_compression.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Network/NetGame/event_schema.h"
 #include "network_data.h"
+#include "event_schema_impl.h"
 
 namespace clan
 {
 
-NetGameEvent NetGameNetworkData::receive_data(const void *data, int size, int &out_bytes_consumed)
+bool NetGameNetworkData::receive_data(const void *data, int size, int &out_bytes_consumed, const NetGameEventSchema &schema, NetGameEvent &out_event)
 {
-	if (size >= 2)
-	{
-		int payload_size = *static_cast<const unsigned short *>(data);
-		if (payload_size > packet_limit)
-			throw Exception("Incoming message too big");
+	out_bytes_consumed = 0;
+	if (size < 2)
+		return false;
 
-		if (size >= 2 + payload_size)
-		{
-			out_bytes_consumed = 2 + payload_size;
-			DataBuffer buffer(static_cast<const char*>(data) + 2, payload_size);
-			return decode_event(buffer);
-		}
+	int payload_size = *static_cast<const unsigned short *>(data);
+	if (payload_size > packet_limit)
+		throw Exception("Incoming message too big");
+
+	if (size < 2 + payload_size)
+		return false;
+
+	const unsigned char *payload = static_cast<const unsigned char *>(data) + 2;
+	if (payload_size >= 2 && (*reinterpret_cast<const unsigned short*>(payload) & schema_id_flag))
+	{
+		decode_schema_event(schema, payload, payload_size, out_event);
+	}
+	else
+	{
+		DataBuffer buffer(payload, payload_size);
+		out_event = decode_event(buffer);
 	}
 
-	out_bytes_consumed = 0;
-	return NetGameEvent(std::string());
+	out_bytes_consumed = 2 + payload_size;
+	return true;
 }
 
-DataBuffer NetGameNetworkData::send_data(const NetGameEvent &e)
+DataBuffer NetGameNetworkData::send_data(const NetGameEvent &e, const NetGameEventSchema &schema)
 {
-	DataBuffer buffer = encode_event(e);
+	int id = schema.find_event(e.get_name());
+	DataBuffer buffer = (id != -1) ? encode_schema_event(schema, id, e) : encode_event(e);
 	if (buffer.get_size() > packet_limit + 2)
 		throw Exception("Outgoing message too big");
 	return buffer;
@@ -302,4 +314,208 @@ unsigned int NetGameNetworkData::get_encoded_length(const NetGameEventValue &val
 	}
 }
 
+void NetGameNetworkData::decode_schema_event(const NetGameEventSchema &schema, const unsigned char *d, unsigned int length, NetGameEvent &e)
+{
+	unsigned int id = *reinterpret_cast<const unsigned short*>(d) & ~schema_id_flag;
+	if (id >= schema.impl->events.size())
+		throw Exception("Invalid network data");
+
+	const NetGameEventSchema_Impl::EventLayout &layout = schema.impl->events[id];
+
+	// Decode into the storage already held by the event
+	e.name = layout.name;
+	e.arguments.resize(layout.argument_types.size());
+
+	unsigned int pos = 2;
+	for (unsigned int i = 0; i < layout.argument_types.size(); i++)
+		decode_packed_value(layout.argument_types[i], d, length, pos, e.arguments[i]);
+
+	if (pos != length)
+		throw Exception("Invalid network data");
+}
+
+void NetGameNetworkData::decode_packed_value(NetGameEventValue::Type type, const unsigned char *d, unsigned int length, unsigned int &pos, NetGameEventValue &value)
+{
+	switch (type)
+	{
+	case NetGameEventValue::null:
+		break;
+	case NetGameEventValue::uinteger:
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		value.value_uint = *reinterpret_cast<const unsigned int*>(d + pos);
+		pos += 4;
+		break;
+	case NetGameEventValue::integer:
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		value.value_int = *reinterpret_cast<const int*>(d + pos);
+		pos += 4;
+		break;
+	case NetGameEventValue::number:
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		value.value_float = *reinterpret_cast<const float*>(d + pos);
+		pos += 4;
+		break;
+	case NetGameEventValue::boolean:
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		value.value_bool = d[pos] != 0;
+		pos += 1;
+		break;
+	case NetGameEventValue::ucharacter:
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		value.value_uchar = d[pos];
+		pos += 1;
+		break;
+	case NetGameEventValue::character:
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		value.value_char = static_cast<char>(d[pos]);
+		pos += 1;
+		break;
+	case NetGameEventValue::string:
+		{
+			if (pos + 2 > length)
+				throw Exception("Invalid network data");
+			unsigned short string_length = *reinterpret_cast<const unsigned short*>(d + pos);
+			pos += 2;
+			if (pos + string_length > length)
+				throw Exception("Invalid network data");
+			value.value_string.assign(reinterpret_cast<const char*>(d + pos), string_length);
+			pos += string_length;
+			break;
+		}
+	case NetGameEventValue::binary:
+		{
+			if (pos + 2 > length)
+				throw Exception("Invalid network data");
+			unsigned short binary_length = *reinterpret_cast<const unsigned short*>(d + pos);
+			pos += 2;
+			if (pos + binary_length > length)
+				throw Exception("Invalid network data");
+			// A new buffer, as the application may still hold on to the previous one
+			value.value_binary = DataBuffer(reinterpret_cast<const char*>(d + pos), binary_length);
+			pos += binary_length;
+			break;
+		}
+	case NetGameEventValue::complex:
+		{
+			// Members of complex values are not part of the schema and keep their type tags
+			if (pos >= length)
+				throw Exception("Invalid network data");
+			unsigned char tag = d[pos++];
+			if (tag != 8)
+				throw Exception("Invalid network data");
+			value = decode_value(tag, d, length, pos);
+			break;
+		}
+	default:
+		throw Exception("Invalid network data");
+	}
+	value.type = type;
+}
+
+DataBuffer NetGameNetworkData::encode_schema_event(const NetGameEventSchema &schema, int id, const NetGameEvent &e)
+{
+	const NetGameEventSchema_Impl::EventLayout &layout = schema.impl->events[id];
+	if (e.arguments.size() != layout.argument_types.size())
+		throw Exception(string_format("Arguments do not match the schema of game event %1", e.name));
+
+	unsigned int length = 2;
+	for (unsigned int i = 0; i < e.arguments.size(); i++)
+	{
+		if (e.arguments[i].get_type() != layout.argument_types[i])
+			throw Exception(string_format("Arguments do not match the schema of game event %1", e.name));
+		length += get_packed_length(e.arguments[i]);
+	}
+
+	DataBuffer data(length + 2);
+
+	*data.get_data<unsigned short>() = length;
+
+	unsigned char *d = data.get_data<unsigned char>() + 2;
+
+	// Write id in place of the name length
+	*reinterpret_cast<unsigned short*>(d) = schema_id_flag | id;
+	d += 2;
+
+	for (const auto &argument : e.arguments)
+		d += encode_packed_value(d, argument);
+
+	return data;
+}
+
+unsigned int NetGameNetworkData::encode_packed_value(unsigned char *d, const NetGameEventValue &value)
+{
+	switch (value.get_type())
+	{
+	case NetGameEventValue::null:
+		return 0;
+	case NetGameEventValue::uinteger:
+		*reinterpret_cast<unsigned int*>(d) = value.get_uinteger();
+		return 4;
+	case NetGameEventValue::integer:
+		*reinterpret_cast<int*>(d) = value.get_integer();
+		return 4;
+	case NetGameEventValue::number:
+		*reinterpret_cast<float*>(d) = value.get_number();
+		return 4;
+	case NetGameEventValue::boolean:
+		*d = value.get_boolean() ? 1 : 0;
+		return 1;
+	case NetGameEventValue::ucharacter:
+		*d = value.value_uchar;
+		return 1;
+	case NetGameEventValue::character:
+		*reinterpret_cast<char*>(d) = value.value_char;
+		return 1;
+	case NetGameEventValue::string:
+		{
+			const std::string &s = value.value_string;
+			*reinterpret_cast<unsigned short*>(d) = s.length();
+			memcpy(d + 2, s.data(), s.length());
+			return 2 + s.length();
+		}
+	case NetGameEventValue::binary:
+		{
+			const DataBuffer &s = value.value_binary;
+			*reinterpret_cast<unsigned short*>(d) = s.get_size();
+			memcpy(d + 2, s.get_data(), s.get_size());
+			return 2 + s.get_size();
+		}
+	case NetGameEventValue::complex:
+		return encode_value(d, value);
+	default:
+		throw Exception("Unknown game event value type");
+	}
+}
+
+unsigned int NetGameNetworkData::get_packed_length(const NetGameEventValue &value)
+{
+	switch (value.get_type())
+	{
+	case NetGameEventValue::null:
+		return 0;
+	case NetGameEventValue::boolean:
+	case NetGameEventValue::character:
+	case NetGameEventValue::ucharacter:
+		return 1;
+	case NetGameEventValue::uinteger:
+	case NetGameEventValue::integer:
+	case NetGameEventValue::number:
+		return 4;
+	case NetGameEventValue::string:
+		return 2 + value.value_string.length();
+	case NetGameEventValue::binary:
+		return 2 + value.value_binary.get_size();
+	case NetGameEventValue::complex:
+		return get_encoded_length(value);
+	default:
+		throw Exception("Unknown game event value type");
+	}
+}
+
 }
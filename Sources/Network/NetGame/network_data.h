@@ -36,12 +36,19 @@ namespace clan
 {
 
 class DataBuffer;
+class NetGameEventSchema;
 
 class NetGameNetworkData
 {
 public:
-	static NetGameEvent receive_data(const void *data, int size, int &out_bytes_consumed);
-	static DataBuffer send_data(const NetGameEvent &e);
+	/// \brief Decodes the first packet in data into out_event
+	///
+	/// \return false if data does not hold a complete packet yet
+	static bool receive_data(const void *data, int size, int &out_bytes_consumed, const NetGameEventSchema &schema, NetGameEvent &out_event);
+	static DataBuffer send_data(const NetGameEvent &e, const NetGameEventSchema &schema);
+
+	/// Schema event ids share the name length field with schema_id_flag
+	enum { max_schema_events = 0x8000 };
 
 private:
 	static NetGameEvent decode_event(const DataBuffer &data);
@@ -52,7 +59,17 @@ private:
 
 	static NetGameEventValue decode_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos);
 
+	static void decode_schema_event(const NetGameEventSchema &schema, const unsigned char *d, unsigned int length, NetGameEvent &out_event);
+	static DataBuffer encode_schema_event(const NetGameEventSchema &schema, int id, const NetGameEvent &e);
+
+	static unsigned int get_packed_length(const NetGameEventValue &value);
+	static unsigned int encode_packed_value(unsigned char *d, const NetGameEventValue &value);
+	static void decode_packed_value(NetGameEventValue::Type type, const unsigned char *d, unsigned int length, unsigned int &pos, NetGameEventValue &out_value);
+
 	enum { packet_limit = 32000 };
+
+	/// Set in the name length field when the packet carries a schema event id and packed arguments
+	enum { schema_id_flag = 0x8000 };
 };
 
 }
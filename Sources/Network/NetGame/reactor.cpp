@@ -0,0 +1,318 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/connection_site.h"
+#include "API/Network/Socket/tcp_connection.h"
+#include "../Socket/tcp_socket.h"
+#include "reactor.h"
+#include "connection_impl.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace clan
+{
+
+#if defined(__linux__)
+
+class NetGameReactorThread
+{
+public:
+	NetGameReactorThread()
+	{
+		epoll_handle = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_handle == -1)
+			throw Exception("Unable to create epoll handle");
+
+		wake_handle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (wake_handle == -1)
+		{
+			::close(epoll_handle);
+			throw Exception("Unable to create eventfd handle");
+		}
+
+		epoll_event event = { 0 };
+		event.events = EPOLLIN;
+		event.data.u64 = 0;
+		if (epoll_ctl(epoll_handle, EPOLL_CTL_ADD, wake_handle, &event) == -1)
+		{
+			::close(wake_handle);
+			::close(epoll_handle);
+			throw Exception("Unable to add eventfd handle to epoll");
+		}
+
+		thread = std::thread(&NetGameReactorThread::thread_main, this);
+	}
+
+	~NetGameReactorThread()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		set_wake();
+		lock.unlock();
+		thread.join();
+
+		::close(wake_handle);
+		::close(epoll_handle);
+	}
+
+	void add(NetGameConnection_Impl *connection, int socket_handle)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		uint64_t id = next_id++;
+		connection->reactor_thread = this;
+		connection->reactor_id = id;
+		connections[id] = Entry(connection, socket_handle);
+		added.push_back(id);
+		set_wake();
+	}
+
+	void remove(NetGameConnection_Impl *connection)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		uint64_t id = connection->reactor_id;
+		while (processing_id == id)
+			processing_done.wait(lock);
+
+		auto it = connections.find(id);
+		if (it != connections.end())
+		{
+			// Sockets are only closed by the connection when it is done, which already removed it. The handle is still open here.
+			if (it->second.registered)
+				epoll_ctl(epoll_handle, EPOLL_CTL_DEL, it->second.socket_handle, nullptr);
+			connections.erase(it);
+		}
+	}
+
+	void wake(NetGameConnection_Impl *connection)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (connections.find(connection->reactor_id) != connections.end())
+		{
+			woken.push_back(connection->reactor_id);
+			set_wake();
+		}
+	}
+
+private:
+	struct Entry
+	{
+		Entry() { }
+		Entry(NetGameConnection_Impl *connection, int socket_handle) : connection(connection), socket_handle(socket_handle) { }
+
+		NetGameConnection_Impl *connection = nullptr;
+		int socket_handle = -1;
+		bool registered = false;
+	};
+
+	void set_wake()
+	{
+		if (!wake_pending)
+		{
+			wake_pending = true;
+			uint64_t value = 1;
+			::write(wake_handle, &value, sizeof(uint64_t));
+		}
+	}
+
+	void thread_main()
+	{
+		const int max_events = 256;
+		epoll_event events[max_events];
+		std::vector<uint64_t> ready;
+
+		while (true)
+		{
+			int count = epoll_wait(epoll_handle, events, max_events, -1);
+			if (count == -1 && errno != EINTR)
+				break;
+
+			ready.clear();
+			bool woken_up = false;
+			for (int i = 0; i < count; i++)
+			{
+				if (events[i].data.u64 == 0)
+					woken_up = true;
+				else
+					ready.push_back(events[i].data.u64);
+			}
+
+			if (woken_up)
+			{
+				uint64_t value = 0;
+				while (::read(wake_handle, &value, sizeof(uint64_t)) == sizeof(uint64_t));
+
+				std::unique_lock<std::mutex> lock(mutex);
+				if (stop_flag)
+					break;
+				wake_pending = false;
+
+				// Registration happens on this thread only, so a handle closed by a connection on this thread
+				// is always removed from the epoll set before a new socket with the same handle is added.
+				for (uint64_t id : added)
+				{
+					auto it = connections.find(id);
+					if (it != connections.end())
+					{
+						epoll_event event = { 0 };
+						event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+						event.data.u64 = id;
+						it->second.registered = epoll_ctl(epoll_handle, EPOLL_CTL_ADD, it->second.socket_handle, &event) == 0;
+						ready.push_back(id);
+					}
+				}
+				added.clear();
+
+				ready.insert(ready.end(), woken.begin(), woken.end());
+				woken.clear();
+			}
+
+			for (uint64_t id : ready)
+				process(id);
+		}
+	}
+
+	void process(uint64_t id)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (stop_flag)
+			return;
+		auto it = connections.find(id);
+		if (it == connections.end())
+			return;
+		NetGameConnection_Impl *connection = it->second.connection;
+		processing_id = id;
+		lock.unlock();
+
+		bool done = connection->process_io();
+
+		lock.lock();
+		processing_id = 0;
+		if (done)
+		{
+			it = connections.find(id);
+			if (it != connections.end())
+			{
+				if (it->second.registered)
+					epoll_ctl(epoll_handle, EPOLL_CTL_DEL, it->second.socket_handle, nullptr);
+				connections.erase(it);
+			}
+		}
+		processing_done.notify_all();
+	}
+
+	int epoll_handle = -1;
+	int wake_handle = -1;
+	std::thread thread;
+
+	std::mutex mutex;
+	std::condition_variable processing_done;
+	bool stop_flag = false;
+	bool wake_pending = false;
+	uint64_t next_id = 1;
+	uint64_t processing_id = 0;
+	std::unordered_map<uint64_t, Entry> connections;
+	std::vector<uint64_t> added;
+	std::vector<uint64_t> woken;
+};
+
+NetGameReactor::NetGameReactor(int thread_count) : next_thread(0)
+{
+	for (int i = 0; i < thread_count; i++)
+		threads.push_back(std::unique_ptr<NetGameReactorThread>(new NetGameReactorThread()));
+}
+
+NetGameReactor::~NetGameReactor()
+{
+}
+
+bool NetGameReactor::is_supported()
+{
+	return true;
+}
+
+void NetGameReactor::add(NetGameConnection_Impl *connection, TCPConnection &socket)
+{
+	TCPSocket *socket_handle = static_cast<TCPSocket*>(static_cast<NetworkEvent&>(socket).get_socket_handle());
+	threads[next_thread++ % threads.size()]->add(connection, socket_handle->handle);
+}
+
+void NetGameReactor::remove(NetGameConnection_Impl *connection)
+{
+	if (connection->reactor_thread)
+		connection->reactor_thread->remove(connection);
+}
+
+void NetGameReactor::wake(NetGameConnection_Impl *connection)
+{
+	connection->reactor_thread->wake(connection);
+}
+
+#else
+
+class NetGameReactorThread
+{
+};
+
+NetGameReactor::NetGameReactor(int thread_count) : next_thread(0)
+{
+	throw Exception("NetGameReactor is not supported on this platform");
+}
+
+NetGameReactor::~NetGameReactor()
+{
+}
+
+bool NetGameReactor::is_supported()
+{
+	return false;
+}
+
+void NetGameReactor::add(NetGameConnection_Impl *connection, TCPConnection &socket)
+{
+}
+
+void NetGameReactor::remove(NetGameConnection_Impl *connection)
+{
+}
+
+void NetGameReactor::wake(NetGameConnection_Impl *connection)
+{
+}
+
+#endif
+
+}
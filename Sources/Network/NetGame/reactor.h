@@ -0,0 +1,74 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+
+class NetGameConnection_Impl;
+class NetGameReactorThread;
+class TCPConnection;
+
+/// \brief Fixed pool of epoll based I/O threads driving NetGameConnection sockets
+///
+/// Each connection is assigned to one of the threads when added. The thread reads and writes the socket when epoll
+/// reports it ready, or when the connection queues new outgoing events with wake().
+class NetGameReactor
+{
+public:
+	NetGameReactor(int thread_count);
+	~NetGameReactor();
+
+	/// \brief Returns true if the reactor is available on this platform
+	static bool is_supported();
+
+	/// \brief Starts driving the connection from one of the I/O threads
+	void add(NetGameConnection_Impl *connection, TCPConnection &socket);
+
+	/// \brief Stops driving the connection
+	///
+	/// Waits for the I/O thread if it is currently processing the connection.
+	void remove(NetGameConnection_Impl *connection);
+
+	/// \brief Schedules the connection for processing on its I/O thread
+	void wake(NetGameConnection_Impl *connection);
+
+private:
+	NetGameReactor(const NetGameReactor &);
+	NetGameReactor &operator=(const NetGameReactor &);
+
+	std::vector<std::unique_ptr<NetGameReactorThread>> threads;
+	std::atomic<unsigned int> next_thread;
+};
+
+}
@@ -29,12 +29,19 @@
 #include "Network/precomp.h"
 #include "API/Network/NetGame/server.h"
 #include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/event_schema.h"
 #include "API/Network/Socket/socket_name.h"
 #include "network_event.h"
 #include "server_impl.h"
+#include "connection_impl.h"
+#include "network_data.h"
 #include <algorithm>
 #include "API/Network/Socket/tcp_connection.h"
 
+#ifndef WIN32
+#include <sys/socket.h>
+#endif
+
 namespace clan
 {
 
@@ -48,6 +55,31 @@ NetGameServer::~NetGameServer()
 	stop();
 }
 
+void NetGameServer::set_io_thread_count(int count)
+{
+	impl->io_thread_count = count;
+}
+
+void NetGameServer::set_transport(NetGameTransport transport)
+{
+	impl->transport = transport;
+}
+
+void NetGameServer::set_mtu(int mtu)
+{
+	impl->mtu = mtu;
+}
+
+void NetGameServer::set_event_schema(const NetGameEventSchema &schema)
+{
+	impl->schema = schema;
+}
+
+NetGameEventSchema NetGameServer::get_event_schema()
+{
+	return impl->schema;
+}
+
 void NetGameServer::process_events()
 {
 	impl->process();
@@ -61,30 +93,57 @@ void NetGameServer::add_network_event(const NetGameNetworkEvent &e)
 
 void NetGameServer::send_event(const NetGameEvent &game_event)
 {
+	send_event(game_event, NetGameChannel::reliable_ordered);
+}
+
+void NetGameServer::send_event(const NetGameEvent &game_event, NetGameChannel channel)
+{
+	// Encode once; every connection queues the same packet data
+	DataBuffer packet = NetGameNetworkData::send_data(game_event, impl->schema);
+
 	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
 	for (auto & elem : impl->connections)
 	{
-		elem->send_event(game_event);
+		elem->impl->send_packet(packet, channel);
 	}
 }
 
 void NetGameServer::start(const std::string &port)
 {
-	stop();
-	std::unique_lock<std::mutex> lock(impl->mutex);
-	impl->stop_flag = false;
-	lock.unlock();
-	impl->tcp_listen.reset(new TCPListen(SocketName(port)));
-	impl->listen_thread = std::thread(&NetGameServer::listen_thread_main, this);
+	listen(SocketName(port));
 }
 
 void NetGameServer::start(const std::string &address, const std::string &port)
+{
+	listen(SocketName(address, port));
+}
+
+void NetGameServer::listen(const SocketName &endpoint)
 {
 	stop();
 	std::unique_lock<std::mutex> lock(impl->mutex);
 	impl->stop_flag = false;
 	lock.unlock();
-	impl->tcp_listen.reset(new TCPListen(SocketName(address, port)));
+
+	if (impl->transport == NetGameTransport::udp)
+	{
+		impl->udp_host.reset(new NetGameUDPHost(impl->mtu));
+		// The connection registers itself with the host. It is added to our list once the host has released its lock.
+		impl->udp_host->listen(endpoint, [this](const SocketName &peer_name)
+		{
+			new NetGameConnection(this, impl->udp_host.get(), peer_name);
+		},
+		[this](NetGameConnection *connection)
+		{
+			std::unique_lock<std::mutex> lock(impl->mutex);
+			impl->connections.push_back(connection);
+		});
+		return;
+	}
+
+	if (impl->io_thread_count > 0 && NetGameReactor::is_supported())
+		impl->reactor.reset(new NetGameReactor(impl->io_thread_count));
+	impl->tcp_listen.reset(new TCPListen(endpoint, SOMAXCONN));
 	impl->listen_thread = std::thread(&NetGameServer::listen_thread_main, this);
 }
 
@@ -94,14 +153,29 @@ void NetGameServer::stop()
 	impl->stop_flag = true;
 	lock.unlock();
 	impl->worker_event.notify();
-	impl->listen_thread.join();
+	if (impl->listen_thread.joinable())
+		impl->listen_thread.join();
 	impl->tcp_listen.reset();
 
-	for (auto & elem : impl->connections)
+	// Stop accepting before the connections are destroyed, so no peer is added while they are
+	if (impl->udp_host)
+		impl->udp_host->stop();
+
+	std::vector<NetGameConnection *> connections;
+	lock.lock();
+	connections.swap(impl->connections);
+	lock.unlock();
+
+	for (auto & elem : connections)
 	{
 		delete elem;
 	}
-	impl->connections.clear();
+	impl->reactor.reset();
+	impl->udp_host.reset();
+
+	// Drop anything the destroyed connections posted
+	lock.lock();
+	impl->events.clear();
 }
 
 void NetGameServer::listen_thread_main()
@@ -115,11 +189,15 @@ void NetGameServer::listen_thread_main()
 		NetworkEvent *events[] = { impl->tcp_listen.get() };
 		impl->worker_event.wait(lock, 1, events);
 
-		SocketName peer_endpoint;
-		TCPConnection connection = impl->tcp_listen->accept(peer_endpoint);
-		if (!connection.is_null())
+		// Accept everything pending so a burst of clients does not overflow the listen backlog
+		while (true)
 		{
-			std::unique_ptr<NetGameConnection> game_connection(new NetGameConnection(this, connection));
+			SocketName peer_endpoint;
+			TCPConnection connection = impl->tcp_listen->accept(peer_endpoint);
+			if (connection.is_null())
+				break;
+
+			std::unique_ptr<NetGameConnection> game_connection(new NetGameConnection(this, connection, impl->reactor.get()));
 			impl->connections.push_back(game_connection.release());
 		}
 	}
@@ -163,7 +241,7 @@ void NetGameServer_Impl::process()
 				sig_game_client_disconnected(new_event.connection, reason);
 			}
 
-			// Destroy connection object
+			// Destroy connection object. The connection may take the UDP host lock, so not while holding ours.
 			{
 				std::unique_lock<std::mutex> mutex_lock(mutex);
 				std::vector<NetGameConnection *>::iterator connection_it;
@@ -172,6 +250,7 @@ void NetGameServer_Impl::process()
 				{
 					connections.erase( connection_it );
 				}
+				mutex_lock.unlock();
 				delete new_event.connection;
 			}
 			break;
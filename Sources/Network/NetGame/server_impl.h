@@ -29,6 +29,10 @@
 #pragma once
 
 #include "API/Network/Socket/tcp_listen.h"
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Network/NetGame/transport.h"
+#include "reactor.h"
+#include "udp_host.h"
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -44,6 +48,15 @@ public:
 	std::unique_ptr<TCPListen> tcp_listen;
 	std::thread listen_thread;
 
+	int io_thread_count = 0;
+	std::unique_ptr<NetGameReactor> reactor;
+
+	NetGameTransport transport = NetGameTransport::tcp;
+	int mtu = 1200;
+	std::unique_ptr<NetGameUDPHost> udp_host;
+
+	NetGameEventSchema schema;
+
 	NetworkConditionVariable worker_event;
 	std::mutex mutex;
 	bool stop_flag = false;
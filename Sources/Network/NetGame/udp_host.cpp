@@ -0,0 +1,667 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/connection_site.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/System/system.h"
+#include "network_event.h"
+#include "network_data.h"
+#include "connection_impl.h"
+#include "udp_host.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace clan
+{
+
+namespace
+{
+	const uint32_t protocol_magic = 0x43504e47;
+	const int header_size = 12;
+	const int max_datagram_size = 65507;
+
+	const int tick_interval = 10;
+	const int keepalive_interval = 100;
+	const int connection_timeout = 10000;
+	const int min_resend_timeout = 30;
+	const int initial_resend_timeout = 100;
+	const int disconnect_repeat = 3;
+
+	/// Sent datagrams remembered for acknowledgement. Also bounds the reliable messages in flight.
+	const int sent_packet_window = 1024;
+	const int reliable_window = 512;
+
+	enum MessageType
+	{
+		message_connect = 1,
+		message_accept = 2,
+		message_disconnect = 3,
+		message_unreliable = 4,
+		message_sequenced = 5,
+		message_reliable = 6
+	};
+
+	uint16_t read_uint16(const unsigned char *d)
+	{
+		uint16_t value;
+		memcpy(&value, d, sizeof(value));
+		return value;
+	}
+
+	uint32_t read_uint32(const unsigned char *d)
+	{
+		uint32_t value;
+		memcpy(&value, d, sizeof(value));
+		return value;
+	}
+
+	void write_uint16(unsigned char *d, uint16_t value)
+	{
+		memcpy(d, &value, sizeof(value));
+	}
+
+	void write_uint32(unsigned char *d, uint32_t value)
+	{
+		memcpy(d, &value, sizeof(value));
+	}
+
+	/// Returns the size of the length prefixed event packet at d, or -1 if it does not fit in size
+	int get_event_packet_size(const unsigned char *d, int size)
+	{
+		if (size < 2)
+			return -1;
+		int packet_size = 2 + read_uint16(d);
+		return packet_size <= size ? packet_size : -1;
+	}
+}
+
+class NetGameUDPPeer
+{
+public:
+	NetGameUDPPeer() : sent_packets(sent_packet_window) { }
+
+	enum State
+	{
+		state_connecting,
+		state_connected,
+		state_closed
+	};
+
+	struct SentPacket
+	{
+		bool in_use = false;
+		uint16_t sequence = 0;
+		uint64_t send_time = 0;
+		std::vector<uint16_t> reliable_ids;
+	};
+
+	struct ReliableMessage
+	{
+		uint16_t id = 0;
+		DataBuffer packet;
+		uint64_t send_time = 0;
+		bool acked = false;
+	};
+
+	SocketName name;
+	NetGameConnection_Impl *connection = nullptr;
+	State state = state_connecting;
+	bool send_accept = false;
+	bool disconnect_requested = false;
+	uint64_t last_receive_time = 0;
+	uint64_t last_send_time = 0;
+	bool ack_pending = false;
+
+	uint16_t local_sequence = 0;
+	std::vector<SentPacket> sent_packets;
+	float round_trip_time = 0.0f;
+
+	uint16_t next_reliable_id = 0;
+	std::deque<ReliableMessage> reliable_queue;
+	uint16_t next_sequenced_id = 0;
+	std::deque<std::pair<uint16_t, DataBuffer>> sequenced_queue;
+	std::deque<DataBuffer> unreliable_queue;
+
+	uint16_t remote_sequence = 0;
+	uint32_t remote_ack_bits = 0;
+	uint16_t expected_reliable_id = 0;
+	std::map<uint16_t, DataBuffer> reliable_received;
+	bool sequenced_received = false;
+	uint16_t last_sequenced_id = 0;
+};
+
+NetGameUDPHost::NetGameUDPHost(int mtu)
+: mtu(mtu)
+{
+	if (mtu < header_size + 64 || mtu > max_datagram_size)
+		throw Exception("Invalid NetGame MTU");
+	thread = std::thread(&NetGameUDPHost::thread_main, this);
+}
+
+NetGameUDPHost::~NetGameUDPHost()
+{
+	stop();
+}
+
+void NetGameUDPHost::listen(const SocketName &endpoint, const std::function<void(const SocketName &)> &new_func_accept, const std::function<void(NetGameConnection *)> &new_func_accepted)
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	socket.bind(endpoint);
+	func_accept = new_func_accept;
+	func_accepted = new_func_accepted;
+}
+
+void NetGameUDPHost::stop()
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	stop_flag = true;
+	lock.unlock();
+	worker_event.notify();
+	if (thread.joinable())
+		thread.join();
+}
+
+void NetGameUDPHost::add(NetGameConnection_Impl *connection, const SocketName &peer_name)
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	std::unique_ptr<NetGameUDPPeer> peer(new NetGameUDPPeer());
+	peer->name = peer_name;
+	peer->connection = connection;
+	peer->state = func_accept ? NetGameUDPPeer::state_connected : NetGameUDPPeer::state_connecting;
+	peer->last_receive_time = System::get_time();
+	connection->udp_peer = peer.get();
+	peers[peer_name] = std::move(peer);
+	lock.unlock();
+	worker_event.notify();
+}
+
+void NetGameUDPHost::remove(NetGameConnection_Impl *connection)
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	NetGameUDPPeer *peer = connection->udp_peer;
+	if (!peer)
+		return;
+	if (peer->state != NetGameUDPPeer::state_closed)
+		send_disconnect(peer);
+	connection->udp_peer = nullptr;
+	peers.erase(peer->name);
+}
+
+void NetGameUDPHost::send(NetGameConnection_Impl *connection, const DataBuffer &packet, NetGameChannel channel)
+{
+	if ((int)packet.get_size() > get_max_event_size())
+		throw Exception("NetGameEvent does not fit in the UDP MTU");
+
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	NetGameUDPPeer *peer = connection->udp_peer;
+	if (!peer || peer->state == NetGameUDPPeer::state_closed || peer->disconnect_requested)
+		return;
+
+	switch (channel)
+	{
+	case NetGameChannel::unreliable:
+		peer->unreliable_queue.push_back(packet);
+		break;
+	case NetGameChannel::unreliable_sequenced:
+		peer->sequenced_queue.push_back(std::make_pair(peer->next_sequenced_id++, packet));
+		break;
+	case NetGameChannel::reliable_ordered:
+		{
+			NetGameUDPPeer::ReliableMessage message;
+			message.id = peer->next_reliable_id++;
+			message.packet = packet;
+			peer->reliable_queue.push_back(message);
+		}
+		break;
+	}
+	lock.unlock();
+	worker_event.notify();
+}
+
+void NetGameUDPHost::disconnect(NetGameConnection_Impl *connection)
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	NetGameUDPPeer *peer = connection->udp_peer;
+	if (peer)
+		peer->disconnect_requested = true;
+	lock.unlock();
+	worker_event.notify();
+}
+
+int NetGameUDPHost::get_max_event_size() const
+{
+	return mtu - header_size - 3;
+}
+
+void NetGameUDPHost::thread_main()
+{
+	DataBuffer datagram(max_datagram_size);
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+	while (!stop_flag)
+	{
+		try
+		{
+			while (true)
+			{
+				SocketName from;
+				int size = socket.read(datagram.get_data(), datagram.get_size(), from);
+				if (size < 0)
+					break;
+				receive_datagram(from, datagram.get_data<unsigned char>(), size, System::get_time());
+			}
+		}
+		catch (const Exception &)
+		{
+			// Read errors are reported per datagram on some platforms. The protocol recovers from the lost datagram.
+		}
+
+		update(System::get_time());
+		post_pending_events(lock);
+		if (stop_flag)
+			break;
+
+		NetworkEvent *events[] = { &socket };
+		worker_event.wait(lock, 1, events, tick_interval);
+	}
+}
+
+void NetGameUDPHost::post_event(NetGameConnection_Impl *connection, const NetGameNetworkEvent &event, bool accepted)
+{
+	pending_events.push_back(PendingEvent(connection->site, event, accepted));
+}
+
+void NetGameUDPHost::post_pending_events(std::unique_lock<std::recursive_mutex> &lock)
+{
+	if (pending_events.empty())
+		return;
+
+	std::vector<PendingEvent> events;
+	events.swap(pending_events);
+	std::function<void(NetGameConnection *)> accepted_callback = func_accepted;
+
+	// The sites take their own mutex, which they may hold while calling into the host
+	lock.unlock();
+	for (auto &pending : events)
+	{
+		if (pending.accepted && accepted_callback)
+			accepted_callback(pending.event.connection);
+		pending.site->add_network_event(pending.event);
+	}
+	lock.lock();
+}
+
+void NetGameUDPHost::receive_datagram(const SocketName &from, const unsigned char *data, int size, uint64_t now)
+{
+	if (size < header_size || read_uint32(data) != protocol_magic)
+		return;
+
+	auto it = peers.find(from);
+	if (it == peers.end())
+	{
+		if (!func_accept || !contains_connect_request(data, size))
+			return;
+
+		func_accept(from);
+		it = peers.find(from);
+		if (it == peers.end())
+			return;
+
+		NetGameConnection_Impl *connection = it->second->connection;
+		post_event(connection, NetGameNetworkEvent(connection->base, NetGameNetworkEvent::client_connected), true);
+	}
+
+	NetGameUDPPeer *peer = it->second.get();
+	if (peer->state == NetGameUDPPeer::state_closed)
+		return;
+
+	// Only the server answers, so any datagram from it means the connect request was accepted
+	if (peer->state == NetGameUDPPeer::state_connecting)
+	{
+		peer->state = NetGameUDPPeer::state_connected;
+		post_event(peer->connection, NetGameNetworkEvent(peer->connection->base, NetGameNetworkEvent::client_connected));
+	}
+
+	peer->last_receive_time = now;
+	peer->ack_pending = true;
+
+	uint16_t ack = read_uint16(data + 6);
+	uint32_t ack_bits = read_uint32(data + 8);
+	acknowledge_sent_packet(peer, ack, now);
+	for (int i = 0; i < 32; i++)
+	{
+		if (ack_bits & (1u << i))
+			acknowledge_sent_packet(peer, ack - 1 - i, now);
+	}
+	while (!peer->reliable_queue.empty() && peer->reliable_queue.front().acked)
+		peer->reliable_queue.pop_front();
+
+	// A datagram received twice still carries acks, but its messages have been handled already
+	if (!update_received_sequence(peer, read_uint16(data + 4)))
+		return;
+
+	int pos = header_size;
+	while (pos < size && peer->state != NetGameUDPPeer::state_closed)
+	{
+		int type = data[pos++];
+		switch (type)
+		{
+		case message_connect:
+			peer->send_accept = true;
+			break;
+		case message_accept:
+			break;
+		case message_disconnect:
+			close_peer(peer, std::string());
+			return;
+		case message_unreliable:
+			{
+				int packet_size = get_event_packet_size(data + pos, size - pos);
+				if (packet_size < 0)
+					return;
+				receive_event(peer, data + pos, packet_size);
+				pos += packet_size;
+			}
+			break;
+		case message_sequenced:
+			{
+				if (pos + 2 > size)
+					return;
+				uint16_t id = read_uint16(data + pos);
+				int packet_size = get_event_packet_size(data + pos + 2, size - pos - 2);
+				if (packet_size < 0)
+					return;
+				if (!peer->sequenced_received || sequence_delta(id, peer->last_sequenced_id) > 0)
+				{
+					peer->sequenced_received = true;
+					peer->last_sequenced_id = id;
+					receive_event(peer, data + pos + 2, packet_size);
+				}
+				pos += 2 + packet_size;
+			}
+			break;
+		case message_reliable:
+			{
+				if (pos + 2 > size)
+					return;
+				uint16_t id = read_uint16(data + pos);
+				int packet_size = get_event_packet_size(data + pos + 2, size - pos - 2);
+				if (packet_size < 0)
+					return;
+				receive_reliable(peer, id, data + pos + 2, packet_size);
+				pos += 2 + packet_size;
+			}
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+void NetGameUDPHost::receive_reliable(NetGameUDPPeer *peer, uint16_t id, const unsigned char *data, int size)
+{
+	int delta = sequence_delta(id, peer->expected_reliable_id);
+	if (delta < 0 || delta >= reliable_window)
+		return;
+
+	if (delta > 0)
+	{
+		// Hold on to it until the messages before it have arrived
+		if (peer->reliable_received.find(id) == peer->reliable_received.end())
+			peer->reliable_received[id] = DataBuffer(data, size);
+		return;
+	}
+
+	receive_event(peer, data, size);
+	peer->expected_reliable_id++;
+
+	while (peer->state != NetGameUDPPeer::state_closed)
+	{
+		auto it = peer->reliable_received.find(peer->expected_reliable_id);
+		if (it == peer->reliable_received.end())
+			break;
+		DataBuffer packet = it->second;
+		peer->reliable_received.erase(it);
+		receive_event(peer, packet.get_data<unsigned char>(), packet.get_size());
+		peer->expected_reliable_id++;
+	}
+}
+
+void NetGameUDPHost::receive_event(NetGameUDPPeer *peer, const unsigned char *data, int size)
+{
+	NetGameConnection_Impl *connection = peer->connection;
+	try
+	{
+		int bytes = 0;
+		if (!NetGameNetworkData::receive_data(data, size, bytes, connection->schema, connection->incoming_event) || bytes != size)
+			throw Exception("Invalid NetGameEvent packet");
+		post_event(connection, NetGameNetworkEvent(connection->base, connection->incoming_event));
+	}
+	catch (const Exception &e)
+	{
+		close_peer(peer, e.message);
+	}
+}
+
+bool NetGameUDPHost::update_received_sequence(NetGameUDPPeer *peer, uint16_t sequence)
+{
+	int delta = sequence_delta(sequence, peer->remote_sequence);
+	if (delta > 0)
+	{
+		// Shift the previous most recent sequence into the bitfield, followed by the gap
+		uint64_t bits = ((uint64_t)peer->remote_ack_bits << 1) | 1;
+		peer->remote_ack_bits = delta <= 32 ? (uint32_t)(bits << (delta - 1)) : 0;
+		peer->remote_sequence = sequence;
+		return true;
+	}
+	else if (delta < 0 && delta >= -32)
+	{
+		uint32_t bit = 1u << (-delta - 1);
+		if (peer->remote_ack_bits & bit)
+			return false;
+		peer->remote_ack_bits |= bit;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+void NetGameUDPHost::acknowledge_sent_packet(NetGameUDPPeer *peer, uint16_t sequence, uint64_t now)
+{
+	NetGameUDPPeer::SentPacket &sent = peer->sent_packets[sequence % sent_packet_window];
+	if (!sent.in_use || sent.sequence != sequence)
+		return;
+	sent.in_use = false;
+
+	float sample = (float)(now - sent.send_time);
+	peer->round_trip_time = peer->round_trip_time == 0.0f ? sample : peer->round_trip_time * 0.9f + sample * 0.1f;
+
+	if (peer->reliable_queue.empty())
+		return;
+	uint16_t first_id = peer->reliable_queue.front().id;
+	for (uint16_t id : sent.reliable_ids)
+	{
+		uint16_t index = id - first_id;
+		if (index < peer->reliable_queue.size() && peer->reliable_queue[index].id == id)
+			peer->reliable_queue[index].acked = true;
+	}
+}
+
+void NetGameUDPHost::update(uint64_t now)
+{
+	for (auto &it : peers)
+	{
+		NetGameUDPPeer *peer = it.second.get();
+		if (peer->state == NetGameUDPPeer::state_closed)
+			continue;
+
+		if (now - peer->last_receive_time > (uint64_t)connection_timeout)
+		{
+			close_peer(peer, peer->state == NetGameUDPPeer::state_connecting ? "Could not connect to server" : "Connection timed out");
+			continue;
+		}
+
+		send_queued(peer, now);
+
+		if (peer->disconnect_requested && peer->reliable_queue.empty())
+		{
+			send_disconnect(peer);
+			close_peer(peer, std::string());
+		}
+	}
+}
+
+void NetGameUDPHost::send_queued(NetGameUDPPeer *peer, uint64_t now)
+{
+	DataBuffer datagram(mtu);
+	unsigned char *d = datagram.get_data<unsigned char>();
+	int pos = header_size;
+	std::vector<uint16_t> reliable_ids;
+
+	if (peer->state == NetGameUDPPeer::state_connecting)
+		d[pos++] = message_connect;
+	if (peer->send_accept)
+	{
+		d[pos++] = message_accept;
+		peer->send_accept = false;
+	}
+
+	// Coalesce the queued messages, starting a new datagram whenever the next message does not fit
+	auto reserve = [&](int message_size)
+	{
+		if (pos + message_size > mtu)
+		{
+			send_datagram(peer, datagram, pos, reliable_ids, now);
+			pos = header_size;
+		}
+	};
+
+	uint64_t resend_timeout = peer->round_trip_time == 0.0f ? initial_resend_timeout : std::max((uint64_t)(peer->round_trip_time * 2.0f), (uint64_t)min_resend_timeout);
+	uint16_t first_id = peer->reliable_queue.empty() ? 0 : peer->reliable_queue.front().id;
+	for (auto &message : peer->reliable_queue)
+	{
+		if (sequence_delta(message.id, first_id) >= reliable_window)
+			break;
+		if (message.acked || (message.send_time != 0 && now - message.send_time < resend_timeout))
+			continue;
+
+		reserve(3 + message.packet.get_size());
+		d[pos] = message_reliable;
+		write_uint16(d + pos + 1, message.id);
+		memcpy(d + pos + 3, message.packet.get_data(), message.packet.get_size());
+		pos += 3 + message.packet.get_size();
+		reliable_ids.push_back(message.id);
+		message.send_time = now;
+	}
+
+	for (auto &message : peer->sequenced_queue)
+	{
+		reserve(3 + message.second.get_size());
+		d[pos] = message_sequenced;
+		write_uint16(d + pos + 1, message.first);
+		memcpy(d + pos + 3, message.second.get_data(), message.second.get_size());
+		pos += 3 + message.second.get_size();
+	}
+	peer->sequenced_queue.clear();
+
+	for (auto &packet : peer->unreliable_queue)
+	{
+		reserve(1 + packet.get_size());
+		d[pos] = message_unreliable;
+		memcpy(d + pos + 1, packet.get_data(), packet.get_size());
+		pos += 1 + packet.get_size();
+	}
+	peer->unreliable_queue.clear();
+
+	if (pos > header_size || peer->ack_pending || now - peer->last_send_time >= (uint64_t)keepalive_interval)
+		send_datagram(peer, datagram, pos, reliable_ids, now);
+}
+
+void NetGameUDPHost::send_disconnect(NetGameUDPPeer *peer)
+{
+	DataBuffer datagram(header_size + 1);
+	datagram.get_data<unsigned char>()[header_size] = message_disconnect;
+	std::vector<uint16_t> reliable_ids;
+
+	// Nothing acknowledges a disconnect, so send it a few times to get past light packet loss
+	for (int i = 0; i < disconnect_repeat; i++)
+		send_datagram(peer, datagram, datagram.get_size(), reliable_ids, System::get_time());
+}
+
+void NetGameUDPHost::send_datagram(NetGameUDPPeer *peer, DataBuffer &datagram, int size, std::vector<uint16_t> &reliable_ids, uint64_t now)
+{
+	uint16_t sequence = ++peer->local_sequence;
+
+	unsigned char *d = datagram.get_data<unsigned char>();
+	write_uint32(d, protocol_magic);
+	write_uint16(d + 4, sequence);
+	write_uint16(d + 6, peer->remote_sequence);
+	write_uint32(d + 8, peer->remote_ack_bits);
+
+	NetGameUDPPeer::SentPacket &sent = peer->sent_packets[sequence % sent_packet_window];
+	sent.in_use = true;
+	sent.sequence = sequence;
+	sent.send_time = now;
+	sent.reliable_ids.swap(reliable_ids);
+	reliable_ids.clear();
+
+	socket.send(d, size, peer->name);
+	peer->last_send_time = now;
+	peer->ack_pending = false;
+}
+
+void NetGameUDPHost::close_peer(NetGameUDPPeer *peer, const std::string &reason)
+{
+	peer->state = NetGameUDPPeer::state_closed;
+	peer->reliable_queue.clear();
+	peer->sequenced_queue.clear();
+	peer->unreliable_queue.clear();
+	peer->reliable_received.clear();
+
+	NetGameConnection_Impl *connection = peer->connection;
+	if (reason.empty())
+		post_event(connection, NetGameNetworkEvent(connection->base, NetGameNetworkEvent::client_disconnected));
+	else
+		post_event(connection, NetGameNetworkEvent(connection->base, NetGameNetworkEvent::client_disconnected, NetGameEvent(reason)));
+}
+
+bool NetGameUDPHost::contains_connect_request(const unsigned char *data, int size)
+{
+	return size > header_size && data[header_size] == message_connect;
+}
+
+int NetGameUDPHost::sequence_delta(uint16_t s1, uint16_t s2)
+{
+	return (int16_t)(uint16_t)(s1 - s2);
+}
+
+}
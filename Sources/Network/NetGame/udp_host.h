@@ -0,0 +1,138 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/transport.h"
+#include "API/Network/Socket/udp_socket.h"
+#include "API/Network/Socket/socket_name.h"
+#include "API/Network/Socket/network_condition_variable.h"
+#include "API/Core/System/databuffer.h"
+#include "network_event.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace clan
+{
+
+class NetGameConnection;
+class NetGameConnection_Impl;
+class NetGameConnectionSite;
+class NetGameUDPPeer;
+
+/// \brief Runs the NetGame UDP protocol for every connection sharing one UDP socket
+///
+/// Each datagram starts with a packet sequence number and acknowledges the last 33 datagrams received from the peer.
+/// The rest of the datagram is filled with as many queued messages as fit in the MTU. Reliable messages stay queued
+/// until a datagram carrying them is acknowledged and are sent again if that takes longer than about two round trips.
+///
+/// A server host accepts peers that send a connect request. A client host has the single peer it connects to.
+/// Network events are collected while the host mutex is held and posted to the connection sites after it has been
+/// released, so the sites may call into the host while holding their own mutex.
+class NetGameUDPHost
+{
+public:
+	NetGameUDPHost(int mtu);
+	~NetGameUDPHost();
+
+	/// \brief Binds the socket and accepts peers sending a connect request
+	///
+	/// func_accept is called on the host thread, with the host mutex held. It must create the connection for the peer
+	/// and must not take any other lock. func_accepted is then called on the host thread, without the host mutex held,
+	/// before the client_connected event of the connection is posted.
+	void listen(const SocketName &endpoint, const std::function<void(const SocketName &)> &func_accept, const std::function<void(NetGameConnection *)> &func_accepted);
+
+	/// \brief Stops the host thread
+	///
+	/// No peers are accepted and no events are posted after this returns. The connections can still be removed.
+	void stop();
+
+	/// \brief Registers a connection for a peer
+	///
+	/// On a listening host the peer is accepted. Otherwise the host starts sending connect requests to the peer.
+	void add(NetGameConnection_Impl *connection, const SocketName &peer_name);
+
+	/// \brief Unregisters a connection, telling the peer if it is still connected
+	void remove(NetGameConnection_Impl *connection);
+
+	void send(NetGameConnection_Impl *connection, const DataBuffer &packet, NetGameChannel channel);
+
+	/// \brief Closes the connection once everything queued on its reliable channel has been acknowledged
+	void disconnect(NetGameConnection_Impl *connection);
+
+	/// \brief Largest event packet that fits in a single datagram
+	int get_max_event_size() const;
+
+private:
+	/// \brief Network event waiting for the host mutex to be released
+	struct PendingEvent
+	{
+		PendingEvent(NetGameConnectionSite *site, const NetGameNetworkEvent &event, bool accepted) : site(site), event(event), accepted(accepted) { }
+
+		NetGameConnectionSite *site;
+		NetGameNetworkEvent event;
+		bool accepted;
+	};
+
+	void thread_main();
+	void post_event(NetGameConnection_Impl *connection, const NetGameNetworkEvent &event, bool accepted = false);
+	void post_pending_events(std::unique_lock<std::recursive_mutex> &lock);
+
+	void receive_datagram(const SocketName &from, const unsigned char *data, int size, uint64_t now);
+	void receive_event(NetGameUDPPeer *peer, const unsigned char *data, int size);
+	void receive_reliable(NetGameUDPPeer *peer, uint16_t id, const unsigned char *data, int size);
+	bool update_received_sequence(NetGameUDPPeer *peer, uint16_t sequence);
+	void acknowledge_sent_packet(NetGameUDPPeer *peer, uint16_t sequence, uint64_t now);
+
+	void update(uint64_t now);
+	void send_queued(NetGameUDPPeer *peer, uint64_t now);
+	void send_disconnect(NetGameUDPPeer *peer);
+	void send_datagram(NetGameUDPPeer *peer, DataBuffer &datagram, int size, std::vector<uint16_t> &reliable_ids, uint64_t now);
+	void close_peer(NetGameUDPPeer *peer, const std::string &reason);
+
+	static bool contains_connect_request(const unsigned char *data, int size);
+	static int sequence_delta(uint16_t s1, uint16_t s2);
+
+	int mtu;
+
+	UDPSocket socket;
+	std::function<void(const SocketName &)> func_accept;
+	std::function<void(NetGameConnection *)> func_accepted;
+	std::map<SocketName, std::unique_ptr<NetGameUDPPeer>> peers;
+	std::vector<PendingEvent> pending_events;
+
+	std::recursive_mutex mutex;
+	NetworkConditionVariable worker_event;
+	bool stop_flag = false;
+	std::thread thread;
+};
+
+}
@@ -4,10 +4,18 @@
 #include "API/Network/Socket/socket_name.h"
 #include "tcp_socket.h"
 #include "API/Core/System/exception.h"
+#include <algorithm>
+
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
 
 namespace clan
 {
 
+	/// Buffers passed to a single gather write, well below IOV_MAX
+	static const int max_gather_buffers = 64;
+
 #if defined(WIN32)
 
 #pragma comment(lib, "ws2_32.lib")
@@ -75,6 +83,28 @@ namespace clan
 		return result;
 	}
 
+	int TCPConnection::write(const void * const *data, const int *sizes, int count)
+	{
+		WSABUF buffers[max_gather_buffers];
+		count = std::min(count, (int)max_gather_buffers);
+		for (int i = 0; i < count; i++)
+		{
+			buffers[i].buf = const_cast<char *>(static_cast<const char *>(data[i]));
+			buffers[i].len = sizes[i];
+		}
+
+		DWORD bytes_sent = 0;
+		int result = WSASend(impl->handle, buffers, count, &bytes_sent, 0, 0, 0);
+		if (result == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() == WSAEWOULDBLOCK)
+				return -1;
+			else
+				throw Exception("Error writing to server");
+		}
+		return bytes_sent;
+	}
+
 	int TCPConnection::read(void *data, int size)
 	{
 		int result = ::recv(impl->handle, static_cast<char *>(data), size, 0);
@@ -198,6 +228,37 @@ namespace clan
 		return result;
 	}
 
+	int TCPConnection::write(const void * const *data, const int *sizes, int count)
+	{
+		iovec buffers[max_gather_buffers];
+		count = std::min(count, (int)max_gather_buffers);
+		for (int i = 0; i < count; i++)
+		{
+			buffers[i].iov_base = const_cast<void *>(data[i]);
+			buffers[i].iov_len = sizes[i];
+		}
+
+		msghdr message;
+		memset(&message, 0, sizeof(msghdr));
+		message.msg_iov = buffers;
+		message.msg_iovlen = count;
+
+		int result = ::sendmsg(impl->handle, &message, 0);
+		if (result == -1)
+		{
+			if (errno == EWOULDBLOCK)
+			{
+				impl->can_write = false;
+				return -1;
+			}
+			else
+			{
+				throw Exception("Error writing to server");
+			}
+		}
+		return result;
+	}
+
 	int TCPConnection::read(void *data, int size)
 	{
 		int result = ::recv(impl->handle, static_cast<char *>(data), size, 0);
@@ -0,0 +1,150 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Sound/soundfilter.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+
+namespace clan
+{
+
+class SoundBuffer_Session_Impl;
+
+/// \brief Change to the mixer state, sent from the game thread to the mixer thread
+class SoundMixerCommand
+{
+public:
+	enum Type
+	{
+		play_session,
+		stop_session,
+		set_session_volume,
+		set_session_pan,
+		set_session_frequency,
+		set_session_position,
+		set_session_end_position,
+		set_session_looping,
+		set_session_interpolation,
+		add_session_filter,
+		remove_session_filter,
+		set_global_volume,
+		set_global_pan,
+		add_filter,
+		remove_filter,
+
+		/// \brief Sent from the mixer thread back to the game thread, so the last references to sessions and filters are released there
+		release
+	};
+
+	SoundMixerCommand() { }
+	SoundMixerCommand(Type type, const std::shared_ptr<SoundBuffer_Session_Impl> &session, float value = 0.0f) : type(type), session(session), value(value) { }
+	SoundMixerCommand(Type type, const std::shared_ptr<SoundBuffer_Session_Impl> &session, int position) : type(type), session(session), position(position) { }
+	SoundMixerCommand(Type type, const std::shared_ptr<SoundBuffer_Session_Impl> &session, const SoundFilter &filter) : type(type), session(session), filter(filter) { }
+	SoundMixerCommand(Type type, float value) : type(type), value(value) { }
+	SoundMixerCommand(Type type, const SoundFilter &filter) : type(type), filter(filter) { }
+
+	// Commands are only moved, so the references they hold are released by whichever thread ends up owning them
+	SoundMixerCommand(SoundMixerCommand &&other) noexcept { *this = std::move(other); }
+	SoundMixerCommand &operator=(SoundMixerCommand &&other) noexcept
+	{
+		type = other.type;
+		session = std::move(other.session);
+		value = other.value;
+		position = other.position;
+		filter.impl = std::move(other.filter.impl);	// SoundFilter has no move operations of its own
+		return *this;
+	}
+
+	/// \brief Returns true if the command holds a reference to a session or filter
+	bool has_references() const { return session || !filter.is_null(); }
+
+	Type type = play_session;
+	std::shared_ptr<SoundBuffer_Session_Impl> session;
+	float value = 0.0f;
+	int position = 0;
+	SoundFilter filter;
+};
+
+/// \brief Lock-free ring buffer of mixer commands for a single producer and a single consumer thread
+class SoundCommandQueue
+{
+public:
+	SoundCommandQueue(int capacity = 4096) : commands(capacity), read_pos(0), write_pos(0)
+	{
+	}
+
+	/// \brief Adds a command to the queue. Returns false if the queue is full, in which case the command is left untouched
+	///
+	/// Must only be called by the producer thread.
+	bool push(SoundMixerCommand &&command)
+	{
+		unsigned int write = write_pos.load(std::memory_order_relaxed);
+		unsigned int next = (write + 1) % commands.size();
+		if (next == read_pos.load(std::memory_order_acquire))
+			return false;
+
+		commands[write] = std::move(command);
+		write_pos.store(next, std::memory_order_release);
+		return true;
+	}
+
+	/// \brief Returns the number of commands that can be pushed before the queue is full
+	///
+	/// Must only be called by the producer thread. The consumer can only make more room, so the result stays valid until the next push.
+	int get_free_space() const
+	{
+		unsigned int write = write_pos.load(std::memory_order_relaxed);
+		unsigned int read = read_pos.load(std::memory_order_acquire);
+		return (int)((read + commands.size() - write - 1) % commands.size());
+	}
+
+	/// \brief Removes the oldest command from the queue. Returns false if the queue is empty
+	///
+	/// Must only be called by the consumer thread.
+	bool pop(SoundMixerCommand &out_command)
+	{
+		unsigned int read = read_pos.load(std::memory_order_relaxed);
+		if (read == write_pos.load(std::memory_order_acquire))
+			return false;
+
+		out_command = std::move(commands[read]);
+		commands[read] = SoundMixerCommand();
+		read_pos.store((read + 1) % commands.size(), std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::vector<SoundMixerCommand> commands;
+	std::atomic<unsigned int> read_pos;
+	std::atomic<unsigned int> write_pos;
+};
+
+}
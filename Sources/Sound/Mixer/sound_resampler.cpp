@@ -0,0 +1,224 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Sound/precomp.h"
+#include "sound_resampler.h"
+#include <cmath>
+#include <algorithm>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace clan
+{
+
+int SoundResampler::get_lookahead() const
+{
+	switch (interpolation)
+	{
+	case SoundInterpolation::nearest: return 0;
+	case SoundInterpolation::linear: return 1;
+	case SoundInterpolation::cubic: return 2;
+	case SoundInterpolation::sinc: return sinc_taps / 2;
+	}
+	return max_lookahead;
+}
+
+void SoundResampler::resample(const float *input, double position, double speed, float *output, int count)
+{
+	switch (interpolation)
+	{
+	case SoundInterpolation::nearest:
+		resample_nearest(input, position, speed, output, count);
+		break;
+	case SoundInterpolation::linear:
+		resample_linear(input, position, speed, output, count);
+		break;
+	case SoundInterpolation::cubic:
+		resample_cubic(input, position, speed, output, count);
+		break;
+	case SoundInterpolation::sinc:
+		resample_sinc(input, position, speed, output, count);
+		break;
+	}
+}
+
+void SoundResampler::resample_nearest(const float *input, double position, double speed, float *output, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		output[i] = input[(int)position];
+		position += speed;
+	}
+}
+
+void SoundResampler::resample_linear(const float *input, double position, double speed, float *output, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		int index = (int)position;
+		float t = (float)(position - index);
+		float a = input[index];
+		float b = input[index + 1];
+		output[i] = a + (b - a) * t;
+		position += speed;
+	}
+}
+
+void SoundResampler::resample_cubic(const float *input, double position, double speed, float *output, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		int index = (int)position;
+		float t = (float)(position - index);
+		float t2 = t * t;
+		float t3 = t2 * t;
+
+		// Catmull-Rom spline weights for input[index - 1] to input[index + 2]
+		float w0 = -0.5f * t3 + t2 - 0.5f * t;
+		float w1 = 1.5f * t3 - 2.5f * t2 + 1.0f;
+		float w2 = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+		float w3 = 0.5f * t3 - 0.5f * t2;
+
+		const float *samples = input + index - 1;
+#ifndef CL_DISABLE_SSE2
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(samples), _mm_set_ps(w3, w2, w1, w0));
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+		output[i] = _mm_cvtss_f32(sum);
+#else
+		output[i] = samples[0] * w0 + samples[1] * w1 + samples[2] * w2 + samples[3] * w3;
+#endif
+		position += speed;
+	}
+}
+
+void SoundResampler::resample_sinc(const float *input, double position, double speed, float *output, int count)
+{
+	const float *table = get_sinc_table(speed);
+	const int first_tap = sinc_taps / 2 - 1;
+	for (int i = 0; i < count; i++)
+	{
+		int index = (int)position;
+		double phase_position = (position - index) * num_phases;
+		int phase = (int)phase_position;
+		float phase_t = (float)(phase_position - phase);
+
+		// The weights are interpolated between the two nearest phases of the table
+		const float *samples = input + index - first_tap;
+		const float *weights0 = table + phase * sinc_taps;
+		const float *weights1 = weights0 + sinc_taps;
+
+#ifndef CL_DISABLE_SSE2
+		__m128 t = _mm_set1_ps(phase_t);
+		__m128 sum = _mm_setzero_ps();
+		for (int j = 0; j < sinc_taps; j += 4)
+		{
+			__m128 w0 = _mm_loadu_ps(weights0 + j);
+			__m128 w1 = _mm_loadu_ps(weights1 + j);
+			__m128 w = _mm_add_ps(w0, _mm_mul_ps(_mm_sub_ps(w1, w0), t));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(samples + j), w));
+		}
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+		output[i] = _mm_cvtss_f32(sum);
+#else
+		float sum = 0.0f;
+		for (int j = 0; j < sinc_taps; j++)
+			sum += samples[j] * (weights0[j] + (weights1[j] - weights0[j]) * phase_t);
+		output[i] = sum;
+#endif
+		position += speed;
+	}
+}
+
+const float *SoundResampler::get_sinc_table(double speed)
+{
+	struct SincTable
+	{
+		SincTable() { create_sinc_table(table, 1.0f); }
+		float table[(num_phases + 1) * sinc_taps];
+	};
+
+	static SincTable full_band_table;
+	if (speed <= 1.0)
+		return full_band_table.table;
+
+	// When playing faster than the mixing frequency the cutoff must be lowered to avoid aliasing.
+	// The cutoff is quantized so that small pitch changes do not rebuild the table on every fragment.
+	int cutoff_step = std::max((int)(sinc_cutoff_steps / speed), 1);
+	if (cutoff_step >= sinc_cutoff_steps)
+		return full_band_table.table;
+
+	if (cutoff_step != lowpass_sinc_cutoff_step)
+	{
+		lowpass_sinc_table.resize((num_phases + 1) * sinc_taps);
+		create_sinc_table(lowpass_sinc_table.data(), cutoff_step / (float)sinc_cutoff_steps);
+		lowpass_sinc_cutoff_step = cutoff_step;
+	}
+	return lowpass_sinc_table.data();
+}
+
+void SoundResampler::create_sinc_table(float *table, float cutoff)
+{
+	const double pi = 3.14159265358979323846;
+	const int first_tap = sinc_taps / 2 - 1;
+	const double window_radius = sinc_taps / 2;
+
+	// One extra phase at the end, so that a phase can always be interpolated with the next one
+	for (int phase = 0; phase <= num_phases; phase++)
+	{
+		double t = phase / (double)num_phases;
+		float *weights = table + phase * sinc_taps;
+
+		double sum = 0.0;
+		for (int j = 0; j < sinc_taps; j++)
+		{
+			double x = (j - first_tap) - t;
+
+			double sinc = 1.0;
+			if (x != 0.0)
+				sinc = std::sin(pi * cutoff * x) / (pi * cutoff * x);
+
+			// Blackman window
+			double window = 0.0;
+			if (std::abs(x) < window_radius)
+				window = 0.42 + 0.5 * std::cos(pi * x / window_radius) + 0.08 * std::cos(2.0 * pi * x / window_radius);
+
+			weights[j] = (float)(sinc * window);
+			sum += weights[j];
+		}
+
+		// Normalize so that every phase passes a constant signal unchanged
+		for (int j = 0; j < sinc_taps; j++)
+			weights[j] = (float)(weights[j] / sum);
+	}
+}
+
+}
@@ -0,0 +1,84 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Sound/soundbuffer_session.h"
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Converts a channel from the session frequency to the mixer frequency
+///
+/// Sinc interpolation uses a polyphase filter table, so each output sample is a single dot product.
+class SoundResampler
+{
+public:
+	/// \brief Number of input samples the buffer must keep before the read position
+	static const int max_history = 7;
+
+	/// \brief Number of input samples the buffer must have after the read position, for any interpolation
+	static const int max_lookahead = 8;
+
+	void set_interpolation(SoundInterpolation new_interpolation) { interpolation = new_interpolation; }
+	SoundInterpolation get_interpolation() const { return interpolation; }
+
+	/// \brief Number of input samples needed after the read position with the current interpolation
+	int get_lookahead() const;
+
+	/// \brief Resamples a block of samples
+	///
+	/// \param input = Input samples. input[floor(position) - max_history] to input[floor(position + (count - 1) * speed) + get_lookahead()] must be valid
+	/// \param position = Read position of the first output sample
+	/// \param speed = Input samples advanced per output sample
+	/// \param output = Output samples
+	/// \param count = Number of samples to write to output
+	void resample(const float *input, double position, double speed, float *output, int count);
+
+private:
+	void resample_nearest(const float *input, double position, double speed, float *output, int count);
+	void resample_linear(const float *input, double position, double speed, float *output, int count);
+	void resample_cubic(const float *input, double position, double speed, float *output, int count);
+	void resample_sinc(const float *input, double position, double speed, float *output, int count);
+
+	const float *get_sinc_table(double speed);
+	static void create_sinc_table(float *table, float cutoff);
+
+	static const int num_phases = 256;
+	static const int sinc_taps = 16;
+	static const int sinc_cutoff_steps = 32;
+
+	SoundInterpolation interpolation = SoundInterpolation::linear;
+
+	/// \brief Sinc table with a lowered cutoff, used when playing faster than the mixing frequency
+	std::vector<float> lowpass_sinc_table;
+	int lowpass_sinc_cutoff_step = 0;
+};
+
+}
@@ -31,9 +31,21 @@
 #include "API/Core/System/system.h"
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 
 #ifndef CL_DISABLE_SSE2
 #include <emmintrin.h>
+
+// AVX versions of the mixing functions are compiled for x86 and selected at runtime
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CL_SOUND_AVX
+#include <immintrin.h>
+#ifdef __GNUC__
+#define CL_AVX_FUNCTION __attribute__((target("avx")))
+#else
+#define CL_AVX_FUNCTION
+#endif
+#endif
 #endif
 
 #ifdef __MINGW32__
@@ -43,6 +55,124 @@
 namespace clan
 {
 
+#ifdef CL_SOUND_AVX
+
+static bool use_avx()
+{
+	static const bool avx = System::detect_cpu_extension(System::avx);
+	return avx;
+}
+
+CL_AVX_FUNCTION static void pack_float_stereo_clamped_avx(float *input[2], int size, const float volume[2], float *output)
+{
+	int avx_size = (size/8)*8;
+
+	__m256 volume0 = _mm256_set1_ps(volume[0]);
+	__m256 volume1 = _mm256_set1_ps(volume[1]);
+	__m256 min_value = _mm256_set1_ps(-1.0f);
+	__m256 max_value = _mm256_set1_ps(1.0f);
+	for (int i = 0; i < avx_size; i+=8)
+	{
+		__m256 samples0 = _mm256_mul_ps(_mm256_loadu_ps(input[0]+i), volume0);
+		__m256 samples1 = _mm256_mul_ps(_mm256_loadu_ps(input[1]+i), volume1);
+		samples0 = _mm256_max_ps(_mm256_min_ps(samples0, max_value), min_value);
+		samples1 = _mm256_max_ps(_mm256_min_ps(samples1, max_value), min_value);
+
+		// unpacklo/unpackhi interleave within each 128 bit lane, the permutes put the lanes back in order
+		__m256 tmp0 = _mm256_unpacklo_ps(samples0, samples1);
+		__m256 tmp1 = _mm256_unpackhi_ps(samples0, samples1);
+		_mm256_storeu_ps(output+i*2, _mm256_permute2f128_ps(tmp0, tmp1, 0x20));
+		_mm256_storeu_ps(output+i*2+8, _mm256_permute2f128_ps(tmp0, tmp1, 0x31));
+	}
+
+	for (int i = avx_size; i < size; i++)
+	{
+		output[i*2] = std::max(std::min(input[0][i] * volume[0], 1.0f), -1.0f);
+		output[i*2 + 1] = std::max(std::min(input[1][i] * volume[1], 1.0f), -1.0f);
+	}
+}
+
+CL_AVX_FUNCTION static void multiply_float_avx(float *channel, int size, float volume)
+{
+	int avx_size = (size/8)*8;
+
+	__m256 volume0 = _mm256_set1_ps(volume);
+	for (int i = 0; i < avx_size; i+=8)
+	{
+		__m256 s = _mm256_loadu_ps(channel+i);
+		_mm256_storeu_ps(channel+i, _mm256_mul_ps(s, volume0));
+	}
+
+	for (int i = avx_size; i < size; i++)
+		channel[i] *= volume;
+}
+
+CL_AVX_FUNCTION static void mix_one_to_one_avx(float *input, int size, float *output, float volume)
+{
+	int avx_size = (size/8)*8;
+
+	__m256 volume0 = _mm256_set1_ps(volume);
+	for (int i = 0; i < avx_size; i+=8)
+	{
+		__m256 sample0 = _mm256_loadu_ps(input+i);
+		__m256 sample1 = _mm256_loadu_ps(output+i);
+		_mm256_storeu_ps(output+i, _mm256_add_ps(_mm256_mul_ps(sample0, volume0), sample1));
+	}
+
+	for (int i = avx_size; i < size; i++)
+		output[i] += input[i] * volume;
+}
+
+CL_AVX_FUNCTION static void mix_one_to_many_avx(float *input, int size, float **output, float *volume, int channels)
+{
+	int avx_size = (size/8)*8;
+
+	for (int i = 0; i < avx_size; i+=8)
+	{
+		__m256 sample0 = _mm256_loadu_ps(input+i);
+		for (int j = 0; j < channels; j++)
+		{
+			__m256 sample1 = _mm256_loadu_ps(output[j]+i);
+			__m256 volume0 = _mm256_set1_ps(volume[j]);
+			_mm256_storeu_ps(output[j]+i, _mm256_add_ps(_mm256_mul_ps(sample0, volume0), sample1));
+		}
+	}
+
+	for (int i = avx_size; i < size; i++)
+	{
+		float sample0 = input[i];
+		for (int j = 0; j < channels; j++)
+			output[j][i] += sample0 * volume[j];
+	}
+}
+
+CL_AVX_FUNCTION static void mix_many_to_one_avx(float **input, float *volume, int channels, int size, float *output)
+{
+	int avx_size = (size/8)*8;
+
+	for (int i = 0; i < avx_size; i+=8)
+	{
+		__m256 sample0 = _mm256_loadu_ps(output+i);
+		for (int j = 0; j < channels; j++)
+		{
+			__m256 sample1 = _mm256_loadu_ps(input[j]+i);
+			__m256 volume0 = _mm256_set1_ps(volume[j]);
+			sample0 = _mm256_add_ps(_mm256_mul_ps(sample1, volume0), sample0);
+		}
+		_mm256_storeu_ps(output+i, sample0);
+	}
+
+	for (int i = avx_size; i < size; i++)
+	{
+		float sample0 = output[i];
+		for (int j = 0; j < channels; j++)
+			sample0 += input[j][i] * volume[j];
+		output[i] = sample0;
+	}
+}
+
+#endif
+
 void *SoundSSE::aligned_alloc(int size)
 {
 	return System::aligned_alloc(size, 16);
@@ -259,6 +389,48 @@ void SoundSSE::pack_float_stereo(float *input[2], int size, float *output)
 	}
 }
 
+void SoundSSE::pack_float_stereo_clamped(float *input[2], int size, const float volume[2], float *output)
+{
+#ifdef CL_SOUND_AVX
+	if (use_avx())
+	{
+		pack_float_stereo_clamped_avx(input, size, volume, output);
+		return;
+	}
+#endif
+
+#ifndef CL_DISABLE_SSE2
+	int sse_size = (size/4)*4;
+
+	__m128 volume0 = _mm_set1_ps(volume[0]);
+	__m128 volume1 = _mm_set1_ps(volume[1]);
+	__m128 min_value = _mm_set1_ps(-1.0f);
+	__m128 max_value = _mm_set1_ps(1.0f);
+	for (int i = 0; i < sse_size; i+=4)
+	{
+		__m128 samples0 = _mm_mul_ps(_mm_loadu_ps(input[0]+i), volume0);
+		__m128 samples1 = _mm_mul_ps(_mm_loadu_ps(input[1]+i), volume1);
+		samples0 = _mm_max_ps(_mm_min_ps(samples0, max_value), min_value);
+		samples1 = _mm_max_ps(_mm_min_ps(samples1, max_value), min_value);
+		__m128 tmp0, tmp1;
+		tmp0 = _mm_unpacklo_ps(samples0, samples1);
+		tmp1 = _mm_unpackhi_ps(samples0, samples1);
+		_mm_storeu_ps(output+i*2, tmp0);
+		_mm_storeu_ps(output+i*2+4, tmp1);
+	}
+
+#else
+	const int sse_size = 0;
+#endif
+
+	// Pack remaining
+	for (int i = sse_size; i < size; i++)
+	{
+		output[i*2] = std::max(std::min(input[0][i] * volume[0], 1.0f), -1.0f);
+		output[i*2 + 1] = std::max(std::min(input[1][i] * volume[1], 1.0f), -1.0f);
+	}
+}
+
 void SoundSSE::copy_float(float *input, int size, float *output)
 {
 #ifndef CL_DISABLE_SSE2
@@ -281,6 +453,13 @@ void SoundSSE::copy_float(float *input, int size, float *output)
 
 void SoundSSE::multiply_float(float *channel, int size, float volume)
 {
+#ifdef CL_SOUND_AVX
+	if (use_avx())
+	{
+		multiply_float_avx(channel, size, volume);
+		return;
+	}
+#endif
 #ifndef CL_DISABLE_SSE2
 	int sse_size = (size/4)*4;
 
@@ -319,6 +498,13 @@ void SoundSSE::set_float(float *channel, int size, float value)
 
 void SoundSSE::mix_one_to_one(float *input, int size, float *output, float volume)
 {
+#ifdef CL_SOUND_AVX
+	if (use_avx())
+	{
+		mix_one_to_one_avx(input, size, output, volume);
+		return;
+	}
+#endif
 #ifndef CL_DISABLE_SSE2
 	int sse_size = (size/4)*4;
 	__m128 volume0 = _mm_set1_ps(volume);
@@ -341,6 +527,13 @@ void SoundSSE::mix_one_to_one(float *input, int size, float *output, float volum
 
 void SoundSSE::mix_one_to_many(float *input, int size, float **output, float *volume, int channels)
 {
+#ifdef CL_SOUND_AVX
+	if (use_avx())
+	{
+		mix_one_to_many_avx(input, size, output, volume, channels);
+		return;
+	}
+#endif
 #ifndef CL_DISABLE_SSE2
 	int sse_size = (size/4)*4;
 	for (int i = 0; i < sse_size; i+=4)
@@ -370,6 +563,13 @@ void SoundSSE::mix_one_to_many(float *input, int size, float **output, float *vo
 
 void SoundSSE::mix_many_to_one(float **input, float *volume, int channels, int size, float *output)
 {
+#ifdef CL_SOUND_AVX
+	if (use_avx())
+	{
+		mix_many_to_one_avx(input, volume, channels, size, output);
+		return;
+	}
+#endif
 #ifndef CL_DISABLE_SSE2
 	int sse_size = (size/4)*4;
 	for (int i = 0; i < sse_size; i+=4)
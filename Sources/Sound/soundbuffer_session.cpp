@@ -67,8 +67,7 @@ int SoundBuffer_Session::get_position() const
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		return impl->provider_session->get_position();
+		return impl->position.load(std::memory_order_relaxed);
 	}
 	else
 	{
@@ -80,9 +79,8 @@ float SoundBuffer_Session::get_position_relative() const
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		int position = impl->provider_session->get_position();
-		int length = impl->provider_session->get_num_samples();
+		int position = impl->position.load(std::memory_order_relaxed);
+		int length = impl->length;
 		if (length == 0) return 1.0f;
 		return position / (float) length;
 	}
@@ -96,8 +94,7 @@ int SoundBuffer_Session::get_length() const
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		return impl->provider_session->get_num_samples();
+		return impl->length;
 	}
 	else
 	{
@@ -121,7 +118,6 @@ float SoundBuffer_Session::get_volume() const
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		return impl->volume;
 	}
 	else
@@ -134,7 +130,6 @@ float SoundBuffer_Session::get_pan() const
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		return impl->pan;
 	}
 	else
@@ -159,7 +154,6 @@ bool SoundBuffer_Session::is_playing()
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		return impl->playing;
 	}
 	else
@@ -168,6 +162,18 @@ bool SoundBuffer_Session::is_playing()
 	}
 }
 
+SoundInterpolation SoundBuffer_Session::get_interpolation() const
+{
+	if (impl)
+	{
+		return impl->interpolation;
+	}
+	else
+	{
+		return SoundInterpolation::linear;
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // SoundBuffer_Session operations:
 
@@ -175,13 +181,11 @@ bool SoundBuffer_Session::set_position(int new_pos)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		if (impl->provider_session->set_position(new_pos))
-		{
-			// instantly update position here?
-			return true;
-		}
-		return false;
+		// The provider session belongs to the mixer thread, so only the range can be checked here
+		if (new_pos < 0 || (impl->length > 0 && new_pos > impl->length))
+			return false;
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_position, impl, new_pos));
+		return true;
 	}
 	else
 	{
@@ -193,13 +197,10 @@ bool SoundBuffer_Session::set_end_position(int new_pos)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		if (impl->provider_session->set_end_position(new_pos))
-		{
-			// instantly update end position here?
-			return true;
-		}
-		return false;
+		if (new_pos < 0 || (impl->length > 0 && new_pos > impl->length))
+			return false;
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_end_position, impl, new_pos));
+		return true;
 	}
 	else
 	{
@@ -223,47 +224,56 @@ bool SoundBuffer_Session::set_position_relative(float new_pos)
 void SoundBuffer_Session::set_volume(float new_volume)
 {
 	if (impl)
+	{
 		impl->volume = new_volume;
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_volume, impl, new_volume));
+	}
 }
 
 void SoundBuffer_Session::set_frequency(int new_frequency)
 {
 	if (impl)
+	{
 		impl->frequency = new_frequency;
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_frequency, impl, (float)new_frequency));
+	}
+}
+
+void SoundBuffer_Session::set_interpolation(SoundInterpolation interpolation)
+{
+	if (impl)
+	{
+		impl->interpolation = interpolation;
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_interpolation, impl, (int)interpolation));
+	}
 }
 
 void SoundBuffer_Session::set_pan(float new_pan)
 {
 	if (impl)
+	{
 		impl->pan = new_pan;
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_pan, impl, new_pan));
+	}
 }
 
 void SoundBuffer_Session::play()
 {
-	if (impl)
+	if (impl && impl->output.impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		if (impl->playing) return;
-		if (impl->provider_session->play())
-		{
-			impl->playing = true;
-			mutex_lock.unlock();
-			impl->output.impl->play_session(*this);
-		}
+		impl->playing = true;
+		impl->output.impl->play_session(*this);
 	}
 }
 
 void SoundBuffer_Session::stop()
 {
-	if (impl)
+	if (impl && impl->output.impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		if (!impl->playing) return;
-		mutex_lock.unlock();
 		impl->output.impl->stop_session(*this);
-		mutex_lock.lock();
 		impl->playing = false;
-		impl->provider_session->stop();
 	}
 }
 
@@ -271,9 +281,8 @@ void SoundBuffer_Session::set_looping(bool loop)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		impl->looping = loop;
-		impl->provider_session->set_looping(loop);
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::set_session_looping, impl, (int)loop));
 	}
 }
 
@@ -281,8 +290,7 @@ void SoundBuffer_Session::add_filter(SoundFilter &filter)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		impl->filters.push_back(filter);
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::add_session_filter, impl, filter));
 	}
 }
 
@@ -290,14 +298,7 @@ void SoundBuffer_Session::remove_filter(SoundFilter &filter)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		for (std::vector<SoundFilter>::size_type i=0; i<impl->filters.size(); i++)
-		{
-			if (impl->filters[i] == filter)
-			{
-				impl->filters.erase(impl->filters.begin()+i);
-			}
-		}
+		impl->send_command(SoundMixerCommand(SoundMixerCommand::remove_session_filter, impl, filter));
 	}
 }
 
@@ -35,6 +35,9 @@
 #include "API/Sound/SoundProviders/soundprovider.h"
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Core/Text/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace clan
 {
@@ -43,22 +46,35 @@ namespace clan
 //! Construction:
 
 SoundBuffer_Session_Impl::SoundBuffer_Session_Impl(SoundBuffer &soundbuffer, bool looping, SoundOutput &output)
-: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), looping(looping), playing(false)
+: soundbuffer(soundbuffer), output(output), volume(1.0f), pan(0.0f), looping(looping), provider_session(nullptr)
 {
 	volume = soundbuffer.get_volume();
 	pan = soundbuffer.get_pan();
+	interpolation = resampler.get_interpolation();
+	playing = false;
 	provider_session = soundbuffer.get_provider()->begin_session();
 	provider_session->set_looping(looping);
 	frequency = provider_session->get_frequency();
+	length = provider_session->get_num_samples();
+	position = provider_session->get_position();
+	mixer_looping = looping;
+	mixer_volume = volume;
+	mixer_pan = pan;
+	mixer_frequency = frequency;
+	mixer_active = false;
 
 	num_buffer_samples = 16*1024;
 	num_buffer_channels = provider_session->get_num_channels();
-	buffer_position = 0.0;
-	buffer_samples_written = 0;
+	end_of_data_padded = false;
 
 	float_buffer_data = new float*[num_buffer_channels];
 	for (int i=0; i<num_buffer_channels; i++) float_buffer_data[i] = new float[num_buffer_samples];
 
+	// Start with silence as the history needed by the resampler:
+	buffer_position = SoundResampler::max_history;
+	buffer_samples_written = SoundResampler::max_history;
+	for (int i=0; i<num_buffer_channels; i++) SoundSSE::set_float(float_buffer_data[i], buffer_samples_written, 0.0f);
+
 	float_buffer_data_offsetted.resize(num_buffer_channels);
 }
 
@@ -82,17 +98,63 @@ SoundBuffer_Session_Impl::~SoundBuffer_Session_Impl()
 
 bool SoundBuffer_Session_Impl::mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels)
 {
-	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
 	get_data_in_mixer_frequency(num_samples, temp_data);
 	run_filters(temp_data, num_samples);
 	mix_channels(num_channels, num_samples, sample_data, temp_data);
+	position.store(provider_session->get_position(), std::memory_order_relaxed);
 	return playing;
 }
 
+void SoundBuffer_Session_Impl::send_command(SoundMixerCommand &&command)
+{
+	if (output.impl)
+		output.impl->push_command(std::move(command));
+	else
+		apply_command(command);
+}
+
+void SoundBuffer_Session_Impl::apply_command(const SoundMixerCommand &command)
+{
+	switch (command.type)
+	{
+	case SoundMixerCommand::set_session_volume:
+		mixer_volume = command.value;
+		break;
+	case SoundMixerCommand::set_session_pan:
+		mixer_pan = command.value;
+		break;
+	case SoundMixerCommand::set_session_frequency:
+		mixer_frequency = command.value;
+		break;
+	case SoundMixerCommand::set_session_position:
+		provider_session->set_position(command.position);
+		position.store(provider_session->get_position(), std::memory_order_relaxed);
+		break;
+	case SoundMixerCommand::set_session_end_position:
+		provider_session->set_end_position(command.position);
+		break;
+	case SoundMixerCommand::set_session_looping:
+		mixer_looping = command.position != 0;
+		provider_session->set_looping(mixer_looping);
+		break;
+	case SoundMixerCommand::set_session_interpolation:
+		resampler.set_interpolation((SoundInterpolation)command.position);
+		break;
+	case SoundMixerCommand::add_session_filter:
+		filters.push_back(command.filter);
+		break;
+	case SoundMixerCommand::remove_session_filter:
+		filters.erase(std::remove(filters.begin(), filters.end(), command.filter), filters.end());
+		break;
+	default:
+		break;
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // SoundBuffer_Session_Impl implementation:
 
-void SoundBuffer_Session_Impl::get_data()
+void SoundBuffer_Session_Impl::get_data(int start)
 {
 	int num_session_channels = provider_session->get_num_channels();
 	if (num_session_channels != num_buffer_channels)
@@ -104,7 +166,7 @@ void SoundBuffer_Session_Impl::get_data()
 	if (num_session_channels > 0)
 	{
 		// Copy stream data to working buffer:
-		int samples_left = num_buffer_samples;
+		int samples_left = num_buffer_samples - start;
 		while (samples_left > 0)
 		{
 			for (int i = 0; i < num_session_channels; i++)
@@ -116,7 +178,7 @@ void SoundBuffer_Session_Impl::get_data()
 			if (samples_left > 0 && provider_session->eof())
 			{
 				// Reached end of stream, loop if enabled.
-				if (looping)
+				if (mixer_looping)
 				{
 					// Try to loop back to beginning:
 					if (provider_session->set_position(0) == false)
@@ -144,48 +206,89 @@ void SoundBuffer_Session_Impl::get_data()
 	}
 }
 
+bool SoundBuffer_Session_Impl::refill_buffer()
+{
+	// Move the samples still needed to the beginning of the buffers.
+	// When playing much faster than the mixing frequency the position can be past the end of the buffers:
+	int keep_start = std::max(int(buffer_position) - SoundResampler::max_history, 0);
+	keep_start = std::min(keep_start, buffer_samples_written);
+	int keep_samples = buffer_samples_written - keep_start;
+	if (keep_start > 0)
+	{
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			memmove(float_buffer_data[chan], float_buffer_data[chan] + keep_start, sizeof(float) * keep_samples);
+		buffer_position -= keep_start;
+		buffer_samples_written = keep_samples;
+	}
+
+	get_data(keep_samples);
+	if (buffer_samples_written > keep_samples)
+	{
+		end_of_data_padded = false;
+		return true;
+	}
+
+	if (!end_of_data_padded)
+	{
+		// No more data. Append silence so the resampler can play the last samples of the stream:
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			SoundSSE::set_float(float_buffer_data[chan] + buffer_samples_written, SoundResampler::max_lookahead, 0.0f);
+		buffer_samples_written += SoundResampler::max_lookahead;
+		end_of_data_padded = true;
+		return true;
+	}
+
+	return false;
+}
+
 void SoundBuffer_Session_Impl::get_data_in_mixer_frequency(int num_samples, float **temp_data)
 {
 	// Convert from session frequency to mixer frequency:
-	// This is done by copying data from the temporary session buffers (buffer_data) to
-	// the temporary mixing buffers (temp_data), and if buffer_data is exhausted, calling
-	// get_data() to fill it with new data from the soundprovider session object.
-	double speed = frequency / double(output.get_mixing_frequency());
-	int sample_count;
-	for (sample_count = 0; sample_count < num_samples; sample_count++)
+	// This is done by resampling data from the temporary session buffers (buffer_data) to
+	// the temporary mixing buffers (temp_data) in blocks, and if buffer_data is exhausted, calling
+	// refill_buffer() to fill it with new data from the soundprovider session object.
+	double speed = mixer_frequency / double(output.get_mixing_frequency());
+
+	// Sessions playing at the mixing frequency are copied directly
+	bool resample = (speed != 1.0);
+	int lookahead = resample ? resampler.get_lookahead() : 0;
+
+	int sample_count = 0;
+	while (sample_count < num_samples && speed > 0.0)
 	{
-		if (buffer_position < buffer_samples_written)
-		{
-			for (int chan = 0; chan < num_buffer_channels; chan++)
-			{
-				temp_data[chan][sample_count] = float_buffer_data[chan][int(buffer_position)];
-			}
-		}
-		else
+		// Number of output samples that can be produced from the data currently in the buffer:
+		double available = (buffer_samples_written - lookahead) - buffer_position;
+		int block_size = 0;
+		if (available > 0.0)
+			block_size = std::min(num_samples - sample_count, (int)std::ceil(available / speed));
+
+		if (block_size <= 0)
 		{
-			if (provider_session->eof())
+			if (!refill_buffer())
 			{
 				playing = false;
 				break;
 			}
-
-			// Out of data, get more from provider:
-			buffer_position -= buffer_samples_written;
-			get_data();
-			sample_count--;
 			continue;
 		}
 
-		buffer_position += speed;
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+		{
+			if (resample)
+				resampler.resample(float_buffer_data[chan], buffer_position, speed, temp_data[chan] + sample_count, block_size);
+			else
+				SoundSSE::copy_float(float_buffer_data[chan] + int(buffer_position), block_size, temp_data[chan] + sample_count);
+		}
+
+		buffer_position += block_size * speed;
+		sample_count += block_size;
 	}
 
 	// Clear the remaining samples (if any)
-	for (; sample_count < num_samples; sample_count++)
+	if (sample_count < num_samples)
 	{
 		for (int chan = 0; chan < num_buffer_channels; chan++)
-		{
-			temp_data[chan][sample_count] = 0.0f;
-		}
+			SoundSSE::set_float(temp_data[chan] + sample_count, num_samples - sample_count, 0.0f);
 	}
 }
 
@@ -199,12 +302,13 @@ void SoundBuffer_Session_Impl::run_filters(float **temp_data, int num_samples)
 
 void SoundBuffer_Session_Impl::get_channel_volume(float *channel_volume)
 {
-	float left_pan = 1-pan;
-	float right_pan = 1+pan;
+	float left_pan = 1-mixer_pan;
+	float right_pan = 1+mixer_pan;
 	if (left_pan < 0.0f) left_pan = 0.0f;
 	if (left_pan > 1.0f) left_pan = 1.0f;
 	if (right_pan < 0.0f) right_pan = 0.0f;
 	if (right_pan > 1.0f) right_pan = 1.0f;
+	float volume = mixer_volume;
 	if (volume < 0.0f) volume = 0.0f;
 	if (volume > 1.0f) volume = 1.0f;
 
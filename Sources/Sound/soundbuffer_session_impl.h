@@ -32,8 +32,11 @@
 #include "API/Sound/soundformat.h"
 #include "API/Sound/soundoutput.h"
 #include "API/Sound/soundbuffer.h"
+#include "API/Sound/soundbuffer_session.h"
+#include "Mixer/sound_resampler.h"
+#include "Mixer/sound_command_queue.h"
 #include <memory>
-#include <mutex>
+#include <atomic>
 
 namespace clan
 {
@@ -63,15 +66,35 @@ public:
 
 public:
 	SoundBuffer soundbuffer;
-	SoundProvider_Session *provider_session;
 	SoundOutput output;
+
+	/// \brief Values set by the game thread, returned by the getters
 	float volume;
 	float frequency;
 	float pan;
 	bool looping;
-	bool playing;
+	SoundInterpolation interpolation;
+	int length;
+
+	/// \brief True while the session plays. Set by the game thread in play and stop, cleared by the mixer thread when the data runs out
+	std::atomic_bool playing;
+
+	/// \brief Playback position of the provider session, published by the mixer thread
+	std::atomic_int position;
+
+	/// \brief Provider session. Only accessed by the mixer thread once the session has been constructed
+	SoundProvider_Session *provider_session;
+
+	/// \brief Filters, resampler, looping, volume, pan and frequency used by the mixer thread. Updated through send_command
 	std::vector<SoundFilter> filters;
-	mutable std::recursive_mutex mutex;
+	SoundResampler resampler;
+	bool mixer_looping;
+	float mixer_volume;
+	float mixer_pan;
+	float mixer_frequency;
+
+	/// \brief True while the session is in the mixer's session list. Only accessed by the mixer thread
+	bool mixer_active;
 
 
 /// \}
@@ -81,6 +104,14 @@ public:
 public:
 	bool mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels);
 
+	/// \brief Sends a session command to the mixer thread, or applies it right away if the session has no sound output
+	void send_command(SoundMixerCommand &&command);
+
+	/// \brief Applies a session command. Called by the mixer thread
+	///
+	/// The command keeps a reference to any filter it removes, so the filter is not destroyed here.
+	void apply_command(const SoundMixerCommand &command);
+
 /// \}
 /// \name Implementation
 /// \{
@@ -98,8 +129,14 @@ private:
 	/// \brief Runs the sample data through attached filters
 	void run_filters( float ** temp_data, int num_samples );
 
-	/// \brief Fills temporary buffers with data from provider.
-	void get_data();
+	/// \brief Fills temporary buffers with data from provider, starting at sample 'start'.
+	void get_data(int start);
+
+	/// \brief Discards consumed samples from the temporary buffers and reads more from the provider.
+	///
+	/// Keeps the samples the resampler needs before the current playback position.
+	/// \return false if no more data is available
+	bool refill_buffer();
 
 	/// \brief Temporary channel buffers containing sound data in provider frequency.
 	float **float_buffer_data;
@@ -117,6 +154,9 @@ private:
 
 	/// \brief Number of samples currently written to buffer_data.
 	int buffer_samples_written;
+
+	/// \brief True if silence has been appended after the last sample of the stream, to let the resampler play the stream to its end
+	bool end_of_data_padded;
 /// \}
 };
 
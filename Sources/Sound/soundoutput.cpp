@@ -138,7 +138,7 @@ const std::string &SoundOutput::get_name() const
 
 int SoundOutput::get_mixing_frequency() const
 {
-	std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
+	// Mixing frequency never changes after construction, so the mixer thread may call this without locking
 	return impl->mixing_frequency;
 }
 
@@ -173,6 +173,8 @@ void SoundOutput::set_global_volume(float volume)
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		impl->volume = volume;
+		mutex_lock.unlock();
+		impl->push_command(SoundMixerCommand(SoundMixerCommand::set_global_volume, volume));
 	}
 }
 
@@ -182,32 +184,21 @@ void SoundOutput::set_global_pan(float pan)
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		impl->pan = pan;
+		mutex_lock.unlock();
+		impl->push_command(SoundMixerCommand(SoundMixerCommand::set_global_pan, pan));
 	}
 }
 
 void SoundOutput::add_filter(SoundFilter &filter)
 {
 	if (impl)
-	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		impl->filters.push_back(filter);
-	}
+		impl->push_command(SoundMixerCommand(SoundMixerCommand::add_filter, filter));
 }
 
 void SoundOutput::remove_filter(SoundFilter &filter)
 {
 	if (impl)
-	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		for (std::vector<SoundFilter>::size_type i=0; i<impl->filters.size(); i++)
-		{
-			if (impl->filters[i] == filter)
-			{
-				impl->filters.erase(impl->filters.begin()+i);
-				break;
-			}
-		}
-	}
+		impl->push_command(SoundMixerCommand(SoundMixerCommand::remove_filter, filter));
 }
 
 /////////////////////////////////////////////////////////////////////////////
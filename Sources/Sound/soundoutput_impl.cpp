@@ -30,6 +30,7 @@
 #include "soundoutput_impl.h"
 #include "soundbuffer_session_impl.h"
 #include "API/Sound/soundfilter.h"
+#include "API/Sound/SoundProviders/soundprovider_session.h"
 #include <algorithm>
 #include "API/Sound/sound_sse.h"
 
@@ -44,8 +45,11 @@ SoundOutput_Impl *SoundOutput_Impl::instance = nullptr;
 
 SoundOutput_Impl::SoundOutput_Impl(int mixing_frequency, int latency)
 : mixing_frequency(mixing_frequency), mixing_latency(latency), volume(1.0f),
-  pan(0.0f), mix_buffer_size(0)
+  pan(0.0f), mixer_volume(1.0f), mixer_pan(0.0f), mix_buffer_size(0)
 {
+	stop_flag = false;
+	mixer_running = false;
+
  	mix_buffers[0] = nullptr;
 	mix_buffers[1] = nullptr;
 	temp_buffers[0] = nullptr;
@@ -61,6 +65,8 @@ SoundOutput_Impl::SoundOutput_Impl(int mixing_frequency, int latency)
 
 SoundOutput_Impl::~SoundOutput_Impl()
 {
+	collect_releases();
+
 	SoundSSE::aligned_free(stereo_buffer);
 	SoundSSE::aligned_free(mix_buffers[0]);
 	SoundSSE::aligned_free(mix_buffers[1]);
@@ -80,27 +86,34 @@ SoundOutput_Impl::~SoundOutput_Impl()
 
 void SoundOutput_Impl::play_session(SoundBuffer_Session &session)
 {
-	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-	sessions.push_back(session);
+	push_command(SoundMixerCommand(SoundMixerCommand::play_session, session.impl));
 }
 
 void SoundOutput_Impl::stop_session(SoundBuffer_Session &session)
 {
-	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
+	push_command(SoundMixerCommand(SoundMixerCommand::stop_session, session.impl));
+}
 
-	for (auto it = sessions.begin(); it != sessions.end(); ++it)
+void SoundOutput_Impl::push_command(SoundMixerCommand &&command)
+{
+	std::unique_lock<std::mutex> producer_lock(producer_mutex);
+	collect_releases();
+	while (!commands.push(std::move(command)))
 	{
-		if (session.impl.get() == it->impl.get())
-		{
-			sessions.erase(it);
-			break;
-		}
+		// Queue is full. Wait for the mixer to catch up, or apply the commands here if there is no mixer thread draining it.
+		// The mixer stops taking commands while the release queue is short on room, so keep emptying it
+		collect_releases();
+		if (mixer_running)
+			std::this_thread::yield();
+		else
+			process_commands();
 	}
 }
 
 void SoundOutput_Impl::start_mixer_thread()
 {
 	stop_flag = false;
+	mixer_running = true;
 	thread = std::thread(&SoundOutput_Impl::mixer_thread, this);
 //	thread.set_priority(cl_priority_highest);
 }
@@ -112,17 +125,17 @@ void SoundOutput_Impl::stop_mixer_thread()
 	mutex_lock.unlock();
 	thread.join();
 	thread = std::thread();
+	mixer_running = false;
 }
 
 void SoundOutput_Impl::mix_fragment()
 {
+	process_commands();
 	resize_mix_buffers();
 	clear_mix_buffers();
 	fill_mix_buffers();
 	filter_mix_buffers();
-	apply_master_volume_on_mix_buffers();
-	clamp_mix_buffers();
-	SoundSSE::pack_float_stereo(mix_buffers, mix_buffer_size, stereo_buffer);
+	pack_mix_buffers();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -152,6 +165,93 @@ bool SoundOutput_Impl::if_continue_mixing()
 	return !stop_flag;
 }
 
+void SoundOutput_Impl::process_commands()
+{
+	// A command releases at most two references (itself and a stopped session) and adds at most one session.
+	// Only taking commands while there is room for that plus one release per active session guarantees
+	// that fill_mix_buffers can release every session that ends without the release queue running full.
+	// Commands left in the queue are applied once the game thread has collected the releases.
+	SoundMixerCommand command;
+	while (releases.get_free_space() >= (int)sessions.size() + 2 && commands.pop(command))
+	{
+		switch (command.type)
+		{
+		case SoundMixerCommand::play_session:
+			if (!command.session->mixer_active)
+			{
+				if (command.session->provider_session->play())
+				{
+					command.session->mixer_active = true;
+					sessions.push_back(command.session);
+				}
+				else
+				{
+					command.session->playing = false;
+				}
+			}
+			break;
+		case SoundMixerCommand::stop_session:
+			remove_session(command.session.get());
+			command.session->provider_session->stop();
+			break;
+		case SoundMixerCommand::set_global_volume:
+			mixer_volume = command.value;
+			break;
+		case SoundMixerCommand::set_global_pan:
+			mixer_pan = command.value;
+			break;
+		case SoundMixerCommand::add_filter:
+			filters.push_back(command.filter);
+			break;
+		case SoundMixerCommand::remove_filter:
+			for (auto it = filters.begin(); it != filters.end(); ++it)
+			{
+				if (*it == command.filter)
+				{
+					filters.erase(it);
+					break;
+				}
+			}
+			break;
+		default:
+			command.session->apply_command(command);
+			break;
+		}
+
+		// The game thread may have dropped its references while the command was queued
+		if (command.has_references())
+			release(std::move(command));
+	}
+}
+
+void SoundOutput_Impl::remove_session(SoundBuffer_Session_Impl *session)
+{
+	for (auto it = sessions.begin(); it != sessions.end(); ++it)
+	{
+		if (it->get() == session)
+		{
+			session->mixer_active = false;
+			release(SoundMixerCommand(SoundMixerCommand::release, *it));
+			sessions.erase(it);
+			break;
+		}
+	}
+}
+
+void SoundOutput_Impl::release(SoundMixerCommand &&command)
+{
+	command.type = SoundMixerCommand::release;
+	bool pushed = releases.push(std::move(command));
+	(void)pushed; // process_commands reserves room for every release, see there
+}
+
+void SoundOutput_Impl::collect_releases()
+{
+	SoundMixerCommand command;
+	while (releases.pop(command))
+		command = SoundMixerCommand();
+}
+
 void SoundOutput_Impl::resize_mix_buffers()
 {
 	if (get_fragment_size() != mix_buffer_size)
@@ -184,25 +284,26 @@ void SoundOutput_Impl::clear_mix_buffers()
 
 void SoundOutput_Impl::fill_mix_buffers()
 {
-	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-	std::vector< SoundBuffer_Session > ended_sessions;
-	std::vector< SoundBuffer_Session >::iterator it;
-	for (it = sessions.begin(); it != sessions.end(); ++it)
+	for (size_t i = 0; i < sessions.size();)
 	{
-		SoundBuffer_Session session = *it;
-		bool playing = session.impl->mix_to(mix_buffers, temp_buffers, mix_buffer_size, 2);
-		if (!playing) ended_sessions.push_back(session);
+		bool playing = sessions[i]->mix_to(mix_buffers, temp_buffers, mix_buffer_size, 2);
+		if (playing)
+		{
+			i++;
+		}
+		else
+		{
+			// Release session, it reached the end of its data:
+			sessions[i]->mixer_active = false;
+			release(SoundMixerCommand(SoundMixerCommand::release, sessions[i]));
+			sessions.erase(sessions.begin() + i);
+		}
 	}
-
-	// Release any sessions pending for removal:
-	int size_ended_sessions = ended_sessions.size();
-	for (int i = 0; i < size_ended_sessions; i++) stop_session(ended_sessions[i]);
 }
 
 void SoundOutput_Impl::filter_mix_buffers()
 {
 	// Apply global filters to mixing buffers:
-	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
 	int size_filters = filters.size();
 	int i;
 	for (i = 0; i < size_filters; i++)
@@ -211,36 +312,25 @@ void SoundOutput_Impl::filter_mix_buffers()
 	}
 }
 
-void SoundOutput_Impl::apply_master_volume_on_mix_buffers()
+void SoundOutput_Impl::pack_mix_buffers()
 {
 	// Calculate volume on left and right channel:
-	float left_pan = 1-pan;
-	float right_pan = 1+pan;
+	float left_pan = 1-mixer_pan;
+	float right_pan = 1+mixer_pan;
 	if (left_pan < 0.0f) left_pan = 0.0f;
 	if (left_pan > 1.0f) left_pan = 1.0f;
 	if (right_pan < 0.0f) right_pan = 0.0f;
 	if (right_pan > 1.0f) right_pan = 1.0f;
+	float volume = mixer_volume;
 	if (volume < 0.0f) volume = 0.0f;
 	if (volume > 1.0f) volume = 1.0f;
 
-	float left_volume = volume * left_pan;
-	float right_volume = volume * right_pan;
+	float channel_volume[2];
+	channel_volume[0] = volume * left_pan;
+	channel_volume[1] = volume * right_pan;
 
-	SoundSSE::multiply_float(mix_buffers[0], mix_buffer_size, left_volume);
-	SoundSSE::multiply_float(mix_buffers[1], mix_buffer_size, right_volume);
-}
-
-void SoundOutput_Impl::clamp_mix_buffers()
-{
-	// Make sure values stay inside 16 bit range:
-	for (auto & elem : mix_buffers)
-	{
-		for (int k=0; k<mix_buffer_size; k++)
-		{
-			if      (elem[k] > 1.0f)  elem[k] = 1.0f;
-			else if (elem[k] < -1.0f) elem[k] = -1.0f;
-		}
-	}
+	// Apply master volume, clamp to the -1 to 1 range and interleave in a single pass over the mixing buffers:
+	SoundSSE::pack_float_stereo_clamped(mix_buffers, mix_buffer_size, channel_volume, stereo_buffer);
 }
 
 }
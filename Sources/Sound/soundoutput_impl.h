@@ -34,6 +34,7 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include "Mixer/sound_command_queue.h"
 
 namespace clan
 {
@@ -50,16 +51,30 @@ namespace clan
 		void play_session(SoundBuffer_Session &session);
 		void stop_session(SoundBuffer_Session &session);
 
+		/// \brief Sends a command to the mixer thread. It is applied before the next fragment is mixed
+		void push_command(SoundMixerCommand &&command);
+
 	protected:
 		std::string name;
 		int mixing_frequency;
 		int mixing_latency;
 		float volume;
 		float pan;
-		std::vector<SoundFilter> filters;
 		std::thread thread;
 		std::atomic_bool stop_flag;
-		std::vector< SoundBuffer_Session > sessions;
+
+		/// \brief True while the mixer thread is running and draining the command queue
+		std::atomic_bool mixer_running;
+
+		/// \brief Global filters. Only accessed by the mixer thread
+		std::vector<SoundFilter> filters;
+
+		/// \brief Master volume and pan used by the mixer thread
+		float mixer_volume;
+		float mixer_pan;
+
+		/// \brief Sessions being mixed. Only accessed by the mixer thread
+		std::vector< std::shared_ptr<SoundBuffer_Session_Impl> > sessions;
 
 		int mix_buffer_size;
 		float *mix_buffers[2];
@@ -101,6 +116,18 @@ namespace clan
 		/// \brief Returns true if the mixer thread should continue mixing fragments
 		bool if_continue_mixing();
 
+		/// \brief Applies the commands sent by push_command
+		void process_commands();
+
+		/// \brief Removes a session from the list of sessions being mixed
+		void remove_session(SoundBuffer_Session_Impl *session);
+
+		/// \brief Hands the references held by a command back to the game thread, so no session or filter is destroyed on the mixer thread
+		void release(SoundMixerCommand &&command);
+
+		/// \brief Destroys the sessions and filters released by the mixer thread. Called by the game thread
+		void collect_releases();
+
 		/// \brief Ensures the mixing buffers match the fragment size
 		void resize_mix_buffers();
 
@@ -113,17 +140,27 @@ namespace clan
 		/// \brief Applies filters to the mixing buffers
 		void filter_mix_buffers();
 
-		/// \brief Apply master volume and panning to mix buffers
-		void apply_master_volume_on_mix_buffers();
-
-		/// \brief Clamp mixing buffer values to the -1 to 1 range
-		void clamp_mix_buffers();
+		/// \brief Apply master volume and panning, clamp to the -1 to 1 range and store the result in stereo_buffer
+		void pack_mix_buffers();
 
 		static std::recursive_mutex singleton_mutex;
 		static SoundOutput_Impl *instance;
 
 		mutable std::recursive_mutex mutex;
 
+		/// \brief Commands from the game thread to the mixer thread
+		SoundCommandQueue commands;
+
+		/// \brief Serializes threads sending commands, so the queue only ever sees a single producer
+		///
+		/// Also makes the thread holding it the single consumer of the release queue.
+		std::mutex producer_mutex;
+
+		/// \brief Session and filter references handed back from the mixer thread to the game thread
+		///
+		/// process_commands keeps room in it for every active session, so releasing never has to wait or allocate.
+		SoundCommandQueue releases;
+
 		friend class SoundOutput;
 	};
 
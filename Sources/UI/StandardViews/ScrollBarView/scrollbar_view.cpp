@@ -271,6 +271,7 @@ namespace clan
 		View::layout_subviews(canvas);
 
 		auto track_geometry = impl->track->geometry();
+		unsigned int thumb_revision = impl->thumb->style()->revision();
 
 		if (impl->min_pos == impl->max_pos || impl->page_step == 0.0)
 		{
@@ -296,6 +297,10 @@ namespace clan
 				impl->thumb->style()->set("left: %1px; top: 0; width: %2px; height: %3px", (float)thumb_pos, (float)thumb_length, track_geometry.content_height );
 			}
 		}
+
+		// The root view positions the thumb after this returns, but only walks into views that need layout
+		if (impl->thumb->style()->revision() != thumb_revision)
+			impl->thumb->set_needs_layout();
 	}
 
 	Signal<void()> &ScrollBarView::sig_scroll()
@@ -191,6 +191,7 @@ namespace clan
 		float t = (float) (impl->_position - impl->_min_position) / (float) (impl->_max_position - impl->_min_position);
 		float thumb_pos = t * (track_length - thumb_length);
 
+		unsigned int thumb_revision = impl->thumb->style()->revision();
 		if (vertical())
 		{
 			impl->thumb->style()->set("top: %1px;", thumb_pos);
@@ -199,6 +200,10 @@ namespace clan
 		{
 			impl->thumb->style()->set("left: %1px;", thumb_pos);
 		}
+
+		// The root view positions the thumb after this returns, but only walks into views that need layout
+		if (impl->thumb->style()->revision() != thumb_revision)
+			impl->thumb->set_needs_layout();
 	}
 
 	std::function<void()> &SliderView::func_value_changed()
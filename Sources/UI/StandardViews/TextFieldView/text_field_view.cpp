@@ -94,7 +94,7 @@ namespace clan
 		impl->cursor_pos = impl->text.size();
 		impl->scroll_pos = 0.0f;
 
-		set_needs_render();
+		set_needs_layout();
 	}
 
 	std::string TextFieldView::placeholder() const
@@ -755,7 +755,7 @@ namespace clan
 			text.erase(text.begin() + new_cursor_pos, text.begin() + cursor_pos);
 			cursor_pos = new_cursor_pos;
 
-			textfield->set_needs_render();
+			textfield->set_needs_layout();
 		}
 	}
 
@@ -777,7 +777,7 @@ namespace clan
 			cursor_pos = start;
 			text.erase(text.begin() + start, text.begin() + start + length);
 
-			textfield->set_needs_render();
+			textfield->set_needs_layout();
 		}
 		else if (cursor_pos < text.length())
 		{
@@ -792,7 +792,7 @@ namespace clan
 			utf8_reader.set_position(cursor_pos);
 			text.erase(text.begin() + cursor_pos, text.begin() + cursor_pos + utf8_reader.get_char_length());
 
-			textfield->set_needs_render();
+			textfield->set_needs_layout();
 		}
 	}
 
@@ -840,7 +840,7 @@ namespace clan
 
 			cursor_pos = std::min(cursor_pos, text.size());
 
-			textfield->set_needs_render();
+			textfield->set_needs_layout();
 		}
 	}
 
@@ -898,7 +898,7 @@ namespace clan
 		text = text.substr(0, cursor_pos) + new_text + text.substr(cursor_pos);
 		cursor_pos += new_text.size();
 
-		textfield->set_needs_render();
+		textfield->set_needs_layout();
 	}
 
 	void TextFieldViewImpl::set_text_selection(size_t start, size_t length)
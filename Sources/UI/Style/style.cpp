@@ -28,6 +28,7 @@
 
 #include "UI/precomp.h"
 #include "API/UI/Style/style.h"
+#include "API/UI/Style/style_cascade.h"
 #include "style_impl.h"
 #include "Properties/background.h"
 #include "Properties/border.h"
@@ -70,6 +71,11 @@ namespace clan
 	{
 	}
 
+	unsigned int Style::revision() const
+	{
+		return impl->revision;
+	}
+
 	void Style::set(const std::string &properties)
 	{
 		StyleProperty::parse(impl.get(), properties);
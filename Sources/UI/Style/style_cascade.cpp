@@ -36,9 +36,52 @@
 #include "style_background_renderer.h"
 #include "style_border_image_renderer.h"
 #include "style_impl.h"
+#include <mutex>
 
 namespace clan
 {
+	namespace
+	{
+		class StylePropertyIds
+		{
+		public:
+			static StylePropertyIds &instance()
+			{
+				static StylePropertyIds ids;
+				return ids;
+			}
+
+			std::mutex mutex;
+			std::unordered_map<StyleString, int, StyleString::hash> ids;
+			std::vector<const char *> names;
+		};
+	}
+
+	int StylePropertyId::find(const char *property_name)
+	{
+		auto &registry = StylePropertyIds::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		auto it = registry.ids.find(StyleString(property_name));
+		if (it != registry.ids.end())
+			return it->second;
+
+		int id = (int)registry.names.size();
+		it = registry.ids.insert(std::make_pair(StyleString(property_name), id)).first;
+		registry.names.push_back(it->first.c_str());
+		return id;
+	}
+
+	const char *StylePropertyId::name() const
+	{
+		if (_id == -1)
+			return "";
+
+		auto &registry = StylePropertyIds::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		return registry.names[_id];
+	}
+
 	StyleGetValue StyleCascade::cascade_value(const char *property_name) const
 	{
 		for (Style *style : cascade)
@@ -68,7 +111,52 @@ namespace clan
 		}
 	}
 
-	StyleGetValue StyleCascade::computed_value(const char *property_name) const
+	StyleGetValue StyleCascade::computed_value(const StylePropertyId &property) const
+	{
+		if (property.is_null())
+			return StyleGetValue();
+
+		validate_computed_values();
+
+		auto it = computed_values.find(property.id());
+		if (it != computed_values.end())
+			return it->second;
+
+		StyleGetValue value = compute_value(property.name());
+		computed_values[property.id()] = value;
+		return value;
+	}
+
+	unsigned int StyleCascade::computed_revision() const
+	{
+		validate_computed_values();
+		return revision;
+	}
+
+	void StyleCascade::validate_computed_values() const
+	{
+		if (parent)
+			parent->validate_computed_values();
+
+		unsigned int parent_revision = parent ? parent->revision : 0;
+		bool changed = computed_parent != parent || computed_parent_revision != parent_revision || computed_cascade != cascade;
+		for (size_t i = 0; !changed && i < cascade.size(); i++)
+			changed = computed_style_revisions[i] != cascade[i]->revision();
+
+		if (changed)
+		{
+			computed_values.clear();
+			computed_cascade = cascade;
+			computed_parent = parent;
+			computed_parent_revision = parent_revision;
+			computed_style_revisions.clear();
+			for (Style *style : cascade)
+				computed_style_revisions.push_back(style->revision());
+			revision++;
+		}
+	}
+
+	StyleGetValue StyleCascade::compute_value(const char *property_name) const
 	{
 		// To do: pass on to property compute functions
 
@@ -28,12 +28,57 @@
 
 #include "UI/precomp.h"
 #include "API/UI/Style/style.h"
+#include "API/UI/Style/style_cascade.h"
 #include "style_impl.h"
+#include <atomic>
 
 namespace clan
 {
+	unsigned int StyleImpl::next_revision()
+	{
+		static std::atomic<unsigned int> last_revision(0);
+		return last_revision.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	bool StyleImpl::is_value(const StyleString &name, const StyleSetValue &value) const
+	{
+		auto type_it = prop_type.find(name);
+		if (type_it == prop_type.end())
+			return value.type == StyleValueType::undefined;
+		if (type_it->second != value.type)
+			return false;
+
+		switch (value.type)
+		{
+		default:
+		case StyleValueType::undefined:
+			return true;
+		case StyleValueType::keyword:
+		case StyleValueType::string:
+		case StyleValueType::url:
+			return prop_text.find(name)->second == value.text;
+		case StyleValueType::length:
+		case StyleValueType::angle:
+		case StyleValueType::time:
+		case StyleValueType::frequency:
+		case StyleValueType::resolution:
+			return prop_dimension.find(name)->second == value.dimension && prop_number.find(name)->second == value.number;
+		case StyleValueType::percentage:
+		case StyleValueType::number:
+			return prop_number.find(name)->second == value.number;
+		case StyleValueType::color:
+			return prop_color.find(name)->second == value.color;
+		}
+	}
+
 	void StyleImpl::set_value(const std::string &name, const StyleSetValue &value)
 	{
+		// Views often set the same value again on every layout (slider and scroll bar thumbs for instance)
+		if (is_value(name, value))
+			return;
+
+		revision = next_revision();
+
 		auto type_it = prop_type.find(name);
 		if (type_it != prop_type.end() && type_it->second != value.type)
 		{
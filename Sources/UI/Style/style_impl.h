@@ -144,5 +144,13 @@ namespace clan
 		std::unordered_map<StyleString, float, StyleString::hash> prop_number;
 		std::unordered_map<StyleString, StyleDimension, StyleString::hash> prop_dimension;
 		std::unordered_map<StyleString, Colorf, StyleString::hash> prop_color;
+
+		/// Changes every time a property value changes. Revisions are unique across all styles.
+		unsigned int revision = next_revision();
+
+		static unsigned int next_revision();
+
+	private:
+		bool is_value(const StyleString &name, const StyleSetValue &value) const;
 	};
 }
@@ -28,6 +28,7 @@
 
 #include "UI/precomp.h"
 #include "hbox_layout.h"
+#include "view_impl.h"
 #include <algorithm>
 #include <cmath>
 
@@ -47,7 +48,7 @@ namespace clan
 				width += subview->style_cascade().computed_value("border-left-width").number();
 				width += subview->style_cascade().computed_value("padding-left").number();
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					width += subview->get_preferred_width(canvas);
+					width += ViewImpl::cached_preferred_width(subview.get(), canvas);
 				else
 					width += subview->style_cascade().computed_value("flex-basis").number();
 				width += subview->style_cascade().computed_value("padding-right").number();
@@ -84,7 +85,7 @@ namespace clan
 				total_shrink_factor += subview->style_cascade().computed_value("flex-shrink").number();
 
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					basis_width += subview->get_preferred_width(canvas);
+					basis_width += ViewImpl::cached_preferred_width(subview.get(), canvas);
 				else
 					basis_width += subview->style_cascade().computed_value("flex-basis").number();
 			}
@@ -101,7 +102,7 @@ namespace clan
 			{
 				float subview_width = subview->style_cascade().computed_value("flex-basis").number();
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					subview_width = subview->get_preferred_width(canvas);
+					subview_width = ViewImpl::cached_preferred_width(subview.get(), canvas);
 
 				if (free_space < 0.0f && total_shrink_factor != 0.0f)
 					subview_width += subview->style_cascade().computed_value("flex-shrink").number() * free_space / total_shrink_factor;
@@ -114,7 +115,7 @@ namespace clan
 				margin_box_height += subview->style_cascade().computed_value("margin-top").number();
 				margin_box_height += subview->style_cascade().computed_value("border-top-width").number();
 				margin_box_height += subview->style_cascade().computed_value("padding-top").number();
-				margin_box_height += subview->get_preferred_height(canvas, subview_width);
+				margin_box_height += ViewImpl::cached_preferred_height(subview.get(), canvas, subview_width);
 				margin_box_height += subview->style_cascade().computed_value("padding-bottom").number();
 				margin_box_height += subview->style_cascade().computed_value("border-bottom-width").number();
 				margin_box_height += subview->style_cascade().computed_value("margin-bottom").number();
@@ -130,7 +131,7 @@ namespace clan
 		for (const auto & subview : subviews)
 		{
 			if (subview->is_static_position_and_visible())
-				return (subview)->get_first_baseline_offset(canvas, width);
+				return ViewImpl::cached_first_baseline_offset(subview.get(), canvas, width);
 		}
 		return 0.0f;
 	}
@@ -141,7 +142,7 @@ namespace clan
 		for (auto it = subviews.rbegin(); it != subviews.rend(); ++it)
 		{
 			if ((*it)->is_static_position_and_visible())
-				return (*it)->get_last_baseline_offset(canvas, width);
+				return ViewImpl::cached_last_baseline_offset(it->get(), canvas, width);
 		}
 		return 0.0f;
 	}
@@ -169,7 +170,7 @@ namespace clan
 				total_shrink_factor += subview->style_cascade().computed_value("flex-shrink").number();
 
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					basis_width += subview->get_preferred_width(canvas);
+					basis_width += ViewImpl::cached_preferred_width(subview.get(), canvas);
 				else
 					basis_width += subview->style_cascade().computed_value("flex-basis").number();
 			}
@@ -186,7 +187,7 @@ namespace clan
 			{
 				float subview_width = subview->style_cascade().computed_value("flex-basis").number();
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					subview_width = subview->get_preferred_width(canvas);
+					subview_width = ViewImpl::cached_preferred_width(subview.get(), canvas);
 
 				if (free_space < 0.0f && total_shrink_factor != 0.0f)
 					subview_width += subview->style_cascade().computed_value("flex-shrink").number() * free_space / total_shrink_factor;
@@ -205,7 +206,7 @@ namespace clan
 				bottom_noncontent += subview->style_cascade().computed_value("border-bottom-width").number();
 				bottom_noncontent += subview->style_cascade().computed_value("padding-bottom").number();
 
-				float subview_height = subview->get_preferred_height(canvas, subview_width);
+				float subview_height = ViewImpl::cached_preferred_height(subview.get(), canvas, subview_width);
 				float available_margin = view->geometry().content_height - subview_height - top_noncontent - bottom_noncontent;
 
 				if (subview->style_cascade().computed_value("margin-top").is_keyword("auto") && subview->style_cascade().computed_value("margin-bottom").is_keyword("auto"))
@@ -247,7 +248,8 @@ namespace clan
 				x += subview->style_cascade().computed_value("border-right-width").number();
 				x += subview->style_cascade().computed_value("margin-right").number();
 
-				subview->layout_subviews(canvas);
+				if (ViewImpl::check_needs_layout(subview.get()))
+					subview->layout_subviews(canvas);
 			}
 		}
 	}
@@ -29,6 +29,7 @@
 #include "UI/precomp.h"
 #include "API/UI/View/root_view.h"
 #include "positioned_layout.h"
+#include "view_impl.h"
 #include <algorithm>
 
 namespace clan
@@ -78,7 +79,8 @@ namespace clan
 				layout_from_containing_box(canvas, subview.get(), offset_initial_containing_box);
 			}
 
-			layout_subviews(canvas, subview.get());
+			if (ViewImpl::check_needs_layout(subview.get()))
+				layout_subviews(canvas, subview.get());
 		}
 	}
 
@@ -105,17 +107,17 @@ namespace clan
 		else if (!view->style_cascade().computed_value("left").is_keyword("auto"))
 		{
 			x = view->style_cascade().computed_value("left").number();
-			width = view->get_preferred_width(canvas);
+			width = ViewImpl::cached_preferred_width(view, canvas);
 		}
 		else if (!view->style_cascade().computed_value("right").is_keyword("auto"))
 		{
-			width = view->get_preferred_width(canvas);
+			width = ViewImpl::cached_preferred_width(view, canvas);
 			x = containing_box.get_width() - view->style_cascade().computed_value("right").number() - width;
 		}
 		else
 		{
 			x = 0.0f;
-			width = view->get_preferred_width(canvas);
+			width = ViewImpl::cached_preferred_width(view, canvas);
 		}
 
 		float y = 0.0f;
@@ -139,17 +141,17 @@ namespace clan
 		else if (!view->style_cascade().computed_value("top").is_keyword("auto"))
 		{
 			y = view->style_cascade().computed_value("top").number();
-			height = view->get_preferred_height(canvas, width);
+			height = ViewImpl::cached_preferred_height(view, canvas, width);
 		}
 		else if (!view->style_cascade().computed_value("bottom").is_keyword("auto"))
 		{
-			height = view->get_preferred_height(canvas, width);
+			height = ViewImpl::cached_preferred_height(view, canvas, width);
 			y = containing_box.get_height() - view->style_cascade().computed_value("bottom").number() - height;
 		}
 		else
 		{
 			y = 0.0f;
-			height = view->get_preferred_height(canvas, width);
+			height = ViewImpl::cached_preferred_height(view, canvas, width);
 		}
 
 		return ViewGeometry::from_content_box(view->style_cascade(), Rectf::xywh(x, y, width, height));
@@ -158,6 +160,7 @@ namespace clan
 	void PositionedLayout::layout_from_containing_box(Canvas &canvas, View *view, const Rectf &containing_box)
 	{
 		view->set_geometry(get_geometry(canvas, view, containing_box));
-		view->layout_subviews(canvas);
+		if (ViewImpl::check_needs_layout(view))
+			view->layout_subviews(canvas);
 	}
 }
@@ -55,8 +55,8 @@ namespace clan
 		{
 			layout_subviews(canvas);
 			PositionedLayout::layout_subviews(canvas, this);
+			impl->clear_needs_layout();
 		}
-		impl->_needs_layout = false;
 	}
 
 	void RootView::render(Canvas &canvas)
@@ -28,6 +28,7 @@
 
 #include "UI/precomp.h"
 #include "vbox_layout.h"
+#include "view_impl.h"
 #include <algorithm>
 #include <cmath>
 
@@ -48,7 +49,7 @@ namespace clan
 				margin_box_width += subview->style_cascade().computed_value("border-left-width").number();
 				margin_box_width += subview->style_cascade().computed_value("padding-left").number();
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					margin_box_width += subview->get_preferred_width(canvas);
+					margin_box_width += ViewImpl::cached_preferred_width(subview.get(), canvas);
 				else
 					margin_box_width += subview->style_cascade().computed_value("flex-basis").number();
 				margin_box_width += subview->style_cascade().computed_value("padding-right").number();
@@ -95,7 +96,7 @@ namespace clan
 				height += subview->style_cascade().computed_value("margin-top").number();
 				height += subview->style_cascade().computed_value("border-top-width").number();
 				height += subview->style_cascade().computed_value("padding-top").number();
-				height += subview->get_preferred_height(canvas, subview_width);
+				height += ViewImpl::cached_preferred_height(subview.get(), canvas, subview_width);
 				height += subview->style_cascade().computed_value("padding-bottom").number();
 				height += subview->style_cascade().computed_value("border-bottom-width").number();
 				height += subview->style_cascade().computed_value("margin-bottom").number();
@@ -110,7 +111,7 @@ namespace clan
 		for (const auto & subview : subviews)
 		{
 			if (subview->is_static_position_and_visible())
-				return (subview)->get_first_baseline_offset(canvas, width);
+				return ViewImpl::cached_first_baseline_offset(subview.get(), canvas, width);
 		}
 		return 0.0f;
 	}
@@ -121,7 +122,7 @@ namespace clan
 		for (auto it = subviews.rbegin(); it != subviews.rend(); ++it)
 		{
 			if ((*it)->is_static_position_and_visible())
-				return (*it)->get_last_baseline_offset(canvas, width);
+				return ViewImpl::cached_last_baseline_offset(it->get(), canvas, width);
 		}
 		return 0.0f;
 	}
@@ -172,7 +173,7 @@ namespace clan
 						}
 					}
 
-					basis_height += subview->get_preferred_height(canvas, subview_width);
+					basis_height += ViewImpl::cached_preferred_height(subview.get(), canvas, subview_width);
 				}
 				else
 				{
@@ -214,7 +215,7 @@ namespace clan
 
 				float subview_height = subview->style_cascade().computed_value("flex-basis").number();
 				if (subview->style_cascade().computed_value("flex-basis").is_keyword("main-size"))
-					subview_height = subview->get_preferred_height(canvas, subview_width);
+					subview_height = ViewImpl::cached_preferred_height(subview.get(), canvas, subview_width);
 
 				if (free_space < 0.0f && total_shrink_factor != 0.0f)
 					subview_height += free_space * subview->style_cascade().computed_value("flex-shrink").number() / total_shrink_factor;
@@ -234,7 +235,8 @@ namespace clan
 				y += subview->style_cascade().computed_value("border-bottom-width").number();
 				y += subview->style_cascade().computed_value("margin-bottom").number();
 
-				subview->layout_subviews(canvas);
+				if (ViewImpl::check_needs_layout(subview.get()))
+					subview->layout_subviews(canvas);
 			}
 		}
 	}
@@ -45,6 +45,15 @@
 
 namespace clan
 {
+	namespace
+	{
+		const StylePropertyId property_position("position");
+		const StylePropertyId property_layout("layout");
+		const StylePropertyId property_flex_direction("flex-direction");
+		const StylePropertyId property_width("width");
+		const StylePropertyId property_height("height");
+	}
+
 	View::View() : impl(new ViewImpl())
 	{
 		//box_style.set_style_changed(bind_member(this, &View::set_needs_layout));
@@ -190,7 +199,7 @@ namespace clan
 
 	bool View::is_static_position_and_visible() const
 	{
-		return style_cascade().computed_value("position").is_keyword("static") && !hidden();
+		return style_cascade().computed_value(property_position).is_keyword("static") && !hidden();
 	}
 
 	bool View::needs_layout() const
@@ -201,6 +210,7 @@ namespace clan
 	void View::set_needs_layout()
 	{
 		impl->_needs_layout = true;
+		impl->clear_measure_cache();
 
 		View *super = superview();
 		if (super)
@@ -245,7 +255,17 @@ namespace clan
 		if (impl->_geometry.content_box() != geometry.content_box())
 		{
 			impl->_geometry = geometry;
-			set_needs_layout();
+
+			// The preferred size of a view does not depend on its geometry. Only flag the subviews for layout and keep the measurement caches.
+			View *view = this;
+			while (true)
+			{
+				view->impl->_needs_layout = true;
+				if (!view->superview())
+					break;
+				view = view->superview();
+			}
+			view->set_needs_render();
 		}
 	}
 
@@ -290,33 +310,33 @@ namespace clan
 
 	float View::get_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("column"))
 			return VBoxLayout::get_preferred_width(canvas, this);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("row"))
 			return HBoxLayout::get_preferred_width(canvas, this);
-		else if (style_cascade().computed_value("width").is_keyword("auto"))
+		else if (style_cascade().computed_value(property_width).is_keyword("auto"))
 			return 0.0f;
 		else
-			return style_cascade().computed_value("width").number();
+			return style_cascade().computed_value(property_width).number();
 	}
 
 	float View::get_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("column"))
 			return VBoxLayout::get_preferred_height(canvas, this, width);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("row"))
 			return HBoxLayout::get_preferred_height(canvas, this, width);
-		else if (style_cascade().computed_value("height").is_keyword("auto"))
+		else if (style_cascade().computed_value(property_height).is_keyword("auto"))
 			return 0.0f;
 		else
-			return style_cascade().computed_value("height").number();
+			return style_cascade().computed_value(property_height).number();
 	}
 
 	float View::get_first_baseline_offset(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("column"))
 			return VBoxLayout::get_first_baseline_offset(canvas, this, width);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("row"))
 			return HBoxLayout::get_first_baseline_offset(canvas, this, width);
 		else
 			return 0.0f;
@@ -324,9 +344,9 @@ namespace clan
 
 	float View::get_last_baseline_offset(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("column"))
 			return VBoxLayout::get_last_baseline_offset(canvas, this, width);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("row"))
 			return HBoxLayout::get_last_baseline_offset(canvas, this, width);
 		else
 			return 0.0f;
@@ -339,9 +359,9 @@ namespace clan
 
 	void View::layout_subviews(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("column"))
 			VBoxLayout::layout_subviews(canvas, this);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(property_layout).is_keyword("flex") && style_cascade().computed_value(property_flex_direction).is_keyword("row"))
 			HBoxLayout::layout_subviews(canvas, this);
 	}
 
@@ -805,6 +825,101 @@ namespace clan
 			style_cascade.cascade.push_back(match.first);
 	}
 
+	float ViewImpl::cached_preferred_width(View *view, Canvas &canvas)
+	{
+		validate_measure_cache(view);
+		ViewImpl *impl = view->impl.get();
+		if (!impl->preferred_width_valid)
+		{
+			impl->preferred_width = view->get_preferred_width(canvas);
+			impl->preferred_width_valid = true;
+		}
+		return impl->preferred_width;
+	}
+
+	float ViewImpl::cached_preferred_height(View *view, Canvas &canvas, float width)
+	{
+		validate_measure_cache(view);
+		ViewImpl *impl = view->impl.get();
+		float height;
+		if (!impl->preferred_heights.find(width, height))
+		{
+			height = view->get_preferred_height(canvas, width);
+			impl->preferred_heights.insert(width, height);
+		}
+		return height;
+	}
+
+	float ViewImpl::cached_first_baseline_offset(View *view, Canvas &canvas, float width)
+	{
+		validate_measure_cache(view);
+		ViewImpl *impl = view->impl.get();
+		float offset;
+		if (!impl->first_baseline_offsets.find(width, offset))
+		{
+			offset = view->get_first_baseline_offset(canvas, width);
+			impl->first_baseline_offsets.insert(width, offset);
+		}
+		return offset;
+	}
+
+	float ViewImpl::cached_last_baseline_offset(View *view, Canvas &canvas, float width)
+	{
+		validate_measure_cache(view);
+		ViewImpl *impl = view->impl.get();
+		float offset;
+		if (!impl->last_baseline_offsets.find(width, offset))
+		{
+			offset = view->get_last_baseline_offset(canvas, width);
+			impl->last_baseline_offsets.insert(width, offset);
+		}
+		return offset;
+	}
+
+	void ViewImpl::validate_measure_cache(View *view)
+	{
+		ViewImpl *impl = view->impl.get();
+		unsigned int revision = impl->style_cascade.computed_revision();
+		if (impl->measure_style_revision != revision)
+		{
+			impl->clear_measure_cache();
+			impl->measure_style_revision = revision;
+		}
+	}
+
+	void ViewImpl::clear_measure_cache()
+	{
+		preferred_width_valid = false;
+		preferred_heights.clear();
+		first_baseline_offsets.clear();
+		last_baseline_offsets.clear();
+	}
+
+	bool ViewImpl::check_needs_layout(View *view)
+	{
+		ViewImpl *impl = view->impl.get();
+		unsigned int revision = impl->style_cascade.computed_revision();
+		if (impl->layout_style_revision != revision)
+		{
+			impl->layout_style_revision = revision;
+			return true;
+		}
+		return impl->_needs_layout;
+	}
+
+	void ViewImpl::clear_needs_layout()
+	{
+		_needs_layout = false;
+
+		// Hidden views and local roots were not laid out and keep their flag until they are
+		for (const std::shared_ptr<View> &subview : _subviews)
+		{
+			ViewImpl *subview_impl = subview->impl.get();
+			if (subview_impl->_needs_layout && !subview_impl->hidden && !subview->local_root())
+				subview_impl->clear_needs_layout();
+		}
+	}
+
 	void ViewImpl::process_event(View *self, EventUI *e, bool use_capture)
 	{
 		ActivationChangeEvent *activation_change = dynamic_cast<ActivationChangeEvent*>(e);
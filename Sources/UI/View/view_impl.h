@@ -36,6 +36,51 @@
 
 namespace clan
 {
+	/// Measurement results of a view for the last few input widths
+	class ViewMeasureCache
+	{
+	public:
+		bool find(float width, float &value) const
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (entries[i].width == width)
+				{
+					value = entries[i].value;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void insert(float width, float value)
+		{
+			entries[next].width = width;
+			entries[next].value = value;
+			next = (next + 1) % max_entries;
+			count = clan::min(count + 1, (int)max_entries);
+		}
+
+		void clear()
+		{
+			count = 0;
+			next = 0;
+		}
+
+	private:
+		enum { max_entries = 4 };
+
+		struct Entry
+		{
+			float width;
+			float value;
+		};
+
+		Entry entries[max_entries];
+		int count = 0;
+		int next = 0;
+	};
+
 	class ViewImpl
 	{
 	public:
@@ -43,6 +88,23 @@ namespace clan
 		void process_event(View *self, EventUI *e, bool use_capture);
 		void update_style_cascade() const;
 
+		// Measurement functions used by the layout classes. They only call the virtual View functions when the
+		// result is not already cached. The caches are cleared by View::set_needs_layout and when the computed
+		// style of the view changes, as state and style changes also affect the size of descendant views.
+		static float cached_preferred_width(View *view, Canvas &canvas);
+		static float cached_preferred_height(View *view, Canvas &canvas, float width);
+		static float cached_first_baseline_offset(View *view, Canvas &canvas, float width);
+		static float cached_last_baseline_offset(View *view, Canvas &canvas, float width);
+
+		static void validate_measure_cache(View *view);
+		void clear_measure_cache();
+
+		/// Clears the needs layout flag of this view and all laid out subviews needing layout
+		void clear_needs_layout();
+
+		/// Returns true if the subviews of a view must be laid out again, either because it was flagged or because its computed style changed
+		static bool check_needs_layout(View *view);
+
 		unsigned int find_next_tab_index(unsigned int tab_index) const;
 		unsigned int find_prev_tab_index(unsigned int tab_index) const;
 		unsigned int find_highest_tab_index() const;
@@ -82,6 +144,14 @@ namespace clan
 
 		bool _needs_layout = true;
 
+		unsigned int measure_style_revision = 0;
+		unsigned int layout_style_revision = 0;
+		bool preferred_width_valid = false;
+		float preferred_width = 0.0f;
+		ViewMeasureCache preferred_heights;
+		ViewMeasureCache first_baseline_offsets;
+		ViewMeasureCache last_baseline_offsets;
+
 		Signal<void(ActivationChangeEvent &)> _sig_activated[2];
 		Signal<void(ActivationChangeEvent &)> _sig_deactivated[2];
 		Signal<void(CloseEvent &)> _sig_close[2];
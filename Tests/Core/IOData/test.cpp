@@ -78,6 +78,7 @@ int TestApp::main()
 		test_directory_scanner();
 		test_iodevice();
 		test_iodevice_memory();
+		test_iodevice_large_file();
 		test_virtual_directory_part2();
 		
 		Console::write_line("All Tests Complete");
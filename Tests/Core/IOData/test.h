@@ -67,6 +67,7 @@ private:
 	void test_directory_scanner(void);
 	void test_iodevice_memory(void);
 	void test_iodevice(void);
+	void test_iodevice_large_file(void);
 	void test_virtual_directory_part2(void);
 	void fail(void);
 	void test_vfs();
@@ -0,0 +1,263 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+namespace
+{
+	const int64_t large_offset = int64_t(5) * 1024 * 1024 * 1024 + 123;
+	const int64_t large_entry_size = int64_t(9) * 512 * 1024 * 1024;
+
+	// Deflate stream made of stored blocks, so its compressed size is also bigger than 4 GB
+	const int deflate_block_size = 65535;
+	const int deflate_block_header_size = 5;
+	const int64_t deflate_block_count = 65600;
+	const int64_t deflated_entry_size = deflate_block_count * deflate_block_size;
+	const int64_t deflated_compressed_size = deflate_block_count * (deflate_block_header_size + deflate_block_size);
+
+	void write_stored_data(File &file, int64_t data_offset)
+	{
+		// Only the last bytes of the data are written, the rest stays sparse
+		file.seek(data_offset + large_entry_size - 8);
+		file.write("ENDOFLRG", 8);
+	}
+
+	void write_deflated_data(File &file, int64_t data_offset)
+	{
+		for (int64_t block = 0; block < deflate_block_count; block++)
+		{
+			bool final_block = (block + 1 == deflate_block_count);
+			file.seek(data_offset + block * (deflate_block_header_size + deflate_block_size));
+			file.write_uint8(final_block ? 1 : 0);	// BFINAL and BTYPE 00, no compression
+			file.write_uint16(deflate_block_size);
+			file.write_uint16(~deflate_block_size & 0xffff);
+		}
+		file.seek(data_offset + deflated_compressed_size - 8);
+		file.write("ENDOFDFL", 8);
+	}
+
+	void write_zip64_fixture(const std::string &filename, const std::string &name, int compression_method, int64_t compressed_size, int64_t uncompressed_size, void (*write_data)(File &file, int64_t data_offset))
+	{
+		File file(filename, File::create_always, File::access_read_write);
+		file.set_little_endian_mode();
+
+		int64_t data_offset = 30 + name.length() + 20;
+
+		file.write_uint32(0x04034b50);
+		file.write_uint16(45);
+		file.write_uint16(0);
+		file.write_uint16(compression_method);
+		file.write_uint16(0);
+		file.write_uint16(0);
+		file.write_uint32(0);
+		file.write_uint32(0xffffffff);
+		file.write_uint32(0xffffffff);
+		file.write_uint16(name.length());
+		file.write_uint16(20);
+		file.write(name.data(), name.length());
+		file.write_uint16(0x0001);
+		file.write_uint16(16);
+		file.write_uint64(uncompressed_size);
+		file.write_uint64(compressed_size);
+
+		write_data(file, data_offset);
+
+		int64_t directory_offset = file.get_position();
+		file.write_uint32(0x02014b50);
+		file.write_uint16(45);
+		file.write_uint16(45);
+		file.write_uint16(0);
+		file.write_uint16(compression_method);
+		file.write_uint16(0);
+		file.write_uint16(0);
+		file.write_uint32(0);
+		file.write_uint32(0xffffffff);
+		file.write_uint32(0xffffffff);
+		file.write_uint16(name.length());
+		file.write_uint16(20);
+		file.write_uint16(0);
+		file.write_uint16(0);
+		file.write_uint16(0);
+		file.write_uint32(0);
+		file.write_uint32(0);
+		file.write(name.data(), name.length());
+		file.write_uint16(0x0001);
+		file.write_uint16(16);
+		file.write_uint64(uncompressed_size);
+		file.write_uint64(compressed_size);
+		int64_t directory_size = file.get_position() - directory_offset;
+
+		int64_t end64_offset = file.get_position();
+		file.write_uint32(0x06064b50);
+		file.write_uint64(44);
+		file.write_uint16(45);
+		file.write_uint16(45);
+		file.write_uint32(0);
+		file.write_uint32(0);
+		file.write_uint64(1);
+		file.write_uint64(1);
+		file.write_uint64(directory_size);
+		file.write_uint64(directory_offset);
+
+		file.write_uint32(0x07064b50);
+		file.write_uint32(0);
+		file.write_uint64(end64_offset);
+		file.write_uint32(1);
+
+		file.write_uint32(0x06054b50);
+		file.write_uint16(0);
+		file.write_uint16(0);
+		file.write_uint16(1);
+		file.write_uint16(1);
+		file.write_uint32((uint32_t)directory_size);
+		file.write_uint32(0xffffffff);
+		file.write_uint16(0);
+		file.close();
+	}
+
+	bool check_large_entry(ZipArchive &zip)
+	{
+		std::vector<ZipFileEntry> files = zip.get_file_list();
+		if (files.size() != 1 || files[0].get_uncompressed_size() != large_entry_size)
+			return false;
+
+		IODevice entry = zip.open_file("large.bin");
+		if (entry.get_size() != large_entry_size)
+			return false;
+
+		char buffer[8];
+		if (!entry.seek(-8, IODevice::seek_end) || entry.get_position() != large_entry_size - 8)
+			return false;
+		if (entry.read(buffer, 8) != 8 || memcmp(buffer, "ENDOFLRG", 8))
+			return false;
+
+		if (!entry.seek(int64_t(3) * 1024 * 1024 * 1024) || entry.read(buffer, 8) != 8)
+			return false;
+		for (auto c : buffer)
+		{
+			if (c != 0)
+				return false;
+		}
+		return true;
+	}
+
+	bool check_deflated_entry(ZipArchive &zip)
+	{
+		IODevice entry = zip.open_file("deflated.bin");
+		if (entry.get_size() != deflated_entry_size)
+			return false;
+
+		std::vector<char> buffer(1024 * 1024);
+		int64_t left = deflated_entry_size - 8;
+		while (left > 0)
+		{
+			int size = (int)std::min(left, (int64_t)buffer.size());
+			if (entry.read(buffer.data(), size) != size)
+				return false;
+			left -= size;
+		}
+		if (entry.read(buffer.data(), 8) != 8 || memcmp(buffer.data(), "ENDOFDFL", 8))
+			return false;
+		return entry.get_position() == deflated_entry_size;
+	}
+}
+
+void TestApp::test_iodevice_large_file(void)
+{
+	Console::write_line(" Header: iodevice.h");
+	Console::write_line("  Class: IODevice");
+	Console::write_line("  (Using a sparse File larger than 4 GB)");
+
+	std::string filename = "large_file_test.bin";
+	std::string zip_filename = "large_file_test.zip";
+
+	try
+	{
+//*** testing seek() and get_size() beyond 4 GB
+		Console::write_line("   Function: bool seek(int64_t position, SeekMode mode = seek_set)");
+		{
+			File file(filename, File::create_always, File::access_read_write);
+			if (!file.seek(large_offset)) fail();
+			if (file.get_position() != large_offset) fail();
+			if (file.write("ClanLib!", 8) != 8) fail();
+			file.close();
+		}
+
+		Console::write_line("   Function: int64_t get_size()");
+		{
+			File file(filename);
+			if (file.get_size() != large_offset + 8) fail();
+
+			char buffer[8];
+			if (!file.seek(-8, IODevice::seek_end)) fail();
+			if (file.get_position() != large_offset) fail();
+			if (file.read(buffer, 8) != 8) fail();
+			if (memcmp(buffer, "ClanLib!", 8)) fail();
+
+			if (!file.seek(-(large_offset + 8), IODevice::seek_cur)) fail();
+			if (file.get_position() != 0) fail();
+			if (!file.seek(int64_t(3) * 1024 * 1024 * 1024, IODevice::seek_cur)) fail();
+			if (file.get_position() != int64_t(3) * 1024 * 1024 * 1024) fail();
+			file.close();
+		}
+
+//*** testing a Zip64 archive with an entry larger than 4 GB
+		Console::write_line("  Class: ZipArchive");
+		Console::write_line("   Function: IODevice open_file(const std::string &filename)");
+		write_zip64_fixture(zip_filename, "large.bin", 0, large_entry_size, large_entry_size, &write_stored_data);
+		{
+			ZipArchive mapped_zip(zip_filename);
+			if (!check_large_entry(mapped_zip)) fail();
+
+			File zip_file(zip_filename);
+			ZipArchive streamed_zip(zip_file);
+			if (!check_large_entry(streamed_zip)) fail();
+		}
+
+		// Deflated entry whose compressed data is bigger than 4 GB
+		write_zip64_fixture(zip_filename, "deflated.bin", 8, deflated_compressed_size, deflated_entry_size, &write_deflated_data);
+		{
+			ZipArchive mapped_zip(zip_filename);
+			if (!check_deflated_entry(mapped_zip)) fail();
+
+			File zip_file(zip_filename);
+			ZipArchive streamed_zip(zip_file);
+			if (!check_deflated_entry(streamed_zip)) fail();
+		}
+	}
+	catch (...)
+	{
+		FileHelp::delete_file(filename);
+		FileHelp::delete_file(zip_filename);
+		throw;
+	}
+
+	FileHelp::delete_file(filename);
+	FileHelp::delete_file(zip_filename);
+}
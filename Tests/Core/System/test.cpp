@@ -55,6 +55,8 @@ int TestApp::main()
 		Console::write_line("Directory: API/Core/System");
 
 		test_datetime();
+		test_workqueue();
+		test_signal();
 		
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
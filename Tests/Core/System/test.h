@@ -72,6 +72,8 @@ public:
 	int main();
 private:
 	void test_datetime();
+	void test_workqueue();
+	void test_signal();
 
 	std::string convert_time(DateTime &datetime);
 	void fail(void);
@@ -0,0 +1,147 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+static void benchmark_signal(int num_slots)
+{
+	Signal<void(int)> signal;
+	int sum = 0;
+	std::vector<Slot> slots;
+	for (int i = 0; i < num_slots; i++)
+		slots.push_back(signal.connect([&sum](int value) { sum += value; }));
+
+	const int num_emits = 1000000;
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_emits; i++)
+		signal(1);
+	uint64_t end_time = System::get_microseconds();
+
+	if (sum != num_emits * num_slots)
+		throw Exception("Signal benchmark did not invoke all slots");
+
+	uint64_t time = clan::max(end_time - start_time, (uint64_t)1);
+	Console::write_line("    %1 slots: %2 emits/sec", num_slots, (int)(num_emits * (uint64_t)1000000 / time));
+}
+
+void TestApp::test_signal()
+{
+	Console::write_line(" Header: signal.h");
+	Console::write_line("  Class: Signal");
+
+	Console::write_line("   Function: connect() and operator()");
+	{
+		Signal<void(int)> signal;
+		int sum = 0;
+		Slot slot1 = signal.connect([&](int value) { sum += value; });
+		Slot slot2 = signal.connect([&](int value) { sum += value * 10; });
+		signal(2);
+		if (sum != 22) fail();
+
+		slot1 = Slot();
+		signal(1);
+		if (sum != 32) fail();
+	}
+
+	Console::write_line("   Function: disconnect during emission");
+	{
+		Signal<void()> signal;
+		int calls = 0;
+		Slot slot2;
+		Slot slot1 = signal.connect([&]() { calls++; slot2 = Slot(); });
+		slot2 = signal.connect([&]() { calls += 100; });
+		signal();
+		if (calls != 1) fail();
+		signal();
+		if (calls != 2) fail();
+	}
+
+	Console::write_line("   Function: slot disconnecting itself during emission");
+	{
+		Signal<void()> signal;
+		int calls = 0;
+		Slot slot;
+		std::string captured = "keeps the callback state alive";
+		slot = signal.connect([&, captured]() { slot = Slot(); calls += (int)captured.length(); });
+		signal();
+		signal();
+		if (calls != (int)captured.length()) fail();
+	}
+
+	Console::write_line("   Function: connect during emission");
+	{
+		Signal<void()> signal;
+		int calls = 0;
+		std::vector<Slot> slots;
+		slots.push_back(signal.connect([&]()
+		{
+			calls++;
+			if (slots.size() < 4)
+				slots.push_back(signal.connect([&]() { calls += 100; }));
+		}));
+		signal();
+		if (calls != 1) fail();
+		signal();
+		if (calls != 102) fail();
+	}
+
+	Console::write_line("   Function: recursive emission");
+	{
+		Signal<void(int)> signal;
+		int calls = 0;
+		Slot slot2;
+		Slot slot1 = signal.connect([&](int depth)
+		{
+			calls++;
+			if (depth > 0)
+				signal(depth - 1);
+			else
+				slot2 = Slot();
+		});
+		slot2 = signal.connect([&](int depth) { calls += 100; });
+		signal(2);
+		if (calls != 3) fail();
+	}
+
+	Console::write_line("   Function: signal destroyed during emission");
+	{
+		std::unique_ptr<Signal<void()>> signal(new Signal<void()>());
+		int calls = 0;
+		Slot slot1 = signal->connect([&]() { calls++; signal.reset(); });
+		Slot slot2 = signal->connect([&]() { calls += 100; });
+		(*signal)();
+		if (calls != 1) fail();
+		if (signal) fail();
+	}
+
+	Console::write_line("   Benchmark: emission rate");
+	benchmark_signal(1);
+	benchmark_signal(8);
+	benchmark_signal(64);
+}
@@ -0,0 +1,322 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+// Copy of the single mutex WorkQueue used before the work stealing scheduler, kept for benchmark comparison
+class LegacyWorkQueue
+{
+public:
+	LegacyWorkQueue()
+	{
+		int num_cores = clan::max(System::get_num_cores() - 1, 1);
+		for (int i = 0; i < num_cores; i++)
+			threads.push_back(std::thread(&LegacyWorkQueue::worker_main, this));
+	}
+
+	~LegacyWorkQueue()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		stop_flag = true;
+		mutex_lock.unlock();
+		worker_event.notify_all();
+		for (auto & elem : threads)
+			elem.join();
+		for (auto & elem : queued_items)
+			delete elem;
+		for (auto & elem : finished_items)
+			delete elem;
+	}
+
+	void queue(WorkItem *item)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		queued_items.push_back(item);
+		++items_queued;
+		mutex_lock.unlock();
+		worker_event.notify_one();
+	}
+
+	int get_items_queued() const { return items_queued; }
+
+	void process_work_completed()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		std::vector<WorkItem *> items;
+		items.swap(finished_items);
+		mutex_lock.unlock();
+		for (auto & item : items)
+		{
+			item->work_completed();
+			delete item;
+			--items_queued;
+		}
+	}
+
+private:
+	void worker_main()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued_items.empty(); });
+			if (stop_flag)
+				break;
+			WorkItem *item = queued_items.front();
+			queued_items.erase(queued_items.begin());
+			mutex_lock.unlock();
+
+			item->process_work();
+
+			mutex_lock.lock();
+			finished_items.push_back(item);
+		}
+	}
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable worker_event;
+	bool stop_flag = false;
+	std::vector<WorkItem *> queued_items;
+	std::vector<WorkItem *> finished_items;
+	std::atomic_int items_queued{ 0 };
+};
+
+class BenchmarkWorkItem : public WorkItem
+{
+public:
+	BenchmarkWorkItem(std::atomic_int &counter) : counter(counter) { }
+
+	void process_work() override
+	{
+		float value = 1.0f;
+		for (int i = 0; i < 64; i++)
+			value = value * 1.0001f + 0.5f;
+		result = value;
+		++counter;
+	}
+
+	std::atomic_int &counter;
+	float result = 0.0f;
+};
+
+template<typename QueueType>
+static uint64_t benchmark_queue(QueueType &queue, int num_items)
+{
+	std::atomic_int counter{ 0 };
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_items; i++)
+		queue.queue(new BenchmarkWorkItem(counter));
+	while (queue.get_items_queued() > 0)
+	{
+		queue.process_work_completed();
+		std::this_thread::yield();
+	}
+	uint64_t end_time = System::get_microseconds();
+	if (counter != num_items)
+		throw Exception("Benchmark work items were not all processed");
+	return clan::max(end_time - start_time, (uint64_t)1);
+}
+
+void TestApp::test_workqueue()
+{
+	Console::write_line(" Header: work_queue.h");
+	Console::write_line("  Class: WorkQueue");
+
+	Console::write_line("   Function: queue() and process_work_completed()");
+	{
+		WorkQueue queue;
+		std::atomic_int processed{ 0 };
+		int completed = 0;
+		for (int i = 0; i < 1000; i++)
+		{
+			queue.queue([&]() { ++processed; });
+			queue.work_completed([&]() { completed++; });
+		}
+		while (queue.get_items_queued() > 0)
+			queue.process_work_completed();
+		if (processed != 1000) fail();
+		if (completed != 1000) fail();
+	}
+
+	Console::write_line("   Function: WorkQueue(true) keeps queue order");
+	{
+		WorkQueue queue(true);
+		std::vector<int> order;
+		for (int i = 0; i < 1000; i++)
+			queue.queue([&order, i]() { order.push_back(i); });
+		while (queue.get_items_queued() > 0)
+			queue.process_work_completed();
+		if (order.size() != 1000) fail();
+		for (int i = 0; i < 1000; i++)
+		{
+			if (order[i] != i) fail();
+		}
+	}
+
+	Console::write_line("   Function: queue() runs external submissions oldest first");
+	{
+		WorkQueue queue;
+		int num_workers = clan::max(System::get_num_cores() - 1, 1);
+
+		// Hold every worker so the submissions below pile up before any of them run
+		std::atomic_int workers_held{ 0 };
+		std::atomic_bool release{ false };
+		for (int i = 0; i < num_workers; i++)
+		{
+			queue.queue([&]()
+			{
+				++workers_held;
+				while (!release)
+					std::this_thread::yield();
+			});
+		}
+		while (workers_held != num_workers)
+			std::this_thread::yield();
+
+		std::mutex order_mutex;
+		std::vector<int> order;
+		for (int i = 0; i < 1000; i++)
+		{
+			queue.queue([&order_mutex, &order, i]()
+			{
+				std::unique_lock<std::mutex> order_lock(order_mutex);
+				order.push_back(i);
+			});
+		}
+		release = true;
+
+		while (queue.get_items_queued() > 0)
+			queue.process_work_completed();
+		if (order.size() != 1000) fail();
+		int first_position = (int)(std::find(order.begin(), order.end(), 0) - order.begin());
+		if (first_position >= 100) fail();
+	}
+
+	Console::write_line("   Function: ~WorkQueue() discards queued work");
+	{
+		std::atomic_int processed{ 0 };
+		{
+			WorkQueue queue(true);
+			queue.queue([&]() { std::this_thread::sleep_for(std::chrono::milliseconds(100)); ++processed; });
+			for (int i = 0; i < 100; i++)
+				queue.queue([&]() { ++processed; });
+		}
+		if (processed > 1) fail();
+	}
+
+	Console::write_line("   Function: create_task_group() and WorkTaskGroup::wait()");
+	{
+		WorkQueue queue;
+		WorkTaskGroup group = queue.create_task_group();
+		if (group.is_null()) fail();
+		std::atomic_int processed{ 0 };
+		for (int i = 0; i < 1000; i++)
+		{
+			queue.queue(group, [&]()
+			{
+				// Nested groups make workers wait on workers
+				WorkTaskGroup inner = queue.create_task_group();
+				queue.queue(inner, [&]() { ++processed; });
+				inner.wait();
+			});
+		}
+		group.wait();
+		if (!group.is_done()) fail();
+		if (processed != 1000) fail();
+		if (queue.get_items_queued() != 0) fail();
+
+		queue.queue(group, []() { throw Exception("Task exception"); });
+		bool exception_thrown = false;
+		try
+		{
+			group.wait();
+		}
+		catch (Exception &)
+		{
+			exception_thrown = true;
+		}
+		if (!exception_thrown) fail();
+	}
+
+	Console::write_line("   Function: parallel_for()");
+	{
+		WorkQueue queue;
+		std::vector<int> values(100000);
+		queue.parallel_for((int)values.size(), 1000, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+				values[i]++;
+		});
+		for (auto & value : values)
+		{
+			if (value != 1) fail();
+		}
+
+		int calls = 0;
+		queue.parallel_for(0, 16, [&](int, int) { calls++; });
+		if (calls != 0) fail();
+
+		std::atomic_int sum{ 0 };
+		queue.parallel_for(100, 0, [&](int begin, int end) { sum += end - begin; });
+		if (sum != 100) fail();
+
+		// Chunk boundaries past the end of the int range must not overflow
+		std::atomic_int chunks{ 0 };
+		std::atomic<int64_t> covered{ 0 };
+		queue.parallel_for(0x7fffff00, 0x40000000, [&](int begin, int end)
+		{
+			if (begin < 0 || end <= begin || end > 0x7fffff00) fail();
+			covered += end - begin;
+			++chunks;
+		});
+		if (chunks != 2) fail();
+		if (covered != 0x7fffff00) fail();
+	}
+
+	Console::write_line("   Benchmark: queue() throughput against the single mutex queue");
+	{
+		const int num_items = 200000;
+
+		LegacyWorkQueue legacy_queue;
+		uint64_t legacy_time = benchmark_queue(legacy_queue, num_items);
+
+		WorkQueue queue;
+		uint64_t time = benchmark_queue(queue, num_items);
+
+		Console::write_line("    %1 items, %2 worker cores", num_items, clan::max(System::get_num_cores() - 1, 1));
+		Console::write_line("    Single mutex queue: %1 items/ms", (int)(num_items * 1000 / legacy_time));
+		Console::write_line("    Work stealing queue: %1 items/ms", (int)(num_items * 1000 / time));
+	}
+}
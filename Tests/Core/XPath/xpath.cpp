@@ -39,6 +39,60 @@ void evaluate(const std::string &xpath, const DomDocument &document)
 	Console::write_line("");
 }
 
+// Evaluates the same expressions many times: compiled for every evaluation, which is what the string API did before
+// it had a cache, through the cached string API, and as precompiled expressions
+void benchmark(const DomDocument &document)
+{
+	const char *expressions[] =
+	{
+		"/root/child/childchild",
+		"root/child[@foo=\"barism\"]/childchild",
+		"root/child[childchild=\"Test6\"]/foobar",
+		"count(root/child[position() mod 2 = 0])",
+		"root/*[local-name()='child' and (@age=10 or namespace-uri()='fisk')]/foobar",
+		"//childchild[1]"
+	};
+	const int num_expressions = sizeof(expressions) / sizeof(expressions[0]);
+	const int iterations = 2000;
+
+	XPathEvaluator evaluator;
+
+	// Constructing an XPathExpression always compiles it, bypassing the cache of the string API
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (auto & expression : expressions)
+			evaluator.evaluate(XPathExpression(expression), document);
+	}
+	uint64_t uncached_time = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (auto & expression : expressions)
+			evaluator.evaluate(expression, document);
+	}
+	uint64_t string_time = System::get_microseconds() - start_time;
+
+	std::vector<XPathExpression> compiled;
+	for (auto & expression : expressions)
+		compiled.push_back(XPathExpression(expression));
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (auto & expression : compiled)
+			evaluator.evaluate(expression, document);
+	}
+	uint64_t compiled_time = System::get_microseconds() - start_time;
+
+	int num_evaluations = iterations * num_expressions;
+	Console::write_line("Benchmark: %1 evaluations", num_evaluations);
+	Console::write_line("Compiled per evaluation: %1 ms (%2 us per evaluation)", (int)(uncached_time / 1000), uncached_time / (double)num_evaluations);
+	Console::write_line("String expressions: %1 ms (%2 us per evaluation)", (int)(string_time / 1000), string_time / (double)num_evaluations);
+	Console::write_line("Compiled expressions: %1 ms (%2 us per evaluation)", (int)(compiled_time / 1000), compiled_time / (double)num_evaluations);
+}
+
 int main(int, char**)
 {
 	try
@@ -92,6 +146,8 @@ int main(int, char**)
 // 		evaluate("local-name(/root/child[1])", document);
 // 		evaluate("id(/root/child[1]/childchild[1])", document);
 // 		evaluate("//childchild[1]", document);
+
+		benchmark(document);
 	}
 	catch(Exception &error)
 	{
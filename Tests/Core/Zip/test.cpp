@@ -31,7 +31,7 @@
 int main(int argc, char** argv)
 {
 	TestApp program;
-	program.main();
+	return program.main();
 }
 
 int TestApp::main()
@@ -41,6 +41,7 @@ int TestApp::main()
 	try
 	{
 		run_test();
+		run_archive_test();
 		console.display_close_message();
 	}
 	catch(Exception error)
@@ -86,3 +87,169 @@ void TestApp::run_test()
 		Console::write_line("Contents: %1", StringHelp::utf8_to_text(str8));
 	}
 }
+
+static std::string make_test_data()
+{
+	std::string data;
+	for (int i = 0; i < 100000; i++)
+		data.append(1, (char)('a' + i % 23));
+	return data;
+}
+
+static std::string read_entry(ZipArchive &archive, const std::string &filename)
+{
+	IODevice file = archive.open_file(filename);
+	std::string contents((size_t)file.get_size(), 0);
+	if (!contents.empty() && file.read(&contents[0], contents.size()) != (int)contents.size())
+		throw Exception(string_format("Unable to read %1 from the archive", filename));
+	return contents;
+}
+
+static std::string list_directory(ZipArchive &archive, const std::string &path)
+{
+	std::vector<std::string> names;
+	for (auto &entry : archive.get_file_list(path))
+		names.push_back(entry.is_directory() ? entry.get_archive_filename() + "/" : entry.get_archive_filename());
+	std::sort(names.begin(), names.end());
+
+	std::string listing;
+	for (auto &name : names)
+		listing += (listing.empty() ? "" : " ") + name;
+	return listing;
+}
+
+/// \brief Returns the offset of the local file header (PK\3\4) or central directory record (PK\1\2) of an entry
+static int find_header(const DataBuffer &zip_data, char type, const std::string &entry_name)
+{
+	const unsigned char *data = zip_data.get_data<unsigned char>();
+	int name_length_offset = (type == 3) ? 26 : 28;
+	int name_offset = (type == 3) ? 30 : 46;
+	for (int pos = 0; pos + name_offset <= (int)zip_data.get_size(); pos++)
+	{
+		if (data[pos] == 'P' && data[pos + 1] == 'K' && data[pos + 2] == type && data[pos + 3] == type + 1)
+		{
+			int name_length = data[pos + name_length_offset] | (data[pos + name_length_offset + 1] << 8);
+			if (pos + name_offset + name_length <= (int)zip_data.get_size() && std::string(zip_data.get_data() + pos + name_offset, name_length) == entry_name)
+				return pos;
+		}
+	}
+	throw Exception(string_format("Zip header of %1 not found", entry_name));
+}
+
+static void write_uint32(DataBuffer &zip_data, int pos, uint32_t value)
+{
+	unsigned char *data = zip_data.get_data<unsigned char>();
+	for (int i = 0; i < 4; i++)
+		data[pos + i] = (unsigned char)(value >> (i * 8));
+}
+
+void TestApp::run_archive_test()
+{
+	Console::write_line("");
+	Console::write_line("ZipArchive:");
+
+	std::string big_data = make_test_data();
+
+	File file("ZipArchive.zip", File::create_always, File::access_write);
+	ZipWriter zip_writer(file);
+	zip_writer.begin_file("readme.txt", true);
+	zip_writer.write_file_data("Read me", 7);
+	zip_writer.end_file();
+	zip_writer.begin_file("data/big.bin", false);
+	zip_writer.write_file_data(big_data.data(), big_data.size());
+	zip_writer.end_file();
+	zip_writer.begin_file("data/small.txt", true);
+	zip_writer.write_file_data("Small", 5);
+	zip_writer.end_file();
+	zip_writer.begin_file("data/sub/deep.txt", true);
+	zip_writer.write_file_data(big_data.data(), big_data.size());
+	zip_writer.end_file();
+	zip_writer.write_toc();
+	file.close();
+
+	// Opened by filename the archive is read through a memory mapping, opened from a device it is streamed
+	ZipArchive mapped_archive("ZipArchive.zip");
+	Console::write_line(" Mapped archive");
+	test_archive_contents(mapped_archive);
+
+	File input("ZipArchive.zip", File::open_existing, File::access_read);
+	ZipArchive streamed_archive(input);
+	Console::write_line(" Streamed archive");
+	test_archive_contents(streamed_archive);
+
+	// Entries pointing past the end of the mapped file must be rejected instead of read out of bounds
+	DataBuffer zip_data = File::read_bytes("ZipArchive.zip");
+
+	DataBuffer bad_offset(zip_data.get_data(), zip_data.get_size());
+	write_uint32(bad_offset, find_header(bad_offset, 1, "data/small.txt") + 42, zip_data.get_size() - 10);
+	Console::write_line(" Local header offset past the end");
+	test_entry_rejected(bad_offset, "data/small.txt");
+
+	DataBuffer bad_size(zip_data.get_data(), zip_data.get_size());
+	int local_header = find_header(bad_size, 3, "data/big.bin");
+	write_uint32(bad_size, local_header + 18, zip_data.get_size());
+	write_uint32(bad_size, local_header + 22, zip_data.get_size());
+	Console::write_line(" Stored size past the end");
+	test_entry_rejected(bad_size, "data/big.bin");
+
+	DataBuffer bad_name_length(zip_data.get_data(), zip_data.get_size());
+	local_header = find_header(bad_name_length, 3, "data/sub/deep.txt");
+	bad_name_length.get_data<unsigned char>()[local_header + 28] = 0xff;
+	bad_name_length.get_data<unsigned char>()[local_header + 29] = 0xff;
+	Console::write_line(" Extra field past the end");
+	test_entry_rejected(bad_name_length, "data/sub/deep.txt");
+
+	Console::write_line("ZipArchive tests passed");
+}
+
+void TestApp::test_archive_contents(ZipArchive &archive)
+{
+	std::string big_data = make_test_data();
+
+	if (archive.get_file_list().size() != 4)
+		throw Exception("Wrong number of entries in the archive");
+
+	// Lookup by name through the index
+	if (read_entry(archive, "readme.txt") != "Read me" ||
+		read_entry(archive, "data/big.bin") != big_data ||
+		read_entry(archive, "data/small.txt") != "Small" ||
+		read_entry(archive, "data/sub/deep.txt") != big_data)
+		throw Exception("Entry contents differ from what was written");
+	Console::write_line("  Entries found by name");
+
+	bool missing_rejected = false;
+	try
+	{
+		archive.open_file("data/missing.txt");
+	}
+	catch (Exception &)
+	{
+		missing_rejected = true;
+	}
+	if (!missing_rejected)
+		throw Exception("Opening a missing entry did not fail");
+
+	// The directory listings are built on the first call
+	if (list_directory(archive, "") != "data/ readme.txt" ||
+		list_directory(archive, "data") != "big.bin small.txt sub/" ||
+		list_directory(archive, "/data/sub/") != "deep.txt" ||
+		list_directory(archive, "nothing") != "")
+		throw Exception("Directory listing differs from the archive contents");
+	Console::write_line("  Directory listings: / = %1, /data/ = %2", list_directory(archive, "/"), list_directory(archive, "/data/"));
+}
+
+void TestApp::test_entry_rejected(const DataBuffer &zip_data, const std::string &entry_name)
+{
+	File::write_bytes("ZipArchiveCorrupt.zip", zip_data);
+	ZipArchive archive("ZipArchiveCorrupt.zip");
+	try
+	{
+		read_entry(archive, entry_name);
+	}
+	catch (Exception &e)
+	{
+		Console::write_line("  Rejected: %1", e.message);
+		return;
+	}
+	throw Exception(string_format("Corrupt entry %1 was not rejected", entry_name));
+}
@@ -30,6 +30,7 @@
 #define _header_test_
 
 #include <ClanLib/core.h>
+#include <algorithm>
 
 using namespace clan;
 
@@ -40,6 +41,9 @@ public:
 
 private:
 	void run_test();
+	void run_archive_test();
+	void test_archive_contents(ZipArchive &archive);
+	void test_entry_rejected(const DataBuffer &zip_data, const std::string &entry_name);
 };
 
 #endif
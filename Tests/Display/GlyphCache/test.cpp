@@ -0,0 +1,83 @@
+#include <ClanLib/core.h>
+#include <ClanLib/application.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+
+using namespace clan;
+
+// Keeps drawing glyphs that have not been drawn before and checks that the glyph texture atlas does not grow beyond
+// its memory budget. Evicted pages must release their textures and freed space must be reused.
+class App : public clan::Application
+{
+public:
+	App()
+	{
+		clan::OpenGLTarget::enable();
+		window = DisplayWindow("Glyph cache eviction test", 800, 600);
+		canvas = Canvas(window);
+
+		family = FontFamily("Tahoma");
+		family.add("Tahoma", font_height);
+		family.set_glyph_cache_budget(budget_pages * page_bytes);
+		font = Font(family, font_height);
+
+		Console::write_line("Drawing %1 new glyphs per frame with a budget of %2 atlas pages", glyphs_per_frame, budget_pages);
+	}
+
+	bool update()
+	{
+		canvas.clear(Colorf::black);
+
+		// Walk through Latin, Greek and Cyrillic, so nearly every glyph is a cache miss
+		std::string text;
+		for (int i = 0; i < glyphs_per_frame; i++)
+		{
+			text += StringHelp::unicode_to_utf8(next_character++);
+			if (next_character > last_character)
+				next_character = first_character;
+		}
+		font.draw_text(canvas, 10.0f, 100.0f, text);
+
+		canvas.flush();
+		window.flip(0);
+
+		GlyphCacheStatistics statistics = family.get_glyph_cache_statistics();
+		if (statistics.atlas_pages > budget_pages)
+			throw Exception(string_format("Glyph atlas grew to %1 pages at frame %2", statistics.atlas_pages, frame));
+		if (statistics.atlas_bytes > budget_pages * page_bytes)
+			throw Exception(string_format("Glyph atlas uses %1 bytes at frame %2", (int)statistics.atlas_bytes, frame));
+
+		frame++;
+		if (frame == num_frames)
+		{
+			if (statistics.evictions == 0)
+				throw Exception("No glyphs were evicted; the test did not exceed the budget");
+
+			Console::write_line("%1 misses, %2 evictions, %3 glyphs and %4 atlas pages cached", (int)statistics.misses, (int)statistics.evictions, statistics.glyph_count, statistics.atlas_pages);
+			Console::write_line("All Tests Complete");
+			return false;
+		}
+
+		return true;
+	}
+
+	static const int font_height = 48;
+	static const int glyphs_per_frame = 16;
+	static const int num_frames = 300;
+	static const int budget_pages = 2;
+	static const int64_t page_bytes = 256 * 256 * 4;
+
+	static const unsigned int first_character = 0x21;
+	static const unsigned int last_character = 0x4ff;
+
+	int frame = 0;
+	unsigned int next_character = first_character;
+
+	FontFamily family;
+	Font font;
+
+	DisplayWindow window;
+	Canvas canvas;
+};
+
+clan::ApplicationInstance<App> clanapp;
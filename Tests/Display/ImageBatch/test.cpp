@@ -0,0 +1,221 @@
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+using namespace clan;
+
+// Loads every image found below a directory (the example assets by default) one at a time, then as a batch,
+// and checks that both give the same pixels. The batch is loaded both blocking and through a WorkQueue with
+// completion callbacks. Also loads a batch of in-memory JPEG and PNG files, including one that is invalid,
+// and checks that an exception other than clan::Exception reaches the thread processing the completed work.
+
+/// \brief Device that fails with a standard library exception, which a decoder could also throw (std::bad_alloc for instance)
+class ThrowingDeviceProvider : public IODeviceProvider
+{
+public:
+	int send(const void *data, int len, bool send_all) override { throw std::runtime_error("device failed"); }
+	int receive(void *data, int len, bool receive_all) override { throw std::runtime_error("device failed"); }
+	int peek(void *data, int len) override { throw std::runtime_error("device failed"); }
+	IODeviceProvider *duplicate() override { return new ThrowingDeviceProvider(); }
+};
+
+static void find_image_files(const std::string &root, const std::string &path, std::vector<std::string> &out_files)
+{
+	DirectoryScanner scanner;
+	if (scanner.scan(PathHelp::combine(root, path)))
+	{
+		while (scanner.next())
+		{
+			std::string name = scanner.get_name();
+			std::string ext = StringHelp::text_to_lower(PathHelp::get_extension(name));
+			if (scanner.is_directory())
+			{
+				if (name != "." && name != "..")
+					find_image_files(root, PathHelp::combine(path, name), out_files);
+			}
+			else if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "tga")
+			{
+				out_files.push_back(PathHelp::combine(path, name));
+			}
+		}
+	}
+}
+
+static bool same_image(const PixelBuffer &a, const PixelBuffer &b)
+{
+	if (a.is_null() || b.is_null() || a.get_width() != b.get_width() || a.get_height() != b.get_height() || a.get_format() != b.get_format())
+		return false;
+	for (int y = 0; y < a.get_height(); y++)
+	{
+		if (memcmp(a.get_line(y), b.get_line(y), a.get_width() * a.get_bytes_per_pixel()) != 0)
+			return false;
+	}
+	return true;
+}
+
+static bool test_corpus(const std::string &path)
+{
+	std::vector<std::string> filenames;
+	find_image_files(path, "", filenames);
+	FileSystem fs(path);
+
+	uint64_t start_time = System::get_microseconds();
+	std::vector<PixelBuffer> images;
+	for (auto & filename : filenames)
+		images.push_back(ImageProviderFactory::load(filename, fs));
+	uint64_t serial_time = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	std::vector<ImageProviderBatchResult> results = ImageProviderFactory::load_batch(filenames, fs);
+	uint64_t batch_time = System::get_microseconds() - start_time;
+
+	bool passed = results.size() == filenames.size();
+	for (size_t i = 0; passed && i < results.size(); i++)
+	{
+		if (results[i].index != (int)i || results[i].filename != filenames[i] || !same_image(results[i].image, images[i]))
+		{
+			Console::write_line("Batch loaded %1 differently: %2", filenames[i], results[i].failure_reason);
+			passed = false;
+		}
+	}
+
+	Console::write_line("Loaded %1 files from %2: %3 ms one at a time, %4 ms as a batch", (int)filenames.size(), path, (int)(serial_time / 1000), (int)(batch_time / 1000));
+
+	std::sort(results.begin(), results.end(), [](const ImageProviderBatchResult &a, const ImageProviderBatchResult &b) { return a.decode_microseconds > b.decode_microseconds; });
+	for (size_t i = 0; i < results.size() && i < 3; i++)
+		Console::write_line("    %1: read %2 us, decode %3 us", results[i].filename, (int)results[i].read_microseconds, (int)results[i].decode_microseconds);
+
+	WorkQueue queue;
+	std::thread::id main_thread = std::this_thread::get_id();
+	std::vector<int> completed(filenames.size());
+	int num_completed = 0;
+	ImageProviderFactory::load_batch(queue, filenames, fs, [&](const ImageProviderBatchResult &result)
+	{
+		if (std::this_thread::get_id() != main_thread || !same_image(result.image, images[result.index]))
+			passed = false;
+		completed[result.index]++;
+		num_completed++;
+	});
+	while (num_completed < (int)filenames.size())
+	{
+		queue.process_work_completed();
+		System::sleep(1);
+	}
+	if (std::count(completed.begin(), completed.end(), 1) != (int)filenames.size())
+		passed = false;
+
+	if (!passed)
+		Console::write_line("Work queue batch reported wrong results!");
+	return passed;
+}
+
+static bool test_devices()
+{
+	PixelBuffer image(333, 222, tf_rgba8);
+	for (int y = 0; y < image.get_height(); y++)
+	{
+		unsigned char *line = image.get_line_uint8(y);
+		for (int x = 0; x < image.get_width(); x++)
+		{
+			line[x * 4 + 0] = (unsigned char)x;
+			line[x * 4 + 1] = (unsigned char)y;
+			line[x * 4 + 2] = (unsigned char)(x ^ y);
+			line[x * 4 + 3] = 255;
+		}
+	}
+
+	MemoryDevice png_file, jpeg_file;
+	PNGProvider::save(image, png_file);
+	JPEGProvider::save(image, jpeg_file);
+	png_file.seek(0);
+	jpeg_file.seek(0);
+
+	DataBuffer garbage(1000);
+	memset(garbage.get_data(), 0x55, garbage.get_size());
+	MemoryDevice garbage_file(garbage);
+
+	std::vector<IODevice> files = { png_file, jpeg_file, garbage_file };
+	std::vector<std::string> types = { "png", "jpg", "png" };
+	std::vector<ImageProviderBatchResult> results(files.size());
+	int num_completed = 0;
+
+	WorkQueue queue;
+	ImageProviderFactory::load_batch(queue, files, types, [&](const ImageProviderBatchResult &result)
+	{
+		results[result.index] = result;
+		num_completed++;
+	});
+	while (num_completed < (int)files.size())
+	{
+		queue.process_work_completed();
+		System::sleep(1);
+	}
+
+	bool passed = same_image(results[0].image, image) &&
+		!results[1].image.is_null() && results[1].image.get_width() == image.get_width() && results[1].image.get_height() == image.get_height() &&
+		results[2].image.is_null() && !results[2].failure_reason.empty();
+
+	if (!passed)
+		Console::write_line("IODevice batch reported wrong results!");
+	return passed;
+}
+
+static bool test_foreign_exception()
+{
+	PixelBuffer image(16, 16, tf_rgba8);
+	memset(image.get_data(), 0x80, image.get_height() * image.get_pitch());
+	MemoryDevice png_file;
+	PNGProvider::save(image, png_file);
+	png_file.seek(0);
+
+	std::vector<IODevice> files = { png_file, IODevice(new ThrowingDeviceProvider()) };
+	std::vector<std::string> types = { "png", "png" };
+	std::vector<ImageProviderBatchResult> results(files.size());
+	int num_completed = 0;
+	int num_exceptions = 0;
+
+	WorkQueue queue;
+	ImageProviderFactory::load_batch(queue, files, types, [&](const ImageProviderBatchResult &result)
+	{
+		results[result.index] = result;
+		num_completed++;
+	});
+	while (num_completed < (int)files.size())
+	{
+		try
+		{
+			queue.process_work_completed();
+		}
+		catch (const std::runtime_error &)
+		{
+			num_exceptions++;
+		}
+		System::sleep(1);
+	}
+
+	bool passed = num_exceptions == 1 && same_image(results[0].image, image) &&
+		results[1].image.is_null() && results[1].failure_reason == "device failed";
+
+	if (!passed)
+		Console::write_line("Standard exception in a batch was not rethrown once!");
+	return passed;
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		bool passed = test_devices();
+		passed = test_foreign_exception() && passed;
+		passed = test_corpus(argc > 1 ? argv[1] : "../../../Examples") && passed;
+		return passed ? 0 : -1;
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+}
@@ -0,0 +1,150 @@
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <cstring>
+
+using namespace clan;
+
+// Decodes baseline JPEGs saved with and without restart intervals from the same image and compares the pixels.
+// Without restart intervals the entropy data is decoded serially from the stream, with them the intervals are
+// decoded in parallel on the display WorkQueue. Restart markers only change the entropy coding, so the results must be identical.
+// Also checks that a truncated file and a corrupt restart marker are rejected, and that a damaged interval only affects its own MCUs.
+
+static PixelBuffer load_jpeg(DataBuffer data)
+{
+	MemoryDevice device(data);
+	return JPEGProvider::load(device);
+}
+
+static bool is_rejected(DataBuffer data)
+{
+	try
+	{
+		load_jpeg(data);
+		return false;
+	}
+	catch (Exception &)
+	{
+		return true;
+	}
+}
+
+/// \brief Returns the number of pixels that differ, ignoring the MCUs in [skip_mcu_begin, skip_mcu_end)
+static int count_differences(const PixelBuffer &a, const PixelBuffer &b, int mcu_size = 8, int skip_mcu_begin = 0, int skip_mcu_end = 0)
+{
+	if (a.get_width() != b.get_width() || a.get_height() != b.get_height())
+		return a.get_width() * a.get_height();
+
+	int width = a.get_width();
+	int height = a.get_height();
+	int mcu_width = (width + mcu_size - 1) / mcu_size;
+	int differences = 0;
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned int *line_a = static_cast<const unsigned int *>(a.get_line(y));
+		const unsigned int *line_b = static_cast<const unsigned int *>(b.get_line(y));
+		for (int x = 0; x < width; x++)
+		{
+			int mcu = x / mcu_size + (y / mcu_size) * mcu_width;
+			if ((mcu < skip_mcu_begin || mcu >= skip_mcu_end) && line_a[x] != line_b[x])
+				differences++;
+		}
+	}
+	return differences;
+}
+
+/// \brief Returns the offset of the given restart marker in the entropy data, or -1 if there are not that many
+static int find_restart_marker(const DataBuffer &data, int marker_index)
+{
+	const unsigned char *bytes = data.get_data<unsigned char>();
+	for (unsigned int i = 0; i + 1 < data.get_size(); i++)
+	{
+		if (bytes[i] == 0xff && bytes[i + 1] >= 0xd0 && bytes[i + 1] <= 0xd7 && marker_index-- == 0)
+			return i;
+	}
+	return -1;
+}
+
+static bool test_pair(const std::string &name, int mcu_size, int restart_interval)
+{
+	DataBuffer plain_data = File::read_bytes("Resources/plain_" + name + ".jpg");
+	DataBuffer restart_data = File::read_bytes("Resources/restart_" + name + ".jpg");
+
+	PixelBuffer serial = load_jpeg(plain_data);
+	PixelBuffer parallel = load_jpeg(restart_data);
+	int differences = count_differences(serial, parallel);
+	Console::write_line("%1: %2x%3, %4 pixels differ between the serial and WorkQueue decode", name, serial.get_width(), serial.get_height(), differences);
+	bool passed = (differences == 0);
+
+	DataBuffer truncated(restart_data, 0, restart_data.get_size() / 2);
+	if (!is_rejected(truncated))
+	{
+		Console::write_line("%1: truncated file was not rejected!", name);
+		passed = false;
+	}
+
+	const int damaged_marker = 4;
+	int marker_pos = find_restart_marker(restart_data, damaged_marker);
+	if (marker_pos == -1)
+		throw Exception("Test image " + name + " has too few restart markers");
+
+	// Replacing a restart marker with another marker ends the entropy data early
+	DataBuffer corrupt_marker(restart_data.get_data(), restart_data.get_size());
+	corrupt_marker.get_data<unsigned char>()[marker_pos + 1] = 0xc8;
+	if (!is_rejected(corrupt_marker))
+	{
+		Console::write_line("%1: corrupt restart marker was not rejected!", name);
+		passed = false;
+	}
+
+	// Corrupting the entropy data of an interval leaves the markers intact. The damaged interval may decode to garbage
+	// or be rejected, but it must not affect any other interval
+	DataBuffer damaged_interval(restart_data.get_data(), restart_data.get_size());
+	unsigned char *damaged_bytes = damaged_interval.get_data<unsigned char>() + marker_pos - 8;
+	for (int i = 0; i < 6; i++)
+	{
+		if (damaged_bytes[i] != 0xff && damaged_bytes[i] != 0x00 && damaged_bytes[i] != (0xff ^ 0x5a))
+			damaged_bytes[i] ^= 0x5a;
+	}
+	try
+	{
+		PixelBuffer damaged = load_jpeg(damaged_interval);
+		int damaged_mcu = damaged_marker * restart_interval;
+		int outside = count_differences(serial, damaged, mcu_size, damaged_mcu, damaged_mcu + restart_interval);
+		int total = count_differences(serial, damaged);
+		Console::write_line("%1: damaged interval decoded, %2 pixels differ inside it", name, total - outside);
+		if (outside != 0)
+		{
+			Console::write_line("%1: %2 pixels outside the damaged interval differ!", name, outside);
+			passed = false;
+		}
+	}
+	catch (Exception &e)
+	{
+		Console::write_line("%1: damaged interval rejected: %2", name, e.message);
+	}
+
+	return passed;
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		bool passed = true;
+		passed = test_pair("420", 16, 3) && passed;	// 4:2:0, restart every 3 MCUs
+		passed = test_pair("444", 8, 26) && passed;	// 4:4:4, restart every MCU row
+		if (!passed)
+		{
+			Console::write_line("JPEG restart interval test failed!");
+			return -1;
+		}
+		Console::write_line("JPEG restart interval decode matches");
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+
+	return 0;
+}
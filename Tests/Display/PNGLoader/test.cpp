@@ -0,0 +1,151 @@
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace clan;
+
+// Saves a generated image as PNG, then measures how fast PNGProvider loads it back.
+// Checks that the decoded pixels match and that the rows decoded callback reports every row exactly once, in order.
+// Finally decodes every PNG found below a directory (the example assets by default) and reports the throughput.
+
+static void find_png_files(const std::string &path, std::vector<std::string> &out_files)
+{
+	DirectoryScanner scanner;
+	if (scanner.scan(path))
+	{
+		while (scanner.next())
+		{
+			std::string name = scanner.get_name();
+			if (scanner.is_directory())
+			{
+				if (name != "." && name != "..")
+					find_png_files(scanner.get_pathname(), out_files);
+			}
+			else if (StringHelp::compare(PathHelp::get_extension(name), "png", true) == 0)
+			{
+				out_files.push_back(scanner.get_pathname());
+			}
+		}
+	}
+}
+
+static void benchmark_corpus(const std::string &path)
+{
+	std::vector<std::string> filenames;
+	find_png_files(path, filenames);
+
+	std::vector<DataBuffer> files;
+	for (auto & filename : filenames)
+		files.push_back(File::read_bytes(filename));
+
+	const int iterations = 5;
+	uint64_t compressed_bytes = 0;
+	uint64_t decoded_bytes = 0;
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (auto & file : files)
+		{
+			MemoryDevice input(file);
+			PixelBuffer image = PNGProvider::load(input);
+			compressed_bytes += file.get_size();
+			decoded_bytes += image.get_pitch() * image.get_height();
+		}
+	}
+	double seconds = (System::get_microseconds() - start_time) / 1000000.0;
+
+	Console::write_line("Decoded %1 files from %2: %3 MB/s compressed, %4 MB/s decoded", (int)files.size(), path,
+		(int)(compressed_bytes / seconds / 1000000.0), (int)(decoded_bytes / seconds / 1000000.0));
+}
+
+int main(int argc, char** argv)
+{
+	const int width = 2048;
+	const int height = 2048;
+	const int iterations = 10;
+
+	try
+	{
+		PixelBuffer image(width, height, tf_rgba8);
+		unsigned char *pixels = image.get_data_uint8();
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				// Gradients with some noise, so the image compresses like a typical texture
+				unsigned char *pixel = pixels + (y * width + x) * 4;
+				pixel[0] = (unsigned char)(x + (rand() & 7));
+				pixel[1] = (unsigned char)(y + (rand() & 7));
+				pixel[2] = (unsigned char)((x + y) / 2);
+				pixel[3] = (unsigned char)(255 - (rand() & 3));
+			}
+		}
+
+		MemoryDevice file;
+		PNGProvider::save(image, file);
+		DataBuffer png_data = file.get_data();
+		Console::write_line("Compressed %1x%2 image to %3 bytes", width, height, (int)png_data.get_size());
+
+		uint64_t start_time = System::get_microseconds();
+		PixelBuffer loaded;
+		for (int i = 0; i < iterations; i++)
+		{
+			MemoryDevice input(png_data);
+			loaded = PNGProvider::load(input);
+		}
+		uint64_t elapsed = System::get_microseconds() - start_time;
+		double megapixels = width * (double)height * iterations / 1000000.0;
+		Console::write_line("Load: %1 MPix/s", (int)(megapixels / (elapsed / 1000000.0)));
+
+		if (loaded.get_width() != width || loaded.get_height() != height || memcmp(loaded.get_data(), image.get_data(), width * height * 4) != 0)
+			Console::write_line("Loaded image differs from the saved image!");
+
+		int next_row = 0;
+		int num_bands = 0;
+		bool bands_valid = true;
+		MemoryDevice input(png_data);
+		PixelBuffer banded = PNGProvider::load(input, false, [&](const PixelBuffer &band_image, int y, int band_height)
+		{
+			if (y != next_row || band_height <= 0 || memcmp(band_image.get_line(y), image.get_line(y), width * 4 * band_height) != 0)
+				bands_valid = false;
+			next_row = y + band_height;
+			num_bands++;
+		});
+		if (!bands_valid || next_row != height || memcmp(banded.get_data(), image.get_data(), width * height * 4) != 0)
+			Console::write_line("Rows decoded callback reported wrong bands!");
+		else
+			Console::write_line("Rows decoded callback reported %1 bands", num_bands);
+
+		bool truncated_rejected = false;
+		try
+		{
+			DataBuffer truncated_data(png_data, 0, png_data.get_size() / 2);
+			MemoryDevice truncated(truncated_data);
+			PNGProvider::load(truncated);
+		}
+		catch (Exception &)
+		{
+			truncated_rejected = true;
+		}
+		if (!truncated_rejected)
+			Console::write_line("Truncated file was not rejected!");
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+
+	try
+	{
+		benchmark_corpus(argc > 1 ? argv[1] : "../../../Examples");
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+
+	return 0;
+}
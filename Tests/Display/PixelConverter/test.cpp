@@ -0,0 +1,196 @@
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace clan;
+
+// Measures PixelConverter throughput in megapixels per second for the common 8 bit format pairs,
+// both on the calling thread and split into bands on a WorkQueue. The scalar kernels are checked against a straightforward
+// reference conversion, and every SIMD kernel set the CPU supports must produce exactly the same bytes as the scalar kernels.
+// Returns non-zero if any conversion differs.
+
+struct InstructionSets
+{
+	const char *name;
+	bool sse2;
+	bool ssse3;
+	bool sse4;
+	bool avx2;
+};
+
+struct ConversionTest
+{
+	const char *name;
+	TextureFormat input_format;
+	TextureFormat output_format;
+	bool premultiply_alpha;
+	bool flip_vertical;
+	Vec4i swizzle;
+};
+
+static int get_bytes(TextureFormat format)
+{
+	return (format == tf_rgb8 || format == tf_bgr8) ? 3 : 4;
+}
+
+// Returns the RGBA value of a pixel
+static Vec4i read_pixel(const unsigned char *data, TextureFormat format)
+{
+	switch (format)
+	{
+	case tf_rgba8: return Vec4i(data[0], data[1], data[2], data[3]);
+	case tf_bgra8: return Vec4i(data[2], data[1], data[0], data[3]);
+	case tf_rgb8: return Vec4i(data[0], data[1], data[2], 255);
+	case tf_bgr8: return Vec4i(data[2], data[1], data[0], 255);
+	default: throw Exception("Unsupported format");
+	}
+}
+
+static int count_mismatches(const ConversionTest &test, const std::vector<unsigned char> &input, const std::vector<unsigned char> &output, int width, int height)
+{
+	int input_bytes = get_bytes(test.input_format);
+	int output_bytes = get_bytes(test.output_format);
+	int mismatches = 0;
+	for (int y = 0; y < height; y++)
+	{
+		int output_y = test.flip_vertical ? height - 1 - y : y;
+		for (int x = 0; x < width; x++)
+		{
+			Vec4i pixel = read_pixel(&input[(y * width + x) * input_bytes], test.input_format);
+			// Equal to the t = v * a + 128; (t + (t >> 8)) >> 8 used by the premultiply kernels
+			if (test.premultiply_alpha)
+				pixel = Vec4i((pixel.r * pixel.a + 127) / 255, (pixel.g * pixel.a + 127) / 255, (pixel.b * pixel.a + 127) / 255, pixel.a);
+
+			int channels[4] = { pixel.r, pixel.g, pixel.b, pixel.a };
+			Vec4i expected(channels[test.swizzle.x], channels[test.swizzle.y], channels[test.swizzle.z], channels[test.swizzle.w]);
+			Vec4i result = read_pixel(&output[(output_y * width + x) * output_bytes], test.output_format);
+			if (output_bytes == 3)
+				expected.a = 255;
+
+			// The generic float path may round differently by one
+			Vec4i diff = result - expected;
+			if (std::abs(diff.r) > 1 || std::abs(diff.g) > 1 || std::abs(diff.b) > 1 || std::abs(diff.a) > 1)
+				mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+int main(int, char**)
+{
+	ConversionTest tests[] =
+	{
+		{ "rgba8 -> rgba8", tf_rgba8, tf_rgba8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "rgba8 -> bgra8", tf_rgba8, tf_bgra8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "bgra8 -> rgba8", tf_bgra8, tf_rgba8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "rgb8 -> rgba8", tf_rgb8, tf_rgba8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "bgr8 -> rgba8", tf_bgr8, tf_rgba8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "rgba8 -> rgb8", tf_rgba8, tf_rgb8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "bgr8 -> rgb8", tf_bgr8, tf_rgb8, false, false, Vec4i(0, 1, 2, 3) },
+		{ "rgba8 -> rgba8 premultiplied", tf_rgba8, tf_rgba8, true, false, Vec4i(0, 1, 2, 3) },
+		{ "bgra8 -> rgba8 premultiplied", tf_bgra8, tf_rgba8, true, false, Vec4i(0, 1, 2, 3) },
+		{ "rgba8 -> bgra8 flipped", tf_rgba8, tf_bgra8, false, true, Vec4i(0, 1, 2, 3) },
+		{ "rgba8 -> rgba8 swizzled (abgr)", tf_rgba8, tf_rgba8, false, false, Vec4i(3, 2, 1, 0) }
+	};
+
+	// The first entry is the scalar reference
+	InstructionSets instruction_sets[] =
+	{
+		{ "scalar", false, false, false, false },
+		{ "sse2", true, false, false, false },
+		{ "ssse3", true, true, false, false },
+		{ "sse4.1", true, true, true, false },
+		{ "avx2", true, true, true, true }
+	};
+
+	const int width = 2048;
+	const int height = 1024;
+	const int iterations = 10;
+
+	std::vector<unsigned char> input(width * height * 4);
+	for (auto & value : input)
+		value = (unsigned char)(rand() >> 4);
+
+	std::vector<unsigned char> reference_output(width * height * 4);
+	std::vector<unsigned char> output(width * height * 4);
+	std::vector<unsigned char> threaded_output(width * height * 4);
+	WorkQueue queue;
+
+	bool failed = false;
+	try
+	{
+		for (auto & test : tests)
+		{
+			int input_pitch = width * get_bytes(test.input_format);
+			int output_pitch = width * get_bytes(test.output_format);
+
+			for (auto & sets : instruction_sets)
+			{
+				if ((sets.sse2 && !System::detect_cpu_extension(System::sse2)) ||
+					(sets.ssse3 && !System::detect_cpu_extension(System::ssse3)) ||
+					(sets.sse4 && !System::detect_cpu_extension(System::sse4_1)) ||
+					(sets.avx2 && !System::detect_cpu_extension(System::avx2)))
+				{
+					Console::write_line("%1 [%2]: skipped, not supported by the CPU", test.name, sets.name);
+					continue;
+				}
+
+				PixelConverter converter;
+				converter.set_premultiply_alpha(test.premultiply_alpha);
+				converter.set_flip_vertical(test.flip_vertical);
+				converter.set_swizzle(test.swizzle);
+				converter.set_instruction_sets(sets.sse2, sets.ssse3, sets.sse4, sets.avx2);
+
+				uint64_t start_time = System::get_microseconds();
+				for (int i = 0; i < iterations; i++)
+					converter.convert(output.data(), output_pitch, test.output_format, input.data(), input_pitch, test.input_format, width, height);
+				uint64_t elapsed = System::get_microseconds() - start_time;
+
+				start_time = System::get_microseconds();
+				for (int i = 0; i < iterations; i++)
+					converter.convert(threaded_output.data(), output_pitch, test.output_format, input.data(), input_pitch, test.input_format, width, height, queue);
+				uint64_t threaded_elapsed = System::get_microseconds() - start_time;
+
+				std::string errors;
+				if (&sets == &instruction_sets[0])
+				{
+					int mismatches = count_mismatches(test, input, output, width, height);
+					if (mismatches)
+						errors += string_format(" (%1 pixels differ from reference!)", mismatches);
+					memcpy(reference_output.data(), output.data(), output_pitch * height);
+				}
+				else if (memcmp(reference_output.data(), output.data(), output_pitch * height) != 0)
+				{
+					errors += " (output differs from scalar kernels!)";
+				}
+
+				if (memcmp(output.data(), threaded_output.data(), output_pitch * height) != 0)
+					errors += " (threaded output differs!)";
+
+				double megapixels = width * (double)height * iterations / 1000000.0;
+				Console::write_line("%1 [%2]: %3 MPix/s, %4 MPix/s threaded%5", test.name, sets.name,
+					(int)(megapixels / (elapsed / 1000000.0)),
+					(int)(megapixels / (threaded_elapsed / 1000000.0)),
+					errors);
+
+				if (!errors.empty())
+					failed = true;
+			}
+		}
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+
+	if (failed)
+	{
+		Console::write_line("FAILED: some conversions differ");
+		return -1;
+	}
+
+	Console::write_line("All conversions match");
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include <ClanLib/core.h>
+#include <ClanLib/application.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+
+using namespace clan;
+
+// Measures how many sprites per second the canvas batcher can push to the GPU.
+// Runs without vsync for a fixed number of frames, so it also works under a software GL implementation such as Mesa llvmpipe.
+class App : public clan::Application
+{
+public:
+	App()
+	{
+		clan::OpenGLTarget::enable();
+		window = DisplayWindow("Sprite throughput benchmark", 1024, 768);
+		canvas = Canvas(window);
+
+		sprite = Sprite(canvas, "Images/testsprite1.png");
+
+		Console::write_line("Drawing %1 sprites per frame for %2 frames", sprites_per_frame, num_frames);
+	}
+
+	bool update()
+	{
+		if (window.get_ic().get_keyboard().get_keycode(keycode_escape))
+			return false;
+
+		// Cross-check the GL state cache during warmup, then time without the glGet queries
+		GraphicContext_GL gc_gl(canvas.get_gc());
+		if (frame == 0)
+			gc_gl.set_state_cache_validation(true);
+		if (frame == warmup_frames)
+		{
+			gc_gl.set_state_cache_validation(false);
+			gc_gl.reset_state_cache_counters();
+			start_time = System::get_microseconds();
+		}
+
+		canvas.clear(Colorf::black);
+
+		float width = (float)canvas.get_width();
+		float height = (float)canvas.get_height();
+		for (int i = 0; i < sprites_per_frame; i++)
+		{
+			// Cheap deterministic scatter so every frame draws the same amount of geometry
+			float x = (float)((i * 7919 + frame * 13) % (int)width);
+			float y = (float)((i * 104729 + frame * 7) % (int)height);
+			sprite.draw(canvas, x, y);
+		}
+
+		canvas.flush();
+		window.flip(0);
+
+		frame++;
+		if (frame == warmup_frames + num_frames)
+		{
+			uint64_t elapsed = System::get_microseconds() - start_time;
+			double seconds = elapsed / 1000000.0;
+			double sprites = (double)sprites_per_frame * num_frames;
+			Console::write_line("%1 frames in %2 ms: %3 frames/sec, %4 sprites/sec",
+				num_frames, (int)(elapsed / 1000), (int)(num_frames / seconds), (int)(sprites / seconds));
+
+			StateCacheCounters_GL counters = gc_gl.get_state_cache_counters();
+			Console::write_line("GL state calls: %1 issued, %2 elided", (int)counters.calls_issued, (int)counters.calls_elided);
+			return false;
+		}
+
+		return true;
+	}
+
+	static const int sprites_per_frame = 20000;
+	static const int warmup_frames = 10;
+	static const int num_frames = 200;
+
+	int frame = 0;
+	uint64_t start_time = 0;
+
+	Sprite sprite;
+
+	DisplayWindow window;
+	Canvas canvas;
+};
+
+clan::ApplicationInstance<App> clanapp;
@@ -0,0 +1,129 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <thread>
+
+using namespace clan;
+
+// Compares the self-describing NetGameEvent encoding with the schema encoding, where both ends register the event
+// layouts up front. Reports bytes per event and encode/decode time, then sends events both ways over loopback.
+
+static const char *test_port = "4563";
+
+static void register_events(NetGameEventSchema &schema)
+{
+	schema.add_event("player-state", {
+		NetGameEventValue::uinteger, NetGameEventValue::number, NetGameEventValue::number, NetGameEventValue::number,
+		NetGameEventValue::number, NetGameEventValue::integer, NetGameEventValue::boolean, NetGameEventValue::ucharacter });
+	schema.add_event("chat", { NetGameEventValue::uinteger, NetGameEventValue::string });
+}
+
+static NetGameEvent create_player_state(unsigned int index)
+{
+	return NetGameEvent("player-state", {
+		index, index * 0.5f, 12.25f, -3.0f, 1.5f, (int)index - 50, NetGameEventValue(index % 2 == 0), (unsigned char)7 });
+}
+
+static bool benchmark(const char *title, const NetGameEventSchema &schema, const NetGameEvent &game_event)
+{
+	const int iterations = 200000;
+
+	DataBuffer packet = schema.encode_event(game_event);
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+		packet = schema.encode_event(game_event);
+	uint64_t encode_time = System::get_microseconds() - start_time;
+
+	NetGameEvent decoded("");
+	start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+		schema.decode_event(packet, decoded);
+	uint64_t decode_time = System::get_microseconds() - start_time;
+
+	Console::write_line("%1: %2 bytes, encode %3 ns, decode %4 ns", title, (int)packet.get_size(),
+		(int)(encode_time * 1000 / iterations), (int)(decode_time * 1000 / iterations));
+
+	if (decoded.to_string() != game_event.to_string())
+	{
+		Console::write_line("Decoded event %1 does not match %2", decoded.to_string(), game_event.to_string());
+		return false;
+	}
+	return true;
+}
+
+static bool test_loopback(const NetGameEventSchema &schema)
+{
+	NetGameServer server;
+	server.set_event_schema(schema);
+	NetGameClient client;
+	client.set_event_schema(schema);
+
+	std::vector<std::string> server_received;
+	std::vector<std::string> client_received;
+	bool connected = false;
+
+	SlotContainer slots;
+	slots.connect(server.sig_event_received(), [&](NetGameConnection *connection, const NetGameEvent &e)
+	{
+		server_received.push_back(e.to_string());
+		server.send_event(e);
+	});
+	slots.connect(client.sig_connected(), [&]() { connected = true; });
+	slots.connect(client.sig_event_received(), [&](const NetGameEvent &e) { client_received.push_back(e.to_string()); });
+
+	server.start("127.0.0.1", test_port);
+	client.connect("127.0.0.1", test_port);
+
+	// A registered event with packed arguments, a string argument and an event the schema does not know about
+	std::vector<NetGameEvent> events = { create_player_state(42), NetGameEvent("chat", { 42u, "Hello" }), NetGameEvent("unregistered", { 1, "one" }) };
+
+	uint64_t timeout = System::get_time() + 5000;
+	bool sent = false;
+	while (client_received.size() < events.size() && System::get_time() < timeout)
+	{
+		server.process_events();
+		client.process_events();
+		if (connected && !sent)
+		{
+			for (auto &e : events)
+				client.send_event(e);
+			sent = true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	client.disconnect();
+	server.stop();
+
+	bool passed = server_received.size() == events.size() && client_received.size() == events.size();
+	for (size_t i = 0; passed && i < events.size(); i++)
+		passed = server_received[i] == events[i].to_string() && client_received[i] == events[i].to_string();
+	Console::write_line("Loopback: %1", passed ? "passed" : "failed");
+	return passed;
+}
+
+int main(int, char**)
+{
+	try
+	{
+		NetGameEventSchema schema;
+		register_events(schema);
+		NetGameEventSchema no_schema;
+
+		bool passed = true;
+		passed = benchmark("Self-describing player-state", no_schema, create_player_state(42)) && passed;
+		passed = benchmark("Schema player-state", schema, create_player_state(42)) && passed;
+		passed = benchmark("Self-describing chat", no_schema, NetGameEvent("chat", { 42u, "Hello" })) && passed;
+		passed = benchmark("Schema chat", schema, NetGameEvent("chat", { 42u, "Hello" })) && passed;
+		passed = test_loopback(schema) && passed;
+
+		if (!passed)
+			Console::write_line("Schema test failed!");
+		return passed ? 0 : -1;
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+}
@@ -0,0 +1,255 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace clan;
+
+// Loopback soak test for NetGameServer. A forked client process opens many connections with plain sockets and
+// keeps one "ping" event in flight on each of them. The server answers every ping with a "pong".
+// Reports the connections, server events per second, server threads and server memory per connection.
+//
+// Usage: netgamesoak [connections] [io threads, 0 for one thread per connection] [seconds]
+//
+// Only builds on Unix, as the client side uses poll() and fork().
+
+static const char *test_port = "4562";
+
+static long get_resident_bytes()
+{
+	long pages = 0, resident = 0;
+	FILE *file = fopen("/proc/self/statm", "r");
+	if (file)
+	{
+		if (fscanf(file, "%ld %ld", &pages, &resident) != 2)
+			resident = 0;
+		fclose(file);
+	}
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+static int get_thread_count()
+{
+	int threads = 0;
+	FILE *file = fopen("/proc/self/status", "r");
+	if (file)
+	{
+		char line[256];
+		while (fgets(line, sizeof(line), file))
+		{
+			if (strncmp(line, "Threads:", 8) == 0)
+				threads = atoi(line + 8);
+		}
+		fclose(file);
+	}
+	return threads;
+}
+
+// Same framing as NetGameNetworkData: packet length, name length, name, int argument, end marker
+static int encode_ping(unsigned char *d, int value)
+{
+	unsigned short payload_length = 3 + 4 + 5;
+	unsigned short name_length = 4;
+	memcpy(d, &payload_length, 2);
+	memcpy(d + 2, &name_length, 2);
+	memcpy(d + 4, "ping", 4);
+	d[8] = 3;
+	memcpy(d + 9, &value, 4);
+	d[13] = 0;
+	return 14;
+}
+
+static int run_clients(int count, int seconds)
+{
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(sockaddr_in));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(atoi(test_port));
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+	std::vector<pollfd> fds;
+	std::vector<int> received(count, 0);
+	for (int i = 0; i < count; i++)
+	{
+		int handle = socket(AF_INET, SOCK_STREAM, 0);
+		if (handle == -1 || connect(handle, (const sockaddr *)&addr, sizeof(sockaddr_in)) == -1)
+		{
+			fprintf(stderr, "Client connect failed after %d connections\n", i);
+			return -1;
+		}
+		int value = 1;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(int));
+		fcntl(handle, F_SETFL, O_NONBLOCK);
+
+		pollfd fd;
+		fd.fd = handle;
+		fd.events = POLLIN;
+		fd.revents = 0;
+		fds.push_back(fd);
+	}
+
+	// Wait until the server has seen every connection before starting the traffic
+	unsigned char go = 0;
+	if (read(0, &go, 1) != 1)
+		return -1;
+
+	unsigned char packet[14];
+	for (int i = 0; i < count; i++)
+	{
+		int length = encode_ping(packet, i);
+		if (send(fds[i].fd, packet, length, 0) != length)
+			return -1;
+	}
+
+	// Keep one ping in flight per connection until the time is up, then wait for the last pongs before closing
+	unsigned char buffer[4096];
+	int outstanding = count;
+	auto end_time = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+	auto drain_end_time = end_time + std::chrono::seconds(10);
+	while (outstanding > 0 && std::chrono::steady_clock::now() < drain_end_time)
+	{
+		bool send_more = std::chrono::steady_clock::now() < end_time;
+
+		if (poll(fds.data(), fds.size(), 100) <= 0)
+			continue;
+
+		for (int i = 0; i < count; i++)
+		{
+			if (fds[i].revents & POLLIN)
+			{
+				int bytes = recv(fds[i].fd, buffer, sizeof(buffer), 0);
+				if (bytes <= 0)
+					return -1;
+
+				// Pong packets have the same size as the pings
+				received[i] += bytes;
+				while (received[i] >= 14)
+				{
+					received[i] -= 14;
+					outstanding--;
+					if (send_more)
+					{
+						int length = encode_ping(packet, i);
+						if (send(fds[i].fd, packet, length, 0) != length)
+							return -1;
+						outstanding++;
+					}
+				}
+			}
+		}
+	}
+	if (outstanding > 0)
+		return -1;
+
+	for (auto &fd : fds)
+		close(fd.fd);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	int connection_count = argc > 1 ? atoi(argv[1]) : 2000;
+	int io_threads = argc > 2 ? atoi(argv[2]) : 4;
+	int seconds = argc > 3 ? atoi(argv[3]) : 5;
+
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < (rlim_t)connection_count + 64)
+	{
+		limit.rlim_cur = std::min((rlim_t)connection_count + 64, limit.rlim_max);
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	try
+	{
+		long base_memory = get_resident_bytes();
+
+		NetGameServer server;
+		server.set_io_thread_count(io_threads);
+
+		int connected = 0;
+		int events_received = 0;
+		bool failed = false;
+		SlotContainer slots;
+		slots.connect(server.sig_client_connected(), [&](NetGameConnection *) { connected++; });
+		slots.connect(server.sig_client_disconnected(), [&](NetGameConnection *, const std::string &reason) { connected--; if (!reason.empty()) failed = true; });
+		slots.connect(server.sig_event_received(), [&](NetGameConnection *connection, const NetGameEvent &e)
+		{
+			events_received++;
+			connection->send_event(NetGameEvent("pong", { e.get_argument(0) }));
+		});
+		server.start("127.0.0.1", test_port);
+
+		int go_pipe[2];
+		if (pipe(go_pipe) == -1)
+			throw Exception("Unable to create pipe");
+
+		pid_t client_pid = fork();
+		if (client_pid == 0)
+		{
+			dup2(go_pipe[0], 0);
+			close(go_pipe[1]);
+			_exit(run_clients(connection_count, seconds) == 0 ? 0 : 1);
+		}
+		close(go_pipe[0]);
+
+		auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+		while (connected < connection_count && std::chrono::steady_clock::now() < timeout)
+		{
+			server.process_events();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		long connected_memory = get_resident_bytes();
+		int thread_count = get_thread_count();
+
+		if (write(go_pipe[1], "x", 1) != 1)
+			throw Exception("Unable to start clients");
+
+		auto start_time = std::chrono::steady_clock::now();
+		int client_status = -1;
+		while (true)
+		{
+			server.process_events();
+			if (waitpid(client_pid, &client_status, WNOHANG) == client_pid)
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+		int traffic_events = events_received;
+		long peak_memory = get_resident_bytes();
+
+		timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+		while (connected > 0 && std::chrono::steady_clock::now() < timeout)
+		{
+			server.process_events();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		server.stop();
+
+		Console::write_line("%1 I/O threads, %2 connections, %3 server threads", io_threads, connection_count, thread_count);
+		Console::write_line("%1 events/sec", (int)(traffic_events / elapsed));
+		Console::write_line("%1 bytes resident per connection after connect, %2 bytes under traffic",
+			(int)((connected_memory - base_memory) / connection_count), (int)((peak_memory - base_memory) / connection_count));
+
+		bool passed = !failed && WIFEXITED(client_status) && WEXITSTATUS(client_status) == 0 && traffic_events > 0 && connected == 0;
+		if (!passed)
+			Console::write_line("Soak test failed!");
+		return passed ? 0 : -1;
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+}
@@ -0,0 +1,366 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace clan;
+
+// Runs NetGameServer and NetGameClient over the UDP transport through a proxy that drops and delays datagrams.
+// Checks the delivery guarantees of each channel, then cuts the link and waits for both ends to time out.
+// Also broadcasts from a second thread while clients connect and disconnect, and stops the server during the broadcast.
+
+static const char *server_port = "4565";
+static const char *proxy_port = "4566";
+
+static const int loss_percent = 20;
+static const int min_latency = 10;
+static const int max_latency = 50;
+
+/// Forwards datagrams between the server and one client, dropping some and delaying the rest by a random amount.
+/// The random delay also reorders datagrams.
+class LossyProxy
+{
+public:
+	LossyProxy() : server_name("127.0.0.1", server_port)
+	{
+		socket.bind(SocketName("127.0.0.1", proxy_port));
+		thread = std::thread(&LossyProxy::thread_main, this);
+	}
+
+	~LossyProxy()
+	{
+		stop_flag = true;
+		stop_event.notify();
+		thread.join();
+	}
+
+	/// Drops every datagram from now on
+	void cut_link()
+	{
+		link_cut = true;
+	}
+
+	int forwarded = 0;
+	int dropped = 0;
+
+private:
+	struct Datagram
+	{
+		uint64_t deliver_time;
+		SocketName to;
+		DataBuffer data;
+	};
+
+	void thread_main()
+	{
+		std::mt19937 random(1234);
+		DataBuffer buffer(64 * 1024);
+		std::vector<Datagram> in_flight;
+		std::mutex mutex;
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!stop_flag)
+		{
+			while (true)
+			{
+				SocketName from;
+				int size = socket.read(buffer.get_data(), buffer.get_size(), from);
+				if (size < 0)
+					break;
+
+				SocketName to;
+				if (from == server_name)
+				{
+					to = client_name;
+				}
+				else
+				{
+					client_name = from;
+					to = server_name;
+				}
+
+				if (link_cut || (int)(random() % 100) < loss_percent || to.get_port().empty())
+				{
+					dropped++;
+					continue;
+				}
+
+				Datagram datagram;
+				datagram.deliver_time = System::get_time() + min_latency + random() % (max_latency - min_latency + 1);
+				datagram.to = to;
+				datagram.data = DataBuffer(buffer.get_data(), size);
+				in_flight.push_back(datagram);
+			}
+
+			uint64_t now = System::get_time();
+			auto due = std::stable_partition(in_flight.begin(), in_flight.end(), [&](const Datagram &d) { return d.deliver_time > now; });
+			for (auto it = due; it != in_flight.end(); ++it)
+			{
+				socket.send(it->data.get_data(), it->data.get_size(), it->to);
+				forwarded++;
+			}
+			in_flight.erase(due, in_flight.end());
+
+			NetworkEvent *events[] = { &socket };
+			stop_event.wait(lock, 1, events, 1);
+		}
+	}
+
+	UDPSocket socket;
+	SocketName server_name;
+	SocketName client_name;
+	std::atomic<bool> link_cut { false };
+	std::atomic<bool> stop_flag { false };
+	NetworkConditionVariable stop_event;
+	std::thread thread;
+};
+
+static bool check(bool condition, const std::string &text)
+{
+	Console::write_line("%1: %2", text, condition ? "passed" : "failed");
+	return condition;
+}
+
+static bool test_channels()
+{
+	LossyProxy proxy;
+
+	NetGameServer server;
+	server.set_transport(NetGameTransport::udp);
+	NetGameClient client;
+	client.set_transport(NetGameTransport::udp);
+
+	const int event_count = 300;
+	std::vector<int> server_reliable, client_reliable, server_unreliable, server_sequenced;
+	bool connected = false;
+	bool client_disconnected = false;
+	std::string server_disconnect_reason;
+	bool server_disconnected = false;
+
+	SlotContainer slots;
+	slots.connect(server.sig_event_received(), [&](NetGameConnection *connection, const NetGameEvent &e)
+	{
+		int index = e.get_argument(0).get_integer();
+		if (e.get_name() == "reliable")
+		{
+			server_reliable.push_back(index);
+			connection->send_event(e, NetGameChannel::reliable_ordered);
+		}
+		else if (e.get_name() == "unreliable")
+		{
+			server_unreliable.push_back(index);
+		}
+		else if (e.get_name() == "sequenced")
+		{
+			server_sequenced.push_back(index);
+		}
+	});
+	slots.connect(server.sig_client_disconnected(), [&](NetGameConnection *, const std::string &reason)
+	{
+		server_disconnected = true;
+		server_disconnect_reason = reason;
+	});
+	slots.connect(client.sig_connected(), [&]() { connected = true; });
+	slots.connect(client.sig_disconnected(), [&]() { client_disconnected = true; });
+	slots.connect(client.sig_event_received(), [&](const NetGameEvent &e) { client_reliable.push_back(e.get_argument(0).get_integer()); });
+
+	server.start("127.0.0.1", server_port);
+	client.connect("127.0.0.1", proxy_port);
+
+	// Send one event per channel every few milliseconds, so they spread over many datagrams
+	int sent = 0;
+	uint64_t next_send_time = 0;
+	uint64_t timeout = System::get_time() + 20000;
+	while ((int)client_reliable.size() < event_count && System::get_time() < timeout)
+	{
+		server.process_events();
+		client.process_events();
+		if (connected && sent < event_count && System::get_time() >= next_send_time)
+		{
+			client.send_event(NetGameEvent("reliable", { sent }), NetGameChannel::reliable_ordered);
+			client.send_event(NetGameEvent("unreliable", { sent }), NetGameChannel::unreliable);
+			client.send_event(NetGameEvent("sequenced", { sent }), NetGameChannel::unreliable_sequenced);
+			sent++;
+			next_send_time = System::get_time() + 3;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	bool passed = check(connected, "Connect through lossy link");
+
+	bool in_order = (int)server_reliable.size() == event_count && (int)client_reliable.size() == event_count;
+	for (int i = 0; in_order && i < event_count; i++)
+		in_order = server_reliable[i] == i && client_reliable[i] == i;
+	passed = check(in_order, "Reliable events arrive once and in order both ways") && passed;
+
+	std::vector<int> unreliable_sorted = server_unreliable;
+	std::sort(unreliable_sorted.begin(), unreliable_sorted.end());
+	bool unique = std::adjacent_find(unreliable_sorted.begin(), unreliable_sorted.end()) == unreliable_sorted.end();
+	passed = check(unique && !server_unreliable.empty() && (int)server_unreliable.size() < event_count,
+		string_format("Unreliable events arrive at most once (%1 of %2)", (int)server_unreliable.size(), event_count)) && passed;
+
+	bool increasing = !server_sequenced.empty();
+	for (size_t i = 1; increasing && i < server_sequenced.size(); i++)
+		increasing = server_sequenced[i] > server_sequenced[i - 1];
+	passed = check(increasing, string_format("Sequenced events only arrive newer (%1 of %2)", (int)server_sequenced.size(), event_count)) && passed;
+
+	Console::write_line("Proxy forwarded %1 datagrams and dropped %2", proxy.forwarded, proxy.dropped);
+
+	// Both ends notice the link going dead through the connection timeout
+	proxy.cut_link();
+	timeout = System::get_time() + 12000;
+	while ((!client_disconnected || !server_disconnected) && System::get_time() < timeout)
+	{
+		server.process_events();
+		client.process_events();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	passed = check(client_disconnected && server_disconnected && server_disconnect_reason == "Connection timed out", "Dead link times out") && passed;
+
+	client.disconnect();
+	server.stop();
+	return passed;
+}
+
+static bool test_disconnect_and_mtu()
+{
+	NetGameServer server;
+	server.set_transport(NetGameTransport::udp);
+	NetGameClient client;
+	client.set_transport(NetGameTransport::udp);
+	client.set_mtu(200);
+
+	bool connected = false;
+	bool server_disconnected = false;
+	std::string server_disconnect_reason = "none";
+
+	SlotContainer slots;
+	slots.connect(client.sig_connected(), [&]() { connected = true; });
+	slots.connect(server.sig_client_disconnected(), [&](NetGameConnection *, const std::string &reason)
+	{
+		server_disconnected = true;
+		server_disconnect_reason = reason;
+	});
+
+	server.start("127.0.0.1", server_port);
+	client.connect("127.0.0.1", server_port);
+
+	uint64_t timeout = System::get_time() + 5000;
+	while (!connected && System::get_time() < timeout)
+	{
+		server.process_events();
+		client.process_events();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	bool passed = check(connected, "Connect directly");
+
+	bool too_big_rejected = false;
+	try
+	{
+		client.send_event(NetGameEvent("too-big", { std::string(300, 'x') }));
+	}
+	catch (const Exception &)
+	{
+		too_big_rejected = true;
+	}
+	passed = check(too_big_rejected, "Event bigger than the MTU is rejected") && passed;
+
+	client.disconnect();
+	timeout = System::get_time() + 5000;
+	while (!server_disconnected && System::get_time() < timeout)
+	{
+		server.process_events();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	passed = check(server_disconnected && server_disconnect_reason.empty(), "Client disconnect reaches the server") && passed;
+
+	server.stop();
+	return passed;
+}
+
+static bool test_broadcast_from_thread()
+{
+	NetGameServer server;
+	server.set_transport(NetGameTransport::udp);
+
+	int server_disconnects = 0;
+	SlotContainer slots;
+	slots.connect(server.sig_client_disconnected(), [&](NetGameConnection *, const std::string &) { server_disconnects++; });
+
+	server.start("127.0.0.1", server_port);
+
+	// Connections are created by the host thread and destroyed by process_events while this thread sends to them
+	std::atomic<bool> stop_broadcast { false };
+	std::thread broadcaster([&]()
+	{
+		int index = 0;
+		while (!stop_broadcast)
+		{
+			server.send_event(NetGameEvent("tick", { index++ }), NetGameChannel::unreliable);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	const int rounds = 10;
+	bool all_received = true;
+	for (int round = 0; round < rounds; round++)
+	{
+		NetGameClient client;
+		client.set_transport(NetGameTransport::udp);
+		int received = 0;
+		slots.connect(client.sig_event_received(), [&](const NetGameEvent &) { received++; });
+
+		client.connect("127.0.0.1", server_port);
+		uint64_t timeout = System::get_time() + 5000;
+		while (received == 0 && System::get_time() < timeout)
+		{
+			server.process_events();
+			client.process_events();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		all_received = all_received && received > 0;
+
+		client.disconnect();
+		timeout = System::get_time() + 5000;
+		while (server_disconnects <= round && System::get_time() < timeout)
+		{
+			server.process_events();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	// Stop the server while a client is being accepted and the broadcast is still running
+	NetGameClient late_client;
+	late_client.set_transport(NetGameTransport::udp);
+	late_client.connect("127.0.0.1", server_port);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	server.stop();
+	stop_broadcast = true;
+	broadcaster.join();
+	late_client.disconnect();
+
+	return check(all_received && server_disconnects == rounds, "Broadcast from another thread while clients come and go");
+}
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = true;
+		passed = test_disconnect_and_mtu() && passed;
+		passed = test_broadcast_from_thread() && passed;
+		passed = test_channels() && passed;
+
+		if (!passed)
+			Console::write_line("UDP test failed!");
+		return passed ? 0 : -1;
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+}
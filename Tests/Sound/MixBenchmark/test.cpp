@@ -0,0 +1,133 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+// Measures how many voices the mixing functions can process per millisecond.
+// A fragment is mixed the same way SoundOutput_Impl::mix_fragment does it, but without a sound card,
+// so the numbers only reflect mixing cost.
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Mixing Benchmark:");
+		Console::write_line("-------------------------");
+		Console::write_line("AVX: %1", System::detect_cpu_extension(System::avx) ? "yes" : "no");
+
+		voice_data.resize(voice_length);
+		int random_number = 1234542;
+		for (auto &sample : voice_data)
+		{
+			random_number = random_number * 1103515245 + 12345;
+			sample = ((random_number >> 16) & 0x7fff) / 16384.0f - 1.0f;
+		}
+
+		for (int i = 0; i < 2; i++)
+		{
+			temp_buffers[i].resize(fragment_size);
+			mix_buffers[i].resize(fragment_size);
+		}
+		stereo_buffer.resize(fragment_size * 2);
+
+		run_benchmark(16);
+		run_benchmark(64);
+		run_benchmark(256);
+		run_benchmark(1024);
+
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::run_benchmark(int num_voices)
+{
+	const int warmup_fragments = 10;
+	const int num_fragments = 200;
+
+	for (int i = 0; i < warmup_fragments; i++)
+		mix_fragment(num_voices);
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_fragments; i++)
+		mix_fragment(num_voices);
+	uint64_t elapsed = System::get_microseconds() - start_time;
+
+	double milliseconds = elapsed / 1000.0;
+	double voices = (double)num_voices * num_fragments;
+	double fragment_ms = fragment_size * 1000.0 / 44100.0;
+	Console::write_line("%1 voices: %2 voices/ms, %3 us per fragment (%4 us of audio)",
+		num_voices, (int)(voices / milliseconds), (int)(elapsed / num_fragments), (int)(fragment_ms * 1000.0));
+}
+
+void TestApp::mix_fragment(int num_voices)
+{
+	float *temp[2] = { temp_buffers[0].data(), temp_buffers[1].data() };
+	float *mix[2] = { mix_buffers[0].data(), mix_buffers[1].data() };
+
+	SoundSSE::set_float(mix[0], fragment_size, 0.0f);
+	SoundSSE::set_float(mix[1], fragment_size, 0.0f);
+
+	for (int voice = 0; voice < num_voices; voice++)
+	{
+		// Every voice reads its own part of the sample data, so the cache sees a realistic access pattern
+		int position = (voice_position + voice * 4099) % (voice_length - fragment_size);
+		SoundSSE::copy_float(&voice_data[position], fragment_size, temp[0]);
+
+		// Per voice volume and panning, like SoundBuffer_Session_Impl::mix_channels does for a mono stream:
+		float pan = (voice % 17) / 8.0f - 1.0f;
+		float volume = 1.0f / num_voices;
+		float channel_volume[2];
+		channel_volume[0] = volume * std::min(1.0f - pan, 1.0f);
+		channel_volume[1] = volume * std::min(1.0f + pan, 1.0f);
+		SoundSSE::mix_one_to_many(temp[0], fragment_size, mix, channel_volume, 2);
+	}
+
+	float master_volume[2] = { 1.0f, 1.0f };
+	SoundSSE::pack_float_stereo_clamped(mix, fragment_size, master_volume, stereo_buffer.data());
+
+	voice_position = (voice_position + fragment_size) % (voice_length - fragment_size);
+}
@@ -0,0 +1,294 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+// Plays a test signal through SoundResampler the way SoundBuffer_Session_Impl::get_data_in_mixer_frequency does:
+// in blocks limited by the data in a small session buffer that is refilled with history, with the pitch changing
+// every fragment and silence padded after the end of the stream. Each interpolation mode is compared against
+// a sample by sample reference computed in double precision, and against calling the resampler one sample at a time.
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound SoundResampler");
+
+		test_interpolation(SoundInterpolation::nearest, "nearest", 1e-6);
+		test_interpolation(SoundInterpolation::linear, "linear", 1e-5);
+		test_interpolation(SoundInterpolation::cubic, "cubic", 1e-5);
+		test_interpolation(SoundInterpolation::sinc, "sinc", 1e-4);
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
+
+double TestApp::get_speed(int fragment)
+{
+	// Binary fractions keep the read positions exact, so the block and reference paths sample the same points.
+	// 1.0 switches the session to the copy path, 2.25 and 1.375 use a lowered sinc cutoff
+	static const double speeds[] = { 0.75, 1.25, 1.0, 2.25, 0.5, 1.375, 0.625 };
+	return speeds[fragment % (sizeof(speeds) / sizeof(speeds[0]))];
+}
+
+void TestApp::test_interpolation(SoundInterpolation interpolation, const char *name, double tolerance)
+{
+	Console::write_line(string_format("   Interpolation: %1", name));
+
+	// A few tones plus noise, with a length that leaves a partial block at the end of the stream
+	std::vector<float> input(5003);
+	int random_number = 1234542;
+	for (size_t i = 0; i < input.size(); i++)
+	{
+		random_number = random_number * 1103515245 + 12345;
+		float noise = ((random_number >> 16) & 0x7fff) / 32768.0f - 0.5f;
+		input[i] = 0.4f * std::sin(i * 0.05f) + 0.3f * std::sin(i * 0.71f) + 0.2f * noise;
+	}
+
+	SoundResampler resampler;
+	resampler.set_interpolation(interpolation);
+
+	std::vector<float> output, single_output, reference;
+	mix_blocks(resampler, input, output, single_output);
+	mix_reference(interpolation, input, reference);
+
+	if (output.size() != reference.size())
+	{
+		Console::write_line(string_format("    Played %1 samples, expected %2", (int)output.size(), (int)reference.size()));
+		fail();
+	}
+
+	double max_error = 0.0;
+	for (size_t i = 0; i < output.size(); i++)
+	{
+		if (output[i] != single_output[i])
+		{
+			Console::write_line(string_format("    Sample %1 differs when resampled one sample at a time", (int)i));
+			fail();
+		}
+		max_error = std::max(max_error, std::abs((double)output[i] - reference[i]));
+	}
+
+	Console::write_line(string_format("    %1 samples, max error %2e-6", (int)output.size(), (int)std::ceil(max_error * 1e6)));
+	if (max_error > tolerance)
+		fail();
+}
+
+void TestApp::mix_blocks(SoundResampler &resampler, const std::vector<float> &input, std::vector<float> &output, std::vector<float> &single_output)
+{
+	std::vector<float> buffer(buffer_size);
+	int buffer_samples_written = SoundResampler::max_history;
+	double buffer_position = SoundResampler::max_history;
+	int input_position = 0;
+	bool end_of_data_padded = false;
+	bool playing = true;
+
+	for (int fragment = 0; playing; fragment++)
+	{
+		double speed = get_speed(fragment);
+		bool resample = (speed != 1.0);
+		int lookahead = resample ? resampler.get_lookahead() : 0;
+
+		std::vector<float> temp(fragment_size), single_temp(fragment_size);
+		int sample_count = 0;
+		while (sample_count < fragment_size)
+		{
+			double available = (buffer_samples_written - lookahead) - buffer_position;
+			int block_size = 0;
+			if (available > 0.0)
+				block_size = std::min(fragment_size - sample_count, (int)std::ceil(available / speed));
+
+			if (block_size <= 0)
+			{
+				// Refill the buffer, keeping the history the resampler reads before the position
+				int keep_start = std::max(int(buffer_position) - SoundResampler::max_history, 0);
+				keep_start = std::min(keep_start, buffer_samples_written);
+				int keep_samples = buffer_samples_written - keep_start;
+				if (keep_start > 0)
+				{
+					memmove(buffer.data(), buffer.data() + keep_start, sizeof(float) * keep_samples);
+					buffer_position -= keep_start;
+					buffer_samples_written = keep_samples;
+				}
+
+				int received = std::min(buffer_size - buffer_samples_written, (int)input.size() - input_position);
+				memcpy(buffer.data() + buffer_samples_written, input.data() + input_position, sizeof(float) * received);
+				input_position += received;
+				buffer_samples_written += received;
+
+				if (received == 0)
+				{
+					if (end_of_data_padded)
+					{
+						playing = false;
+						break;
+					}
+					for (int i = 0; i < SoundResampler::max_lookahead; i++)
+						buffer[buffer_samples_written++] = 0.0f;
+					end_of_data_padded = true;
+				}
+				else
+				{
+					end_of_data_padded = false;
+				}
+				continue;
+			}
+
+			if (resample)
+			{
+				resampler.resample(buffer.data(), buffer_position, speed, temp.data() + sample_count, block_size);
+				for (int i = 0; i < block_size; i++)
+					resampler.resample(buffer.data(), buffer_position + i * speed, speed, single_temp.data() + sample_count + i, 1);
+			}
+			else
+			{
+				for (int i = 0; i < block_size; i++)
+					temp[sample_count + i] = single_temp[sample_count + i] = buffer[int(buffer_position) + i];
+			}
+
+			buffer_position += block_size * speed;
+			sample_count += block_size;
+		}
+
+		output.insert(output.end(), temp.begin(), temp.begin() + sample_count);
+		single_output.insert(single_output.end(), single_temp.begin(), single_temp.begin() + sample_count);
+	}
+}
+
+void TestApp::mix_reference(SoundInterpolation interpolation, const std::vector<float> &input, std::vector<float> &output)
+{
+	// Silent history before the stream and the silence padded after it
+	std::vector<float> padded(SoundResampler::max_history, 0.0f);
+	padded.insert(padded.end(), input.begin(), input.end());
+	padded.insert(padded.end(), SoundResampler::max_lookahead, 0.0f);
+
+	SoundResampler lookahead_query;
+	lookahead_query.set_interpolation(interpolation);
+
+	double position = SoundResampler::max_history;
+	for (int fragment = 0; ; fragment++)
+	{
+		double speed = get_speed(fragment);
+		int lookahead = (speed != 1.0) ? lookahead_query.get_lookahead() : 0;
+		for (int i = 0; i < fragment_size; i++)
+		{
+			if (position >= (double)(padded.size() - lookahead))
+				return;
+			output.push_back((float)reference_sample(interpolation, padded, position, speed));
+			position += speed;
+		}
+	}
+}
+
+double TestApp::reference_sample(SoundInterpolation interpolation, const std::vector<float> &padded, double position, double speed)
+{
+	int index = (int)position;
+	double t = position - index;
+
+	// Sessions playing at the mixing frequency are copied without interpolation
+	if (speed == 1.0)
+		return padded[index];
+
+	switch (interpolation)
+	{
+	case SoundInterpolation::nearest:
+		return padded[index];
+	case SoundInterpolation::linear:
+		return padded[index] + (padded[index + 1] - padded[index]) * t;
+	case SoundInterpolation::cubic:
+	{
+		// Catmull-Rom spline
+		double p0 = padded[index - 1], p1 = padded[index], p2 = padded[index + 1], p3 = padded[index + 2];
+		return p1 + 0.5 * t * (p2 - p0 + t * (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3 + t * (3.0 * (p1 - p2) + p3 - p0)));
+	}
+	case SoundInterpolation::sinc:
+		return reference_sinc(padded, index, t, speed);
+	}
+	return 0.0;
+}
+
+double TestApp::reference_sinc(const std::vector<float> &padded, int index, double t, double speed)
+{
+	// 16-tap Blackman windowed sinc, normalized to unity gain, with the cutoff lowered in 1/32 steps when playing faster
+	const double pi = 3.14159265358979323846;
+	const int taps = 16;
+	const int first_tap = taps / 2 - 1;
+
+	double cutoff = 1.0;
+	if (speed > 1.0)
+	{
+		int cutoff_step = std::max((int)(32 / speed), 1);
+		if (cutoff_step < 32)
+			cutoff = cutoff_step / 32.0;
+	}
+
+	double weights[taps];
+	double weight_sum = 0.0;
+	for (int j = 0; j < taps; j++)
+	{
+		double x = (j - first_tap) - t;
+		double sinc = (x != 0.0) ? std::sin(pi * cutoff * x) / (pi * cutoff * x) : 1.0;
+		double window = 0.0;
+		if (std::abs(x) < taps / 2)
+			window = 0.42 + 0.5 * std::cos(pi * x / (taps / 2)) + 0.08 * std::cos(2.0 * pi * x / (taps / 2));
+		weights[j] = sinc * window;
+		weight_sum += weights[j];
+	}
+
+	double sum = 0.0;
+	for (int j = 0; j < taps; j++)
+		sum += padded[index - first_tap + j] * weights[j] / weight_sum;
+	return sum;
+}
@@ -0,0 +1,58 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+
+// The resampler is internal to clanSound, so this test is built against the source tree
+#include "API/core.h"
+#include "API/sound.h"
+#include "Sound/Mixer/sound_resampler.h"
+using namespace clan;
+
+#include <vector>
+#include <cmath>
+
+class TestApp
+{
+public:
+	int main();
+
+private:
+	void test_interpolation(SoundInterpolation interpolation, const char *name, double tolerance);
+	void mix_blocks(SoundResampler &resampler, const std::vector<float> &input, std::vector<float> &output, std::vector<float> &single_output);
+	void mix_reference(SoundInterpolation interpolation, const std::vector<float> &input, std::vector<float> &output);
+
+	static double get_speed(int fragment);
+	static double reference_sample(SoundInterpolation interpolation, const std::vector<float> &padded, double position, double speed);
+	static double reference_sinc(const std::vector<float> &padded, int index, double t, double speed);
+
+	void fail();
+
+	static const int fragment_size = 256;
+	static const int buffer_size = 1000;
+};
@@ -217,6 +217,13 @@ void TestApp::do_test()
 	SoundSSE::mix_many_to_one(in_float, volumes, 2, data_size, out2_float_buffer1);
 	check_float(out_float_buffer1, out2_float_buffer1, data_size);
 
+	float clamp_volumes[2] = {1.7f, 0.6f};
+	memcpy(out_float_buffer1, in_float_buffer1, sizeof(out_float_buffer1));
+	pack_float_stereo_clamped(in_float, data_size/2, clamp_volumes, out_float_buffer1);
+	memcpy(out2_float_buffer1, in_float_buffer1, sizeof(out2_float_buffer1));
+	SoundSSE::pack_float_stereo_clamped(in_float, data_size/2, clamp_volumes, out2_float_buffer1);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+
 }
 
 void TestApp::check_float(float *aptr, float *bptr, int num)
@@ -320,6 +327,20 @@ void TestApp::pack_float_stereo(float *input[2], int size, float *output)
 	}
 }
 
+void TestApp::pack_float_stereo_clamped(float *input[2], int size, const float volume[2], float *output)
+{
+	for (int i = 0; i < size; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			float value = input[j][i] * volume[j];
+			if (value > 1.0f) value = 1.0f;
+			if (value < -1.0f) value = -1.0f;
+			output[i*2 + j] = value;
+		}
+	}
+}
+
 void TestApp::copy_float(float *input, int size, float *output)
 {
 	const int sse_size = 0;
@@ -49,6 +49,7 @@ private:
 	static void unpack_float_stereo(float *input, int size, float *output[2]);
 	static void pack_16bit_stereo(float *input[2], int size, short *output);
 	static void pack_float_stereo(float *input[2], int size, float *output);
+	static void pack_float_stereo_clamped(float *input[2], int size, const float volume[2], float *output);
 	static void copy_float(float *input, int size, float *output);
 	static void multiply_float(float *channel, int size, float volume);
 	static void set_float(float *channel, int size, float value);
@@ -0,0 +1,297 @@
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/ui.h>
+#include <cmath>
+#include <random>
+
+using namespace clan;
+
+// Builds a deep tree of alternating column and row boxes with text-like leaves, then times relayout after
+// changing the text of a single leaf against a relayout of the whole tree. The geometry after each
+// incremental relayout is compared with the geometry a full relayout produces.
+// The tree also holds a slider and a scroll bar, which restyle their thumbs on every layout. Moving them must
+// only relayout their own subtrees, so the number of leaves measured by each incremental relayout is checked too.
+
+class BenchmarkLeafView : public View
+{
+public:
+	BenchmarkLeafView(const std::string &text) : _text(text) { }
+
+	void set_text(const std::string &text)
+	{
+		_text = text;
+		set_needs_layout();
+	}
+
+	const std::string &text() const { return _text; }
+
+	float get_preferred_width(Canvas &canvas) override
+	{
+		measure_count++;
+		return _text.length() * char_width;
+	}
+
+	float get_preferred_height(Canvas &canvas, float width) override
+	{
+		measure_count++;
+		float lines = std::ceil(_text.length() * char_width / clan::max(width, char_width));
+		return clan::max(lines, 1.0f) * line_height;
+	}
+
+	float get_first_baseline_offset(Canvas &canvas, float width) override
+	{
+		return line_height - 4.0f;
+	}
+
+	float get_last_baseline_offset(Canvas &canvas, float width) override
+	{
+		return get_preferred_height(canvas, width) - 4.0f;
+	}
+
+	/// Number of width and height measurements of all leaves
+	static int measure_count;
+
+private:
+	static const float char_width;
+	static const float line_height;
+
+	std::string _text;
+};
+
+const float BenchmarkLeafView::char_width = 7.0f;
+const float BenchmarkLeafView::line_height = 16.0f;
+int BenchmarkLeafView::measure_count = 0;
+
+// Label whose size follows the computed (possibly inherited) font size, like LabelView does with its font
+class StyledLabelView : public View
+{
+public:
+	StyledLabelView(const std::string &text) : _text(text) { }
+
+	float get_preferred_width(Canvas &canvas) override
+	{
+		return _text.length() * font_size() * 0.5f;
+	}
+
+	float get_preferred_height(Canvas &canvas, float width) override
+	{
+		return font_size() * 1.2f;
+	}
+
+	float get_first_baseline_offset(Canvas &canvas, float width) override
+	{
+		return font_size();
+	}
+
+	float get_last_baseline_offset(Canvas &canvas, float width) override
+	{
+		return font_size();
+	}
+
+private:
+	float font_size() const { return style_cascade().computed_value("font-size").number(); }
+
+	std::string _text;
+};
+
+// Root view that is not attached to any window
+class BenchmarkRootView : public RootView
+{
+public:
+	using RootView::layout;
+
+protected:
+	bool root_hidden() const override { return false; }
+	void set_root_hidden(bool value) override { }
+	Canvas get_root_canvas() const override { return Canvas(); }
+	void set_root_needs_render() override { }
+	void layout_local() override { }
+	Pointf root_to_screen_pos(const Pointf &pos) override { return pos; }
+	Pointf root_from_screen_pos(const Pointf &pos) override { return pos; }
+};
+
+static void build_tree(View *parent, int depth, int branches, bool column, std::minstd_rand &random, std::vector<BenchmarkLeafView *> &leaves)
+{
+	for (int i = 0; i < branches; i++)
+	{
+		if (depth == 0)
+		{
+			auto leaf = std::make_shared<BenchmarkLeafView>(std::string(1 + random() % 20, 'x'));
+			leaf->style()->set("margin: 1px 2px");
+			leaves.push_back(leaf.get());
+			parent->add_subview(leaf);
+		}
+		else
+		{
+			auto box = std::make_shared<View>();
+			box->style()->set(column ? "flex-direction: column" : "flex-direction: row");
+			box->style()->set("padding: 2px");
+			box->style()->set("flex-grow: 1");
+			parent->add_subview(box);
+			build_tree(box.get(), depth - 1, branches, !column, random, leaves);
+		}
+	}
+}
+
+static void invalidate_all(View *view)
+{
+	view->set_needs_layout();
+	for (const auto &subview : view->subviews())
+		invalidate_all(subview.get());
+}
+
+// A state change on a container, or a style change inside it, must resize the labels it contains
+static bool test_style_change_resizes_label()
+{
+	auto root = std::make_shared<BenchmarkRootView>();
+	root->style()->set("flex-direction: column");
+
+	auto container = std::make_shared<View>();
+	container->style()->set("flex-direction: row");
+	root->add_subview(container);
+
+	auto label = std::make_shared<StyledLabelView>("Hello");
+	label->style()->set("font-size: 10px");
+	label->style("big")->set("font-size: 20px");
+	container->add_subview(label);
+
+	root->set_geometry(ViewGeometry::from_content_box(root->style_cascade(), Rectf(0.0f, 0.0f, 640.0f, 480.0f)));
+
+	Canvas canvas;
+	root->layout(canvas);
+	Sizef small_size = label->geometry().content_box().get_size();
+
+	container->set_state_cascade("big", true);
+	root->layout(canvas);
+	Sizef big_size = label->geometry().content_box().get_size();
+
+	label->style("big")->set("font-size: 30px");
+	container->set_needs_layout();
+	root->layout(canvas);
+	Sizef restyled_size = label->geometry().content_box().get_size();
+
+	bool passed = true;
+	if (small_size != Sizef(25.0f, 12.0f) || big_size != Sizef(50.0f, 24.0f) || restyled_size != Sizef(75.0f, 36.0f))
+	{
+		Console::write_line("Label did not follow the font size: %1x%2, %3x%4, %5x%6",
+			small_size.width, small_size.height, big_size.width, big_size.height, restyled_size.width, restyled_size.height);
+		passed = false;
+	}
+	return passed;
+}
+
+static void get_geometry(View *view, std::vector<Rectf> &out_boxes)
+{
+	out_boxes.push_back(view->geometry().content_box());
+	for (const auto &subview : view->subviews())
+		get_geometry(subview.get(), out_boxes);
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		int depth = argc > 1 ? StringHelp::text_to_int(argv[1]) : 7;
+		int branches = argc > 2 ? StringHelp::text_to_int(argv[2]) : 4;
+		int iterations = 200;
+
+		if (!test_style_change_resizes_label())
+			return -1;
+
+		std::minstd_rand random;
+		std::vector<BenchmarkLeafView *> leaves;
+		auto root = std::make_shared<BenchmarkRootView>();
+		root->style()->set("flex-direction: column");
+
+		auto controls = std::make_shared<View>();
+		controls->style()->set("flex-direction: row; height: 20px");
+		auto slider = std::make_shared<SliderView>();
+		slider->style()->set("width: 200px");
+		slider->set_min_position(0);
+		slider->set_max_position(100);
+		controls->add_subview(slider);
+		auto scrollbar = std::make_shared<ScrollBarView>(false);
+		scrollbar->style()->set("width: 200px");
+		scrollbar->set_horizontal();
+		scrollbar->set_range(0.0, 100.0);
+		controls->add_subview(scrollbar);
+		root->add_subview(controls);
+
+		build_tree(root.get(), depth - 1, branches, false, random, leaves);
+		root->set_geometry(ViewGeometry::from_content_box(root->style_cascade(), Rectf(0.0f, 0.0f, 1920.0f, 1080.0f)));
+
+		Canvas canvas;
+		uint64_t start_time = System::get_microseconds();
+		root->layout(canvas);
+		uint64_t initial_time = System::get_microseconds() - start_time;
+
+		std::vector<Rectf> initial_boxes;
+		get_geometry(root.get(), initial_boxes);
+
+		uint64_t incremental_time = 0;
+		uint64_t full_time = 0;
+		uint64_t controls_time = 0;
+		int incremental_measures = 0;
+		int controls_measures = 0;
+		bool passed = true;
+		for (int i = 0; i < iterations; i++)
+		{
+			BenchmarkLeafView *leaf = leaves[random() % leaves.size()];
+			std::string text = leaf->text();
+			if (text.length() > 1 && (i & 1))
+				text.pop_back();
+			else
+				text.push_back('x');
+
+			BenchmarkLeafView::measure_count = 0;
+			start_time = System::get_microseconds();
+			leaf->set_text(text);
+			root->layout(canvas);
+			incremental_time += System::get_microseconds() - start_time;
+			incremental_measures += BenchmarkLeafView::measure_count;
+
+			BenchmarkLeafView::measure_count = 0;
+			start_time = System::get_microseconds();
+			slider->set_position(i % 100);
+			scrollbar->set_position((i * 7) % 100);
+			root->layout(canvas);
+			controls_time += System::get_microseconds() - start_time;
+			controls_measures += BenchmarkLeafView::measure_count;
+
+			std::vector<Rectf> incremental_boxes;
+			get_geometry(root.get(), incremental_boxes);
+
+			start_time = System::get_microseconds();
+			invalidate_all(root.get());
+			root->layout(canvas);
+			full_time += System::get_microseconds() - start_time;
+
+			std::vector<Rectf> full_boxes;
+			get_geometry(root.get(), full_boxes);
+			if (incremental_boxes != full_boxes)
+				passed = false;
+		}
+
+		Console::write_line("%1 views, %2 leaves", (int)initial_boxes.size(), (int)leaves.size());
+		Console::write_line("Initial layout: %1 us", (int)initial_time);
+		Console::write_line("Single leaf text change: %1 us incremental, %2 us full relayout", (int)(incremental_time / iterations), (int)(full_time / iterations));
+		Console::write_line("Slider and scroll bar move: %1 us", (int)(controls_time / iterations));
+		Console::write_line("Leaf measurements per relayout: %1 for a text change, %2 for a slider and scroll bar move", incremental_measures / iterations, controls_measures / iterations);
+
+		if (!passed)
+			Console::write_line("Incremental relayout gave different geometry than a full relayout!");
+
+		// Moving a thumb restyles it, which must not invalidate the measurements of unrelated views
+		if (incremental_measures / iterations > (int)leaves.size() / 10 || controls_measures / iterations > (int)leaves.size() / 10)
+		{
+			Console::write_line("Incremental relayout measured too many leaves!");
+			passed = false;
+		}
+		return passed ? 0 : -1;
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		return -1;
+	}
+}